@@ -39,6 +39,7 @@ struct contextMeshOptions {
   int NewtonConvergenceTestXYZ;
   int ignorePeriodicity, boundaryLayerFanPoints;
   int maxNumThreads1D, maxNumThreads2D, maxNumThreads3D;
+  int domainDecomposition2D, parallelRefinement3D;
   double angleToleranceFacetOverlap;
   int renumber;
   // mesh IO
@@ -296,6 +297,7 @@ public:
     int autoSaveDatabase, autoLoadDatabase;
     int autoArchiveOutputFiles, autoMesh, autoMergeFile;
     int autoShowViews, autoShowLastStep, autoCheck, showInvisibleParameters;
+    int remoteCompression;
   } solver;
   // print options
   struct {
@@ -1030,6 +1030,9 @@ StringXNumber MeshOptions_Number[] = {
   { F,   "CpuTime" , opt_mesh_cpu_time , 0. ,
     "CPU time (in seconds) for the generation of the current mesh (read-only)" },
 
+  { F|O, "DomainDecomposition2D" , opt_mesh_domain_decomposition_2d , 0. ,
+    "Split surfaces whose estimated number of triangles exceeds this value "
+    "into sub-domains meshed in parallel (0: never split)" },
   { F|O, "DrawSkinOnly" , opt_mesh_draw_skin_only , 0. ,
     "Draw only the skin of 3D meshes?" },
   { F|O, "Dual" , opt_mesh_dual , 0. ,
@@ -1116,6 +1119,9 @@ StringXNumber MeshOptions_Number[] = {
     "Version of the MSH file format to use" },
   { F|O, "MedFileMinorVersion" , opt_mesh_med_file_minor_version , -1. ,
     "Minor version of the MED file format to use (-1: use minor version of the MED library)" },
+  { F|O, "ParallelRefinement3D" , opt_mesh_parallel_refinement_3d , 0. ,
+    "Refine 3D Delaunay meshes by batches of points inserted in parallel "
+    "before the serial refinement (experimental)" },
   { F|O, "PartitionHexWeight" , opt_mesh_partition_hex_weight , -1 ,
     "Weight of hexahedral element for METIS load balancing (-1: automatic)" },
   { F|O, "PartitionLineWeight" , opt_mesh_partition_line_weight , -1 ,
@@ -1345,6 +1351,9 @@ StringXNumber SolverOptions_Number[] = {
   { F|O, "Plugins" , opt_solver_plugins , 0. ,
     "Enable default solver plugins?" },
 
+  { F|O, "RemoteCompression" , opt_solver_remote_compression , 0. ,
+    "Ask remote Gmsh servers to send quantized, delta-encoded and compressed "
+    "vertex arrays" },
   { F|O, "ShowInvisibleParameters" , opt_solver_show_invisible_parameters , 0. ,
     "Show all parameters, even those marked invisible" },
 
@@ -31,6 +31,10 @@
 #include "PViewData.h"
 #include "PViewDataRemote.h"
 
+// set while the server asks for compressed vertex arrays
+static bool compressVertexArrays = false;
+static VertexArrayHistory vertexArrayHistory;
+
 static void computeAndSendVertexArrays(GmshClient *client, bool compute = true)
 {
   for(std::size_t i = 0; i < PView::list.size(); i++) {
@@ -48,12 +52,23 @@ static void computeAndSendVertexArrays(GmshClient *client, bool compute = true)
     for(int type = 0; type < 4; type++) {
       if(va[type]) {
         int len;
-        char *str = va[type]->toChar(p->getTag(), data->getName(), type + 1,
-                                     min, max, data->getNumTimeSteps(),
-                                     data->getTime(opt->timeStep),
-                                     data->getBoundingBox(), len);
-        client->SendMessage(GmshSocket::GMSH_VERTEX_ARRAY, len, str);
-        delete[] str;
+        if(compressVertexArrays) {
+          char *str = va[type]->toCompressedChar(
+            p->getTag(), data->getName(), type + 1, min, max,
+            data->getNumTimeSteps(), data->getTime(opt->timeStep),
+            data->getBoundingBox(), vertexArrayHistory, len);
+          client->SendMessage(GmshSocket::GMSH_VERTEX_ARRAY_COMPRESSED, len,
+                              str);
+          delete[] str;
+        }
+        else {
+          char *str = va[type]->toChar(p->getTag(), data->getName(), type + 1,
+                                       min, max, data->getNumTimeSteps(),
+                                       data->getTime(opt->timeStep),
+                                       data->getBoundingBox(), len);
+          client->SendMessage(GmshSocket::GMSH_VERTEX_ARRAY, len, str);
+          delete[] str;
+        }
       }
     }
   }
@@ -213,7 +228,13 @@ int GmshRemote()
         delete[] msg;
         break;
       }
-      else if(type == GmshSocket::GMSH_VERTEX_ARRAY) {
+      else if(type == GmshSocket::GMSH_VERTEX_ARRAY ||
+              type == GmshSocket::GMSH_VERTEX_ARRAY_COMPRESSED) {
+        // a request for plain arrays also resets the references of the
+        // delta-encoding (e.g. after a decoding error on the other end)
+        compressVertexArrays =
+          (type == GmshSocket::GMSH_VERTEX_ARRAY_COMPRESSED);
+        if(!compressVertexArrays) vertexArrayHistory.clear();
         ParseString(msg);
 #if !defined(HAVE_MPI)
         computeAndSendVertexArrays(client);
@@ -46,6 +46,8 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <netdb.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #if defined(HAVE_NO_SOCKLEN_T)
 typedef int socklen_t;
 #endif
@@ -85,6 +87,8 @@ class GmshSocket{
     GMSH_CLIENT_CHANGED      = 34,
     GMSH_PARAMETER_WITHOUT_CHOICES = 35,
     GMSH_PARAMETER_QUERY_WITHOUT_CHOICES = 36,
+    GMSH_SHARED_MEMORY       = 37,
+    GMSH_VERTEX_ARRAY_COMPRESSED = 38,
     GMSH_OPTION_1            = 100,
     GMSH_OPTION_2            = 101,
     GMSH_OPTION_3            = 102,
@@ -97,6 +101,24 @@ class GmshSocket{
   std::string _sockname;
   // statistics
   unsigned long int _sent, _received;
+  // shared memory transport: when both ends are on the same host (i.e. are
+  // connected through a UNIX socket) and the peer has accepted it, large
+  // messages are written in a shared memory segment, and only a control
+  // message with the type, the length and the name of the segment goes
+  // through the socket
+  bool _shm;
+  int _shmCount;
+  char *_shmData;
+  int _shmSize;
+  bool _IsUnixSocket() const
+  {
+#if !defined(WIN32)
+    const char *s = _sockname.c_str();
+    return strstr(s, "/") || strstr(s, "\\") || !strstr(s, ":");
+#else
+    return false;
+#endif
+  }
   // send some data over the socket
   int _SendData(const void *buffer, int bytes)
   {
@@ -128,6 +150,80 @@ class GmshSocket{
     _received += bytes;
     return bytes;
   }
+  // send a message through a new shared memory segment (the receiver unlinks
+  // it)
+  bool _SendSharedMemory(int type, int length, const void *msg)
+  {
+#if !defined(WIN32)
+    char name[256];
+    sprintf(name, "/gmsh-%d-%d", (int)getpid(), _shmCount++);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0) return false;
+    if(ftruncate(fd, length) < 0){
+      close(fd);
+      shm_unlink(name);
+      return false;
+    }
+    void *ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(ptr == MAP_FAILED){
+      shm_unlink(name);
+      return false;
+    }
+    memcpy(ptr, msg, length);
+    munmap(ptr, length);
+    char ctrl[512];
+    sprintf(ctrl, "%d %d %s", type, length, name);
+    int t = GMSH_SHARED_MEMORY, l = strlen(ctrl);
+    _SendData(&t, sizeof(int));
+    _SendData(&l, sizeof(int));
+    _SendData(ctrl, l);
+    return true;
+#else
+    return false;
+#endif
+  }
+  // handle a shared memory control message: either the acceptance of shared
+  // memory messages by the peer (we then read the next header), or the
+  // description of a segment, which is mapped until the body is received
+  int _ReceiveSharedMemory(int *type, int *len)
+  {
+#if !defined(WIN32)
+    std::string ctrl(*len, ' ');
+    if(*len && _ReceiveData(&ctrl[0], *len) != *len) return 0;
+    if(ctrl == "accept"){
+      _shm = true;
+      int swap;
+      return ReceiveHeader(type, len, &swap);
+    }
+    char name[256];
+    if(sscanf(ctrl.c_str(), "%d %d %255s", type, len, name) != 3) return 0;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd < 0) return 0;
+    void *ptr = mmap(NULL, *len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    shm_unlink(name);
+    if(ptr == MAP_FAILED) return 0;
+    _shmData = (char *)ptr;
+    _shmSize = *len;
+    _received += *len;
+    return 1;
+#else
+    return 0;
+#endif
+  }
+  // copy the body of a message received through shared memory
+  int _ReceiveSharedMemoryData(void *buffer, int bytes)
+  {
+#if !defined(WIN32)
+    if(bytes > _shmSize) bytes = _shmSize;
+    memcpy(buffer, _shmData, bytes);
+    munmap(_shmData, _shmSize);
+#endif
+    _shmData = 0;
+    _shmSize = 0;
+    return bytes;
+  }
   // utility function to swap bytes in an array
   void _SwapBytes(char *array, int size, int n)
   {
@@ -150,7 +246,9 @@ class GmshSocket{
 #endif
   }
  public:
-  GmshSocket() : _sock(0), _sent(0), _received(0)
+  GmshSocket()
+    : _sock(0), _sent(0), _received(0), _shm(false), _shmCount(0),
+      _shmData(0), _shmSize(0)
   {
 #if defined(WIN32) && !defined(__CYGWIN__)
     WSADATA wsaData;
@@ -182,6 +280,9 @@ class GmshSocket{
   }
   void SendMessage(int type, int length, const void *msg)
   {
+    // send large messages through shared memory if possible
+    if(_shm && length > (1 << 20) && _SendSharedMemory(type, length, msg))
+      return;
     // send header (type + length)
     _SendData(&type, sizeof(int));
     _SendData(&length, sizeof(int));
@@ -218,6 +319,7 @@ class GmshSocket{
       }
       if(_ReceiveData(len, sizeof(int)) > 0){
         if(*swap) _SwapBytes((char*)len, sizeof(int), 1);
+        if(*type == GMSH_SHARED_MEMORY) return _ReceiveSharedMemory(type, len);
         return 1;
       }
     }
@@ -225,12 +327,18 @@ class GmshSocket{
   }
   int ReceiveMessage(int len, void *buffer)
   {
+    if(_shmData) return _ReceiveSharedMemoryData(buffer, len) == len;
     if(_ReceiveData(buffer, len) == len) return 1;
     return 0;
   }
   // str should be allocated with size (len+1)
   int ReceiveString(int len, char *str)
   {
+    if(_shmData) {
+      if(_ReceiveSharedMemoryData(str, len) != len) return 0;
+      str[len] = '\0';
+      return 1;
+    }
     if(_ReceiveData(str, len) == len) {
       str[len] = '\0';
       return 1;
@@ -251,6 +359,14 @@ class GmshSocket{
     shutdown(s, SHUT_RDWR);
 #endif
   }
+  // tell the peer that we can receive messages through shared memory, and
+  // allow sending them (the peer has advertised it in its start message)
+  void AcceptSharedMemory()
+  {
+    if(!_IsUnixSocket()) return;
+    SendString(GMSH_SHARED_MEMORY, "accept");
+    _shm = true;
+  }
   unsigned long int SentBytes(){ return _sent; }
   unsigned long int ReceivedBytes(){ return _received; }
 };
@@ -261,6 +377,7 @@ class GmshClient : public GmshSocket {
   ~GmshClient(){}
   int Connect(const char *sockname)
   {
+    _sockname = sockname;
     if(strstr(sockname, "/") || strstr(sockname, "\\") || !strstr(sockname, ":")){
 #if !defined(WIN32) || defined(__CYGWIN__)
       // UNIX socket (testing ":" is not enough with Windows paths)
@@ -326,6 +443,8 @@ class GmshClient : public GmshSocket {
 #else
     sprintf(tmp, "%d", _getpid());
 #endif
+    // advertise that we can use shared memory on the same host
+    if(_IsUnixSocket()) strcat(tmp, " shm");
     SendString(GMSH_START, tmp);
   }
   void Stop(){ SendString(GMSH_STOP, "Goodbye!"); }
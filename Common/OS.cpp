@@ -280,6 +280,25 @@ FILE *Fopen(const char *f, const char *mode)
 #endif
 }
 
+// file positions on 64 bits (long is 32 bits on Windows)
+long long Ftell(FILE *fp)
+{
+#if defined(WIN32) && !defined(__CYGWIN__)
+  return _ftelli64(fp);
+#else
+  return ftello(fp);
+#endif
+}
+
+int Fseek(FILE *fp, long long offset, int whence)
+{
+#if defined(WIN32) && !defined(__CYGWIN__)
+  return _fseeki64(fp, offset, whence);
+#else
+  return fseeko(fp, offset, whence);
+#endif
+}
+
 const char *GetEnvironmentVar(const char *var)
 {
 #if defined(WIN32) && !defined(__CYGWIN__)
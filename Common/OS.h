@@ -10,6 +10,8 @@
 #include <stdio.h>
 
 FILE *Fopen(const char *f, const char *mode);
+long long Ftell(FILE *fp);
+int Fseek(FILE *fp, long long offset, int whence);
 const char *GetEnvironmentVar(const char *var);
 void SetEnvironmentVar(const char *var, const char *val);
 void SleepInSeconds(double s);
@@ -6546,6 +6546,13 @@ double opt_mesh_max_num_threads_2d(OPT_ARGS_NUM)
   return CTX::instance()->mesh.maxNumThreads2D;
 }
 
+double opt_mesh_domain_decomposition_2d(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET)
+    CTX::instance()->mesh.domainDecomposition2D = (int) val;
+  return CTX::instance()->mesh.domainDecomposition2D;
+}
+
 double opt_mesh_max_num_threads_3d(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET)
@@ -6553,6 +6560,13 @@ double opt_mesh_max_num_threads_3d(OPT_ARGS_NUM)
   return CTX::instance()->mesh.maxNumThreads3D;
 }
 
+double opt_mesh_parallel_refinement_3d(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET)
+    CTX::instance()->mesh.parallelRefinement3D = (int) val;
+  return CTX::instance()->mesh.parallelRefinement3D;
+}
+
 double opt_mesh_angle_tolerance_facet_overlap(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET){
@@ -6664,6 +6678,13 @@ double opt_solver_show_invisible_parameters(OPT_ARGS_NUM)
   return CTX::instance()->solver.showInvisibleParameters;
 }
 
+double opt_solver_remote_compression(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET)
+    CTX::instance()->solver.remoteCompression = (int)val;
+  return CTX::instance()->solver.remoteCompression;
+}
+
 double opt_post_horizontal_scales(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET)
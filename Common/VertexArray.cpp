@@ -11,6 +11,10 @@
 #include "Numeric.h"
 #include "OS.h"
 
+#if defined(HAVE_LIBZ)
+#include <zlib.h>
+#endif
+
 template<int N> float ElementDataLessThan<N>::tolerance = 0.0F;
 float BarycenterLessThan::tolerance = 0.0F;
 
@@ -231,21 +235,15 @@ void VertexArray::sort(double x, double y, double z)
   _colors = sortedColors;
 }
 
-char *VertexArray::toChar(int num, const std::string &name, int type,
-                          double min, double max, int numsteps, double time,
-                          const SBoundingBox3d &bbox, int &len)
+static int encodeHeader(char *bytes, int num, const std::string &name,
+                        int type, double min, double max, int numsteps,
+                        double time, const SBoundingBox3d &bbox)
 {
-  int vn = _vertices.size(), nn = _normals.size(), cn = _colors.size();
-  int vs = vn * sizeof(float),
-      ns = nn * sizeof(normal_type),
-      cs = cn * sizeof(unsigned char);
   int is = sizeof(int), ds = sizeof(double);
   int ss = name.size();
   double xmin = bbox.min().x(), ymin = bbox.min().y(), zmin = bbox.min().z();
   double xmax = bbox.max().x(), ymax = bbox.max().y(), zmax = bbox.max().z();
 
-  len = ss + 7 * is + 9 * ds + vs + ns + cs;
-  char *bytes = new char[len];
   int index = 0;
   memcpy(&bytes[index], &num, is); index += is;
   memcpy(&bytes[index], &ss, is); index += is;
@@ -261,6 +259,24 @@ char *VertexArray::toChar(int num, const std::string &name, int type,
   memcpy(&bytes[index], &xmax, ds); index += ds;
   memcpy(&bytes[index], &ymax, ds); index += ds;
   memcpy(&bytes[index], &zmax, ds); index += ds;
+  return index;
+}
+
+char *VertexArray::toChar(int num, const std::string &name, int type,
+                          double min, double max, int numsteps, double time,
+                          const SBoundingBox3d &bbox, int &len)
+{
+  int vn = _vertices.size(), nn = _normals.size(), cn = _colors.size();
+  int vs = vn * sizeof(float),
+      ns = nn * sizeof(normal_type),
+      cs = cn * sizeof(unsigned char);
+  int is = sizeof(int), ds = sizeof(double);
+  int ss = name.size();
+
+  len = ss + 7 * is + 9 * ds + vs + ns + cs;
+  char *bytes = new char[len];
+  int index = encodeHeader(bytes, num, name, type, min, max, numsteps, time,
+                           bbox);
   memcpy(&bytes[index], &vn, is); index += is;
   if(vs){ memcpy(&bytes[index], &_vertices[0], vs); index += vs; }
   memcpy(&bytes[index], &nn, is); index += is;
@@ -270,6 +286,81 @@ char *VertexArray::toChar(int num, const std::string &name, int type,
   return bytes;
 }
 
+char *VertexArray::toCompressedChar(int num, const std::string &name, int type,
+                                    double min, double max, int numsteps,
+                                    double time, const SBoundingBox3d &bbox,
+                                    VertexArrayHistory &history, int &len)
+{
+  int vn = _vertices.size(), nn = _normals.size(), cn = _colors.size();
+  int is = sizeof(int), ds = sizeof(double), us = sizeof(unsigned short);
+
+  // quantize the coordinates in the bounding box of the vertices; the raw
+  // data contains the box, then the coordinates, the normals (as bytes) and
+  // the colors
+  double qmin[3] = {0., 0., 0.}, qmax[3] = {0., 0., 0.};
+  for(int i = 0; i < vn; i++){
+    int d = i % 3;
+    if(i < 3 || _vertices[i] < qmin[d]) qmin[d] = _vertices[i];
+    if(i < 3 || _vertices[i] > qmax[d]) qmax[d] = _vertices[i];
+  }
+  std::vector<unsigned char> raw(6 * ds + vn * us + nn + cn);
+  int index = 0;
+  memcpy(&raw[index], qmin, 3 * ds); index += 3 * ds;
+  memcpy(&raw[index], qmax, 3 * ds); index += 3 * ds;
+  for(int i = 0; i < vn; i++){
+    int d = i % 3;
+    double s = (qmax[d] > qmin[d]) ? 65535. / (qmax[d] - qmin[d]) : 0.;
+    unsigned short q = (unsigned short)((_vertices[i] - qmin[d]) * s + 0.5);
+    memcpy(&raw[index], &q, us); index += us;
+  }
+  for(int i = 0; i < nn; i++){
+#if defined(HAVE_VISUDEV)
+    char c = float2char(_normals[i]);
+#else
+    char c = _normals[i];
+#endif
+    raw[index++] = (unsigned char)c;
+  }
+  for(int i = 0; i < cn; i++) raw[index++] = _colors[i];
+
+  // delta-encode with respect to the previous array if it has the same size
+  // and was quantized in the same box (e.g. successive time steps on the same
+  // mesh): unchanged data becomes zeros
+  std::vector<unsigned char> &last = history[std::make_pair(num, type)];
+  int flags = 0;
+  std::vector<unsigned char> packed(raw);
+  if(last.size() == raw.size() && !memcmp(&last[0], &raw[0], 6 * ds)){
+    flags |= 2;
+    for(std::size_t i = 6 * ds; i < raw.size(); i++)
+      packed[i] = raw[i] - last[i];
+  }
+  last.swap(raw);
+
+  int rawSize = packed.size(), packedSize = rawSize;
+#if defined(HAVE_LIBZ)
+  std::vector<unsigned char> z(compressBound(rawSize));
+  uLongf zlen = z.size();
+  if(compress2(&z[0], &zlen, &packed[0], rawSize, Z_BEST_SPEED) == Z_OK &&
+     (int)zlen < rawSize){
+    flags |= 1;
+    packedSize = zlen;
+    packed.swap(z);
+  }
+#endif
+
+  len = name.size() + 10 * is + 9 * ds + packedSize;
+  char *bytes = new char[len];
+  index = encodeHeader(bytes, num, name, type, min, max, numsteps, time, bbox);
+  memcpy(&bytes[index], &flags, is); index += is;
+  memcpy(&bytes[index], &vn, is); index += is;
+  memcpy(&bytes[index], &nn, is); index += is;
+  memcpy(&bytes[index], &cn, is); index += is;
+  memcpy(&bytes[index], &rawSize, is); index += is;
+  memcpy(&bytes[index], &packedSize, is); index += is;
+  if(packedSize){ memcpy(&bytes[index], &packed[0], packedSize); }
+  return bytes;
+}
+
 int VertexArray::decodeHeader(int length, const char *bytes, int swap,
                               std::string &name, int &tag, int &type,
                               double &min, double &max, int &numSteps, double &time,
@@ -340,6 +431,93 @@ void VertexArray::fromChar(int length, const char *bytes, int swap)
   }
 }
 
+bool VertexArray::fromCompressedChar(int length, const char *bytes, int swap,
+                                     VertexArrayHistory &history)
+{
+  std::string name;
+  int tag, type, numSteps;
+  double min, max, time, xmin, ymin, zmin, xmax, ymax, zmax;
+  int index = decodeHeader(length, bytes, swap, name, tag, type, min, max,
+                           numSteps, time, xmin, ymin, zmin, xmax, ymax, zmax);
+  if(!index) return false;
+
+  int is = sizeof(int), ds = sizeof(double), us = sizeof(unsigned short);
+  // the reference of the delta-encoding is lost on any error
+  std::pair<int, int> key(tag, type);
+  if(length < index + 6 * is){
+    Msg::Error("Too few bytes to create compressed vertex array: %d", length);
+    history.erase(key);
+    return false;
+  }
+  int flags, vn, nn, cn, rawSize, packedSize;
+  memcpy(&flags, &bytes[index], is); index += is;
+  memcpy(&vn, &bytes[index], is); index += is;
+  memcpy(&nn, &bytes[index], is); index += is;
+  memcpy(&cn, &bytes[index], is); index += is;
+  memcpy(&rawSize, &bytes[index], is); index += is;
+  memcpy(&packedSize, &bytes[index], is); index += is;
+  if(rawSize != 6 * ds + vn * us + nn + cn ||
+     length < index + packedSize){
+    Msg::Error("Corrupted compressed vertex array");
+    history.erase(key);
+    return false;
+  }
+
+  std::vector<unsigned char> raw(rawSize);
+  if(flags & 1){
+#if defined(HAVE_LIBZ)
+    uLongf rlen = rawSize;
+    if(uncompress(&raw[0], &rlen, (const Bytef *)&bytes[index], packedSize) !=
+         Z_OK || (int)rlen != rawSize){
+      Msg::Error("Could not uncompress vertex array");
+      history.erase(key);
+      return false;
+    }
+#else
+    Msg::Error("Gmsh must be compiled with zlib to read compressed vertex "
+               "arrays");
+    history.erase(key);
+    return false;
+#endif
+  }
+  else if(rawSize)
+    memcpy(&raw[0], &bytes[index], rawSize);
+
+  std::vector<unsigned char> &last = history[key];
+  if(flags & 2){
+    if(last.size() != raw.size()){
+      Msg::Error("Missing reference for delta-encoded vertex array");
+      history.erase(key);
+      return false;
+    }
+    for(std::size_t i = 6 * ds; i < raw.size(); i++) raw[i] += last[i];
+  }
+  last = raw;
+
+  double qmin[3], qmax[3];
+  index = 0;
+  memcpy(qmin, &raw[index], 3 * ds); index += 3 * ds;
+  memcpy(qmax, &raw[index], 3 * ds); index += 3 * ds;
+  _vertices.resize(vn);
+  for(int i = 0; i < vn; i++){
+    int d = i % 3;
+    unsigned short q;
+    memcpy(&q, &raw[index], us); index += us;
+    _vertices[i] = qmin[d] + q * (qmax[d] - qmin[d]) / 65535.;
+  }
+  _normals.resize(nn);
+  for(int i = 0; i < nn; i++){
+#if defined(HAVE_VISUDEV)
+    _normals[i] = char2float((char)raw[index++]);
+#else
+    _normals[i] = (char)raw[index++];
+#endif
+  }
+  _colors.resize(cn);
+  for(int i = 0; i < cn; i++) _colors[i] = raw[index++];
+  return true;
+}
+
 void VertexArray::merge(VertexArray* va)
 {
   if(va->getNumVertices() != 0) {
@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <string>
 #include "SVector3.h"
 #include "SBoundingBox3d.h"
 
@@ -19,6 +21,11 @@ typedef char normal_type;
 
 class MElement;
 
+// last quantized arrays sent or received for each (view tag, array type), used
+// for the delta-encoding of compressed vertex arrays
+typedef std::map<std::pair<int, int>, std::vector<unsigned char> >
+  VertexArrayHistory;
+
 template <int N> class ElementData {
 private:
   float _x[N], _y[N], _z[N], _nx[N], _ny[N], _nz[N];
@@ -224,6 +231,16 @@ public:
                double max, int numsteps, double time,
                const SBoundingBox3d &bbox, int &len);
   void fromChar(int length, const char *bytes, int swap);
+  // same as toChar/fromChar, with the vertex coordinates quantized on 16 bits,
+  // the arrays delta-encoded with respect to the previous array of the same
+  // view and type, and compressed with zlib (if available); fromCompressedChar
+  // returns false (and forgets the reference of the array) on error
+  char *toCompressedChar(int num, const std::string &name, int type,
+                         double min, double max, int numsteps, double time,
+                         const SBoundingBox3d &bbox,
+                         VertexArrayHistory &history, int &len);
+  bool fromCompressedChar(int length, const char *bytes, int swap,
+                          VertexArrayHistory &history);
   static int decodeHeader(int length, const char *bytes, int swap,
                           std::string &name, int &tag, int &type, double &min,
                           double &max, int &numSteps, double &time,
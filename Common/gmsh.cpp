@@ -607,6 +607,28 @@ GMSH_API void gmsh::model::getPartitions(const int dim, const int tag,
     partitions.push_back(p[i]);
 }
 
+static void _splitParametricCoord(const std::vector<double> &parametricCoord,
+                                  std::vector<double> &u,
+                                  std::vector<double> &v)
+{
+  std::size_t n = parametricCoord.size() / 2;
+  u.resize(n);
+  v.resize(n);
+  for(std::size_t i = 0; i < n; i++) {
+    u[i] = parametricCoord[2 * i];
+    v[i] = parametricCoord[2 * i + 1];
+  }
+}
+
+static void _interleave(const std::vector<double> xyz[3],
+                        std::vector<double> &out)
+{
+  std::size_t n = xyz[0].size();
+  out.resize(3 * n);
+  for(std::size_t i = 0; i < n; i++)
+    for(int d = 0; d < 3; d++) out[3 * i + d] = xyz[d][i];
+}
+
 GMSH_API void gmsh::model::getValue(const int dim, const int tag,
                                     const std::vector<double> &parametricCoord,
                                     std::vector<double> &points)
@@ -627,23 +649,17 @@ GMSH_API void gmsh::model::getValue(const int dim, const int tag,
   }
   else if(dim == 1) {
     GEdge *ge = static_cast<GEdge *>(entity);
-    for(std::size_t i = 0; i < parametricCoord.size(); i++) {
-      GPoint gp = ge->point(parametricCoord[i]);
-      points.push_back(gp.x());
-      points.push_back(gp.y());
-      points.push_back(gp.z());
-    }
+    std::vector<double> xyz[3];
+    ge->points(parametricCoord, xyz);
+    _interleave(xyz, points);
   }
   else if(dim == 2) {
     if(parametricCoord.size() < 2) return;
     GFace *gf = static_cast<GFace *>(entity);
-    for(std::size_t i = 0; i < parametricCoord.size(); i += 2) {
-      SPoint2 param(parametricCoord[i], parametricCoord[i + 1]);
-      GPoint gp = gf->point(param);
-      points.push_back(gp.x());
-      points.push_back(gp.y());
-      points.push_back(gp.z());
-    }
+    std::vector<double> u, v, xyz[3];
+    _splitParametricCoord(parametricCoord, u, v);
+    gf->points(u, v, xyz);
+    _interleave(xyz, points);
   }
 }
 
@@ -663,25 +679,22 @@ gmsh::model::getDerivative(const int dim, const int tag,
   }
   if(dim == 1) {
     GEdge *ge = static_cast<GEdge *>(entity);
-    for(std::size_t i = 0; i < parametricCoord.size(); i++) {
-      SVector3 d = ge->firstDer(parametricCoord[i]);
-      deriv.push_back(d.x());
-      deriv.push_back(d.y());
-      deriv.push_back(d.z());
-    }
+    std::vector<double> d[3];
+    ge->firstDers(parametricCoord, d);
+    _interleave(d, deriv);
   }
   else if(dim == 2) {
     if(parametricCoord.size() < 2) return;
     GFace *gf = static_cast<GFace *>(entity);
-    for(std::size_t i = 0; i < parametricCoord.size(); i += 2) {
-      SPoint2 param(parametricCoord[i], parametricCoord[i + 1]);
-      Pair<SVector3, SVector3> d = gf->firstDer(param);
-      deriv.push_back(d.left().x());
-      deriv.push_back(d.left().y());
-      deriv.push_back(d.left().z());
-      deriv.push_back(d.right().x());
-      deriv.push_back(d.right().y());
-      deriv.push_back(d.right().z());
+    std::vector<double> u, v, du[3], dv[3];
+    _splitParametricCoord(parametricCoord, u, v);
+    gf->firstDers(u, v, du, dv);
+    deriv.resize(6 * u.size());
+    for(std::size_t i = 0; i < u.size(); i++) {
+      for(int j = 0; j < 3; j++) {
+        deriv[6 * i + j] = du[j][i];
+        deriv[6 * i + 3 + j] = dv[j][i];
+      }
     }
   }
 }
@@ -702,16 +715,14 @@ gmsh::model::getCurvature(const int dim, const int tag,
   }
   if(dim == 1) {
     GEdge *ge = static_cast<GEdge *>(entity);
-    for(std::size_t i = 0; i < parametricCoord.size(); i++)
-      curvatures.push_back(ge->curvature(parametricCoord[i]));
+    ge->curvatures(parametricCoord, curvatures);
   }
   else if(dim == 2) {
     if(parametricCoord.size() < 2) return;
     GFace *gf = static_cast<GFace *>(entity);
-    for(std::size_t i = 0; i < parametricCoord.size(); i += 2) {
-      SPoint2 param(parametricCoord[i], parametricCoord[i + 1]);
-      curvatures.push_back(gf->curvatureMax(param));
-    }
+    std::vector<double> u, v;
+    _splitParametricCoord(parametricCoord, u, v);
+    gf->curvaturesMax(u, v, curvatures);
   }
 }
 
@@ -763,13 +774,10 @@ GMSH_API void gmsh::model::getNormal(const int tag,
   }
   normals.clear();
   if(parametricCoord.size() < 2) return;
-  for(std::size_t i = 0; i < parametricCoord.size(); i += 2) {
-    SPoint2 param(parametricCoord[i], parametricCoord[i + 1]);
-    SVector3 n = gf->normal(param);
-    normals.push_back(n.x());
-    normals.push_back(n.y());
-    normals.push_back(n.z());
-  }
+  std::vector<double> u, v, n[3];
+  _splitParametricCoord(parametricCoord, u, v);
+  gf->normals(u, v, n);
+  _interleave(n, normals);
 }
 
 GMSH_API void gmsh::model::setVisibility(const vectorpair &dimTags,
@@ -245,7 +245,11 @@ bool gmshLocalNetworkClient::receiveMessage(gmshLocalNetworkClient *master)
   }
 
   switch(type) {
-  case GmshSocket::GMSH_START: setPid(atoi(message.c_str())); break;
+  case GmshSocket::GMSH_START:
+    setPid(atoi(message.c_str()));
+    if(message.find("shm") != std::string::npos)
+      getGmshServer()->AcceptSharedMemory();
+    break;
   case GmshSocket::GMSH_STOP:
     setPid(-1);
     if(getFather()) {
@@ -443,9 +447,11 @@ bool gmshLocalNetworkClient::receiveMessage(gmshLocalNetworkClient *master)
     Msg::Info("Got %d Mb message in %g seconds", length / 1024 / 1024,
               TimeOfDay() - timer);
     break;
-  case GmshSocket::GMSH_VERTEX_ARRAY: {
+  case GmshSocket::GMSH_VERTEX_ARRAY:
+  case GmshSocket::GMSH_VERTEX_ARRAY_COMPRESSED: {
     int n = PView::list.size();
-    PView::fillVertexArray(this, length, &message[0], swap);
+    PView::fillVertexArray(this, length, &message[0], swap,
+                           type == GmshSocket::GMSH_VERTEX_ARRAY_COMPRESSED);
 #if defined(HAVE_FLTK)
     if(FlGui::available())
       FlGui::instance()->updateViews(n != (int)PView::list.size(), true);
@@ -5,6 +5,7 @@
 //
 // Contributed by Matti Pellikka <matti.pellikka@gmail.com>.
 
+#include <algorithm>
 #include "Cell.h"
 #include "MTriangle.h"
 #include "MQuadrangle.h"
@@ -42,6 +43,27 @@ bool equalVertices(const std::vector<MVertex *> &v1,
 
 int Cell::_globalNum = 0;
 
+class Less_BdCell {
+public:
+  bool operator()(const std::pair<Cell *, BdInfo> &p, const Cell *c) const
+  {
+    return Less_Cell()(p.first, c);
+  }
+};
+
+static Cell::biter findBdCell(Cell::bdList &l, Cell *cell)
+{
+  Cell::biter it = std::lower_bound(l.begin(), l.end(), cell, Less_BdCell());
+  if(it != l.end() && !Less_Cell()(cell, it->first)) return it;
+  return l.end();
+}
+
+static void insertBdCell(Cell::bdList &l, Cell *cell, int orientation)
+{
+  Cell::biter it = std::lower_bound(l.begin(), l.end(), cell, Less_BdCell());
+  l.insert(it, std::make_pair(cell, BdInfo(orientation)));
+}
+
 std::pair<Cell *, bool> Cell::createCell(MElement *element, int domain)
 {
   Cell *cell = new Cell();
@@ -98,20 +120,25 @@ Cell::Cell(Cell *parent, int i)
 
 bool Cell::_sortVertexIndices()
 {
-  std::map<MVertex *, int, MVertexLessThanNum> si;
-
-  bool noinsert = false;
-  for(std::size_t i = 0; i < _v.size(); i++)
-    noinsert = (!si.insert(std::make_pair(_v[i], i)).second || noinsert);
-
-  if(noinsert == true) {
-    Msg::Warning("The input mesh has degenerate elements, ignored");
-    return false;
+  // insertion sort of the (at most 8) vertex indices by vertex number
+  const int n = _v.size();
+  _si.resize(n);
+  for(int i = 0; i < n; i++) {
+    int j = i;
+    while(j > 0 && _v[(int)_si[j - 1]]->getNum() > _v[i]->getNum()) {
+      _si[j] = _si[j - 1];
+      j--;
+    }
+    _si[j] = i;
   }
 
-  std::map<MVertex *, int, MVertexLessThanNum>::iterator it;
-  for(it = si.begin(); it != si.end(); it++) _si.push_back(it->second);
-
+  for(int i = 1; i < n; i++) {
+    if(_v[(int)_si[i]]->getNum() == _v[(int)_si[i - 1]]->getNum()) {
+      Msg::Warning("The input mesh has degenerate elements, ignored");
+      _si.clear();
+      return false;
+    }
+  }
   return true;
 }
 
@@ -533,18 +560,20 @@ void Cell::restoreCellBoundary()
     it->second.reset();
     if(it->second.get() == 0) toRemove.push_back(it->first);
   }
-  for(std::size_t i = 0; i < toRemove.size(); i++) _cbd.erase(toRemove[i]);
+  for(std::size_t i = 0; i < toRemove.size(); i++)
+    _cbd.erase(findBdCell(_cbd, toRemove[i]));
   toRemove.clear();
   for(biter it = firstBoundary(true); it != lastBoundary(); it++) {
     it->second.reset();
     if(it->second.get() == 0) toRemove.push_back(it->first);
   }
-  for(std::size_t i = 0; i < toRemove.size(); i++) _bd.erase(toRemove[i]);
+  for(std::size_t i = 0; i < toRemove.size(); i++)
+    _bd.erase(findBdCell(_bd, toRemove[i]));
 }
 
 void Cell::addBoundaryCell(int orientation, Cell *cell, bool other)
 {
-  biter it = _bd.find(cell);
+  biter it = findBdCell(_bd, cell);
   if(it != _bd.end()) {
     int newOrientation = it->second.get() + orientation;
     it->second.set(newOrientation);
@@ -557,13 +586,13 @@ void Cell::addBoundaryCell(int orientation, Cell *cell, bool other)
     }
   }
   else
-    _bd.insert(std::make_pair(cell, BdInfo(orientation)));
+    insertBdCell(_bd, cell, orientation);
   if(other) cell->addCoboundaryCell(orientation, this, false);
 }
 
 void Cell::addCoboundaryCell(int orientation, Cell *cell, bool other)
 {
-  biter it = _cbd.find(cell);
+  biter it = findBdCell(_cbd, cell);
   if(it != _cbd.end()) {
     int newOrientation = it->second.get() + orientation;
     it->second.set(newOrientation);
@@ -576,13 +605,13 @@ void Cell::addCoboundaryCell(int orientation, Cell *cell, bool other)
     }
   }
   else
-    _cbd.insert(std::make_pair(cell, BdInfo(orientation)));
+    insertBdCell(_cbd, cell, orientation);
   if(other) cell->addBoundaryCell(orientation, this, false);
 }
 
 void Cell::removeBoundaryCell(Cell *cell, bool other)
 {
-  biter it = _bd.find(cell);
+  biter it = findBdCell(_bd, cell);
   if(it != _bd.end()) {
     it->second.set(0);
     if(other) it->first->removeCoboundaryCell(this, false);
@@ -592,7 +621,7 @@ void Cell::removeBoundaryCell(Cell *cell, bool other)
 
 void Cell::removeCoboundaryCell(Cell *cell, bool other)
 {
-  biter it = _cbd.find(cell);
+  biter it = findBdCell(_cbd, cell);
   if(it != _cbd.end()) {
     it->second.set(0);
     if(other) it->first->removeBoundaryCell(this, false);
@@ -603,12 +632,12 @@ void Cell::removeCoboundaryCell(Cell *cell, bool other)
 bool Cell::hasBoundary(Cell *cell, bool orig)
 {
   if(!orig) {
-    biter it = _bd.find(cell);
+    biter it = findBdCell(_bd, cell);
     if(it != _bd.end() && it->second.get() != 0) return true;
     return false;
   }
   else {
-    biter it = _bd.find(cell);
+    biter it = findBdCell(_bd, cell);
     if(it != _bd.end() && it->second.geto() != 0) return true;
     return false;
   }
@@ -617,12 +646,12 @@ bool Cell::hasBoundary(Cell *cell, bool orig)
 bool Cell::hasCoboundary(Cell *cell, bool orig)
 {
   if(!orig) {
-    biter it = _cbd.find(cell);
+    biter it = findBdCell(_cbd, cell);
     if(it != _cbd.end() && it->second.get() != 0) return true;
     return false;
   }
   else {
-    biter it = _cbd.find(cell);
+    biter it = findBdCell(_cbd, cell);
     if(it != _cbd.end() && it->second.geto() != 0) return true;
     return false;
   }
@@ -632,9 +661,9 @@ Cell::biter Cell::firstBoundary(bool orig)
 {
   biter it = _bd.begin();
   if(!orig)
-    while(it->second.get() == 0 && it != _bd.end()) it++;
+    while(it != _bd.end() && it->second.get() == 0) it++;
   else
-    while(it->second.geto() == 0 && it != _bd.end()) it++;
+    while(it != _bd.end() && it->second.geto() == 0) it++;
   return it;
 }
 
@@ -644,9 +673,9 @@ Cell::biter Cell::firstCoboundary(bool orig)
 {
   biter it = _cbd.begin();
   if(!orig)
-    while(it->second.get() == 0 && it != _cbd.end()) it++;
+    while(it != _cbd.end() && it->second.get() == 0) it++;
   else
-    while(it->second.geto() == 0 && it != _cbd.end()) it++;
+    while(it != _cbd.end() && it->second.geto() == 0) it++;
   return it;
 }
 
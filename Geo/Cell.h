@@ -51,9 +51,15 @@ protected:
   // for some algorithms to omit this cell
   bool _immune;
 
+public:
+  // list of (co)boundary cells, sorted with Less_Cell (stored contiguously,
+  // which takes much less memory than a map)
+  typedef std::vector<std::pair<Cell *, BdInfo> > bdList;
+
+protected:
   // list of cells on the boundary and on the coboundary of this cell
-  std::map<Cell *, BdInfo, Less_Cell> _bd;
-  std::map<Cell *, BdInfo, Less_Cell> _cbd;
+  bdList _bd;
+  bdList _cbd;
 
   Cell() {}
 
@@ -105,7 +111,7 @@ public:
   virtual bool hasVertex(int vertex) const;
 
   // (co)boundary cell iterator
-  typedef std::map<Cell *, BdInfo, Less_Cell>::iterator biter;
+  typedef bdList::iterator biter;
 
   // iterators to (first/last (co)boundary cells of this cell
   // (orig: to original (co)boundary cells of this cell)
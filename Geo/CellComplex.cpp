@@ -75,6 +75,14 @@ bool CellComplex::_insertCells(std::vector<MElement *> &elements, int domain)
 
   double t1 = Cpu();
 
+  // the cells are created in parallel, and inserted serially
+  std::vector<std::pair<Cell *, bool> > elementCells(elements.size());
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < (int)elements.size(); i++)
+    elementCells[i] = Cell::createCell(elements[i], domain);
+
   for(std::size_t i = 0; i < elements.size(); i++) {
     MElement *element = elements.at(i);
     int dim = element->getDim();
@@ -86,7 +94,7 @@ bool CellComplex::_insertCells(std::vector<MElement *> &elements, int domain)
     if(type == TYPE_QUA || type == TYPE_HEX || type == TYPE_PYR ||
        type == TYPE_PRI)
       _simplicial = false;
-    std::pair<Cell *, bool> maybeCell = Cell::createCell(element, domain);
+    std::pair<Cell *, bool> maybeCell = elementCells[i];
     if(!maybeCell.second) {
       delete maybeCell.first;
       continue;
@@ -123,31 +131,50 @@ bool CellComplex::_insertCells(std::vector<MElement *> &elements, int domain)
         Msg::Info(" - Creating subdomain %d-cells", dim);
     }
 
-    for(citer cit = firstCell(dim); cit != lastCell(dim); cit++) {
-      Cell *cell = *cit;
-      for(int i = 0; i < cell->getNumBdElements(); i++) {
-        std::pair<Cell *, bool> maybeCell = Cell::createCell(cell, i);
-        if(!maybeCell.second) {
-          delete maybeCell.first;
-          continue;
-        }
-        Cell *newCell = maybeCell.first;
-        std::pair<citer, bool> insert =
-          _cells[newCell->getDim()].insert(newCell);
-        if(!insert.second) {
-          delete newCell;
-          newCell = *(insert.first);
-          if(domain) newCell->setDomain(domain);
-        }
-        else
-          _createCount++;
-        if(domain == 0) {
-          int ori = cell->findBdCellOrientation(newCell, i);
-          cell->addBoundaryCell(ori, newCell, true);
-          if(_smallestCell.first == cell)
-            _smallestCell = std::make_pair(newCell, _smallestCell.second);
-          if(_biggestCell.first == cell)
-            _biggestCell = std::make_pair(newCell, _biggestCell.second);
+    // create the boundary cells of chunks of cells in parallel (the chunks
+    // bound the number of duplicate boundary cells alive at the same time)
+    const std::size_t chunkSize = 100000;
+    std::vector<Cell *> cells(firstCell(dim), lastCell(dim));
+    std::vector<std::vector<std::pair<Cell *, bool> > > bdCells;
+    for(std::size_t start = 0; start < cells.size(); start += chunkSize) {
+      const int n = std::min(chunkSize, cells.size() - start);
+      bdCells.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+      for(int j = 0; j < n; j++) {
+        Cell *cell = cells[start + j];
+        bdCells[j].resize(cell->getNumBdElements());
+        for(int i = 0; i < cell->getNumBdElements(); i++)
+          bdCells[j][i] = Cell::createCell(cell, i);
+      }
+
+      for(int j = 0; j < n; j++) {
+        Cell *cell = cells[start + j];
+        for(int i = 0; i < cell->getNumBdElements(); i++) {
+          std::pair<Cell *, bool> maybeCell = bdCells[j][i];
+          if(!maybeCell.second) {
+            delete maybeCell.first;
+            continue;
+          }
+          Cell *newCell = maybeCell.first;
+          std::pair<citer, bool> insert =
+            _cells[newCell->getDim()].insert(newCell);
+          if(!insert.second) {
+            delete newCell;
+            newCell = *(insert.first);
+            if(domain) newCell->setDomain(domain);
+          }
+          else
+            _createCount++;
+          if(domain == 0) {
+            int ori = cell->findBdCellOrientation(newCell, i);
+            cell->addBoundaryCell(ori, newCell, true);
+            if(_smallestCell.first == cell)
+              _smallestCell = std::make_pair(newCell, _smallestCell.second);
+            if(_biggestCell.first == cell)
+              _biggestCell = std::make_pair(newCell, _biggestCell.second);
+          }
         }
       }
     }
@@ -95,7 +95,7 @@ void ExtrudeParams::Rotate(double matr[3][3])
 
 void ExtrudeParams::Extrude(double t, double &x, double &y, double &z)
 {
-  double dx, dy, dz, angle;
+  double dx, dy, dz;
   double n[3] = {0., 0., 0.};
 
   switch(geo.Type) {
@@ -108,16 +108,10 @@ void ExtrudeParams::Extrude(double t, double &x, double &y, double &z)
     z += dz;
     break;
   case ROTATE:
-    angle = geo.angle;
-    geo.angle = geo.angle * t;
-    ProtudeXYZ(x, y, z, this);
-    geo.angle = angle;
+    ProtudeXYZ(x, y, z, this, geo.angle * t);
     break;
   case TRANSLATE_ROTATE:
-    angle = geo.angle;
-    geo.angle = geo.angle * t;
-    ProtudeXYZ(x, y, z, this);
-    geo.angle = angle;
+    ProtudeXYZ(x, y, z, this, geo.angle * t);
     dx = geo.trans[0] * t;
     dy = geo.trans[1] * t;
     dz = geo.trans[2] * t;
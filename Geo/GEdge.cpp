@@ -426,6 +426,49 @@ double GEdge::curvature(double par) const
   return norm(crossprod(d1, secondDer(par))) * std::pow(1.0 / norm(d1), 3);
 }
 
+void GEdge::points(const std::vector<double> &par,
+                   std::vector<double> xyz[3]) const
+{
+  const int n = par.size();
+  for(int d = 0; d < 3; d++) xyz[d].resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    GPoint p = point(par[i]);
+    xyz[0][i] = p.x();
+    xyz[1][i] = p.y();
+    xyz[2][i] = p.z();
+  }
+}
+
+void GEdge::firstDers(const std::vector<double> &par,
+                      std::vector<double> der[3]) const
+{
+  const int n = par.size();
+  for(int d = 0; d < 3; d++) der[d].resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    SVector3 d = firstDer(par[i]);
+    der[0][i] = d.x();
+    der[1][i] = d.y();
+    der[2][i] = d.z();
+  }
+}
+
+void GEdge::curvatures(const std::vector<double> &par,
+                       std::vector<double> &curv) const
+{
+  const int n = par.size();
+  curv.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) curv[i] = curvature(par[i]);
+}
+
 double GEdge::length(const double &u0, const double &u1, const int nbQuadPoints)
 {
   double *t = 0, *w = 0;
@@ -128,6 +128,16 @@ public:
   // get the curvature
   virtual double curvature(double par) const;
 
+  // batched versions of point, firstDer and curvature: the results for
+  // par[i] are stored in the i-th entry of the output arrays (one array per
+  // coordinate)
+  virtual void points(const std::vector<double> &par,
+                      std::vector<double> xyz[3]) const;
+  virtual void firstDers(const std::vector<double> &par,
+                         std::vector<double> der[3]) const;
+  virtual void curvatures(const std::vector<double> &par,
+                          std::vector<double> &curv) const;
+
   // reparmaterize the point onto the given face
   virtual SPoint2 reparamOnFace(const GFace *face, double epar, int dir) const;
 
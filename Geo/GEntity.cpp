@@ -303,3 +303,8 @@ void GEntity::copyMasterCoordinates()
     }
   }
 }
+
+bool GEntity::batchInParallel(std::size_t n) const
+{
+  return n > 64 && Msg::GetMaxThreads() > 1 && threadSafeEvaluation();
+}
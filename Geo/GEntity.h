@@ -252,6 +252,12 @@ public:
   // does the entity have a parametrization?
   virtual bool haveParametrization() { return true; }
 
+  // can the geometry of the entity be evaluated by several threads at once?
+  virtual bool threadSafeEvaluation() const { return false; }
+
+  // should a batch of n evaluations be done in parallel?
+  bool batchInParallel(std::size_t n) const;
+
   // parametric bounds of the entity in the "i" direction.
   virtual Range<double> parBounds(int i) const { return Range<double>(0., 0.); }
 
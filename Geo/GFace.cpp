@@ -35,7 +35,8 @@
 #define SQU(a) ((a) * (a))
 
 GFace::GFace(GModel *model, int tag)
-  : GEntity(model, tag), r1(0), r2(0), va_geom_triangles(0)
+  : GEntity(model, tag), r1(0), r2(0), _paramSampling(0),
+    va_geom_triangles(0)
 {
   meshStatistics.status = GFace::PENDING;
   meshStatistics.refineAllEdges = false;
@@ -51,6 +52,7 @@ GFace::~GFace()
   }
 
   if(va_geom_triangles) delete va_geom_triangles;
+  deleteParamSampling();
 
   deleteMesh();
 }
@@ -903,6 +905,69 @@ double GFace::curvatures(const SPoint2 &param, SVector3 &dirMax,
   return curvMax;
 }
 
+void GFace::points(const std::vector<double> &u, const std::vector<double> &v,
+                   std::vector<double> xyz[3]) const
+{
+  const int n = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) xyz[d].resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    GPoint p = point(u[i], v[i]);
+    xyz[0][i] = p.x();
+    xyz[1][i] = p.y();
+    xyz[2][i] = p.z();
+  }
+}
+
+void GFace::firstDers(const std::vector<double> &u,
+                      const std::vector<double> &v, std::vector<double> du[3],
+                      std::vector<double> dv[3]) const
+{
+  const int n = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) {
+    du[d].resize(n);
+    dv[d].resize(n);
+  }
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    Pair<SVector3, SVector3> der = firstDer(SPoint2(u[i], v[i]));
+    for(int d = 0; d < 3; d++) {
+      du[d][i] = der.left()[d];
+      dv[d][i] = der.right()[d];
+    }
+  }
+}
+
+void GFace::normals(const std::vector<double> &u, const std::vector<double> &v,
+                    std::vector<double> n[3]) const
+{
+  const int nb = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) n[d].resize(nb);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(nb))
+#endif
+  for(int i = 0; i < nb; i++) {
+    SVector3 nn = normal(SPoint2(u[i], v[i]));
+    for(int d = 0; d < 3; d++) n[d][i] = nn[d];
+  }
+}
+
+void GFace::curvaturesMax(const std::vector<double> &u,
+                          const std::vector<double> &v,
+                          std::vector<double> &curv) const
+{
+  const int n = std::min(u.size(), v.size());
+  curv.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) curv[i] = curvatureMax(SPoint2(u[i], v[i]));
+}
+
 double GFace::getMetricEigenvalue(const SPoint2 &)
 {
   Msg::Error("Metric eigenvalue is not implemented for this type of surface");
@@ -977,6 +1042,226 @@ void GFace::getMetricEigenVectors(const SPoint2 &param, double eigVal[2],
   }
 }
 
+// A regular sampling of the parametrization of a face, with the samples
+// bucketed in a uniform grid: used to find good initial guesses in XYZtoUV
+class GFaceParamSampling {
+private:
+  std::vector<SPoint2> _uv;
+  std::vector<SPoint3> _xyz;
+  double _lo[3], _h[3];
+  int _n[3];
+  std::vector<int> _start, _index;
+  int _cell(int i, int j, int k) const { return i + _n[0] * (j + _n[1] * k); }
+
+public:
+  GFaceParamSampling(const GFace *gf, int nbSamples)
+  {
+    Range<double> ru = gf->parBounds(0);
+    Range<double> rv = gf->parBounds(1);
+    double hi[3] = {-1.e22, -1.e22, -1.e22};
+    for(int d = 0; d < 3; d++) _lo[d] = 1.e22;
+    for(int i = 0; i < nbSamples; i++) {
+      for(int j = 0; j < nbSamples; j++) {
+        double u = ru.low() + (ru.high() - ru.low()) * i / (nbSamples - 1);
+        double v = rv.low() + (rv.high() - rv.low()) * j / (nbSamples - 1);
+        GPoint p = gf->point(u, v);
+        if(!p.succeeded()) continue;
+        _uv.push_back(SPoint2(u, v));
+        _xyz.push_back(SPoint3(p.x(), p.y(), p.z()));
+        for(int d = 0; d < 3; d++) {
+          _lo[d] = std::min(_lo[d], _xyz.back()[d]);
+          hi[d] = std::max(hi[d], _xyz.back()[d]);
+        }
+      }
+    }
+    if(_xyz.empty()) return;
+
+    // surfaces are 2D objects: aim at a few samples per non-empty bucket
+    double L = 0.;
+    for(int d = 0; d < 3; d++) L = std::max(L, hi[d] - _lo[d]);
+    int nb = std::max(1, (int)ceil(0.5 * sqrt((double)_xyz.size())));
+    for(int d = 0; d < 3; d++) {
+      double Ld = hi[d] - _lo[d];
+      _n[d] = (L > 0.) ? std::max(1, (int)ceil(nb * Ld / L)) : 1;
+      _h[d] = (Ld > 0.) ? Ld / _n[d] : 1.;
+    }
+
+    // compressed storage of the buckets
+    std::vector<int> cell(_xyz.size());
+    _start.assign(_n[0] * _n[1] * _n[2] + 1, 0);
+    for(std::size_t i = 0; i < _xyz.size(); i++) {
+      int c[3];
+      for(int d = 0; d < 3; d++)
+        c[d] = std::min(_n[d] - 1, (int)((_xyz[i][d] - _lo[d]) / _h[d]));
+      cell[i] = _cell(c[0], c[1], c[2]);
+      _start[cell[i] + 1]++;
+    }
+    for(std::size_t i = 1; i < _start.size(); i++) _start[i] += _start[i - 1];
+    _index.resize(_xyz.size());
+    std::vector<int> pos(_start.begin(), _start.end() - 1);
+    for(std::size_t i = 0; i < _xyz.size(); i++) _index[pos[cell[i]]++] = i;
+  }
+
+  // parametric coordinates of the sample closest to (x,y,z)
+  bool closest(double x, double y, double z, double &u, double &v) const
+  {
+    if(_xyz.empty()) return false;
+    double q[3] = {x, y, z};
+    int c[3];
+    for(int d = 0; d < 3; d++)
+      c[d] = std::max(0, std::min(_n[d] - 1, (int)floor((q[d] - _lo[d]) / _h[d])));
+
+    double best = 1.e300;
+    int ibest = -1;
+    for(int r = 0;; r++) {
+      // visit the shell of buckets at distance r from the bucket of q
+      for(int k = std::max(0, c[2] - r); k <= std::min(_n[2] - 1, c[2] + r); k++) {
+        for(int j = std::max(0, c[1] - r); j <= std::min(_n[1] - 1, c[1] + r);
+            j++) {
+          for(int i = std::max(0, c[0] - r); i <= std::min(_n[0] - 1, c[0] + r);
+              i++) {
+            if(std::abs(i - c[0]) != r && std::abs(j - c[1]) != r &&
+               std::abs(k - c[2]) != r)
+              continue;
+            int cc = _cell(i, j, k);
+            for(int l = _start[cc]; l < _start[cc + 1]; l++) {
+              const SPoint3 &p = _xyz[_index[l]];
+              double d2 = SQU(p.x() - x) + SQU(p.y() - y) + SQU(p.z() - z);
+              if(d2 < best) {
+                best = d2;
+                ibest = _index[l];
+              }
+            }
+          }
+        }
+      }
+      // lower bound of the distance to the buckets not visited yet
+      bool covered = true;
+      double bound = 1.e300;
+      for(int d = 0; d < 3; d++) {
+        if(c[d] - r > 0) {
+          covered = false;
+          bound = std::min(bound, q[d] - (_lo[d] + (c[d] - r) * _h[d]));
+        }
+        if(c[d] + r < _n[d] - 1) {
+          covered = false;
+          bound = std::min(bound, _lo[d] + (c[d] + r + 1) * _h[d] - q[d]);
+        }
+      }
+      if(covered) break;
+      if(ibest >= 0 && bound > 0. && bound * bound >= best) break;
+    }
+    u = _uv[ibest].x();
+    v = _uv[ibest].y();
+    return true;
+  }
+};
+
+const GFaceParamSampling *GFace::_getParamSampling() const
+{
+  // double-checked: the sampling is only built once, and is published after
+  // it is complete
+  GFaceParamSampling *s;
+#if defined(_OPENMP)
+#pragma omp atomic read
+#endif
+  s = _paramSampling;
+#if defined(_OPENMP)
+#pragma omp flush
+#endif
+  if(s) return s;
+#if defined(_OPENMP)
+#pragma omp critical(GFaceParamSampling)
+#endif
+  {
+    s = _paramSampling;
+    if(!s) {
+      s = new GFaceParamSampling(this, 16);
+#if defined(_OPENMP)
+#pragma omp flush
+#pragma omp atomic write
+#endif
+      _paramSampling = s;
+    }
+  }
+  return s;
+}
+
+void GFace::deleteParamSampling()
+{
+  if(_paramSampling) delete _paramSampling;
+  _paramSampling = 0;
+}
+
+// Newton iterations for XYZtoUV, starting from (U,V)
+static bool newtonXYZtoUV(const GFace *gf, double X, double Y, double Z,
+                          double &U, double &V, double relax, bool onSurface,
+                          double tol, int MaxIter, int i, int j)
+{
+  Range<double> ru = gf->parBounds(0);
+  Range<double> rv = gf->parBounds(1);
+  const double umin = ru.low(), umax = ru.high();
+  const double vmin = rv.low(), vmax = rv.high();
+  double Unew = 0., Vnew = 0., err = 1.0, err2;
+  double mat[3][3], jac[3][3];
+  int iter = 1;
+
+  GPoint P = gf->point(U, V);
+  err2 = sqrt(SQU(X - P.x()) + SQU(Y - P.y()) + SQU(Z - P.z()));
+  if(err2 < 1.e-8 * CTX::instance()->lc) return true;
+
+  while(err > tol && iter < MaxIter) {
+    P = gf->point(U, V);
+    Pair<SVector3, SVector3> der = gf->firstDer(SPoint2(U, V));
+    mat[0][0] = der.left().x();
+    mat[0][1] = der.left().y();
+    mat[0][2] = der.left().z();
+    mat[1][0] = der.right().x();
+    mat[1][1] = der.right().y();
+    mat[1][2] = der.right().z();
+    mat[2][0] = 0.;
+    mat[2][1] = 0.;
+    mat[2][2] = 0.;
+    invert_singular_matrix3x3(mat, jac);
+
+    Unew = U + relax * (jac[0][0] * (X - P.x()) + jac[1][0] * (Y - P.y()) +
+                        jac[2][0] * (Z - P.z()));
+    Vnew = V + relax * (jac[0][1] * (X - P.x()) + jac[1][1] * (Y - P.y()) +
+                        jac[2][1] * (Z - P.z()));
+
+    // don't remove this test: it is important
+    if((Unew > umax + tol || Unew < umin - tol) &&
+       (Vnew > vmax + tol || Vnew < vmin - tol))
+      break;
+
+    err = SQU(Unew - U) + SQU(Vnew - V);
+    err2 = sqrt(SQU(X - P.x()) + SQU(Y - P.y()) + SQU(Z - P.z()));
+
+    iter++;
+    U = Unew;
+    V = Vnew;
+  }
+
+  if(iter < MaxIter && err <= tol && Unew <= umax && Vnew <= vmax &&
+     Unew >= umin && Vnew >= vmin) {
+    if(onSurface && err2 > 1.e-4 * CTX::instance()->lc &&
+       !CTX::instance()->mesh.NewtonConvergenceTestXYZ) {
+      Msg::Warning("Converged for i=%d j=%d (err=%g iter=%d) BUT "
+                   "xyz error = %g in point (%e,%e,%e) on surface %d",
+                   i, j, err, iter, err2, X, Y, Z, gf->tag());
+    }
+
+    if(onSurface && err2 > 1.e-4 * CTX::instance()->lc &&
+       CTX::instance()->mesh.NewtonConvergenceTestXYZ) {
+      // not converged in XYZ coordinates
+    }
+    else {
+      return true;
+    }
+  }
+  return false;
+}
+
 void GFace::XYZtoUV(double X, double Y, double Z, double &U, double &V,
                     double relax, bool onSurface) const
 {
@@ -984,9 +1269,6 @@ void GFace::XYZtoUV(double X, double Y, double Z, double &U, double &V,
   const int MaxIter = onSurface ? 25 : 10;
   const int NumInitGuess = 9;
 
-  double Unew = 0., Vnew = 0., err, err2;
-  int iter;
-  double mat[3][3], jac[3][3];
   double umin, umax, vmin, vmax;
   // don't use 0.9, 0.1 it fails with ruled surfaces
   double initu[NumInitGuess] = {0.5, 0.6, 0.4, 0.7, 0.3, 0.8, 0.2, 1.0, 0.0};
@@ -1005,66 +1287,19 @@ void GFace::XYZtoUV(double X, double Y, double Z, double &U, double &V,
     initv[i] = vmin + initv[i] * (vmax - vmin);
   }
 
+  // start from the closest sample of the parametrization, which converges in
+  // a few iterations in most cases
+  if(_getParamSampling()->closest(X, Y, Z, U, V) &&
+     newtonXYZtoUV(this, X, Y, Z, U, V, relax, onSurface, tol, MaxIter, -1, -1))
+    return;
+
   for(int i = 0; i < NumInitGuess; i++) {
     for(int j = 0; j < NumInitGuess; j++) {
       U = initu[i];
       V = initv[j];
-      err = 1.0;
-      iter = 1;
-
-      GPoint P = point(U, V);
-      err2 = sqrt(SQU(X - P.x()) + SQU(Y - P.y()) + SQU(Z - P.z()));
-      if(err2 < 1.e-8 * CTX::instance()->lc) return;
-
-      while(err > tol && iter < MaxIter) {
-        P = point(U, V);
-        Pair<SVector3, SVector3> der = firstDer(SPoint2(U, V));
-        mat[0][0] = der.left().x();
-        mat[0][1] = der.left().y();
-        mat[0][2] = der.left().z();
-        mat[1][0] = der.right().x();
-        mat[1][1] = der.right().y();
-        mat[1][2] = der.right().z();
-        mat[2][0] = 0.;
-        mat[2][1] = 0.;
-        mat[2][2] = 0.;
-        invert_singular_matrix3x3(mat, jac);
-
-        Unew = U + relax * (jac[0][0] * (X - P.x()) + jac[1][0] * (Y - P.y()) +
-                            jac[2][0] * (Z - P.z()));
-        Vnew = V + relax * (jac[0][1] * (X - P.x()) + jac[1][1] * (Y - P.y()) +
-                            jac[2][1] * (Z - P.z()));
-
-        // don't remove this test: it is important
-        if((Unew > umax + tol || Unew < umin - tol) &&
-           (Vnew > vmax + tol || Vnew < vmin - tol))
-          break;
-
-        err = SQU(Unew - U) + SQU(Vnew - V);
-        err2 = sqrt(SQU(X - P.x()) + SQU(Y - P.y()) + SQU(Z - P.z()));
-
-        iter++;
-        U = Unew;
-        V = Vnew;
-      }
-
-      if(iter < MaxIter && err <= tol && Unew <= umax && Vnew <= vmax &&
-         Unew >= umin && Vnew >= vmin) {
-        if(onSurface && err2 > 1.e-4 * CTX::instance()->lc &&
-           !CTX::instance()->mesh.NewtonConvergenceTestXYZ) {
-          Msg::Warning("Converged for i=%d j=%d (err=%g iter=%d) BUT "
-                       "xyz error = %g in point (%e,%e,%e) on surface %d",
-                       i, j, err, iter, err2, X, Y, Z, tag());
-        }
-
-        if(onSurface && err2 > 1.e-4 * CTX::instance()->lc &&
-           CTX::instance()->mesh.NewtonConvergenceTestXYZ) {
-          // not converged in XYZ coordinates
-        }
-        else {
-          return;
-        }
-      }
+      if(newtonXYZtoUV(this, X, Y, Z, U, V, relax, onSurface, tol, MaxIter, i,
+                       j))
+        return;
     }
   }
 
@@ -1085,6 +1320,17 @@ SPoint2 GFace::parFromPoint(const SPoint3 &p, bool onSurface) const
   return SPoint2(U, V);
 }
 
+void GFace::parFromPoints(const std::vector<SPoint3> &p,
+                          std::vector<SPoint2> &uv, bool onSurface) const
+{
+  uv.resize(p.size());
+  const int n = p.size();
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 64) if(Msg::GetMaxThreads() > 1 && n > 256)
+#endif
+  for(int i = 0; i < n; i++) uv[i] = parFromPoint(p[i], onSurface);
+}
+
 #if defined(HAVE_BFGS)
 
 class data_wrapper {
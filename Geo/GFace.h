@@ -26,6 +26,7 @@ class MPolygon;
 class ExtrudeParams;
 
 class GRegion;
+class GFaceParamSampling;
 
 // A model face.
 class GFace : public GEntity {
@@ -41,6 +42,10 @@ protected:
 
   BoundaryLayerColumns _columns;
 
+  // sampling of the parametrization, built on demand by XYZtoUV
+  mutable GFaceParamSampling *_paramSampling;
+  const GFaceParamSampling *_getParamSampling() const;
+
 public: // this will become protected or private
   std::list<GEdgeLoop> edgeLoops;
 
@@ -148,6 +153,9 @@ public:
   void XYZtoUV(double X, double Y, double Z, double &U, double &V, double relax,
                bool onSurface = true) const;
 
+  // delete the sampling used by XYZtoUV (to call if the geometry changes)
+  void deleteParamSampling();
+
   // get the bounding box
   virtual SBoundingBox3d bounds(bool fast = false) const;
 
@@ -181,6 +189,11 @@ public:
   // that is on the face
   virtual SPoint2 parFromPoint(const SPoint3 &, bool onSurface = true) const;
 
+  // same as parFromPoint, for a batch of points
+  virtual void parFromPoints(const std::vector<SPoint3> &p,
+                             std::vector<SPoint2> &uv,
+                             bool onSurface = true) const;
+
   // true if the parameter value is interior to the face
   virtual bool containsParam(const SPoint2 &pt);
 
@@ -214,6 +227,23 @@ public:
                             SVector3 &dirMin, double &curvMax,
                             double &curvMin) const;
 
+  // batched versions of point, firstDer, normal and curvatureMax: the results
+  // for (u[i], v[i]) are stored in the i-th entry of the output arrays (one
+  // array per coordinate)
+  virtual void points(const std::vector<double> &u,
+                      const std::vector<double> &v,
+                      std::vector<double> xyz[3]) const;
+  virtual void firstDers(const std::vector<double> &u,
+                         const std::vector<double> &v,
+                         std::vector<double> du[3],
+                         std::vector<double> dv[3]) const;
+  virtual void normals(const std::vector<double> &u,
+                       const std::vector<double> &v,
+                       std::vector<double> n[3]) const;
+  virtual void curvaturesMax(const std::vector<double> &u,
+                             const std::vector<double> &v,
+                             std::vector<double> &curv) const;
+
   // return a type-specific additional information string
   virtual std::string getAdditionalInfoString(bool multline = false);
 
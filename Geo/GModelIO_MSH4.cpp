@@ -2013,9 +2013,45 @@ getAdditionalEntities(std::set<GRegion *, GEntityLessThan> &regions,
   return numVertices;
 }
 
+// Nodes classified on each entity, when they differ from the mesh vertices of
+// the entities (see GModel::_writePartitionedMSH4)
+typedef std::map<GEntity *, std::vector<MVertex *> > nodesByEntity;
+
+static const std::vector<MVertex *> &getMSH4Nodes(GEntity *const entity,
+                                                   const nodesByEntity *nodes)
+{
+  if(!nodes) return entity->mesh_vertices;
+  static const std::vector<MVertex *> empty;
+  nodesByEntity::const_iterator it = nodes->find(entity);
+  return (it == nodes->end()) ? empty : it->second;
+}
+
+static void writeMSH4EntityNodes(GEntity *const entity, FILE *fp, bool binary,
+                                 int saveParametric, double scalingFactor,
+                                 const std::vector<MVertex *> &verts)
+{
+  if(binary) {
+    int entityTag = entity->tag();
+    int entityDim = entity->dim();
+    unsigned long numVerts = verts.size();
+    fwrite(&entityTag, sizeof(int), 1, fp);
+    fwrite(&entityDim, sizeof(int), 1, fp);
+    fwrite(&saveParametric, sizeof(int), 1, fp);
+    fwrite(&numVerts, sizeof(unsigned long), 1, fp);
+  }
+  else {
+    fprintf(fp, "%d %d %d %lu\n", entity->tag(), entity->dim(), saveParametric,
+            (unsigned long)verts.size());
+  }
+
+  for(std::size_t i = 0; i < verts.size(); i++)
+    verts[i]->writeMSH4(fp, binary, saveParametric, scalingFactor);
+}
+
 static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
                            bool binary, int saveParametric,
-                           double scalingFactor, bool saveAll)
+                           double scalingFactor, bool saveAll,
+                           const nodesByEntity *nodes)
 {
   std::set<GRegion *, GEntityLessThan> regions;
   std::set<GFace *, GEntityLessThan> faces;
@@ -2070,7 +2106,15 @@ static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
         regions.insert(*it);
   }
 
-  unsigned long numVertices = model->getNumMeshVertices();
+  unsigned long numVertices = 0;
+  if(nodes) {
+    for(nodesByEntity::const_iterator it = nodes->begin(); it != nodes->end();
+        ++it)
+      numVertices += it->second.size();
+  }
+  else {
+    numVertices = model->getNumMeshVertices();
+  }
   if(!saveAll && !partitioned) {
     numVertices = getAdditionalEntities(regions, faces, edges, vertices);
   }
@@ -2087,85 +2131,21 @@ static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
             numVertices);
   }
 
-  for(GModel::viter it = vertices.begin(); it != vertices.end(); ++it) {
-    if(binary) {
-      int entityTag = (*it)->tag();
-      int entityDim = (*it)->dim();
-      unsigned long numVerts = (*it)->getNumMeshVertices();
-      fwrite(&entityTag, sizeof(int), 1, fp);
-      fwrite(&entityDim, sizeof(int), 1, fp);
-      fwrite(&saveParametric, sizeof(int), 1, fp);
-      fwrite(&numVerts, sizeof(unsigned long), 1, fp);
-    }
-    else {
-      fprintf(fp, "%d %d %d %lu\n", (*it)->tag(), (*it)->dim(), saveParametric,
-              (unsigned long)(*it)->getNumMeshVertices());
-    }
+  for(GModel::viter it = vertices.begin(); it != vertices.end(); ++it)
+    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                         getMSH4Nodes(*it, nodes));
 
-    for(std::size_t i = 0; i < (*it)->getNumMeshVertices(); i++)
-      (*it)->getMeshVertex(i)->writeMSH4(fp, binary, saveParametric,
-                                         scalingFactor);
-  }
+  for(GModel::eiter it = edges.begin(); it != edges.end(); ++it)
+    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                         getMSH4Nodes(*it, nodes));
 
-  for(GModel::eiter it = edges.begin(); it != edges.end(); ++it) {
-    if(binary) {
-      int entityTag = (*it)->tag();
-      int entityDim = (*it)->dim();
-      unsigned long numVerts = (*it)->getNumMeshVertices();
-      fwrite(&entityTag, sizeof(int), 1, fp);
-      fwrite(&entityDim, sizeof(int), 1, fp);
-      fwrite(&saveParametric, sizeof(int), 1, fp);
-      fwrite(&numVerts, sizeof(unsigned long), 1, fp);
-    }
-    else {
-      fprintf(fp, "%d %d %d %lu\n", (*it)->tag(), (*it)->dim(), saveParametric,
-              (unsigned long)(*it)->getNumMeshVertices());
-    }
-
-    for(std::size_t i = 0; i < (*it)->getNumMeshVertices(); i++)
-      (*it)->getMeshVertex(i)->writeMSH4(fp, binary, saveParametric,
-                                         scalingFactor);
-  }
-
-  for(GModel::fiter it = faces.begin(); it != faces.end(); ++it) {
-    if(binary) {
-      int entityTag = (*it)->tag();
-      int entityDim = (*it)->dim();
-      unsigned long numVerts = (*it)->getNumMeshVertices();
-      fwrite(&entityTag, sizeof(int), 1, fp);
-      fwrite(&entityDim, sizeof(int), 1, fp);
-      fwrite(&saveParametric, sizeof(int), 1, fp);
-      fwrite(&numVerts, sizeof(unsigned long), 1, fp);
-    }
-    else {
-      fprintf(fp, "%d %d %d %lu\n", (*it)->tag(), (*it)->dim(), saveParametric,
-              (unsigned long)(*it)->getNumMeshVertices());
-    }
-
-    for(std::size_t i = 0; i < (*it)->getNumMeshVertices(); i++)
-      (*it)->getMeshVertex(i)->writeMSH4(fp, binary, saveParametric,
-                                         scalingFactor);
-  }
-
-  for(GModel::riter it = regions.begin(); it != regions.end(); ++it) {
-    if(binary) {
-      int entityTag = (*it)->tag();
-      int entityDim = (*it)->dim();
-      unsigned long numVerts = (*it)->getNumMeshVertices();
-      fwrite(&entityTag, sizeof(int), 1, fp);
-      fwrite(&entityDim, sizeof(int), 1, fp);
-      fwrite(&saveParametric, sizeof(int), 1, fp);
-      fwrite(&numVerts, sizeof(unsigned long), 1, fp);
-    }
-    else {
-      fprintf(fp, "%d %d %d %lu\n", (*it)->tag(), (*it)->dim(), saveParametric,
-              (unsigned long)(*it)->getNumMeshVertices());
-    }
+  for(GModel::fiter it = faces.begin(); it != faces.end(); ++it)
+    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                         getMSH4Nodes(*it, nodes));
 
-    for(std::size_t i = 0; i < (*it)->getNumMeshVertices(); i++)
-      (*it)->getMeshVertex(i)->writeMSH4(fp, binary, saveParametric,
-                                         scalingFactor);
-  }
+  for(GModel::riter it = regions.begin(); it != regions.end(); ++it)
+    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                         getMSH4Nodes(*it, nodes));
 
   if(binary) fprintf(fp, "\n");
 }
@@ -2502,9 +2482,10 @@ static void writeMSH4GhostCells(GModel *const model, FILE *fp, bool binary)
   }
 }
 
-int GModel::_writeMSH4(const std::string &name, double version, bool binary,
-                       bool saveAll, bool saveParametric, double scalingFactor,
-                       bool append)
+static int writeMSH4(GModel *const model, const std::string &name,
+                     double version, bool binary, bool saveAll,
+                     bool saveParametric, double scalingFactor, bool append,
+                     const nodesByEntity *nodes)
 {
   FILE *fp = 0;
   if(append)
@@ -2518,7 +2499,7 @@ int GModel::_writeMSH4(const std::string &name, double version, bool binary,
   }
 
   // if there are no physicals we save all the elements
-  if(noPhysicalGroups()) saveAll = true;
+  if(model->noPhysicalGroups()) saveAll = true;
 
   // header
   fprintf(fp, "$MeshFormat\n");
@@ -2531,10 +2512,11 @@ int GModel::_writeMSH4(const std::string &name, double version, bool binary,
   fprintf(fp, "$EndMeshFormat\n");
 
   // physicals
-  if(numPhysicalNames() > 0) {
+  if(model->numPhysicalNames() > 0) {
     fprintf(fp, "$PhysicalNames\n");
-    fprintf(fp, "%d\n", numPhysicalNames());
-    for(piter it = firstPhysicalName(); it != lastPhysicalName(); ++it) {
+    fprintf(fp, "%d\n", model->numPhysicalNames());
+    for(GModel::piter it = model->firstPhysicalName();
+        it != model->lastPhysicalName(); ++it) {
       std::string name = it->second;
       if(name.size() > 128) name.resize(128);
       fprintf(fp, "%d %d \"%s\"\n", it->first.first, it->first.second,
@@ -2545,40 +2527,48 @@ int GModel::_writeMSH4(const std::string &name, double version, bool binary,
 
   // entities
   fprintf(fp, "$Entities\n");
-  writeMSH4Entities(this, fp, false, binary, scalingFactor);
+  writeMSH4Entities(model, fp, false, binary, scalingFactor);
   fprintf(fp, "$EndEntities\n");
 
   // partitioned entities
-  if(getNumPartitions() > 0) {
+  if(model->getNumPartitions() > 0) {
     fprintf(fp, "$PartitionedEntities\n");
-    writeMSH4Entities(this, fp, true, binary, scalingFactor);
+    writeMSH4Entities(model, fp, true, binary, scalingFactor);
     fprintf(fp, "$EndPartitionedEntities\n");
   }
 
   // nodes
   fprintf(fp, "$Nodes\n");
-  writeMSH4Nodes(this, fp, getNumPartitions() == 0 ? false : true, binary,
-                 saveParametric ? 1 : 0, scalingFactor, saveAll);
+  writeMSH4Nodes(model, fp, model->getNumPartitions() == 0 ? false : true,
+                 binary, saveParametric ? 1 : 0, scalingFactor, saveAll, nodes);
   fprintf(fp, "$EndNodes\n");
 
   // elements
   fprintf(fp, "$Elements\n");
-  writeMSH4Elements(this, fp, getNumPartitions() == 0 ? false : true, binary,
-                    saveAll);
+  writeMSH4Elements(model, fp, model->getNumPartitions() == 0 ? false : true,
+                    binary, saveAll);
   fprintf(fp, "$EndElements\n");
 
   // periodic
-  writeMSH4PeriodicNodes(this, fp, getNumPartitions() == 0 ? false : true,
-                         binary);
+  writeMSH4PeriodicNodes(model, fp,
+                         model->getNumPartitions() == 0 ? false : true, binary);
 
   // ghostCells
-  writeMSH4GhostCells(this, fp, binary);
+  writeMSH4GhostCells(model, fp, binary);
 
   fclose(fp);
 
   return 1;
 }
 
+int GModel::_writeMSH4(const std::string &name, double version, bool binary,
+                       bool saveAll, bool saveParametric, double scalingFactor,
+                       bool append)
+{
+  return writeMSH4(this, name, version, binary, saveAll, saveParametric,
+                   scalingFactor, append, 0);
+}
+
 static void associateVertices(GModel *model)
 {
   for(GModel::const_viter it = model->firstVertex(); it != model->lastVertex();
@@ -2668,136 +2658,140 @@ static void associateVertices(GModel *model)
   }
 }
 
+// Classify the nodes of the elements of a model on its entities, in the same
+// way as associateVertices(), but without modifying the model
+static void classifyNodes(GModel *const model, nodesByEntity &nodes)
+{
+  std::vector<GEntity *> entities;
+  model->getEntities(entities);
+  std::set<MVertex *> classified;
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    GEntity *ge = entities[i];
+    for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
+      MElement *e = ge->getMeshElement(j);
+      for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+        if(classified.insert(e->getVertex(k)).second)
+          nodes[ge].push_back(e->getVertex(k));
+      }
+    }
+  }
+}
+
 int GModel::_writePartitionedMSH4(const std::string &baseName, double version,
                                   bool binary, bool saveAll,
                                   bool saveParametric, double scalingFactor)
 {
-  std::vector<GEntity *> ghostEntities;
+  const unsigned int numPartitions = getNumPartitions();
+
+  // Entities of each partition, computed in a single pass over the entities:
+  // partitioned and ghost entities belong to their partitions, the other
+  // entities to all the partitions
+  std::vector<std::vector<GEntity *> > partEntities(numPartitions + 1);
   std::vector<GEntity *> entities;
   getEntities(entities);
   for(std::size_t i = 0; i < entities.size(); i++) {
-    if(entities[i]->geomType() == GEntity::GhostCurve ||
-       entities[i]->geomType() == GEntity::GhostSurface ||
-       entities[i]->geomType() == GEntity::GhostVolume) {
-      ghostEntities.push_back(entities[i]);
+    GEntity *ge = entities[i];
+    std::vector<unsigned int> partitions;
+    switch(ge->geomType()) {
+    case GEntity::PartitionVolume:
+      partitions = static_cast<partitionRegion *>(ge)->getPartitions();
+      break;
+    case GEntity::PartitionSurface:
+      partitions = static_cast<partitionFace *>(ge)->getPartitions();
+      break;
+    case GEntity::PartitionCurve:
+      partitions = static_cast<partitionEdge *>(ge)->getPartitions();
+      break;
+    case GEntity::PartitionPoint:
+      partitions = static_cast<partitionVertex *>(ge)->getPartitions();
+      break;
+    case GEntity::GhostCurve:
+      static_cast<ghostEdge *>(ge)->saveMesh(true);
+      partitions.push_back(static_cast<ghostEdge *>(ge)->getPartition());
+      break;
+    case GEntity::GhostSurface:
+      static_cast<ghostFace *>(ge)->saveMesh(true);
+      partitions.push_back(static_cast<ghostFace *>(ge)->getPartition());
+      break;
+    case GEntity::GhostVolume:
+      static_cast<ghostRegion *>(ge)->saveMesh(true);
+      partitions.push_back(static_cast<ghostRegion *>(ge)->getPartition());
+      break;
+    default: partitions.push_back(0); break;
+    }
+    for(std::size_t j = 0; j < partitions.size(); j++) {
+      if(partitions[j] <= numPartitions)
+        partEntities[partitions[j]].push_back(ge);
     }
   }
 
-  // Create a temporary model
-  GModel *tmp = new GModel();
-  tmp->setPhysicalNames(getPhysicalNames());
-  tmp->setNumPartitions(getNumPartitions());
-
-  for(std::size_t i = 1; i <= getNumPartitions(); i++) {
-    std::set<GEntity *> entitiesSet;
-    GEntity *ghostEntity = 0;
+  // Each partition is written independently. The nodes are classified on the
+  // entities of each partition without modifying the model, so that partitions
+  // can be written in parallel; when saving parametric coordinates, the node
+  // classification is used by MVertex::writeMSH4, so we fall back to modifying
+  // the model and writing the partitions one at a time.
+  const bool modifyModel = saveParametric;
+  const int nparts = numPartitions;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic) if(!modifyModel)
+#endif
+  for(int i = 1; i <= nparts; i++) {
+    std::ostringstream sstream;
+    sstream << baseName << "_" << i << ".msh";
 
-    for(std::size_t j = 0; j < entities.size(); j++) {
-      GEntity *ge = entities[j];
-      switch(ge->geomType()) {
-      case GEntity::PartitionVolume: {
-        partitionRegion *pr = static_cast<partitionRegion *>(ge);
-        if(std::find(pr->getPartitions().begin(), pr->getPartitions().end(),
-                     i) != pr->getPartitions().end()) {
-          tmp->add(pr);
-          if(ghostEntities.size()) entitiesSet.insert(pr);
-        }
-      } break;
-      case GEntity::PartitionSurface: {
-        partitionFace *pf = static_cast<partitionFace *>(ge);
-        if(std::find(pf->getPartitions().begin(), pf->getPartitions().end(),
-                     i) != pf->getPartitions().end()) {
-          tmp->add(pf);
-          if(ghostEntities.size()) entitiesSet.insert(pf);
-        }
-      } break;
-      case GEntity::PartitionCurve: {
-        partitionEdge *pe = static_cast<partitionEdge *>(ge);
-        if(std::find(pe->getPartitions().begin(), pe->getPartitions().end(),
-                     i) != pe->getPartitions().end()) {
-          tmp->add(pe);
-          if(ghostEntities.size()) entitiesSet.insert(pe);
-        }
-      } break;
-      case GEntity::PartitionPoint: {
-        partitionVertex *pv = static_cast<partitionVertex *>(ge);
-        if(std::find(pv->getPartitions().begin(), pv->getPartitions().end(),
-                     i) != pv->getPartitions().end()) {
-          tmp->add(pv);
-          if(ghostEntities.size()) entitiesSet.insert(pv);
-        }
-      } break;
-      case GEntity::GhostCurve:
-        if(i == static_cast<ghostEdge *>(ge)->getPartition()) {
-          static_cast<ghostEdge *>(ge)->saveMesh(true);
-          tmp->add(static_cast<ghostEdge *>(ge));
-          if(ghostEntities.size()) entitiesSet.insert(ge);
-          ghostEntity = ge;
-        }
-        break;
-      case GEntity::GhostSurface:
-        if(i == static_cast<ghostFace *>(ge)->getPartition()) {
-          static_cast<ghostFace *>(ge)->saveMesh(true);
-          tmp->add(static_cast<ghostFace *>(ge));
-          if(ghostEntities.size()) entitiesSet.insert(ge);
-          ghostEntity = ge;
-        }
-        break;
-      case GEntity::GhostVolume:
-        if(i == static_cast<ghostRegion *>(ge)->getPartition()) {
-          static_cast<ghostRegion *>(ge)->saveMesh(true);
-          tmp->add(static_cast<ghostRegion *>(ge));
-          if(ghostEntities.size()) entitiesSet.insert(ge);
-          ghostEntity = ge;
+    GModel *tmp = 0;
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+    {
+      if(numPartitions > 100) {
+        if(i % 100 == 1) {
+          Msg::Info("Writing partition %d/%d in file '%s'", i, numPartitions,
+                    sstream.str().c_str());
         }
-        break;
-      default:
-        switch(ge->dim()){
-        case 0: tmp->add(static_cast<GVertex *>(ge)); break;
-        case 1: tmp->add(static_cast<GEdge *>(ge)); break;
-        case 2: tmp->add(static_cast<GFace *>(ge)); break;
-        case 3: tmp->add(static_cast<GRegion *>(ge)); break;
-        }
-        if(ghostEntities.size()) entitiesSet.insert(ge);
-        break;
       }
+      else {
+        Msg::Info("Writing partition %d in file '%s'", i,
+                  sstream.str().c_str());
+      }
+      // creating a model is not thread-safe
+      tmp = new GModel();
     }
+    tmp->setPhysicalNames(getPhysicalNames());
+    tmp->setNumPartitions(numPartitions);
 
-    associateVertices(tmp);
-
-    if(ghostEntity) {
-      for(std::size_t j = 0; j < ghostEntity->getNumMeshElements(); j++) {
-        MElement *e = ghostEntity->getMeshElement(j);
-        for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-          MVertex *v = e->getVertex(k);
-          if(entitiesSet.find(v->onWhat()) == entitiesSet.end()) {
-            v->setEntity(ghostEntity);
-            ghostEntity->addMeshVertex(v);
-          }
+    for(int k = 0; k < 2; k++) {
+      const std::vector<GEntity *> &ents = partEntities[k ? i : 0];
+      for(std::size_t j = 0; j < ents.size(); j++) {
+        switch(ents[j]->dim()) {
+        case 0: tmp->add(static_cast<GVertex *>(ents[j])); break;
+        case 1: tmp->add(static_cast<GEdge *>(ents[j])); break;
+        case 2: tmp->add(static_cast<GFace *>(ents[j])); break;
+        case 3: tmp->add(static_cast<GRegion *>(ents[j])); break;
         }
       }
     }
 
-    std::ostringstream sstream;
-    sstream << baseName << "_" << i << ".msh";
-
-    if(getNumPartitions() > 100) {
-      if(i % 100 == 1) {
-        Msg::Info("Writing partition %d/%d in file '%s'", i, getNumPartitions(),
-                  sstream.str().c_str());
-      }
+    if(modifyModel) {
+      associateVertices(tmp);
+      writeMSH4(tmp, sstream.str(), version, binary, saveAll, saveParametric,
+                scalingFactor, false, 0);
     }
     else {
-      Msg::Info("Writing partition %d in file '%s'", i, sstream.str().c_str());
+      nodesByEntity nodes;
+      classifyNodes(tmp, nodes);
+      writeMSH4(tmp, sstream.str(), version, binary, saveAll, saveParametric,
+                scalingFactor, false, &nodes);
     }
-
-    tmp->_writeMSH4(sstream.str(), version, binary, saveAll, saveParametric,
-                    scalingFactor, false);
     tmp->remove();
+
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+    delete tmp;
   }
-  delete tmp;
 
-  associateVertices(this);
+  if(modifyModel) associateVertices(this);
 
   return 1;
 }
@@ -2387,10 +2387,13 @@ void ReplaceAllDuplicatesNew(double tol)
   ReplaceDuplicateSurfaces(NULL);
 }
 
-void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e)
+void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e,
+                double angle)
 {
+  // only work on local copies: this is called concurrently when meshing
+  // extruded entities
   double matrix[4][4];
-  double T[3];
+  double T[3], axe[3] = {e->geo.axe[0], e->geo.axe[1], e->geo.axe[2]};
   Vertex v(x, y, z);
 
   T[0] = -e->geo.pt[0];
@@ -2399,7 +2402,7 @@ void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e)
   SetTranslationMatrix(matrix, T);
   ApplyTransformationToPointAlways(matrix, &v);
 
-  SetRotationMatrix(matrix, e->geo.axe, e->geo.angle);
+  SetRotationMatrix(matrix, axe, angle);
   ApplyTransformationToPointAlways(matrix, &v);
 
   T[0] = -T[0];
@@ -2411,8 +2414,6 @@ void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e)
   x = v.Pos.X;
   y = v.Pos.Y;
   z = v.Pos.Z;
-
-  List_Reset(ListOfTransformedPoints);
 }
 
 int ExtrudePoint(int type, int ip, double T0, double T1, double T2, double A0,
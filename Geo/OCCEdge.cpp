@@ -309,6 +309,51 @@ int OCCEdge::minimumDrawSegments() const
     return CTX::instance()->geom.numSubEdges * GEdge::minimumDrawSegments();
 }
 
+void OCCEdge::points(const std::vector<double> &par,
+                     std::vector<double> xyz[3]) const
+{
+  if(!trimmed && curve.IsNull()) {
+    GEdge::points(par, xyz);
+    return;
+  }
+  const std::size_t n = par.size();
+  for(int d = 0; d < 3; d++) xyz[d].resize(n);
+  for(std::size_t i = 0; i < n; i++) {
+    double x, y, z;
+    if(trimmed) {
+      double u, v;
+      curve2d->Value(par[i]).Coord(u, v);
+      GPoint p = trimmed->point(u, v);
+      x = p.x();
+      y = p.y();
+      z = p.z();
+    }
+    else {
+      curve->Value(par[i]).Coord(x, y, z);
+    }
+    xyz[0][i] = x;
+    xyz[1][i] = y;
+    xyz[2][i] = z;
+  }
+}
+
+void OCCEdge::firstDers(const std::vector<double> &par,
+                        std::vector<double> der[3]) const
+{
+  // build the adaptor once for the whole batch
+  BRepAdaptor_Curve brepc(c);
+  BRepLProp_CLProps prop(brepc, 1, 1e-5);
+  const std::size_t n = par.size();
+  for(int d = 0; d < 3; d++) der[d].resize(n);
+  for(std::size_t i = 0; i < n; i++) {
+    prop.SetParameter(par[i]);
+    gp_Vec d1 = prop.D1();
+    der[0][i] = d1.X();
+    der[1][i] = d1.Y();
+    der[2][i] = d1.Z();
+  }
+}
+
 double OCCEdge::curvature(double par) const
 {
   const double eps = 1.e-15;
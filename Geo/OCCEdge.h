@@ -40,6 +40,10 @@ public:
   virtual bool degenerate(int) const { return BRep_Tool::Degenerated(c); }
   virtual GPoint point(double p) const;
   virtual SVector3 firstDer(double par) const;
+  virtual void points(const std::vector<double> &par,
+                      std::vector<double> xyz[3]) const;
+  virtual void firstDers(const std::vector<double> &par,
+                         std::vector<double> der[3]) const;
   virtual double curvature(double par) const;
   virtual SPoint2 reparamOnFace(const GFace *face, double epar, int dir) const;
   virtual GPoint closestPoint(const SPoint3 &queryPoint, double &param) const;
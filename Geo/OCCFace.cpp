@@ -219,6 +219,62 @@ void OCCFace::secondDer(const SPoint2 &param, SVector3 &dudu, SVector3 &dvdv,
   dudv = SVector3(duv.X(), duv.Y(), duv.Z());
 }
 
+void OCCFace::points(const std::vector<double> &u,
+                     const std::vector<double> &v,
+                     std::vector<double> xyz[3]) const
+{
+  const std::size_t n = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) xyz[d].resize(n);
+  for(std::size_t i = 0; i < n; i++) {
+    gp_Pnt val = occface->Value(u[i], v[i]);
+    xyz[0][i] = val.X();
+    xyz[1][i] = val.Y();
+    xyz[2][i] = val.Z();
+  }
+}
+
+void OCCFace::firstDers(const std::vector<double> &u,
+                        const std::vector<double> &v,
+                        std::vector<double> du[3],
+                        std::vector<double> dv[3]) const
+{
+  const std::size_t n = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) {
+    du[d].resize(n);
+    dv[d].resize(n);
+  }
+  gp_Pnt pnt;
+  gp_Vec d1u, d1v;
+  for(std::size_t i = 0; i < n; i++) {
+    occface->D1(u[i], v[i], pnt, d1u, d1v);
+    du[0][i] = d1u.X();
+    du[1][i] = d1u.Y();
+    du[2][i] = d1u.Z();
+    dv[0][i] = d1v.X();
+    dv[1][i] = d1v.Y();
+    dv[2][i] = d1v.Z();
+  }
+}
+
+void OCCFace::normals(const std::vector<double> &u,
+                      const std::vector<double> &v,
+                      std::vector<double> n[3]) const
+{
+  const std::size_t nb = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) n[d].resize(nb);
+  const double sign = (s.Orientation() == TopAbs_REVERSED) ? -1. : 1.;
+  gp_Pnt pnt;
+  gp_Vec d1u, d1v;
+  for(std::size_t i = 0; i < nb; i++) {
+    occface->D1(u[i], v[i], pnt, d1u, d1v);
+    SVector3 t1(d1u.X(), d1u.Y(), d1u.Z());
+    SVector3 t2(d1v.X(), d1v.Y(), d1v.Z());
+    SVector3 nn(crossprod(t1, t2));
+    nn.normalize();
+    for(int d = 0; d < 3; d++) n[d][i] = sign * nn[d];
+  }
+}
+
 GPoint OCCFace::point(double par1, double par2) const
 {
   double pp[2] = {par1, par2};
@@ -295,6 +351,29 @@ SPoint2 OCCFace::parFromPoint(const SPoint3 &qp, bool onSurface) const
   return SPoint2(U, V);
 }
 
+void OCCFace::parFromPoints(const std::vector<SPoint3> &p,
+                            std::vector<SPoint2> &uv, bool onSurface) const
+{
+  // initializing the projector is much more expensive than projecting a
+  // point: do it once for the whole batch (serially, as the evaluation of
+  // some OCC surfaces is not thread-safe)
+  uv.resize(p.size());
+  if(p.empty()) return;
+  GeomAPI_ProjectPointOnSurf proj;
+  proj.Init(occface, umin, umax, vmin, vmax);
+  for(std::size_t i = 0; i < p.size(); i++) {
+    proj.Perform(gp_Pnt(p[i].x(), p[i].y(), p[i].z()));
+    if(!proj.NbPoints()) {
+      Msg::Error("OCC Project Point on Surface FAIL");
+      uv[i] = GFace::parFromPoint(p[i]);
+      continue;
+    }
+    double U, V;
+    proj.LowerDistanceParameters(U, V);
+    uv[i] = SPoint2(U, V);
+  }
+}
+
 GEntity::GeomType OCCFace::geomType() const
 {
   if(occface->DynamicType() == STANDARD_TYPE(Geom_Plane))
@@ -40,10 +40,23 @@ public:
   virtual Pair<SVector3, SVector3> firstDer(const SPoint2 &param) const;
   virtual void secondDer(const SPoint2 &, SVector3 &, SVector3 &,
                          SVector3 &) const;
+  virtual void points(const std::vector<double> &u,
+                      const std::vector<double> &v,
+                      std::vector<double> xyz[3]) const;
+  virtual void firstDers(const std::vector<double> &u,
+                         const std::vector<double> &v,
+                         std::vector<double> du[3],
+                         std::vector<double> dv[3]) const;
+  virtual void normals(const std::vector<double> &u,
+                       const std::vector<double> &v,
+                       std::vector<double> n[3]) const;
   virtual GEntity::GeomType geomType() const;
   ModelType getNativeType() const { return OpenCascadeModel; }
   void *getNativePtr() const { return (void *)&s; }
   virtual SPoint2 parFromPoint(const SPoint3 &, bool onSurface = true) const;
+  virtual void parFromPoints(const std::vector<SPoint3> &p,
+                             std::vector<SPoint2> &uv,
+                             bool onSurface = true) const;
   virtual double curvatureMax(const SPoint2 &param) const;
   virtual double curvatures(const SPoint2 &param, SVector3 &dirMax,
                             SVector3 &dirMin, double &curvMax,
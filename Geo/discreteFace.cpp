@@ -11,8 +11,6 @@
 #include "Geo.h"
 #include "Context.h"
 #include "MPoint.h"
-#include "MElementOctree.h"
-#include "Octree.h"
 
 discreteFace::discreteFace(GModel *model, int num) : GFace(model, num)
 {
@@ -119,20 +117,31 @@ static void splitDiscreteEdge(discreteEdge *de, MVertex *v, GVertex *gv,
 
 #endif
 
+#if defined(HAVE_HXT)
+
+// find the triangle containing (u,v) in the parametrization, starting from the
+// one found by the previous query of the calling thread
+static int findTriangle(const hxt_reparam_surf &param, double u, double v,
+                        double uv[2])
+{
+  int *last = param.threadLastHit();
+  int i = param.locator.find(u, v, uv, last ? last[0] : -1);
+  if(last && i >= 0) last[0] = i;
+  return i;
+}
+
+#endif
+
 int discreteFace::trianglePosition(double par1, double par2, double &u,
                                    double &v) const
 {
 #if defined(HAVE_HXT)
   if(_parametrizations.empty()) return 0;
 
-  double xy[3] = {par1, par2, 0};
-  double uv[3];
-  const MElement *e =
-    _parametrizations[_currentParametrization].oct->find(par1, par2, 0.0);
-  if(!e) return -1;
-  e->xyz2uvw(xy, uv);
+  double uv[2];
   int position =
-    (int)((MTriangle *)e - &_parametrizations[_currentParametrization].t2d[0]);
+    findTriangle(_parametrizations[_currentParametrization], par1, par2, uv);
+  if(position < 0) return -1;
   u = uv[0];
   v = uv[1];
   return position;
@@ -147,17 +156,14 @@ GPoint discreteFace::point(double par1, double par2) const
   if(_parametrizations.empty()) return 0;
 
   double xy[3] = {par1, par2, 0};
-  double uv[3];
-  const MElement *e =
-    _parametrizations[_currentParametrization].oct->find(par1, par2, 0.0);
-  if(!e) {
+  double uv[2];
+  int position =
+    findTriangle(_parametrizations[_currentParametrization], par1, par2, uv);
+  if(position < 0) {
     GPoint gp = GPoint(1.e21, 1.e21, 1.e21, this, xy);
     gp.setNoSuccess();
     return gp;
   }
-  e->xyz2uvw(xy, uv);
-  int position =
-    (int)((MTriangle *)e - &_parametrizations[_currentParametrization].t2d[0]);
   const MTriangle &t3d =
     _parametrizations[_currentParametrization].t3d[position];
 
@@ -238,6 +244,20 @@ GPoint discreteFace::closestPoint(const SPoint3 &queryPoint, double maxDistance,
 #if defined(HAVE_HXT)
   if(_parametrizations.empty()) return GPoint();
 
+  const hxt_reparam_surf &param = _parametrizations[_currentParametrization];
+  int *last = param.threadLastHit();
+
+  // the closest triangle is not farther than the one found by the previous
+  // query of this thread
+  if(last && last[1] >= 0) {
+    std::pair<MTriangle *, MTriangle *> t(
+      const_cast<MTriangle *>(&param.t3d[last[1]]),
+      const_cast<MTriangle *>(&param.t2d[last[1]]));
+    dfWrapper w(queryPoint);
+    discreteFace_rtree_callback(&t, &w);
+    maxDistance = std::max(maxDistance, 1.0001 * w._distance);
+  }
+
   dfWrapper wrapper(queryPoint);
   do {
     wrapper._distance = 1.e22;
@@ -245,10 +265,10 @@ GPoint discreteFace::closestPoint(const SPoint3 &queryPoint, double maxDistance,
                      queryPoint.z() - maxDistance};
     double MAX[3] = {queryPoint.x() + maxDistance, queryPoint.y() + maxDistance,
                      queryPoint.z() + maxDistance};
-    _parametrizations[_currentParametrization].rtree3d.Search(
-      MIN, MAX, discreteFace_rtree_callback, &wrapper);
+    param.rtree3d.Search(MIN, MAX, discreteFace_rtree_callback, &wrapper);
     maxDistance *= 2.0;
   } while(!wrapper._t3d);
+  if(last) last[1] = (int)(wrapper._t3d - &param.t3d[0]);
 
   if(normal) {
     SVector3 t1(
@@ -308,15 +328,14 @@ SVector3 discreteFace::normal(const SPoint2 &param) const
 #if defined(HAVE_HXT)
   if(_parametrizations.empty()) return SVector3();
 
-  MElement *e = _parametrizations[_currentParametrization].oct->find(
-    param.x(), param.y(), 0.0);
-  if(!e) {
+  double uv[2];
+  int position = findTriangle(_parametrizations[_currentParametrization],
+                              param.x(), param.y(), uv);
+  if(position < 0) {
     Msg::Warning("Triangle not found at uv=(%g,%g) on discrete surface %d",
                  param.x(), param.y(), tag());
     return SVector3(0, 0, 1);
   }
-  int position =
-    (int)((MTriangle *)e - &_parametrizations[_currentParametrization].t2d[0]);
   const MTriangle &t3d =
     _parametrizations[_currentParametrization].t3d[position];
   return _NORMAL_(t3d);
@@ -341,17 +360,16 @@ Pair<SVector3, SVector3> discreteFace::firstDer(const SPoint2 &param) const
   if(_parametrizations.empty())
     return Pair<SVector3, SVector3>(SVector3(), SVector3());
 
-  MElement *e = _parametrizations[_currentParametrization].oct->find(
-    param.x(), param.y(), 0.0);
-  if(!e) {
+  double uv[2];
+  int position = findTriangle(_parametrizations[_currentParametrization],
+                              param.x(), param.y(), uv);
+  if(position < 0) {
     Msg::Warning("Triangle not found for first derivative at uv=(%g,%g) on "
                  "discrete surface %d",
                  param.x(), param.y(), tag());
     return Pair<SVector3, SVector3>(SVector3(1, 0, 0), SVector3(0, 1, 0));
   }
-
-  int position =
-    (int)((MTriangle *)e - &_parametrizations[_currentParametrization].t2d[0]);
+  const MTriangle *e = &_parametrizations[_currentParametrization].t2d[position];
 
   const MTriangle &t3d =
     _parametrizations[_currentParametrization].t3d[position];
@@ -602,13 +620,12 @@ GPoint discreteFace::intersectionWithCircle(const SVector3 &n1,
 #if defined(HAVE_HXT)
   if(_parametrizations.empty()) return GPoint();
 
-  MTriangle *t2d =
-    (MTriangle *)_parametrizations[_currentParametrization].oct->find(
-      uv[0], uv[1], 0.0);
-  MTriangle *t3d = NULL;
-  if(t2d) {
-    int position =
-      (int)(t2d - &_parametrizations[_currentParametrization].t2d[0]);
+  double xi[2];
+  int position = findTriangle(_parametrizations[_currentParametrization],
+                              uv[0], uv[1], xi);
+  MTriangle *t2d = NULL, *t3d = NULL;
+  if(position >= 0) {
+    t2d = &_parametrizations[_currentParametrization].t2d[position];
     t3d = &_parametrizations[_currentParametrization].t3d[position];
   }
 
@@ -1002,9 +1019,7 @@ HXTStatus discreteFace::_reparametrizeThroughHxt()
   }
 
   for(size_t i = 0; i < _parametrizations.size(); i++) {
-    std::vector<MElement *> temp;
     for(size_t j = 0; j < _parametrizations[i].t2d.size(); j++) {
-      temp.push_back(&_parametrizations[i].t2d[j]);
       double MIN[3] = {_parametrizations[i].t3d[j].getVertex(0)->x(),
                        _parametrizations[i].t3d[j].getVertex(0)->y(),
                        _parametrizations[i].t3d[j].getVertex(0)->z()};
@@ -1030,7 +1045,9 @@ HXTStatus discreteFace::_reparametrizeThroughHxt()
                                                 &_parametrizations[i].t2d[j]);
       _parametrizations[i].rtree3d.Insert(MIN, MAX, tt);
     }
-    _parametrizations[i].oct = new MElementOctree(temp);
+    _parametrizations[i].locator.build(&_parametrizations[i].t2d);
+    _parametrizations[i].lastHit.assign(16 * std::max(1, Msg::GetMaxThreads()),
+                                        -1);
   }
 
   for(size_t i = 0; i < _parametrizations.size(); i++) {
@@ -1044,9 +1061,135 @@ HXTStatus discreteFace::_reparametrizeThroughHxt()
   return HXT_STATUS_OK;
 }
 
-hxt_reparam_surf::~hxt_reparam_surf()
+int *hxt_reparam_surf::threadLastHit() const
 {
-  if(oct) delete oct;
+  std::size_t i = 16 * Msg::GetThreadNum();
+  return (i < lastHit.size()) ? &lastHit[i] : NULL;
+}
+
+void hxt_uv_locator::build(const std::vector<MTriangle> *t2d)
+{
+  _t2d = t2d;
+  _start.clear();
+  _triangles.clear();
+  const int n = _t2d->size();
+  if(!n) return;
+
+  double max[2];
+  _min[0] = max[0] = (*_t2d)[0].getVertex(0)->x();
+  _min[1] = max[1] = (*_t2d)[0].getVertex(0)->y();
+  for(int i = 0; i < n; i++) {
+    for(int j = 0; j < 3; j++) {
+      const MVertex *v = (*_t2d)[i].getVertex(j);
+      _min[0] = std::min(_min[0], v->x());
+      _min[1] = std::min(_min[1], v->y());
+      max[0] = std::max(max[0], v->x());
+      max[1] = std::max(max[1], v->y());
+    }
+  }
+  // about one triangle per cell
+  double w[2] = {std::max(max[0] - _min[0], 1.e-12),
+                 std::max(max[1] - _min[1], 1.e-12)};
+  _n[0] = std::min(n, std::max(1, (int)std::sqrt(n * w[0] / w[1])));
+  _n[1] = std::min(n, std::max(1, n / _n[0]));
+  _h[0] = w[0] / _n[0];
+  _h[1] = w[1] / _n[1];
+
+  // compressed storage of the triangles overlapping each cell
+  std::vector<int> range(4 * n);
+  _start.assign(_n[0] * _n[1] + 1, 0);
+  for(int pass = 0; pass < 2; pass++) {
+    for(int i = 0; i < n; i++) {
+      int *r = &range[4 * i];
+      if(!pass) {
+        const MTriangle &t = (*_t2d)[i];
+        double tmin[2] = {t.getVertex(0)->x(), t.getVertex(0)->y()};
+        double tmax[2] = {tmin[0], tmin[1]};
+        for(int j = 1; j < 3; j++) {
+          tmin[0] = std::min(tmin[0], t.getVertex(j)->x());
+          tmin[1] = std::min(tmin[1], t.getVertex(j)->y());
+          tmax[0] = std::max(tmax[0], t.getVertex(j)->x());
+          tmax[1] = std::max(tmax[1], t.getVertex(j)->y());
+        }
+        for(int k = 0; k < 2; k++) {
+          r[k] = std::max(0, (int)std::floor((tmin[k] - _min[k]) / _h[k]));
+          r[2 + k] = std::min(_n[k] - 1,
+                              (int)std::floor((tmax[k] - _min[k]) / _h[k]));
+        }
+      }
+      for(int ci = r[0]; ci <= r[2]; ci++) {
+        for(int cj = r[1]; cj <= r[3]; cj++) {
+          const int c = ci + _n[0] * cj;
+          if(!pass)
+            _start[c + 1]++;
+          else
+            _triangles[_start[c]++] = i;
+        }
+      }
+    }
+    if(!pass) {
+      for(std::size_t c = 1; c < _start.size(); c++) _start[c] += _start[c - 1];
+      _triangles.resize(_start.back());
+    }
+    else {
+      for(std::size_t c = _start.size() - 1; c > 0; c--)
+        _start[c] = _start[c - 1];
+      _start[0] = 0;
+    }
+  }
+}
+
+bool hxt_uv_locator::_inside(int i, double u, double v, double tol,
+                             double uv[2], double &dist) const
+{
+  const MTriangle &t = (*_t2d)[i];
+  const double x0 = t.getVertex(0)->x(), y0 = t.getVertex(0)->y();
+  const double x1 = t.getVertex(1)->x() - x0, y1 = t.getVertex(1)->y() - y0;
+  const double x2 = t.getVertex(2)->x() - x0, y2 = t.getVertex(2)->y() - y0;
+  const double det = x1 * y2 - x2 * y1;
+  if(det == 0.) return false;
+  uv[0] = ((u - x0) * y2 - x2 * (v - y0)) / det;
+  uv[1] = (x1 * (v - y0) - (u - x0) * y1) / det;
+  dist = -std::min(std::min(uv[0], uv[1]), 1. - uv[0] - uv[1]);
+  return dist <= tol;
+}
+
+int hxt_uv_locator::find(double u, double v, double uv[2], int hint) const
+{
+  if(!_t2d || _start.empty()) return -1;
+  const double tol = MElement::getTolerance();
+  double dist;
+  if(hint >= 0 && hint < (int)_t2d->size() &&
+     _inside(hint, u, v, tol, uv, dist))
+    return hint;
+
+  const int ci = std::min(
+    _n[0] - 1, std::max(0, (int)std::floor((u - _min[0]) / _h[0])));
+  const int cj = std::min(
+    _n[1] - 1, std::max(0, (int)std::floor((v - _min[1]) / _h[1])));
+  const int c = ci + _n[0] * cj;
+  for(int k = _start[c]; k < _start[c + 1]; k++) {
+    if(_inside(_triangles[k], u, v, tol, uv, dist)) return _triangles[k];
+  }
+
+  // not found: as MElementOctree::find(), accept the closest triangle in the
+  // neighborhood, with a tolerance up to 0.1 in local coordinates
+  int best = -1;
+  double bestDist = 0.1, tuv[2];
+  for(int i = std::max(0, ci - 1); i <= std::min(_n[0] - 1, ci + 1); i++) {
+    for(int j = std::max(0, cj - 1); j <= std::min(_n[1] - 1, cj + 1); j++) {
+      const int c2 = i + _n[0] * j;
+      for(int k = _start[c2]; k < _start[c2 + 1]; k++) {
+        if(_inside(_triangles[k], u, v, bestDist, tuv, dist)) {
+          best = _triangles[k];
+          bestDist = dist;
+          uv[0] = tuv[0];
+          uv[1] = tuv[1];
+        }
+      }
+    }
+  }
+  return best;
 }
 
 #endif
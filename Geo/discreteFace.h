@@ -27,11 +27,30 @@ extern "C" {
 #include "hxt_curvature.h"
 }
 
-class MElementOctree;
+// Locator of the triangles of a parametrization in the (u,v) plane: a uniform
+// grid of the bounding boxes of the triangles. It is immutable once built, and
+// can thus be queried concurrently.
+class hxt_uv_locator {
+private:
+  const std::vector<MTriangle> *_t2d;
+  double _min[2], _h[2];
+  int _n[2];
+  std::vector<int> _start, _triangles;
+  bool _inside(int i, double u, double v, double tol, double uv[2],
+               double &dist) const;
+
+public:
+  hxt_uv_locator() : _t2d(NULL) {}
+  void build(const std::vector<MTriangle> *t2d);
+  // return the index of the triangle containing (u,v) and the local coordinates
+  // of the point in this triangle, or -1; hint is the index of the triangle
+  // found by the previous query of the calling thread (or -1)
+  int find(double u, double v, double uv[2], int hint = -1) const;
+};
 
 class hxt_reparam_surf {
 public:
-  MElementOctree *oct;
+  hxt_uv_locator locator;
   mutable RTree<std::pair<MTriangle *, MTriangle *> *, double, 3> rtree3d;
   std::vector<MVertex> v2d;
   std::vector<MVertex> v3d;
@@ -39,8 +58,10 @@ public:
   std::vector<MTriangle> t3d;
   std::vector<GEdge *> bnd;
   std::vector<GEdge *> emb;
-  hxt_reparam_surf() : oct(NULL) {}
-  ~hxt_reparam_surf();
+  // last triangles found in (u,v) and in (x,y,z) by each thread, padded to
+  // avoid false sharing
+  mutable std::vector<int> lastHit;
+  int *threadLastHit() const;
 };
 
 #endif
@@ -76,6 +97,7 @@ public:
   virtual void secondDer(const SPoint2 &param, SVector3 &dudu, SVector3 &dvdv,
                          SVector3 &dudv) const;
   void createGeometry();
+  virtual bool threadSafeEvaluation() const { return true; }
   virtual bool haveParametrization()
   {
 #if defined(HAVE_HXT)
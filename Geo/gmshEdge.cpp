@@ -71,6 +71,38 @@ SVector3 gmshEdge::secondDer(double par) const
   return SVector3(a.Pos.X, a.Pos.Y, a.Pos.Z);
 }
 
+void gmshEdge::points(const std::vector<double> &par,
+                      std::vector<double> xyz[3]) const
+{
+  const int n = par.size();
+  for(int d = 0; d < 3; d++) xyz[d].resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    Vertex a = InterpolateCurve(c, par[i], 0);
+    xyz[0][i] = a.Pos.X;
+    xyz[1][i] = a.Pos.Y;
+    xyz[2][i] = a.Pos.Z;
+  }
+}
+
+void gmshEdge::firstDers(const std::vector<double> &par,
+                         std::vector<double> der[3]) const
+{
+  const int n = par.size();
+  for(int d = 0; d < 3; d++) der[d].resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    Vertex a = InterpolateCurve(c, par[i], 1);
+    der[0][i] = a.Pos.X;
+    der[1][i] = a.Pos.Y;
+    der[2][i] = a.Pos.Z;
+  }
+}
+
 GEntity::GeomType gmshEdge::geomType() const
 {
   switch(c->Typ) {
@@ -22,6 +22,11 @@ public:
   virtual GPoint point(double p) const;
   virtual SVector3 firstDer(double par) const;
   virtual SVector3 secondDer(double par) const;
+  virtual void points(const std::vector<double> &par,
+                      std::vector<double> xyz[3]) const;
+  virtual void firstDers(const std::vector<double> &par,
+                         std::vector<double> der[3]) const;
+  virtual bool threadSafeEvaluation() const { return true; }
   ModelType getNativeType() const { return GmshModel; }
   void *getNativePtr() const { return c; }
   virtual std::string getAdditionalInfoString(bool multline = false);
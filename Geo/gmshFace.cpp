@@ -49,6 +49,7 @@ bool gmshFace::degenerate(int dim) const
 void gmshFace::resetNativePtr(Surface *face)
 {
   s = face;
+  deleteParamSampling();
   l_edges.clear();
   l_dirs.clear();
   edgeLoops.clear();
@@ -255,6 +256,92 @@ GPoint gmshFace::point(double par1, double par2) const
   }
 }
 
+void gmshFace::points(const std::vector<double> &u,
+                      const std::vector<double> &v,
+                      std::vector<double> xyz[3]) const
+{
+  const int n = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) xyz[d].resize(n);
+  if(s->Typ == MSH_SURF_PLAN && !s->geometry) {
+    double x, y, z, VX[3], VY[3];
+    getMeanPlaneData(VX, VY, x, y, z);
+    double o[3] = {x, y, z};
+    for(int d = 0; d < 3; d++)
+      for(int i = 0; i < n; i++) xyz[d][i] = o[d] + VX[d] * u[i] + VY[d] * v[i];
+    return;
+  }
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    Vertex p = InterpolateSurface(s, u[i], v[i], 0, 0);
+    xyz[0][i] = p.Pos.X;
+    xyz[1][i] = p.Pos.Y;
+    xyz[2][i] = p.Pos.Z;
+  }
+}
+
+void gmshFace::firstDers(const std::vector<double> &u,
+                         const std::vector<double> &v,
+                         std::vector<double> du[3],
+                         std::vector<double> dv[3]) const
+{
+  const int n = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) {
+    du[d].resize(n);
+    dv[d].resize(n);
+  }
+  if(s->Typ == MSH_SURF_PLAN && !s->geometry) {
+    double x, y, z, VX[3], VY[3];
+    getMeanPlaneData(VX, VY, x, y, z);
+    for(int d = 0; d < 3; d++) {
+      std::fill(du[d].begin(), du[d].end(), VX[d]);
+      std::fill(dv[d].begin(), dv[d].end(), VY[d]);
+    }
+    return;
+  }
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(n))
+#endif
+  for(int i = 0; i < n; i++) {
+    Vertex vu = InterpolateSurface(s, u[i], v[i], 1, 1);
+    Vertex vv = InterpolateSurface(s, u[i], v[i], 1, 2);
+    du[0][i] = vu.Pos.X;
+    du[1][i] = vu.Pos.Y;
+    du[2][i] = vu.Pos.Z;
+    dv[0][i] = vv.Pos.X;
+    dv[1][i] = vv.Pos.Y;
+    dv[2][i] = vv.Pos.Z;
+  }
+}
+
+void gmshFace::normals(const std::vector<double> &u,
+                       const std::vector<double> &v,
+                       std::vector<double> n[3]) const
+{
+  const int nb = std::min(u.size(), v.size());
+  for(int d = 0; d < 3; d++) n[d].resize(nb);
+  if(!nb) return;
+  if(s->Typ == MSH_SURF_PLAN) {
+    // the (correctly oriented) normal of a plane is computed only once
+    SVector3 nn = normal(SPoint2(u[0], v[0]));
+    for(int d = 0; d < 3; d++) std::fill(n[d].begin(), n[d].end(), nn[d]);
+    return;
+  }
+#if defined(_OPENMP)
+#pragma omp parallel for if(batchInParallel(nb))
+#endif
+  for(int i = 0; i < nb; i++) {
+    Vertex vu = InterpolateSurface(s, u[i], v[i], 1, 1);
+    Vertex vv = InterpolateSurface(s, u[i], v[i], 1, 2);
+    Vertex nn = vu % vv;
+    nn.norme();
+    n[0][i] = nn.Pos.X;
+    n[1][i] = nn.Pos.Y;
+    n[2][i] = nn.Pos.Z;
+  }
+}
+
 GPoint gmshFace::closestPoint(const SPoint3 &qp,
                               const double initialGuess[2]) const
 {
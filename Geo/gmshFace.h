@@ -30,6 +30,17 @@ public:
   virtual Pair<SVector3, SVector3> firstDer(const SPoint2 &param) const;
   virtual void secondDer(const SPoint2 &, SVector3 &, SVector3 &,
                          SVector3 &) const;
+  virtual void points(const std::vector<double> &u,
+                      const std::vector<double> &v,
+                      std::vector<double> xyz[3]) const;
+  virtual void firstDers(const std::vector<double> &u,
+                         const std::vector<double> &v,
+                         std::vector<double> du[3],
+                         std::vector<double> dv[3]) const;
+  virtual void normals(const std::vector<double> &u,
+                       const std::vector<double> &v,
+                       std::vector<double> n[3]) const;
+  virtual bool threadSafeEvaluation() const { return true; }
   virtual GEntity::GeomType geomType() const;
   ModelType getNativeType() const { return GmshModel; }
   void *getNativePtr() const { return s; }
@@ -177,12 +177,9 @@ static void propagateValuesOnFace(GFace *_gf,
   linearSystem<double> *_lsys = 0;
 #if defined(HAVE_PETSC)
   _lsys = new linearSystemPETSc<double>;
-#elif defined(HAVE_GMM)
-  linearSystemGmm<double> *_lsysb = new linearSystemGmm<double>;
-  _lsysb->setGmres(1);
-  _lsys = _lsysb;
 #else
-  _lsys = new linearSystemFull<double>;
+  _lsys = new linearSystemCSRKrylov<double>(linearSystemCSRKrylov<double>::CG,
+                                            linearSystemCSRKrylov<double>::AMG);
 #endif
 
   dofManager<double> myAssembler(_lsys);
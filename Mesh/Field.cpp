@@ -941,7 +941,7 @@ public:
     }
     return true;
   }
-  double evaluate(double x, double y, double z)
+  double evaluate(double x, double y, double z) const
   {
     if(!_f) return MAX_LC;
     std::vector<double> values(3 + _fields.size()), res(1);
@@ -1016,7 +1016,7 @@ public:
     }
     return true;
   }
-  void evaluate(double x, double y, double z, SMetric3 &metr)
+  void evaluate(double x, double y, double z, SMetric3 &metr) const
   {
     const int index[6][2] = {{0, 0}, {1, 1}, {2, 2}, {0, 1}, {0, 2}, {1, 2}};
     for(int iFunction = 0; iFunction < 6; iFunction++) {
@@ -1053,23 +1053,42 @@ public:
       f, "Mathematical function to evaluate.", &update_needed);
     f = "F2 + Sin(z)";
   }
-  using Field::operator();
-  double operator()(double x, double y, double z, GEntity *ge = 0)
+  void update()
   {
-    double ret = 0;
+    // the flag is reset after the expression is compiled, so that threads
+    // seeing it cleared evaluate the new expression
+    bool needed;
 #if defined(_OPENMP)
-#pragma omp critical
+#pragma omp atomic read
+#endif
+    needed = update_needed;
+#if defined(_OPENMP)
+#pragma omp flush
+#endif
+    if(!needed) return;
+#if defined(_OPENMP)
+#pragma omp critical(MathEvalFieldUpdate)
 #endif
     {
       if(update_needed) {
         if(!expr.set_function(f))
           Msg::Error("Field %i: Invalid matheval expression \"%s\"", this->id,
                      f.c_str());
+#if defined(_OPENMP)
+#pragma omp flush
+#pragma omp atomic write
+#endif
         update_needed = false;
       }
-      ret = expr.evaluate(x, y, z);
     }
-    return ret;
+  }
+  using Field::operator();
+  double operator()(double x, double y, double z, GEntity *ge = 0)
+  {
+    // the compiled expression can be evaluated concurrently: only its update
+    // is serialized
+    update();
+    return expr.evaluate(x, y, z);
   }
   const char *getName() { return "MathEval"; }
   std::string getDescription()
@@ -1107,10 +1126,19 @@ public:
       f[5], "element 23 of the metric tensor.", &update_needed);
     f[5] = "F2 + Sin(z)";
   }
-  void operator()(double x, double y, double z, SMetric3 &metr, GEntity *ge = 0)
+  void update()
   {
+    bool needed;
 #if defined(_OPENMP)
-#pragma omp critical
+#pragma omp atomic read
+#endif
+    needed = update_needed;
+#if defined(_OPENMP)
+#pragma omp flush
+#endif
+    if(!needed) return;
+#if defined(_OPENMP)
+#pragma omp critical(MathEvalFieldAnisoUpdate)
 #endif
     {
       if(update_needed) {
@@ -1119,28 +1147,26 @@ public:
             Msg::Error("Field %i: Invalid matheval expression \"%s\"", this->id,
                        f[i].c_str());
         }
+#if defined(_OPENMP)
+#pragma omp flush
+#pragma omp atomic write
+#endif
         update_needed = false;
       }
-      expr.evaluate(x, y, z, metr);
     }
   }
+  void operator()(double x, double y, double z, SMetric3 &metr, GEntity *ge = 0)
+  {
+    // the compiled expressions can be evaluated concurrently: only their
+    // update is serialized
+    update();
+    expr.evaluate(x, y, z, metr);
+  }
   double operator()(double x, double y, double z, GEntity *ge = 0)
   {
     SMetric3 metr;
-#if defined(_OPENMP)
-#pragma omp critical
-#endif
-    {
-      if(update_needed) {
-        for(int i = 0; i < 6; i++) {
-          if(!expr.set_function(i, f[i]))
-            Msg::Error("Field %i: Invalid matheval expression \"%s\"", this->id,
-                       f[i].c_str());
-        }
-        update_needed = false;
-      }
-      expr.evaluate(x, y, z, metr);
-    }
+    update();
+    expr.evaluate(x, y, z, metr);
     return metr(0, 0);
   }
   const char *getName() { return "MathEvalAniso"; }
@@ -2575,7 +2601,10 @@ std::string BoundaryLayerField::getDescription()
   return "hwall * ratio^(dist/hwall)";
 }
 
+static const int _MAX_THREADS = 256;
+
 BoundaryLayerField::BoundaryLayerField()
+  : _attractors(_MAX_THREADS), _generation(0)
 {
   hwall_n = .1;
   hfar = 1;
@@ -2616,60 +2645,130 @@ BoundaryLayerField::BoundaryLayerField()
      "boundary layer should not be applied", &update_needed);
 }
 
+BoundaryLayerField::attractors &BoundaryLayerField::_current()
+{
+  int t = Msg::GetThreadNum();
+  if(t >= (int)_attractors.size()) {
+    Msg::Error("Maximum number of threads (%d) exceeded in boundary layer "
+               "field", (int)_attractors.size());
+    t = 0;
+  }
+  return _attractors[t];
+}
+
 void BoundaryLayerField::removeAttractors()
 {
-  for(std::list<DistanceField *>::iterator it = _att_fields.begin();
-      it != _att_fields.end(); ++it)
-    delete *it;
-  _att_fields.clear();
-  update_needed = true;
+  for(std::size_t i = 0; i < _attractors.size(); i++) {
+    for(std::list<DistanceField *>::iterator it =
+          _attractors[i].fields.begin();
+        it != _attractors[i].fields.end(); ++it)
+      delete *it;
+    _attractors[i].fields.clear();
+    _attractors[i].update_needed = true;
+  }
 }
 
-void BoundaryLayerField::setupFor1d(int iE)
+void BoundaryLayerField::_updateAttractors(attractors &a, int nbe)
 {
-  if(edges_id_saved.empty()) {
-    edges_id_saved = edges_id;
-    nodes_id_saved = nodes_id;
+  // options have been modified: start a new generation of attractors (the
+  // flag is tested again and reset in the critical section)
+  bool needed;
+#if defined(_OPENMP)
+#pragma omp atomic read
+#endif
+  needed = update_needed;
+  if(needed) {
+#if defined(_OPENMP)
+#pragma omp critical(BoundaryLayerFieldUpdate)
+#endif
+    {
+      if(update_needed) {
+        int g = _generation + 1;
+#if defined(_OPENMP)
+#pragma omp atomic write
+#endif
+        _generation = g;
+#if defined(_OPENMP)
+#pragma omp atomic write
+#endif
+        update_needed = false;
+      }
+    }
   }
+  int generation;
+#if defined(_OPENMP)
+#pragma omp atomic read
+#endif
+  generation = _generation;
+  if(!a.update_needed && a.generation == generation) return;
+  // only the attractors of the calling thread are rebuilt
+  for(std::list<DistanceField *>::iterator it = a.fields.begin();
+      it != a.fields.end(); ++it)
+    delete *it;
+  a.fields.clear();
+  const std::list<int> &nodes = a.restricted ? a.nodes_id : nodes_id;
+  const std::list<int> &edges = a.restricted ? a.edges_id : edges_id;
+  for(std::list<int>::const_iterator it = nodes.begin(); it != nodes.end();
+      ++it) {
+    a.fields.push_back(new DistanceField(0, *it, 100000));
+  }
+  for(std::list<int>::const_iterator it = edges.begin(); it != edges.end();
+      ++it) {
+    a.fields.push_back(new DistanceField(1, *it, nbe));
+  }
+  a.generation = generation;
+  a.update_needed = false;
+}
 
-  nodes_id.clear();
-  edges_id.clear();
+void BoundaryLayerField::setupFor1d(int iE)
+{
+  attractors &a = _current();
+  a.restricted = true;
+  a.nodes_id.clear();
+  a.edges_id.clear();
 
-  bool found = std::find(edges_id_saved.begin(), edges_id_saved.end(), iE) !=
-    edges_id_saved.end();
+  bool found = std::find(edges_id.begin(), edges_id.end(), iE) !=
+    edges_id.end();
 
   if(!found) {
     GEdge *ge = GModel::current()->getEdgeByTag(iE);
     GVertex *gv0 = ge->getBeginVertex();
     if(gv0){
-      found = std::find(nodes_id_saved.begin(), nodes_id_saved.end(),
-                        gv0->tag()) != nodes_id_saved.end();
-      if(found) nodes_id.push_back(gv0->tag());
+      found = std::find(nodes_id.begin(), nodes_id.end(),
+                        gv0->tag()) != nodes_id.end();
+      if(found) a.nodes_id.push_back(gv0->tag());
     }
     GVertex *gv1 = ge->getEndVertex();
     if(gv1){
-      found = std::find(nodes_id_saved.begin(), nodes_id_saved.end(),
-                        gv1->tag()) != nodes_id_saved.end();
-      if(found) nodes_id.push_back(gv1->tag());
+      found = std::find(nodes_id.begin(), nodes_id.end(),
+                        gv1->tag()) != nodes_id.end();
+      if(found) a.nodes_id.push_back(gv1->tag());
     }
   }
-  removeAttractors();
+  for(std::list<DistanceField *>::iterator it = a.fields.begin();
+      it != a.fields.end(); ++it)
+    delete *it;
+  a.fields.clear();
+  a.update_needed = true;
 }
 
 void BoundaryLayerField::setupFor2d(int iF)
 {
+  attractors &a = _current();
+  a.restricted = true;
+  a.nodes_id.clear();
+  a.edges_id.clear();
+  for(std::list<DistanceField *>::iterator it = a.fields.begin();
+      it != a.fields.end(); ++it)
+    delete *it;
+  a.fields.clear();
+  a.update_needed = true;
+
   if(std::find(excluded_faces_id.begin(), excluded_faces_id.end(), iF) !=
      excluded_faces_id.end())
     return;
 
   // remove GFaces from the attractors (only used in 2D) for edges and vertices
-  if(edges_id_saved.empty()) {
-    edges_id_saved = edges_id;
-    nodes_id_saved = nodes_id;
-  }
-
-  nodes_id.clear();
-  edges_id.clear();
 
   // FIXME :
   // NOT REALLY A NICE WAY TO DO IT (VERY AD HOC)
@@ -2684,8 +2783,8 @@ void BoundaryLayerField::setupFor2d(int iF)
   for(std::vector<GEdge *>::iterator it = ed.begin(); it != ed.end(); ++it) {
     bool isIn = false;
     int iE = (*it)->tag();
-    bool found = std::find(edges_id_saved.begin(), edges_id_saved.end(), iE) !=
-      edges_id_saved.end();
+    bool found = std::find(edges_id.begin(), edges_id.end(), iE) !=
+      edges_id.end();
     // this edge is a BL Edge
     if(found) {
       std::vector<GFace *> fc = (*it)->faces();
@@ -2712,35 +2811,24 @@ void BoundaryLayerField::setupFor2d(int iF)
       }
     }
     if(isIn) {
-      edges_id.push_back(iE);
+      a.edges_id.push_back(iE);
       if((*it)->getBeginVertex())
-        nodes_id.push_back((*it)->getBeginVertex()->tag());
+        a.nodes_id.push_back((*it)->getBeginVertex()->tag());
       if((*it)->getEndVertex())
-        nodes_id.push_back((*it)->getEndVertex()->tag());
+        a.nodes_id.push_back((*it)->getEndVertex()->tag());
     }
   }
-
-  removeAttractors();
 }
 
 double BoundaryLayerField::operator()(double x, double y, double z, GEntity *ge)
 {
-  if(update_needed) {
-    for(std::list<int>::iterator it = nodes_id.begin(); it != nodes_id.end();
-        ++it) {
-      _att_fields.push_back(new DistanceField(0, *it, 100000));
-    }
-    for(std::list<int>::iterator it = edges_id.begin(); it != edges_id.end();
-        ++it) {
-      _att_fields.push_back(new DistanceField(1, *it, 300000));
-    }
-    update_needed = false;
-  }
+  attractors &a = _current();
+  _updateAttractors(a, 300000);
 
   double dist = 1.e22;
-  if(_att_fields.empty()) return dist;
-  for(std::list<DistanceField *>::iterator it = _att_fields.begin();
-      it != _att_fields.end(); ++it) {
+  if(a.fields.empty()) return dist;
+  for(std::list<DistanceField *>::iterator it = a.fields.begin();
+      it != a.fields.end(); ++it) {
     double cdist = (*(*it))(x, y, z);
     if(cdist < dist) {
       dist = cdist;
@@ -2748,9 +2836,7 @@ double BoundaryLayerField::operator()(double x, double y, double z, GEntity *ge)
   }
 
   if(dist > thickness * ratio) return 1.e22;
-  current_distance = dist;
   // const double dist = (*field) (x, y, z);
-  // current_distance = dist;
   double lc = dist * (ratio - 1) + hwall_n;
 
   // double lc =  hwall_n;
@@ -2761,9 +2847,11 @@ double BoundaryLayerField::operator()(double x, double y, double z, GEntity *ge)
 void BoundaryLayerField::computeFor1dMesh(double x, double y, double z,
                                           SMetric3 &metr)
 {
+  const attractors &a = _current();
+  const std::list<int> &nodes = a.restricted ? a.nodes_id : nodes_id;
   double xpk = 0., ypk = 0., zpk = 0.;
   double distk = 1.e22;
-  for(std::list<int>::iterator it = nodes_id.begin(); it != nodes_id.end();
+  for(std::list<int>::const_iterator it = nodes.begin(); it != nodes.end();
       ++it) {
     GVertex *v = GModel::current()->getVertexByTag(*it);
     double xp = v->x();
@@ -2883,27 +2971,16 @@ void BoundaryLayerField::operator()(DistanceField *cc, double dist, double x,
 void BoundaryLayerField::operator()(double x, double y, double z,
                                     SMetric3 &metr, GEntity *ge)
 {
-  if(update_needed) {
-    for(std::list<int>::iterator it = nodes_id.begin(); it != nodes_id.end();
-        ++it) {
-      _att_fields.push_back(new DistanceField(0, *it, 100000));
-    }
-    for(std::list<int>::iterator it = edges_id.begin(); it != edges_id.end();
-        ++it) {
-      _att_fields.push_back(new DistanceField(1, *it, 10000));
-    }
-    update_needed = false;
-  }
+  attractors &a = _current();
+  _updateAttractors(a, 10000);
 
-  current_distance = 1.e22;
-  current_closest = 0;
+  double current_distance = 1.e22;
   std::vector<SMetric3> hop;
   SMetric3 v(1. / (CTX::instance()->mesh.lcMax * CTX::instance()->mesh.lcMax));
   hop.push_back(v);
-  for(std::list<DistanceField *>::iterator it = _att_fields.begin();
-      it != _att_fields.end(); ++it) {
+  for(std::list<DistanceField *>::iterator it = a.fields.begin();
+      it != a.fields.end(); ++it) {
     double cdist = (*(*it))(x, y, z);
-    SPoint3 CLOSEST = (*it)->getAttractorInfo().second;
     SMetric3 localMetric;
     if(iIntersect) {
       (*this)(*it, cdist, x, y, z, localMetric, ge);
@@ -2912,9 +2989,7 @@ void BoundaryLayerField::operator()(double x, double y, double z,
     if(cdist < current_distance) {
       if(!iIntersect) (*this)(*it, cdist, x, y, z, localMetric, ge);
       current_distance = cdist;
-      current_closest = *it;
       v = localMetric;
-      _closest_point = CLOSEST;
     }
   }
   if(iIntersect)
@@ -177,20 +177,32 @@ class DistanceField;
 
 class BoundaryLayerField : public Field {
 private:
-  std::list<DistanceField *> _att_fields;
+  // the attractors depend on the entity being meshed (see setupFor1d and
+  // setupFor2d), so that they are stored per thread; each thread rebuilds its
+  // own attractors when the options of the field change (i.e. when the
+  // generation of the field changes)
+  struct attractors {
+    bool restricted, update_needed;
+    int generation;
+    std::list<int> nodes_id, edges_id;
+    std::list<DistanceField *> fields;
+    attractors() : restricted(false), update_needed(true), generation(0) {}
+  };
+  std::vector<attractors> _attractors;
+  int _generation;
+  attractors &_current();
+  void _updateAttractors(attractors &a, int nbe);
   std::list<double> hwall_n_nodes;
   std::list<int> nodes_id, edges_id;
-  std::list<int> edges_id_saved, nodes_id_saved, fan_nodes_id;
+  std::list<int> fan_nodes_id;
   std::list<int> excluded_faces_id;
   void operator()(DistanceField *cc, double dist, double x, double y, double z,
                   SMetric3 &metr, GEntity *ge);
 
 public:
   double hwall_n, ratio, hfar, thickness;
-  double current_distance, tgt_aniso_ratio;
-  SPoint3 _closest_point;
+  double tgt_aniso_ratio;
   int iRecombine, iIntersect;
-  DistanceField *current_closest;
   virtual bool isotropic() const { return false; }
   virtual const char *getName();
   virtual std::string getDescription();
@@ -199,23 +211,29 @@ public:
   virtual double operator()(double x, double y, double z, GEntity *ge = 0);
   virtual void operator()(double x, double y, double z, SMetric3 &metr,
                           GEntity *ge = 0);
-  bool isEdgeBL(int iE) const
+  // is the curve a boundary layer curve for the entity being meshed by the
+  // calling thread?
+  bool isEdgeBL(int iE)
   {
-    return std::find(edges_id.begin(), edges_id.end(), iE) != edges_id.end();
+    const attractors &a = _current();
+    const std::list<int> &l = a.restricted ? a.edges_id : edges_id;
+    return std::find(l.begin(), l.end(), iE) != l.end();
   }
+  // is the curve in the list given by the user?
   bool isEdgeBLSaved(int iE) const
   {
-    return std::find(edges_id_saved.begin(), edges_id_saved.end(), iE) !=
-           edges_id_saved.end();
+    return std::find(edges_id.begin(), edges_id.end(), iE) != edges_id.end();
   }
   bool isFanNode(int iV) const
   {
     return std::find(fan_nodes_id.begin(), fan_nodes_id.end(), iV) !=
            fan_nodes_id.end();
   }
-  bool isEndNode(int iV) const
+  bool isEndNode(int iV)
   {
-    return std::find(nodes_id.begin(), nodes_id.end(), iV) != nodes_id.end();
+    const attractors &a = _current();
+    const std::list<int> &l = a.restricted ? a.nodes_id : nodes_id;
+    return std::find(l.begin(), l.end(), iV) != l.end();
   }
   double hwall(int iV)
   {
@@ -230,6 +248,7 @@ public:
   }
 
   void computeFor1dMesh(double x, double y, double z, SMetric3 &metr);
+  // restrict the attractors of the calling thread to the given curve/surface
   void setupFor1d(int iE);
   void setupFor2d(int iF);
   void removeAttractors();
@@ -43,6 +43,7 @@
 #include "simple3D.h"
 #include "yamakawa.h"
 #include "pointInsertion.h"
+#include "meshGFaceDecomposition.h"
 #endif
 
 #if defined(HAVE_OPTHOM)
@@ -327,6 +328,31 @@ static void Mesh0D(GModel *m)
   }
 }
 
+// extruded copies (the "top" of extrusions) read the mesh of their source,
+// which can still be modified after its status is set to DONE: when meshing in
+// parallel, a copy thus waits until its source was meshed in a previous pass
+static bool waitForExtrusionSource(GEdge *ge)
+{
+  ExtrudeParams *ep = ge->meshAttributes.extrude;
+  if(Msg::GetMaxThreads() == 1 || !ep || !ep->mesh.ExtrudeMesh ||
+     ep->geo.Mode == EXTRUDED_ENTITY)
+    return false;
+  GEdge *from = ge->model()->getEdgeByTag(std::abs(ep->geo.Source));
+  return from && from->geomType() != GEntity::DiscreteCurve &&
+         from->meshStatistics.status != GEdge::DONE;
+}
+
+static bool waitForExtrusionSource(GFace *gf)
+{
+  ExtrudeParams *ep = gf->meshAttributes.extrude;
+  if(Msg::GetMaxThreads() == 1 || !ep || !ep->mesh.ExtrudeMesh ||
+     ep->geo.Mode == EXTRUDED_ENTITY)
+    return false;
+  GFace *from = gf->model()->getFaceByTag(std::abs(ep->geo.Source));
+  return from && from->geomType() != GEntity::DiscreteSurface &&
+         from->meshStatistics.status != GFace::DONE;
+}
+
 static void Mesh1D(GModel *m)
 {
   m->getFields()->initialize();
@@ -340,17 +366,6 @@ static void Mesh1D(GModel *m)
      CTX::instance()->mesh.maxNumThreads1D <= Msg::GetMaxThreads())
     Msg::SetNumThreads(CTX::instance()->mesh.maxNumThreads1D);
 
-  // boundary layers are not yet thread-safe
-  if(m->getFields()->getNumBoundaryLayerFields())
-    Msg::SetNumThreads(1);
-
-  for(GModel::eiter it = m->firstEdge(); it != m->lastEdge(); ++it) {
-    // Extruded meshes are not yet fully thread-safe (not sure why!)
-    if((*it)->meshAttributes.extrude &&
-       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh)
-      Msg::SetNumThreads(1);
-  }
-
   std::vector<GEdge *> temp;
   for(GModel::eiter it = m->firstEdge(); it != m->lastEdge(); ++it) {
     (*it)->meshStatistics.status = GEdge::PENDING;
@@ -359,16 +374,24 @@ static void Mesh1D(GModel *m)
 
   Msg::ResetProgressMeter();
 
-  int nIter = 0, nTot = m->getNumEdges();
+  int nIter = 0, nTot = m->getNumEdges(), nPrevWaiting = nTot + 1;
   while(1) {
-    int nPending = 0;
+    int nPending = 0, nWaiting = 0;
     const size_t sss = temp.size();
+    std::vector<char> wait(sss, 0);
+    for(size_t K = 0; K < sss; K++) {
+      if(temp[K]->meshStatistics.status == GEdge::PENDING &&
+         waitForExtrusionSource(temp[K])) {
+        wait[K] = 1;
+        nWaiting++;
+      }
+    }
 #if defined(_OPENMP)
 #pragma omp parallel for schedule(dynamic)
 #endif
     for(size_t K = 0; K < sss; K++) {
       GEdge *ed = temp[K];
-      if(ed->meshStatistics.status == GEdge::PENDING) {
+      if(ed->meshStatistics.status == GEdge::PENDING && !wait[K]) {
         ed->mesh(true);
 #if defined(_OPENMP)
 #pragma omp critical
@@ -381,7 +404,9 @@ static void Mesh1D(GModel *m)
     }
 
     if(!nPending) break;
-    if(nIter++ > 10) break;
+    // chains of extrusions need one pass per copy
+    if(nIter++ > 10 && nWaiting >= nPrevWaiting) break;
+    nPrevWaiting = nWaiting;
   }
 
   Msg::SetNumThreads(prevNumThreads);
@@ -469,16 +494,7 @@ static void Mesh2D(GModel *m)
      CTX::instance()->mesh.maxNumThreads2D <= Msg::GetMaxThreads())
     Msg::SetNumThreads(CTX::instance()->mesh.maxNumThreads2D);
 
-  // boundary layers are not yet thread-safe
-  if(m->getFields()->getNumBoundaryLayerFields())
-    Msg::SetNumThreads(1);
-
   for(GModel::fiter it = m->firstFace(); it != m->lastFace(); ++it) {
-    // STL remeshing is not yet thread-safe
-    if((*it)->geomType() == GEntity::DiscreteSurface){
-      if(static_cast<discreteFace *>(*it)->haveParametrization())
-        Msg::SetNumThreads(1);
-    }
     // DelQuad and co are not yet thread-safe
     if((*it)->getMeshingAlgo() == ALGO_2D_FRONTAL_QUAD ||
        (*it)->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS ||
@@ -487,9 +503,10 @@ static void Mesh2D(GModel *m)
     // Periodic meshing is not yet thread-safe
     if((*it)->getMeshMaster() != *it)
       Msg::SetNumThreads(1);
-    // Extruded meshes are not yet fully thread-safe (not sure why!)
+    // QuadToTri extrusions modify their source surface
     if((*it)->meshAttributes.extrude &&
-       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh)
+       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh &&
+       (*it)->meshAttributes.extrude->mesh.QuadToTri)
       Msg::SetNumThreads(1);
   }
 
@@ -506,16 +523,35 @@ static void Mesh2D(GModel *m)
 
     Msg::ResetProgressMeter();
 
-    int nIter = 0, nTot = m->getNumFaces();
+    int nIter = 0, nTot = m->getNumFaces(), nPrevWaiting = nTot + 1;
     while(1) {
-      int nPending = 0;
+      int nPending = 0, nWaiting = 0;
       std::vector<GFace *> temp;
       temp.insert(temp.begin(), f.begin(), f.end());
+      // surfaces that can be split in sub-domains are meshed one at a time,
+      // each one using all the threads
+      for(size_t K = 0; K < temp.size(); K++) {
+        if(temp[K]->meshStatistics.status != GFace::PENDING) continue;
+        backgroundMesh::current()->unset();
+        if(canMeshGFaceByDomainDecomposition(temp[K])) {
+          temp[K]->mesh(true);
+          nPending++;
+          if(!nIter) Msg::ProgressMeter(nPending, nTot, false, "Meshing 2D...");
+        }
+      }
+      std::vector<char> wait(temp.size(), 0);
+      for(size_t K = 0; K < temp.size(); K++) {
+        if(temp[K]->meshStatistics.status == GFace::PENDING &&
+           waitForExtrusionSource(temp[K])) {
+          wait[K] = 1;
+          nWaiting++;
+        }
+      }
 #if defined(_OPENMP)
 #pragma omp parallel for schedule(dynamic)
 #endif
       for(size_t K = 0; K < temp.size(); K++) {
-        if(temp[K]->meshStatistics.status == GFace::PENDING) {
+        if(temp[K]->meshStatistics.status == GFace::PENDING && !wait[K]) {
           backgroundMesh::current()->unset();
           temp[K]->mesh(true);
 #if defined(_OPENMP)
@@ -531,7 +567,8 @@ static void Mesh2D(GModel *m)
       // iter == 2 is for meshing re-parametrized surfaces; after that, we
       // serialize (self-intersections of 1D meshes are not thread safe)!
       if(nIter > 2) Msg::SetNumThreads(1);
-      if(nIter++ > 10) break;
+      if(nIter++ > 10 && nWaiting >= nPrevWaiting) break;
+      nPrevWaiting = nWaiting;
     }
   }
 
@@ -809,25 +846,57 @@ static void Mesh3D(GModel *m)
      CTX::instance()->mesh.maxNumThreads3D <= Msg::GetMaxThreads())
     Msg::SetNumThreads(CTX::instance()->mesh.maxNumThreads3D);
 
+  std::vector<GRegion *> regions;
   for(GModel::riter it = m->firstRegion(); it != m->lastRegion(); ++it) {
-    // Extruded meshes are not yet fully thread-safe (not sure why!)
+    regions.push_back(*it);
+    // QuadToTri extrusions modify their source surface
     if((*it)->meshAttributes.extrude &&
-       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh)
+       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh &&
+       (*it)->meshAttributes.extrude->mesh.QuadToTri)
       Msg::SetNumThreads(1);
   }
 
   if(m->getNumRegions()) Msg::ProgressMeter(0, 100, false, "Meshing 3D...");
 
   // mesh the extruded volumes first
-  std::for_each(m->firstRegion(), m->lastRegion(), meshGRegionExtruded());
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(size_t K = 0; K < regions.size(); K++) {
+    meshGRegionExtruded mre;
+    mre(regions[K]);
+  }
 
   // then subdivide if necessary (unfortunately the subdivision is a
   // global operation, which can require changing the surface mesh!)
   SubdivideExtrudedMesh(m);
 
-  // then mesh all the non-delaunay regions (front3D with netgen)
+  // then mesh the transfinite regions, which are independent; the regions
+  // that cannot be meshed this way are handled by the serial loop below
+  std::vector<char> transfiniteDone(regions.size(), 0);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(size_t K = 0; K < regions.size(); K++) {
+    GRegion *gr = regions[K];
+    if(gr->meshAttributes.method != MESH_TRANSFINITE) continue;
+    if(gr->geomType() == GEntity::DiscreteVolume) continue;
+    if(CTX::instance()->mesh.meshOnlyVisible && !gr->getVisibility())
+      continue;
+    ExtrudeParams *ep = gr->meshAttributes.extrude;
+    if(ep && ep->mesh.ExtrudeMesh) continue;
+    deMeshGRegion dem;
+    dem(gr);
+    if(MeshTransfiniteVolume(gr)) transfiniteDone[K] = 1;
+  }
+
+  // then mesh all the other non-delaunay regions (front3D with netgen)
   std::vector<GRegion *> delaunay;
-  std::for_each(m->firstRegion(), m->lastRegion(), meshGRegion(delaunay));
+  for(size_t K = 0; K < regions.size(); K++) {
+    if(transfiniteDone[K]) continue;
+    meshGRegion mr(delaunay);
+    mr(regions[K]);
+  }
 
   // and finally mesh the delaunay regions (again, this is global; but
   // we mesh each connected part separately for performance and mesh
@@ -978,7 +1047,15 @@ void OptimizeMesh(GModel *m)
   Msg::StatusBar(true, "Optimizing 3D mesh...");
   double t1 = Cpu();
 
+  // regions are optimized one after the other, each one with all the threads
+  int prevNumThreads = Msg::GetMaxThreads();
+  if(CTX::instance()->mesh.maxNumThreads3D > 0 &&
+     CTX::instance()->mesh.maxNumThreads3D <= Msg::GetMaxThreads())
+    Msg::SetNumThreads(CTX::instance()->mesh.maxNumThreads3D);
+
   std::for_each(m->firstRegion(), m->lastRegion(), optimizeMeshGRegion());
+
+  Msg::SetNumThreads(prevNumThreads);
   // Ensure that all volume Jacobians are positive
   m->setAllVolumesPositive();
 
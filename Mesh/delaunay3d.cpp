@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <cmath>
 #include <queue>
+#include <iterator>
 #include "SPoint3.h"
 #include "SBoundingBox3d.h"
 #include "delaunay3d.h"
@@ -25,6 +26,8 @@
 #include "Context.h"
 #include "robustPredicates.h"
 #include "OS.h"
+#include "GRegion.h"
+#include "BackgroundMeshTools.h"
 
 #ifndef MAX_NUM_THREADS_
 #define MAX_NUM_THREADS_ 8
@@ -181,8 +184,9 @@ struct Tet {
   Vert *V[4];
   CHECKTYPE _bitset[MAX_NUM_THREADS_];
   bool _modified;
+  GRegion *_gr;
 
-  Tet() : _modified(true)
+  Tet() : _modified(true), _gr(NULL)
   {
     V[0] = V[1] = V[2] = V[3] = NULL;
     T[0] = T[1] = T[2] = T[3] = NULL;
@@ -224,7 +228,7 @@ struct Tet {
       return 0;
     }
   }
-  Tet(Vert *v0, Vert *v1, Vert *v2, Vert *v3)
+  Tet(Vert *v0, Vert *v1, Vert *v2, Vert *v3) : _gr(NULL)
   {
     setVertices(v0, v1, v2, v3);
     T[0] = T[1] = T[2] = T[3] = NULL;
@@ -1067,15 +1071,21 @@ void delaunayTrgl(const std::size_t numThreads,
 	  assignTo[K + myThread * NPTS_AT_ONCE][iPGlob] : NULL;
 
         if(vToAdd[K]) {
+          // start from the tet the point was created in, if known
+          Tet *hint = vToAdd[K]->getT();
+          if(hint && hint->V[0]) Choice[K] = hint;
           // In 3D, insertion of a point may lead to deletion of tets !!
           if(!Choice[K]->V[0]) Choice[K] = randomTet(0, allocator);
-          while(1) {
+          for(int iter = 0; iter < 100; iter++) {
             t[K] = walk(Choice[K], vToAdd[K], Npts, totSearch, myThread);
             if(t[K]) break;
             // the domain may not be convex. we then start from a random tet and
             // walk from there
             Choice[K] = randomTet(0, allocator);
           }
+          // the point may lie in a part of the mesh that cannot be reached
+          // (e.g. another region): it is then not inserted
+          if(!t[K]) vToAdd[K] = NULL;
         }
       }
 
@@ -1119,6 +1129,8 @@ void delaunayTrgl(const std::size_t numThreads,
           const std::size_t bSize = bndK.size();
           totCavity += cSize;
           Choice[K] = cavityK[0];
+          // cavities never cross region boundaries (no neighbor there)
+          GRegion *gr = cavityK[0]->_gr;
           for(std::size_t i = 0; i < bSize; i++) {
             // reuse memory slots of invalid elements
             Tet *t = (i < cSize) ? cavityK[i] : allocator.newTet(myThread);
@@ -1126,6 +1138,7 @@ void delaunayTrgl(const std::size_t numThreads,
               cacheMisses[myThread]++;
             t->setVerticesNoTest(bndK[i].f.V[0], bndK[i].f.V[1], bndK[i].f.V[2],
                                  vToAdd[K]);
+            t->_gr = gr;
             Tet *neigh = bndK[i].t;
             t->T[0] = neigh;
             t->T[1] = t->T[2] = t->T[3] = NULL;
@@ -1338,3 +1351,309 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
   for(int i = 0; i < 8; i++) delete box[i];
   for(std::size_t i = 0; i < _vertices.size(); i++) delete _vertices[i];
 }
+
+// Refinement of an existing mesh: points are created on the edges that are too
+// long w.r.t. the mesh size, and inserted by batches with delaunayTrgl()
+
+struct refinementPoint {
+  double x, y, z, lc1, lc2, lc;
+  Tet *t;
+  bool operator<(const refinementPoint &other) const
+  {
+    if(lc != other.lc) return lc < other.lc;
+    if(x != other.x) return x < other.x;
+    if(y != other.y) return y < other.y;
+    return z < other.z;
+  }
+};
+
+struct edgeXtet {
+  Vert *v[2];
+  Tet *t;
+  edgeXtet(Vert *v0, Vert *v1, Tet *_t) : t(_t)
+  {
+    v[0] = std::min(v0, v1);
+    v[1] = std::max(v0, v1);
+  }
+  bool operator<(const edgeXtet &other) const
+  {
+    if(v[0] != other.v[0]) return v[0] < other.v[0];
+    return v[1] < other.v[1];
+  }
+  bool operator==(const edgeXtet &other) const
+  {
+    return v[0] == other.v[0] && v[1] == other.v[1];
+  }
+};
+
+struct pointCell {
+  int level, i, j, k;
+  bool operator<(const pointCell &other) const
+  {
+    if(level != other.level) return level < other.level;
+    if(i != other.i) return i < other.i;
+    if(j != other.j) return j < other.j;
+    return k < other.k;
+  }
+};
+
+// Keep the points (sorted by increasing size) that are not closer than 0.7 *
+// min(lc) to an already accepted point. Accepted points are stored in a grid
+// per size octave, whose cells are larger than the rejection radius of the
+// points they contain: only 27 cells per octave need to be checked.
+static void filterPoints(const std::vector<refinementPoint> &p,
+                         std::vector<std::size_t> &accepted)
+{
+  std::map<pointCell, std::vector<std::size_t> > grid;
+  std::set<int> levels;
+  for(std::size_t n = 0; n < p.size(); n++) {
+    const int myLevel = (int)std::floor(std::log(p[n].lc) / std::log(2.));
+    bool ok = true;
+    for(std::set<int>::iterator it = levels.begin();
+        ok && it != levels.end() && *it <= myLevel; ++it) {
+      const double h = 0.7 * std::pow(2., *it + 1);
+      pointCell c;
+      c.level = *it;
+      const int i = (int)std::floor(p[n].x / h);
+      const int j = (int)std::floor(p[n].y / h);
+      const int k = (int)std::floor(p[n].z / h);
+      for(c.i = i - 1; ok && c.i <= i + 1; c.i++) {
+        for(c.j = j - 1; ok && c.j <= j + 1; c.j++) {
+          for(c.k = k - 1; ok && c.k <= k + 1; c.k++) {
+            std::map<pointCell, std::vector<std::size_t> >::iterator itc =
+              grid.find(c);
+            if(itc == grid.end()) continue;
+            for(std::size_t l = 0; l < itc->second.size(); l++) {
+              const refinementPoint &q = p[itc->second[l]];
+              const double d = 0.7 * std::min(p[n].lc, q.lc);
+              const double dx = p[n].x - q.x, dy = p[n].y - q.y,
+                           dz = p[n].z - q.z;
+              if(dx * dx + dy * dy + dz * dz < d * d) {
+                ok = false;
+                break;
+              }
+            }
+          }
+        }
+      }
+    }
+    if(!ok) continue;
+    const double h = 0.7 * std::pow(2., myLevel + 1);
+    pointCell c;
+    c.level = myLevel;
+    c.i = (int)std::floor(p[n].x / h);
+    c.j = (int)std::floor(p[n].y / h);
+    c.k = (int)std::floor(p[n].z / h);
+    grid[c].push_back(n);
+    levels.insert(myLevel);
+    accepted.push_back(n);
+  }
+}
+
+static double meshSize(double lc1, double lc2)
+{
+  return Extend2dMeshIn3dVolumes() ? std::min(lc1, lc2) : lc2;
+}
+
+// Create points on the edges of the tets that are longer than the mesh size;
+// only edges strictly inside a region are split, i.e. not the edges of the
+// faces without neighbor (on the boundary of the regions, on the interfaces
+// between regions or on embedded faces)
+static void createEdgePoints(tetContainer &allocator, int numThreads,
+                             std::vector<double> &sizes,
+                             std::vector<double> &sizesBGM,
+                             std::vector<refinementPoint> &points)
+{
+  static const int edges[6][2] = {{0, 1}, {0, 2}, {0, 3},
+                                  {1, 2}, {1, 3}, {2, 3}};
+  std::vector<edgeXtet> e, b;
+  for(int myThread = 0; myThread < numThreads; myThread++) {
+    for(std::size_t i = 0; i < allocator.size(myThread); i++) {
+      Tet *t = allocator(myThread, i);
+      if(!t->V[0]) continue;
+      for(int j = 0; j < 6; j++)
+        e.push_back(edgeXtet(t->V[edges[j][0]], t->V[edges[j][1]], t));
+      for(int j = 0; j < 4; j++) {
+        if(t->T[j]) continue;
+        Face f = t->getFace(j);
+        for(int k = 0; k < 3; k++)
+          b.push_back(edgeXtet(f.V[k], f.V[(k + 1) % 3], t));
+      }
+    }
+  }
+  std::sort(e.begin(), e.end());
+  e.erase(std::unique(e.begin(), e.end()), e.end());
+  std::sort(b.begin(), b.end());
+  b.erase(std::unique(b.begin(), b.end()), b.end());
+  std::vector<edgeXtet> interior;
+  interior.reserve(e.size());
+  std::set_difference(e.begin(), e.end(), b.begin(), b.end(),
+                      std::back_inserter(interior));
+  e.swap(interior);
+
+  const int nbEdges = e.size();
+#if defined(_OPENMP)
+#pragma omp parallel num_threads(numThreads)
+#endif
+  {
+    std::vector<refinementPoint> myPoints;
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic, 1024)
+#endif
+    for(int i = 0; i < nbEdges; i++) {
+      Vert *a = e[i].v[0], *b = e[i].v[1];
+      const double dx = b->x() - a->x(), dy = b->y() - a->y(),
+                   dz = b->z() - a->z();
+      const double l = std::sqrt(dx * dx + dy * dy + dz * dz);
+      const int n = (int)(2. * l / (a->lc() + b->lc()) + 0.5);
+      if(n < 2) continue;
+      const std::size_t ia = a->getNum() - 1, ib = b->getNum() - 1;
+      for(int k = 1; k < n; k++) {
+        const double u = (double)k / n;
+        refinementPoint p;
+        p.x = a->x() + u * dx;
+        p.y = a->y() + u * dy;
+        p.z = a->z() + u * dz;
+        p.lc1 = (1 - u) * sizes[ia] + u * sizes[ib];
+        p.lc2 = BGM_MeshSize(e[i].t->_gr, 0, 0, p.x, p.y, p.z);
+        p.lc = meshSize(p.lc1, p.lc2);
+        p.t = e[i].t;
+        myPoints.push_back(p);
+      }
+    }
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+    points.insert(points.end(), myPoints.begin(), myPoints.end());
+  }
+}
+
+int delaunayRefinement(const int numThreads, const int nptsatonce,
+                       std::vector<MTet4 *> &tets,
+                       const std::set<MFace, Less_Face> &embeddedFaces,
+                       std::vector<double> &sizes,
+                       std::vector<double> &sizesBGM,
+                       std::vector<MTetrahedron *> &T,
+                       std::vector<GRegion *> &R)
+{
+  const int nt = std::max(1, std::min(numThreads, MAX_NUM_THREADS_));
+  const int np = std::max(1, std::min(nptsatonce, 8));
+
+  // vertices of the existing mesh: vertex i has number i + 1
+  const std::size_t NV = sizes.size();
+  std::vector<MVertex *> mverts(NV, (MVertex *)NULL);
+  std::vector<Vert *> verts(NV, (Vert *)NULL);
+  double maxx = 0, maxy = 0, maxz = 0;
+  tetContainer allocator(nt, tets.size() / nt + 1000);
+  for(std::size_t i = 0; i < tets.size(); i++) {
+    if(tets[i]->isDeleted()) continue;
+    Vert *v[4];
+    for(int j = 0; j < 4; j++) {
+      MVertex *mv = tets[i]->tet()->getVertex(j);
+      std::size_t idx = mv->getIndex();
+      if(!verts[idx]) {
+        mverts[idx] = mv;
+        verts[idx] = new Vert(mv->x(), mv->y(), mv->z(),
+                              meshSize(sizes[idx], sizesBGM[idx]), idx + 1);
+        maxx = std::max(maxx, std::abs(mv->x()));
+        maxy = std::max(maxy, std::abs(mv->y()));
+        maxz = std::max(maxz, std::abs(mv->z()));
+      }
+      v[j] = verts[idx];
+    }
+    Tet *t = allocator.newTet(0);
+    t->setVertices(v[0], v[1], v[2], v[3]);
+    t->_gr = tets[i]->onWhat();
+  }
+
+  // connect the tets, except through the boundaries of the regions and the
+  // embedded faces
+  {
+    connContainer c;
+    for(std::size_t i = 0; i < allocator.size(0); i++) {
+      Tet *t = allocator(0, i);
+      for(int j = 0; j < 4; j++) c.push_back(conn(t->getFace(j), j, t));
+    }
+    std::sort(c.begin(), c.end());
+    for(std::size_t i = 0; i + 1 < c.size(); i++) {
+      if(!(c[i] == c[i + 1])) continue;
+      bool link = c[i].t->_gr == c[i + 1].t->_gr;
+      if(link && !embeddedFaces.empty()) {
+        const Face &f = c[i].f;
+        MFace mf(mverts[f.v[0]->getNum() - 1], mverts[f.v[1]->getNum() - 1],
+                 mverts[f.v[2]->getNum() - 1]);
+        link = embeddedFaces.find(mf) == embeddedFaces.end();
+      }
+      if(link) {
+        c[i].t->T[c[i].i] = c[i + 1].t;
+        c[i + 1].t->T[c[i + 1].i] = c[i].t;
+      }
+      i++;
+    }
+  }
+
+  robustPredicates::exactinit(1, maxx, maxy, maxz);
+
+  std::vector<Vert *> newVerts;
+  std::vector<double> newSizes, newSizesBGM;
+  for(int iter = 0; iter < 20; iter++) {
+    std::vector<refinementPoint> points;
+    createEdgePoints(allocator, nt, sizes, sizesBGM, points);
+    std::sort(points.begin(), points.end());
+    std::vector<std::size_t> accepted;
+    filterPoints(points, accepted);
+    Msg::Debug("Refinement pass %d: inserting %d points", iter + 1,
+              (int)accepted.size());
+    if(accepted.empty()) break;
+    std::vector<Vert *> S;
+    for(std::size_t i = 0; i < accepted.size(); i++) {
+      const refinementPoint &p = points[accepted[i]];
+      Vert *v = new Vert(p.x, p.y, p.z, p.lc, NV + newVerts.size() + 1);
+      v->setT(p.t);
+      newVerts.push_back(v);
+      newSizes.push_back(p.lc1);
+      newSizesBGM.push_back(p.lc2);
+      S.push_back(v);
+    }
+    Vert *box[8];
+    delaunayTriangulation(nt, np, S, box, allocator);
+  }
+
+  // create the new vertices that have been inserted, and the tets
+  std::vector<MVertex *> newMverts(newVerts.size(), (MVertex *)NULL);
+  int nbInserted = 0;
+  for(int myThread = 0; myThread < nt; myThread++) {
+    for(std::size_t i = 0; i < allocator.size(myThread); i++) {
+      Tet *t = allocator(myThread, i);
+      if(!t->V[0]) continue;
+      MVertex *v[4];
+      for(int j = 0; j < 4; j++) {
+        std::size_t num = t->V[j]->getNum() - 1;
+        if(num < NV) {
+          v[j] = mverts[num];
+          continue;
+        }
+        num -= NV;
+        if(!newMverts[num]) {
+          Vert *pv = newVerts[num];
+          MVertex *mv = new MVertex(pv->x(), pv->y(), pv->z(), t->_gr);
+          mv->setIndex(sizes.size());
+          sizes.push_back(newSizes[num]);
+          sizesBGM.push_back(newSizesBGM[num]);
+          t->_gr->mesh_vertices.push_back(mv);
+          newMverts[num] = mv;
+          nbInserted++;
+        }
+        v[j] = newMverts[num];
+      }
+      MTetrahedron *tr = new MTetrahedron(v[0], v[1], v[2], v[3]);
+      tr->setVolumePositive();
+      T.push_back(tr);
+      R.push_back(t->_gr);
+    }
+  }
+
+  for(std::size_t i = 0; i < verts.size(); i++) delete verts[i];
+  for(std::size_t i = 0; i < newVerts.size(); i++) delete newVerts[i];
+  return nbInserted;
+}
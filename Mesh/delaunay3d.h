@@ -6,8 +6,14 @@
 #ifndef _DELAUNAY3D_H_
 #define _DELAUNAY3D_H_
 
+#include <vector>
+#include <set>
+#include "MFace.h"
+
 class MVertex;
 class MTetrahedron;
+class MTet4;
+class GRegion;
 
 // tetrahedralize the vertices given in S; adds 8 new vertices at the end of S (the
 // corners of an enclosing box)
@@ -15,4 +21,18 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
                            std::vector<MVertex *> &S,
                            std::vector<MTetrahedron *> &T);
 
+// refine the tets (whose vertices have their mesh size given by sizes and
+// sizesBGM, indexed by MVertex::getIndex()) by inserting points on the edges
+// that are too long, by batches and in parallel; cavities never cross the
+// boundaries of the regions nor the embedded faces. The new tets are returned
+// in T (with their region in R), and the new vertices are added to the regions
+// and to the size vectors. Returns the number of vertices inserted.
+int delaunayRefinement(const int numThreads, const int nptsatonce,
+                       std::vector<MTet4 *> &tets,
+                       const std::set<MFace, Less_Face> &embeddedFaces,
+                       std::vector<double> &sizes,
+                       std::vector<double> &sizesBGM,
+                       std::vector<MTetrahedron *> &T,
+                       std::vector<GRegion *> &R);
+
 #endif
@@ -126,7 +126,7 @@ struct F_Lc_aniso {
       Field *bl_field = fields->get(fields->getBoundaryLayerField(i));
       if(bl_field == NULL) continue;
       BoundaryLayerField *blf = dynamic_cast<BoundaryLayerField *>(bl_field);
-      if(blf->isEdgeBL(ge->tag())) break;
+      if(blf->isEdgeBLSaved(ge->tag())) break;
       SMetric3 lc_bgm;
       blf->computeFor1dMesh(p.x(), p.y(), p.z(), lc_bgm);
       lc_here = intersection_conserveM1(lc_here, lc_bgm);
@@ -472,6 +472,14 @@ static void addBoundaryLayerPoints(GEdge *ge, double &t_begin, double &t_end,
 
   if(n == 0) return;
 
+  // restrict the boundary layer fields to this curve (for the calling thread)
+  for(int i = 0; i < n; ++i) {
+    Field *bl_field = fields->get(fields->getBoundaryLayerField(i));
+    if(bl_field == NULL) continue;
+    BoundaryLayerField *blf = dynamic_cast<BoundaryLayerField *>(bl_field);
+    blf->setupFor1d(ge->tag());
+  }
+
   if(!ge->getBeginVertex() || !ge->getEndVertex()) return;
 
   // Check if edge is a BL edge
@@ -479,7 +487,7 @@ static void addBoundaryLayerPoints(GEdge *ge, double &t_begin, double &t_end,
     Field *bl_field = fields->get(fields->getBoundaryLayerField(i));
     if(bl_field == NULL) continue;
     BoundaryLayerField *blf = dynamic_cast<BoundaryLayerField *>(bl_field);
-    if(blf->isEdgeBL(ge->tag())) return;
+    if(blf->isEdgeBLSaved(ge->tag())) return;
   }
 
   SVector3 dir(ge->getEndVertex()->x() - ge->getBeginVertex()->x(),
@@ -494,7 +502,6 @@ static void addBoundaryLayerPoints(GEdge *ge, double &t_begin, double &t_end,
     Field *bl_field = fields->get(fields->getBoundaryLayerField(i));
     if(bl_field == NULL) continue;
     BoundaryLayerField *blf = dynamic_cast<BoundaryLayerField *>(bl_field);
-    blf->setupFor1d(ge->tag());
 
     if(blf->isEndNode(gvb->tag())) {
       if(ge->geomType() != GEntity::Line) {
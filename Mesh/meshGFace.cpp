@@ -37,6 +37,7 @@
 #include "Context.h"
 #include "boundaryLayersData.h"
 #include "filterElements.h"
+#include "meshGFaceDecomposition.h"
 
 // define this to use the old initial delaunay
 #define OLD_CODE_DELAUNAY 1
@@ -2949,7 +2950,7 @@ void meshGFace::operator()(GFace *gf, bool print)
       gf->meshStatistics.status = GFace::FAILED;
     }
   }
-  else {
+  else if(onlyInitialMesh || !meshGFaceByDomainDecomposition(gf)) {
     meshGenerator(gf, 0, repairSelfIntersecting1dMesh, onlyInitialMesh,
                   debugSurface >= 0 || debugSurface == -100);
   }
@@ -0,0 +1,582 @@
+// Gmsh - Copyright (C) 1997-2019 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file for license information. Please report all
+// issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include "GmshConfig.h"
+#include "GmshMessage.h"
+#include "meshGFaceDecomposition.h"
+#include "meshGFace.h"
+#include "meshGFaceOptimize.h"
+#include "BackgroundMeshTools.h"
+#include "GModel.h"
+#include "GFace.h"
+#include "GEdge.h"
+#include "MVertex.h"
+#include "MLine.h"
+#include "MTriangle.h"
+#include "MQuadrangle.h"
+#include "Field.h"
+#include "ExtrudeParams.h"
+#include "Context.h"
+#include "robustPredicates.h"
+
+// An end of a cut, carrying the mesh size used to discretize the cut at that
+// end: the size at the nodes of the cut is then interpolated between its ends
+// (as along curves), which 2D algorithms like MeshAdapt extend in the strips.
+class stripVertex : public GVertex {
+private:
+  MVertex *_v;
+
+public:
+  stripVertex(GModel *m, MVertex *v, double lc) : GVertex(m, -1, lc), _v(v) {}
+  virtual GPoint point() const { return GPoint(x(), y(), z(), this); }
+  virtual double x() const { return _v->x(); }
+  virtual double y() const { return _v->y(); }
+  virtual double z() const { return _v->z(); }
+};
+
+// A piece of the boundary of a strip: either a cut, i.e. a straight segment
+// in the parametric plane of the surface, or a chain of the original 1D mesh
+// (in which case only the mesh lines are used).
+class stripEdge : public GEdge {
+private:
+  const GFace *_gf;
+  SPoint2 _a, _b;
+
+public:
+  stripEdge(const GFace *gf, const SPoint2 &a, const SPoint2 &b,
+            GVertex *va = 0, GVertex *vb = 0)
+    : GEdge(gf->model(), -1, va, vb), _gf(gf), _a(a), _b(b)
+  {
+  }
+  SPoint2 uv(double t) const { return _a + (_b - _a) * t; }
+  virtual Range<double> parBounds(int i) const { return Range<double>(0., 1.); }
+  virtual GPoint point(double t) const
+  {
+    GPoint p = _gf->point(uv(t));
+    return GPoint(p.x(), p.y(), p.z(), this, t);
+  }
+  virtual SVector3 firstDer(double t) const
+  {
+    Pair<SVector3, SVector3> d = _gf->firstDer(uv(t));
+    return d.first() * (_b.x() - _a.x()) + d.second() * (_b.y() - _a.y());
+  }
+  virtual SPoint2 reparamOnFace(const GFace *face, double t, int dir) const
+  {
+    return uv(t);
+  }
+  virtual bool isMeshDegenerated() const { return false; }
+};
+
+// A strip of the parametric domain of a surface: all the geometrical queries
+// are forwarded to the original surface.
+class stripFace : public GFace {
+private:
+  GFace *_gf;
+
+public:
+  stripFace(GFace *gf, GEdge *boundary) : GFace(gf->model(), gf->tag()), _gf(gf)
+  {
+    meshAttributes = gf->meshAttributes;
+    l_edges.push_back(boundary);
+    l_dirs.push_back(1);
+    boundary->addFace(this);
+  }
+  virtual GeomType geomType() const { return _gf->geomType(); }
+  virtual ModelType getNativeType() const { return _gf->getNativeType(); }
+  virtual void *getNativePtr() const { return _gf->getNativePtr(); }
+  virtual Range<double> parBounds(int i) const { return _gf->parBounds(i); }
+  virtual SBoundingBox3d bounds(bool fast = false) const
+  {
+    return _gf->bounds(fast);
+  }
+  virtual GPoint point(double par1, double par2) const
+  {
+    return _gf->point(par1, par2);
+  }
+  virtual SPoint2 parFromPoint(const SPoint3 &p, bool onSurface = true) const
+  {
+    return _gf->parFromPoint(p, onSurface);
+  }
+  virtual bool containsParam(const SPoint2 &pt)
+  {
+    return _gf->containsParam(pt);
+  }
+  virtual GPoint closestPoint(const SPoint3 &queryPoint,
+                              const double initialGuess[2]) const
+  {
+    return _gf->closestPoint(queryPoint, initialGuess);
+  }
+  virtual SVector3 normal(const SPoint2 &param) const
+  {
+    return _gf->normal(param);
+  }
+  virtual Pair<SVector3, SVector3> firstDer(const SPoint2 &param) const
+  {
+    return _gf->firstDer(param);
+  }
+  virtual void secondDer(const SPoint2 &param, SVector3 &dudu, SVector3 &dvdv,
+                         SVector3 &dudv) const
+  {
+    _gf->secondDer(param, dudu, dvdv, dudv);
+  }
+  virtual double curvatureMax(const SPoint2 &param) const
+  {
+    return _gf->curvatureMax(param);
+  }
+  virtual double curvatures(const SPoint2 &param, SVector3 &dirMax,
+                            SVector3 &dirMin, double &curvMax,
+                            double &curvMin) const
+  {
+    return _gf->curvatures(param, dirMax, dirMin, curvMax, curvMin);
+  }
+  virtual double getMetricEigenvalue(const SPoint2 &param)
+  {
+    return _gf->getMetricEigenvalue(param);
+  }
+  virtual void getMetricEigenVectors(const SPoint2 &param, double eigVal[2],
+                                     double eigVec[4]) const
+  {
+    _gf->getMetricEigenVectors(param, eigVal, eigVec);
+  }
+  virtual double getMeshSize() const { return _gf->getMeshSize(); }
+  virtual bool threadSafeEvaluation() const
+  {
+    return _gf->threadSafeEvaluation();
+  }
+};
+
+typedef std::pair<MVertex *, MVertex *> segment;
+
+// order a set of segments into a single closed loop
+static bool buildLoop(const std::vector<segment> &segments,
+                      std::vector<MVertex *> &loop)
+{
+  loop.clear();
+  std::map<MVertex *, std::vector<MVertex *>, MVertexLessThanNum> adj;
+  for(std::size_t i = 0; i < segments.size(); i++) {
+    adj[segments[i].first].push_back(segments[i].second);
+    adj[segments[i].second].push_back(segments[i].first);
+  }
+  if(adj.size() < 3) return false;
+  std::map<MVertex *, std::vector<MVertex *>, MVertexLessThanNum>::iterator it;
+  for(it = adj.begin(); it != adj.end(); ++it)
+    if(it->second.size() != 2) return false;
+  MVertex *first = adj.begin()->first, *prev = 0, *cur = first;
+  do {
+    loop.push_back(cur);
+    const std::vector<MVertex *> &n = adj[cur];
+    MVertex *next = (n[0] != prev) ? n[0] : n[1];
+    prev = cur;
+    cur = next;
+  } while(cur != first && loop.size() <= adj.size());
+  return cur == first && loop.size() == adj.size();
+}
+
+static bool segmentsIntersect(SPoint2 a, SPoint2 b, SPoint2 c, SPoint2 d)
+{
+  // conservative: touching or colinear segments are considered intersecting
+  double o1 = robustPredicates::orient2d(a, b, c);
+  double o2 = robustPredicates::orient2d(a, b, d);
+  double o3 = robustPredicates::orient2d(c, d, a);
+  double o4 = robustPredicates::orient2d(c, d, b);
+  return o1 * o2 <= 0. && o3 * o4 <= 0.;
+}
+
+static double meshSize(GFace *gf, const SPoint2 &uv, const GPoint &p,
+                       double lcBoundary)
+{
+  double lc = BGM_MeshSize(gf, uv.x(), uv.y(), p.x(), p.y(), p.z());
+  if(Extend1dMeshIn2dSurfaces()) lc = std::min(lc, lcBoundary);
+  return lc;
+}
+
+static bool isEligible(GFace *gf)
+{
+  if(CTX::instance()->mesh.domainDecomposition2D <= 0) return false;
+  if(gf->geomType() == GEntity::DiscreteSurface ||
+     gf->geomType() == GEntity::GhostSurface)
+    return false;
+  int algo = gf->getMeshingAlgo();
+  if(algo != ALGO_2D_MESHADAPT && algo != ALGO_2D_AUTO &&
+     algo != ALGO_2D_DELAUNAY && algo != ALGO_2D_FRONTAL)
+    return false;
+  if(CTX::instance()->mesh.recombineAll || gf->meshAttributes.recombine)
+    return false;
+  if(gf->meshAttributes.method == MESH_TRANSFINITE) return false;
+  if(gf->meshAttributes.extrude && gf->meshAttributes.extrude->mesh.ExtrudeMesh)
+    return false;
+  if(gf->getMeshMaster() != gf) return false;
+  if(gf->periodic(0) || gf->periodic(1)) return false;
+  if(gf->embeddedEdges().size() || gf->embeddedVertices().size()) return false;
+  if(gf->model()->getFields()->getNumBoundaryLayerFields()) return false;
+  std::vector<GEdge *> const &edges = gf->edges();
+  for(std::size_t i = 0; i < edges.size(); i++)
+    if(edges[i]->isSeam(gf)) return false;
+  return true;
+}
+
+// boundary loop of a surface and estimated number of triangles in bins along
+// the cut direction
+struct densityData {
+  std::vector<MVertex *> loop;
+  std::vector<SPoint2> uv;
+  double lcBoundary, wmin, dw, total;
+  int dir;
+  std::vector<double> density;
+};
+
+static const int NB = 64;
+
+static bool estimateDensity(GFace *gf, densityData &dd)
+{
+  // the boundary of the surface must be a single loop
+  std::vector<segment> segments;
+  std::vector<GEdge *> const &edges = gf->edges();
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    if(edges[i]->isMeshDegenerated()) continue;
+    for(std::size_t j = 0; j < edges[i]->lines.size(); j++)
+      segments.push_back(segment(edges[i]->lines[j]->getVertex(0),
+                                 edges[i]->lines[j]->getVertex(1)));
+  }
+  std::vector<MVertex *> &loop = dd.loop;
+  if(!buildLoop(segments, loop)) return false;
+
+  const std::size_t n = loop.size();
+  std::vector<SPoint2> &uv = dd.uv;
+  uv.resize(n);
+  double lcBoundary = 0.;
+  SBoundingBox3d bbox;
+  for(std::size_t i = 0; i < n; i++) {
+    if(!reparamMeshVertexOnFace(loop[i], gf, uv[i])) return false;
+    bbox += SPoint3(uv[i].x(), uv[i].y(), 0.);
+    lcBoundary += loop[i]->distance(loop[(i + 1) % n]);
+  }
+  lcBoundary /= n;
+  dd.lcBoundary = lcBoundary;
+
+  // cut along the parametric direction with the largest physical extent
+  SPoint2 center(0.5 * (bbox.min().x() + bbox.max().x()),
+                 0.5 * (bbox.min().y() + bbox.max().y()));
+  Pair<SVector3, SVector3> der = gf->firstDer(center);
+  double extent[2] = {der.first().norm() * (bbox.max().x() - bbox.min().x()),
+                      der.second().norm() * (bbox.max().y() - bbox.min().y())};
+  const int dir = (extent[0] >= extent[1]) ? 0 : 1;
+  const double wmin = bbox.min()[dir], wmax = bbox.max()[dir];
+  const double tmin = bbox.min()[1 - dir], tmax = bbox.max()[1 - dir];
+  if(wmax - wmin <= 0. || tmax - tmin <= 0.) return false;
+
+  // estimate the number of triangles in bins along the cut direction, by
+  // sampling the size field on a grid restricted to the domain
+  const double dw = (wmax - wmin) / NB, dt = (tmax - tmin) / NB;
+  std::vector<double> &density = dd.density;
+  density.assign(NB, 0.);
+  for(int j = 0; j < NB; j++) {
+    const double t = tmin + (j + 0.5) * dt;
+    std::vector<double> x;
+    for(std::size_t i = 0; i < n; i++) {
+      const SPoint2 &a = uv[i], &b = uv[(i + 1) % n];
+      if((a[1 - dir] >= t) != (b[1 - dir] >= t))
+        x.push_back(a[dir] + (t - a[1 - dir]) / (b[1 - dir] - a[1 - dir]) *
+                               (b[dir] - a[dir]));
+    }
+    std::sort(x.begin(), x.end());
+    for(std::size_t k = 0; k + 1 < x.size(); k += 2) {
+      int i0 = std::max(0, (int)std::ceil((x[k] - wmin) / dw - 0.5));
+      int i1 = std::min(NB - 1, (int)std::floor((x[k + 1] - wmin) / dw - 0.5));
+      for(int i = i0; i <= i1; i++) {
+        const double w = wmin + (i + 0.5) * dw;
+        SPoint2 p = dir ? SPoint2(t, w) : SPoint2(w, t);
+        GPoint gp = gf->point(p);
+        if(!gp.succeeded()) continue;
+        Pair<SVector3, SVector3> d = gf->firstDer(p);
+        const double area = norm(crossprod(d.first(), d.second())) * dw * dt;
+        const double lc = meshSize(gf, p, gp, lcBoundary);
+        density[i] += area / (lc * lc * std::sqrt(3.) / 4.);
+      }
+    }
+  }
+  dd.total = 0.;
+  for(int i = 0; i < NB; i++) dd.total += density[i];
+  dd.dir = dir;
+  dd.wmin = wmin;
+  dd.dw = dw;
+  return true;
+}
+
+bool canMeshGFaceByDomainDecomposition(GFace *gf)
+{
+  if(!isEligible(gf)) return false;
+  densityData dd;
+  return estimateDensity(gf, dd) &&
+         dd.total >= CTX::instance()->mesh.domainDecomposition2D;
+}
+
+bool meshGFaceByDomainDecomposition(GFace *gf)
+{
+  if(!isEligible(gf)) return false;
+  densityData dd;
+  if(!estimateDensity(gf, dd) ||
+     dd.total < CTX::instance()->mesh.domainDecomposition2D)
+    return false;
+
+  const std::vector<MVertex *> &loop = dd.loop;
+  std::vector<SPoint2> &uv = dd.uv;
+  const std::vector<double> &density = dd.density;
+  const std::size_t n = loop.size();
+  const int dir = dd.dir;
+  const double wmin = dd.wmin, dw = dd.dw, total = dd.total;
+
+
+  // place the cuts so that the strips have the same estimated number of
+  // triangles
+  const int nStrips = std::min(std::max(2, Msg::GetMaxThreads()), NB / 4);
+  std::vector<double> cuts;
+  {
+    double sum = 0.;
+    int i = 0;
+    for(int k = 1; k < nStrips; k++) {
+      const double target = total * k / nStrips;
+      while(i < NB - 1 && sum + density[i] < target) sum += density[i++];
+      const double f = density[i] > 0. ? (target - sum) / density[i] : 0.5;
+      cuts.push_back(wmin + (i + std::min(1., std::max(0., f))) * dw);
+    }
+  }
+
+  // snap the ends of each cut on the closest nodes of the boundary
+  const int nCuts = cuts.size();
+  std::vector<std::pair<std::size_t, std::size_t> > ends(nCuts);
+  std::vector<bool> used(n, false);
+  for(int k = 0; k < nCuts; k++) {
+    std::vector<std::size_t> snap;
+    for(std::size_t i = 0; i < n; i++) {
+      const std::size_t i1 = (i + 1) % n;
+      if((uv[i][dir] >= cuts[k]) == (uv[i1][dir] >= cuts[k])) continue;
+      snap.push_back(std::abs(uv[i][dir] - cuts[k]) <
+                         std::abs(uv[i1][dir] - cuts[k]) ?
+                       i :
+                       i1);
+    }
+    if(snap.size() != 2 || snap[0] == snap[1] || used[snap[0]] ||
+       used[snap[1]]) {
+      Msg::Debug("Could not split surface %d along a straight cut", gf->tag());
+      return false;
+    }
+    used[snap[0]] = used[snap[1]] = true;
+    ends[k] = std::make_pair(snap[0], snap[1]);
+  }
+
+  // the cuts must be inside the domain and must not intersect each other
+  for(int k = 0; k < nCuts; k++) {
+    const std::size_t a = ends[k].first, b = ends[k].second;
+    for(std::size_t i = 0; i < n; i++) {
+      const std::size_t i1 = (i + 1) % n;
+      if(i == a || i == b || i1 == a || i1 == b) continue;
+      if(segmentsIntersect(uv[a], uv[b], uv[i], uv[i1])) return false;
+    }
+    for(int l = 0; l < k; l++)
+      if(segmentsIntersect(uv[a], uv[b], uv[ends[l].first],
+                           uv[ends[l].second]))
+        return false;
+  }
+
+  // discretize the cuts w.r.t. the mesh size field
+  std::vector<stripEdge *> cutEdges(nCuts);
+  std::vector<stripVertex *> cutEnds;
+  std::vector<std::vector<MVertex *> > cutNodes(nCuts);
+  for(int k = 0; k < nCuts; k++) {
+    const std::size_t a = ends[k].first, b = ends[k].second;
+    const double lcA = 0.5 * (loop[a]->distance(loop[(a + 1) % n]) +
+                              loop[a]->distance(loop[(a + n - 1) % n]));
+    const double lcB = 0.5 * (loop[b]->distance(loop[(b + 1) % n]) +
+                              loop[b]->distance(loop[(b + n - 1) % n]));
+    cutEnds.push_back(new stripVertex(gf->model(), loop[a], lcA));
+    cutEnds.push_back(new stripVertex(gf->model(), loop[b], lcB));
+    cutEdges[k] = new stripEdge(gf, uv[a], uv[b], cutEnds[2 * k],
+                                cutEnds[2 * k + 1]);
+    const int M = 64;
+    std::vector<double> integral(M + 1, 0.);
+    GPoint p0 = cutEdges[k]->point(0.);
+    double lc0 = std::min(lcA, meshSize(gf, uv[a], p0, lcA));
+    for(int m = 1; m <= M; m++) {
+      const double t = (double)m / M;
+      GPoint p1 = cutEdges[k]->point(t);
+      const double lc1 =
+        meshSize(gf, cutEdges[k]->uv(t), p1, lcA + (lcB - lcA) * t);
+      const double dl = std::sqrt((p1.x() - p0.x()) * (p1.x() - p0.x()) +
+                                  (p1.y() - p0.y()) * (p1.y() - p0.y()) +
+                                  (p1.z() - p0.z()) * (p1.z() - p0.z()));
+      integral[m] = integral[m - 1] + 2. * dl / (lc0 + lc1);
+      p0 = p1;
+      lc0 = lc1;
+    }
+    const int N = std::max(1, (int)(integral[M] + 0.5));
+    cutNodes[k].push_back(loop[a]);
+    int m = 1;
+    for(int q = 1; q < N; q++) {
+      const double target = integral[M] * q / N;
+      while(m < M && integral[m] < target) m++;
+      const double t =
+        (m - 1 + (target - integral[m - 1]) / (integral[m] - integral[m - 1])) /
+        M;
+      GPoint gp = cutEdges[k]->point(t);
+      cutNodes[k].push_back(
+        new MEdgeVertex(gp.x(), gp.y(), gp.z(), cutEdges[k], t));
+    }
+    cutNodes[k].push_back(loop[b]);
+    for(std::size_t i = 0; i + 1 < cutNodes[k].size(); i++)
+      cutEdges[k]->lines.push_back(
+        new MLine(cutNodes[k][i], cutNodes[k][i + 1]));
+  }
+
+  // assign the chains of the boundary between the ends of the cuts to the
+  // strips; a point is in strip s if it is on the "w > cut" side of the s
+  // first cuts
+  std::vector<double> side(nCuts);
+  for(int k = 0; k < nCuts; k++) {
+    SPoint2 a = uv[ends[k].first], b = uv[ends[k].second];
+    SPoint2 c = a + (dir ? SPoint2(0., 1.) : SPoint2(1., 0.));
+    side[k] = robustPredicates::orient2d(a, b, c) > 0. ? 1. : -1.;
+  }
+  std::vector<std::size_t> pos;
+  for(int k = 0; k < nCuts; k++) {
+    pos.push_back(ends[k].first);
+    pos.push_back(ends[k].second);
+  }
+  std::sort(pos.begin(), pos.end());
+  std::vector<std::vector<segment> > stripSegments(nCuts + 1);
+  bool ok = true;
+  for(std::size_t j = 0; j < pos.size(); j++) {
+    const std::size_t i0 = pos[j], i1 = pos[(j + 1) % pos.size()];
+    const std::size_t len = (i1 + n - i0) % n;
+    const std::size_t im = (i0 + (len - 1) / 2) % n;
+    SPoint2 mid = (uv[im] + uv[(im + 1) % n]) * 0.5;
+    int s = 0;
+    for(int k = 0; k < nCuts; k++) {
+      double o = robustPredicates::orient2d(uv[ends[k].first],
+                                            uv[ends[k].second], mid);
+      if(o == 0.) ok = false;
+      if(o * side[k] > 0.) s++;
+    }
+    for(std::size_t i = i0; i != i1; i = (i + 1) % n)
+      stripSegments[s].push_back(segment(loop[i], loop[(i + 1) % n]));
+  }
+  // cut k separates strips k and k + 1
+  for(int k = 0; k < nCuts; k++) {
+    for(std::size_t i = 0; i + 1 < cutNodes[k].size(); i++) {
+      segment sg(cutNodes[k][i], cutNodes[k][i + 1]);
+      stripSegments[k].push_back(sg);
+      stripSegments[k + 1].push_back(sg);
+    }
+  }
+  std::vector<MVertex *> stripLoop;
+  for(int s = 0; s <= nCuts && ok; s++)
+    if(!buildLoop(stripSegments[s], stripLoop)) ok = false;
+
+  std::vector<stripEdge *> stripEdges;
+  std::vector<stripFace *> strips;
+  if(ok) {
+    for(int s = 0; s <= nCuts; s++) {
+      stripEdge *se = new stripEdge(gf, SPoint2(), SPoint2());
+      for(std::size_t i = 0; i < stripSegments[s].size(); i++)
+        se->lines.push_back(
+          new MLine(stripSegments[s][i].first, stripSegments[s][i].second));
+      stripEdges.push_back(se);
+      strips.push_back(new stripFace(gf, se));
+    }
+
+    Msg::Info("Meshing surface %d in %d sub-domains (%g estimated triangles)",
+              gf->tag(), (int)strips.size(), total);
+
+    // mesh the strips concurrently (if the geometry can be evaluated
+    // concurrently)
+    const int nS = strips.size();
+    std::vector<int> done(nS, 0);
+#if defined(_OPENMP)
+    const bool parallel =
+      gf->threadSafeEvaluation() && Msg::GetMaxThreads() > 1;
+#pragma omp parallel for schedule(dynamic) if(parallel)
+#endif
+    for(int s = 0; s < nS; s++) {
+      if(meshGenerator(strips[s], 0, false, false, false) &&
+         strips[s]->meshStatistics.status == GFace::DONE)
+        done[s] = 1;
+    }
+    for(int s = 0; s < nS; s++)
+      if(!done[s]) ok = false;
+  }
+
+  if(ok) {
+    // the nodes of the cuts become nodes of the surface
+    std::map<MVertex *, MVertex *> cutMap;
+    for(int k = 0; k < nCuts; k++) {
+      for(std::size_t i = 1; i + 1 < cutNodes[k].size(); i++) {
+        MVertex *v = cutNodes[k][i];
+        double t;
+        v->getParameter(0, t);
+        SPoint2 p = cutEdges[k]->uv(t);
+        MVertex *nv = new MFaceVertex(v->x(), v->y(), v->z(), gf, p.x(), p.y());
+        cutMap[v] = nv;
+        gf->mesh_vertices.push_back(nv);
+      }
+    }
+    gf->meshStatistics.nbTriangle = gf->meshStatistics.nbGoodQuality = 0;
+    gf->meshStatistics.worst_element_shape = 1.;
+    gf->meshStatistics.best_element_shape = 0.;
+    double avg = 0.;
+    for(std::size_t s = 0; s < strips.size(); s++) {
+      stripFace *sf = strips[s];
+      for(std::size_t i = 0; i < sf->mesh_vertices.size(); i++) {
+        sf->mesh_vertices[i]->setEntity(gf);
+        gf->mesh_vertices.push_back(sf->mesh_vertices[i]);
+      }
+      for(std::size_t i = 0; i < sf->getNumMeshElements(); i++) {
+        MElement *e = sf->getMeshElement(i);
+        for(std::size_t j = 0; j < e->getNumVertices(); j++) {
+          std::map<MVertex *, MVertex *>::iterator it =
+            cutMap.find(e->getVertex(j));
+          if(it != cutMap.end()) e->setVertex(j, it->second);
+        }
+      }
+      gf->triangles.insert(gf->triangles.end(), sf->triangles.begin(),
+                           sf->triangles.end());
+      gf->quadrangles.insert(gf->quadrangles.end(), sf->quadrangles.begin(),
+                             sf->quadrangles.end());
+      sf->mesh_vertices.clear();
+      sf->triangles.clear();
+      sf->quadrangles.clear();
+      gf->meshStatistics.nbTriangle += sf->meshStatistics.nbTriangle;
+      gf->meshStatistics.nbGoodQuality += sf->meshStatistics.nbGoodQuality;
+      gf->meshStatistics.worst_element_shape =
+        std::min(gf->meshStatistics.worst_element_shape,
+                 sf->meshStatistics.worst_element_shape);
+      gf->meshStatistics.best_element_shape =
+        std::max(gf->meshStatistics.best_element_shape,
+                 sf->meshStatistics.best_element_shape);
+      avg += sf->meshStatistics.average_element_shape *
+             sf->meshStatistics.nbTriangle;
+    }
+    if(gf->meshStatistics.nbTriangle)
+      gf->meshStatistics.average_element_shape =
+        avg / gf->meshStatistics.nbTriangle;
+    // smooth across the interfaces between the strips
+    laplaceSmoothing(gf, CTX::instance()->mesh.nbSmoothing);
+    gf->meshStatistics.status = GFace::DONE;
+  }
+
+  for(std::size_t s = 0; s < strips.size(); s++) delete strips[s];
+  for(std::size_t s = 0; s < stripEdges.size(); s++) delete stripEdges[s];
+  for(int k = 0; k < nCuts; k++) {
+    for(std::size_t i = 1; i + 1 < cutNodes[k].size(); i++)
+      delete cutNodes[k][i];
+    delete cutEdges[k];
+  }
+  for(std::size_t i = 0; i < cutEnds.size(); i++) delete cutEnds[i];
+  if(!ok)
+    Msg::Debug("Domain decomposition of surface %d failed", gf->tag());
+  return ok;
+}
@@ -0,0 +1,24 @@
+// Gmsh - Copyright (C) 1997-2019 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file for license information. Please report all
+// issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef _MESH_GFACE_DECOMPOSITION_H_
+#define _MESH_GFACE_DECOMPOSITION_H_
+
+class GFace;
+
+// Intra-surface parallel meshing: if the estimated number of triangles of a
+// surface exceeds Mesh.DomainDecomposition2D, its parametric domain is split
+// into strips along cuts placed w.r.t. the mesh size field, the strips are
+// meshed concurrently with the 2D algorithm of the surface, and their meshes
+// are merged (the nodes of the cuts being shared).
+
+// will the surface be meshed by domain decomposition?
+bool canMeshGFaceByDomainDecomposition(GFace *gf);
+
+// mesh the surface by domain decomposition; returns false (and leaves the
+// surface untouched) if the surface is not split
+bool meshGFaceByDomainDecomposition(GFace *gf);
+
+#endif
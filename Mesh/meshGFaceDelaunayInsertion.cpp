@@ -379,7 +379,7 @@ int inCircumCircleAniso(GFace *gf, MTriangle *base, const double *uv,
 
 MTri3::MTri3(MTriangle *t, double lc, SMetric3 *metric, bidimMeshData *data,
              GFace *gf)
-  : deleted(false), base(t)
+  : deleted(false), queued(false), base(t)
 {
   neigh[0] = neigh[1] = neigh[2] = 0;
   double center[3];
@@ -451,6 +451,14 @@ MTri3::MTri3(MTriangle *t, double lc, SMetric3 *metric, bidimMeshData *data,
   }
 }
 
+bidimMeshData::~bidimMeshData()
+{
+  for(std::size_t i = 0; i < spareTris.size(); i++) {
+    delete spareTris[i]->tri();
+    delete spareTris[i];
+  }
+}
+
 int MTri3::inCircumCircle(const double *p) const
 {
   double pa[3] = {base->getVertex(0)->x(), base->getVertex(0)->y(),
@@ -566,8 +574,8 @@ static void recurFindCavity(std::vector<edgeXface> &shell,
   }
 }
 
-static void recurFindCavityAniso(GFace *gf, std::list<edgeXface> &shell,
-                                 std::list<MTri3 *> &cavity, double *metric,
+static void recurFindCavityAniso(GFace *gf, std::vector<edgeXface> &shell,
+                                 std::vector<MTri3 *> &cavity, double *metric,
                                  double *param, MTri3 *t, bidimMeshData &data)
 {
   t->setDeleted(true);
@@ -657,10 +665,26 @@ inline double getSurfUV(MTriangle *t, bidimMeshData &data)
   return s * 0.5;
 }
 
-static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity,
-                         bool force, GFace *gf, MVertex *v, double *param, MTri3 *t,
+static MTri3 *newTri3(MVertex *v0, MVertex *v1, MVertex *v2, double lc,
+                      bidimMeshData &data, GFace *gf)
+{
+  if(data.spareTris.empty())
+    return new MTri3(new MTriangle(v0, v1, v2), lc, 0, &data, gf);
+  MTri3 *t4 = data.spareTris.back();
+  data.spareTris.pop_back();
+  MTriangle *t = t4->tri();
+  t->setVertex(0, v0);
+  t->setVertex(1, v1);
+  t->setVertex(2, v2);
+  *t4 = MTri3(t, lc, 0, &data, gf);
+  return t4;
+}
+
+static int insertVertexB(std::vector<edgeXface> &shell,
+                         std::vector<MTri3 *> &cavity, bool force, GFace *gf,
+                         MVertex *v, double *param, MTri3 *t,
                          std::set<MTri3 *, compareTri3Ptr> &allTets,
-                         std::set<MTri3 *, compareTri3Ptr> *activeTets,
+                         MTri3Queue *activeTets,
                          bidimMeshData &data, double *metric, MTri3 **oneNewTriangle,
                          bool verifyStarShapeness = true)
 {
@@ -670,8 +694,6 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
 
   double EPS = verifyStarShapeness ? 1.e-12 : 1.e12;
 
-  std::vector<edgeXface> conn;
-
   // check that volume is conserved
   double newVolume = 0.0;
   double oldVolume = 0.0;
@@ -679,21 +701,21 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
   double oldMinQuality = 2.0;
 
   // TODO C++11 std::accumulate with lambda
-  std::list<MTri3 *>::iterator ittet = cavity.begin();
-  std::list<MTri3 *>::iterator ittete = cavity.end();
+  std::vector<MTri3 *>::iterator ittet = cavity.begin();
+  std::vector<MTri3 *>::iterator ittete = cavity.end();
   while(ittet != ittete) {
     oldVolume += std::abs(getSurfUV((*ittet)->tri(), data));
     oldMinQuality = std::min(oldMinQuality, (*ittet)->tri()->gammaShapeMeasure());
     ++ittet;
   }
 
-  MTri3 **newTris = new MTri3 *[shell.size()];
-
-  std::vector<MTri3 *> new_cavity;
+  std::vector<MTri3 *> &newTris = data.newTris;
+  newTris.clear();
 
-  int k = 0;
+  std::vector<MTri3 *> &new_cavity = data.newCavity;
+  new_cavity.clear();
 
-  std::list<edgeXface>::iterator it = shell.begin();
+  std::vector<edgeXface>::iterator it = shell.begin();
 
   bool onePointIsTooClose = false;
   double lcMin = std::numeric_limits<double>::infinity();
@@ -711,10 +733,9 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
       v0 = it->_v(1);
       v1 = it->_v(0);
     }
-    MTriangle *t = new MTriangle(v0, v1, v);
-    int index0 = data.getIndex(t->getVertex(0));
-    int index1 = data.getIndex(t->getVertex(1));
-    int index2 = data.getIndex(t->getVertex(2));
+    int index0 = data.getIndex(v0);
+    int index1 = data.getIndex(v1);
+    int index2 = data.getIndex(v);
     const double ONE_THIRD = 1. / 3.;
     double lc = ONE_THIRD * (data.vSizes[index0] + data.vSizes[index1] +
                              data.vSizes[index2]);
@@ -726,7 +747,7 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
     lcMin = std::min(lcMin, std::min(data.vSizes[index0], data.vSizes[index1]));
     lcBGMMin = std::min(lcBGMMin, std::min(data.vSizesBGM[index0], data.vSizesBGM[index1]));
 
-    MTri3 *t4 = new MTri3(t, LL, 0, &data, gf);
+    MTri3 *t4 = newTri3(v0, v1, v, LL, data, gf);
 
     if(oneNewTriangle) {
       force = true;
@@ -753,7 +774,7 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
       onePointIsTooClose = true;
     }
 
-    newTris[k++] = t4;
+    newTris.push_back(t4);
     // all new triangles are pushed front in order to be able to destroy them if
     // the cavity is not star shaped around the new vertex.
     new_cavity.push_back(t4);
@@ -773,20 +794,17 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
   // for adding a point we require that the area remains the same after addition
   // of the point, and that the point is not too close to an edge
   if(std::abs(oldVolume - newVolume) < EPS * oldVolume && !onePointIsTooClose){
-    connectTris(new_cavity.begin(), new_cavity.end(), conn);
+    connectTris(new_cavity.begin(), new_cavity.end(), data.conn);
     // 30 % of the time is spent here!
-    allTets.insert(newTris, newTris + shell.size());
+    allTets.insert(newTris.begin(), newTris.end());
     if(activeTets) {
       for(std::vector<MTri3 *>::iterator i = new_cavity.begin();
           i != new_cavity.end(); ++i) {
         int active_edge;
-        if(isActive(*i, LIMIT_, active_edge) && (*i)->getRadius() > LIMIT_) {
-          if((*activeTets).find(*i) == (*activeTets).end())
-            (*activeTets).insert(*i);
-        }
+        if(isActive(*i, LIMIT_, active_edge) && (*i)->getRadius() > LIMIT_)
+          activeTets->push(*i);
       }
     }
-    delete[] newTris;
     return 1;
   }
   else {
@@ -801,11 +819,8 @@ static int insertVertexB(std::list<edgeXface> &shell, std::list<MTri3 *> &cavity
     // _printTris("new_cavity.pos", new_cavity.begin(), new_cavity.end(), Us, Vs, false);
     // _printTris("newTris.pos", &newTris[0], newTris+shell.size(), Us, Vs, false);
     // _printTris("allTris.pos", allTets.begin(),allTets.end(), Us, Vs, false);
-    for(std::size_t i = 0; i < shell.size(); i++) {
-      delete newTris[i]->tri();
-      delete newTris[i];
-    }
-    delete[] newTris;
+    data.spareTris.insert(data.spareTris.end(), newTris.begin(),
+                          newTris.end());
 
     if(std::abs(oldVolume - newVolume) > EPS * oldVolume) return -3;
     if(onePointIsTooClose) return -4;
@@ -917,7 +932,7 @@ static bool insertAPoint(GFace *gf,
                          double center[2], double metric[3],
                          bidimMeshData &data,
                          std::set<MTri3 *, compareTri3Ptr> &AllTris,
-                         std::set<MTri3 *, compareTri3Ptr> *ActiveTris = 0,
+                         MTri3Queue *ActiveTris = 0,
                          MTri3 *worst = 0, MTri3 **oneNewTriangle = 0,
                          bool testStarShapeness = false)
 {
@@ -932,15 +947,17 @@ static bool insertAPoint(GFace *gf,
     worst = *it;
 
   MTri3 *ptin = 0;
-  std::list<edgeXface> shell;
-  std::list<MTri3 *> cavity;
+  std::vector<edgeXface> &shell = data.shell;
+  std::vector<MTri3 *> &cavity = data.cavity;
+  shell.clear();
+  cavity.clear();
   double uv[2];
 
   // if the point is able to break the bad triangle "worst"
   if(inCircumCircleAniso(gf, worst->tri(), center, metric, data)) {
     recurFindCavityAniso(gf, shell, cavity, metric, center, worst, data);
-    for(std::list<MTri3 *>::iterator itc = cavity.begin(); itc != cavity.end();
-        ++itc) {
+    for(std::vector<MTri3 *>::iterator itc = cavity.begin();
+        itc != cavity.end(); ++itc) {
       if(invMapUV((*itc)->tri(), center, data, uv, 1.e-8)) {
         ptin = *itc;
         break;
@@ -1006,7 +1023,7 @@ static bool insertAPoint(GFace *gf,
       worst->forceRadius(-1);
       AllTris.insert(worst);
       delete v;
-      for(std::list<MTri3 *>::iterator itc = cavity.begin();
+      for(std::vector<MTri3 *>::iterator itc = cavity.begin();
           itc != cavity.end(); ++itc)
         (*itc)->setDeleted(false);
       return false;
@@ -1017,8 +1034,8 @@ static bool insertAPoint(GFace *gf,
     }
   }
   else {
-    for(std::list<MTri3 *>::iterator itc = cavity.begin(); itc != cavity.end();
-        ++itc)
+    for(std::vector<MTri3 *>::iterator itc = cavity.begin();
+        itc != cavity.end(); ++itc)
       (*itc)->setDeleted(false);
     AllTris.erase(it);
     worst->forceRadius(0);
@@ -1291,7 +1308,7 @@ void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
                          std::vector<SPoint2> *true_boundary)
 {
   std::set<MTri3 *, compareTri3Ptr> AllTris;
-  std::set<MTri3 *, compareTri3Ptr> ActiveTris;
+  MTri3Queue ActiveTris;
   bidimMeshData DATA(equivalence, parametricCoordinates);
   bool testStarShapeness = true;
   SPoint3 c;
@@ -1311,7 +1328,7 @@ void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
   std::set<MTri3 *, compareTri3Ptr>::iterator it = AllTris.begin();
   for(; it != AllTris.end(); ++it) {
     if(isActive(*it, LIMIT_, active_edge))
-      ActiveTris.insert(*it);
+      ActiveTris.push(*it);
     else if((*it)->getRadius() < LIMIT_)
       break;
   }
@@ -1335,9 +1352,8 @@ void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
     // }
 
     // printf("%d active tris \n",ActiveTris.size());
-    if(!ActiveTris.size()) break;
-    MTri3 *worst = (*ActiveTris.begin());
-    ActiveTris.erase(ActiveTris.begin());
+    if(ActiveTris.empty()) break;
+    MTri3 *worst = ActiveTris.pop();
 
     if(!worst->isDeleted() && isActive(worst, LIMIT_, active_edge) &&
        worst->getRadius() > LIMIT_) {
@@ -1511,7 +1527,7 @@ void bowyerWatsonFrontalLayers(
   std::map<MVertex *, SPoint2> *parametricCoordinates)
 {
   std::set<MTri3 *, compareTri3Ptr> AllTris;
-  std::set<MTri3 *, compareTri3Ptr> ActiveTris;
+  MTri3Queue ActiveTris;
   bidimMeshData DATA(equivalence, parametricCoordinates);
 
   if(quad) {
@@ -1535,7 +1551,7 @@ void bowyerWatsonFrontalLayers(
   std::set<MEdge, Less_Edge> _front;
   for(; it != AllTris.end(); ++it) {
     if(isActive(*it, LIMIT_, active_edge)) {
-      ActiveTris.insert(*it);
+      ActiveTris.push(*it);
       updateActiveEdges(*it, LIMIT_, _front);
     }
     else if((*it)->getRadius() < LIMIT_)
@@ -1560,7 +1576,7 @@ void bowyerWatsonFrontalLayers(
     // printf("%d active triangles\n",ActiveTris.size());
 
     while(1) {
-      if(!ActiveTris.size()) break;
+      if(ActiveTris.empty()) break;
 
       /* if (1 || gf->tag() == 1900){
            char name[245];
@@ -1568,11 +1584,7 @@ void bowyerWatsonFrontalLayers(
            _printTris (name, AllTris, Us,Vs,true);
          }
       */
-      std::set<MTri3 *, compareTri3Ptr>::iterator WORST_ITER =
-        ActiveTris.begin();
-
-      MTri3 *worst = (*WORST_ITER);
-      ActiveTris.erase(WORST_ITER);
+      MTri3 *worst = ActiveTris.pop();
       if(!worst->isDeleted() &&
          (ITERATION > max_layers ?
             isActive(worst, LIMIT_, active_edge) :
@@ -1616,13 +1628,13 @@ void bowyerWatsonFrontalLayers(
     it = ActiveTrisNotInFront.begin();
     for(; it != ActiveTrisNotInFront.end(); ++it) {
       if((*it)->getRadius() > LIMIT_ && isActive(*it, LIMIT_, active_edge)) {
-        ActiveTris.insert(*it);
+        ActiveTris.push(*it);
         updateActiveEdges(*it, LIMIT_, _front);
       }
     }
     // Msg::Info("%d active tris %d front edges %d not in front",
     //           ActiveTris.size(),_front.size(),ActiveTrisNotInFront.size());
-    if(!ActiveTris.size()) break;
+    if(ActiveTris.empty()) break;
   }
 
   transferDataStructure(gf, AllTris, DATA);
@@ -14,61 +14,15 @@
 #include <list>
 #include <set>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 class GModel;
 class GFace;
 class BDS_Mesh;
 class BDS_Point;
 
-struct bidimMeshData {
-  std::map<MVertex *, int> indices;
-  std::vector<double> Us, Vs, vSizes, vSizesBGM;
-  std::vector<SMetric3> vMetricsBGM;
-  std::map<MVertex *, MVertex *> *equivalence;
-  std::map<MVertex *, SPoint2> *parametricCoordinates;
-  std::set<MEdge, Less_Edge> internalEdges; // embedded edges
-  //  std::set<MVertex*> internalVertices; // embedded vertices
-  inline void addVertex(MVertex *mv, double u, double v, double size,
-                        double sizeBGM)
-  {
-    int index = Us.size();
-    if(mv->onWhat()->dim() == 2)
-      mv->setIndex(index);
-    else
-      indices[mv] = index;
-    if(parametricCoordinates) {
-      std::map<MVertex *, SPoint2>::iterator it =
-        parametricCoordinates->find(mv);
-      if(it != parametricCoordinates->end()) {
-        u = it->second.x();
-        v = it->second.y();
-      }
-    }
-    Us.push_back(u);
-    Vs.push_back(v);
-    vSizes.push_back(size);
-    vSizesBGM.push_back(sizeBGM);
-  }
-  inline int getIndex(MVertex *mv)
-  {
-    if(mv->onWhat()->dim() == 2) return mv->getIndex();
-    return indices[mv];
-  }
-  inline MVertex *equivalent(MVertex *v1) const
-  {
-    if(equivalence) {
-      std::map<MVertex *, MVertex *>::iterator it = equivalence->find(v1);
-      if(it == equivalence->end()) return 0;
-      return it->second;
-    }
-    return 0;
-  }
-  bidimMeshData(std::map<MVertex *, MVertex *> *e = 0,
-                std::map<MVertex *, SPoint2> *p = 0)
-    : equivalence(e), parametricCoordinates(p)
-  {
-  }
-};
+struct bidimMeshData;
 
 void buildMetric(GFace *gf, double *uv, double *metric);
 int inCircumCircleAniso(GFace *gf, double *p1, double *p2, double *p3,
@@ -78,7 +32,7 @@ int inCircumCircleAniso(GFace *gf, MTriangle *base, const double *uv,
 
 class MTri3 {
 protected:
-  bool deleted;
+  bool deleted, queued;
   double circum_radius;
   MTriangle *base;
   MTri3 *neigh[3];
@@ -117,6 +71,8 @@ public:
     return inCircumCircle(v->x(), v->y());
   }
   inline void setDeleted(bool d) { deleted = d; }
+  inline bool isQueued() const { return queued; }
+  inline void setQueued(bool q) { queued = q; }
   inline bool assertNeigh() const
   {
     if(deleted) return true;
@@ -144,6 +100,39 @@ public:
   }
 };
 
+// Priority queue of the active triangles of the frontal algorithms, the worst
+// one (w.r.t. compareTri3Ptr) first. The triangles are kept in a binary heap,
+// and a flag in MTri3 avoids duplicates without searching the queue.
+class MTri3Queue {
+private:
+  struct compareHeap {
+    bool operator()(const MTri3 *a, const MTri3 *b) const
+    {
+      return compareTri3Ptr()(b, a);
+    }
+  };
+  std::vector<MTri3 *> _heap;
+
+public:
+  bool empty() const { return _heap.empty(); }
+  std::size_t size() const { return _heap.size(); }
+  void push(MTri3 *t)
+  {
+    if(t->isQueued()) return;
+    t->setQueued(true);
+    _heap.push_back(t);
+    std::push_heap(_heap.begin(), _heap.end(), compareHeap());
+  }
+  MTri3 *pop()
+  {
+    std::pop_heap(_heap.begin(), _heap.end(), compareHeap());
+    MTri3 *t = _heap.back();
+    _heap.pop_back();
+    t->setQueued(false);
+    return t;
+  }
+};
+
 void connectTriangles(std::list<MTri3 *> &);
 void connectTriangles(std::vector<MTri3 *> &);
 void connectTriangles(std::set<MTri3 *, compareTri3Ptr> &AllTris);
@@ -207,4 +196,60 @@ struct edgeXface {
   }
 };
 
+struct bidimMeshData {
+  std::map<MVertex *, int> indices;
+  std::vector<double> Us, Vs, vSizes, vSizesBGM;
+  std::vector<SMetric3> vMetricsBGM;
+  std::map<MVertex *, MVertex *> *equivalence;
+  std::map<MVertex *, SPoint2> *parametricCoordinates;
+  std::set<MEdge, Less_Edge> internalEdges; // embedded edges
+  //  std::set<MVertex*> internalVertices; // embedded vertices
+  inline void addVertex(MVertex *mv, double u, double v, double size,
+                        double sizeBGM)
+  {
+    int index = Us.size();
+    if(mv->onWhat()->dim() == 2)
+      mv->setIndex(index);
+    else
+      indices[mv] = index;
+    if(parametricCoordinates) {
+      std::map<MVertex *, SPoint2>::iterator it =
+        parametricCoordinates->find(mv);
+      if(it != parametricCoordinates->end()) {
+        u = it->second.x();
+        v = it->second.y();
+      }
+    }
+    Us.push_back(u);
+    Vs.push_back(v);
+    vSizes.push_back(size);
+    vSizesBGM.push_back(sizeBGM);
+  }
+  inline int getIndex(MVertex *mv)
+  {
+    if(mv->onWhat()->dim() == 2) return mv->getIndex();
+    return indices[mv];
+  }
+  inline MVertex *equivalent(MVertex *v1) const
+  {
+    if(equivalence) {
+      std::map<MVertex *, MVertex *>::iterator it = equivalence->find(v1);
+      if(it == equivalence->end()) return 0;
+      return it->second;
+    }
+    return 0;
+  }
+  // work buffers of the point insertion, reused from one point to the next
+  std::vector<edgeXface> shell, conn;
+  std::vector<MTri3 *> cavity, newCavity, newTris;
+  // triangles created for rejected points, recycled for the next insertions
+  std::vector<MTri3 *> spareTris;
+  bidimMeshData(std::map<MVertex *, MVertex *> *e = 0,
+                std::map<MVertex *, SPoint2> *p = 0)
+    : equivalence(e), parametricCoordinates(p)
+  {
+  }
+  ~bidimMeshData();
+};
+
 #endif
@@ -4,6 +4,7 @@
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <set>
+#include <map>
 #include "GmshConfig.h"
 #include "GModel.h"
 #include "MLine.h"
@@ -82,11 +83,32 @@ createQuaTri(std::vector<MVertex *> &v, GFace *to,
   }
 }
 
+// vertices created in the layers above each interior vertex of the source
+// entity, which can then be retrieved without querying the rtree
+typedef std::map<MVertex *, std::vector<MVertex *> > extrudedColumns;
+
+static MVertex *findExtrudedVertex(MVertex *v, int j, int k, ExtrudeParams *ep,
+                                   MVertexRTree &pos,
+                                   const extrudedColumns &columns)
+{
+  extrudedColumns::const_iterator it = columns.find(v);
+  if(it != columns.end()) {
+    int l = k;
+    for(int jj = 0; jj < j; jj++) l += ep->mesh.NbElmLayer[jj];
+    if(l == 0) return v;
+    if(l - 1 < (int)it->second.size()) return it->second[l - 1];
+  }
+  double x = v->x(), y = v->y(), z = v->z();
+  ep->Extrude(j, k, x, y, z);
+  return pos.find(x, y, z);
+}
+
 static void
 extrudeMesh(GEdge *from, GFace *to, MVertexRTree &pos,
             std::set<std::pair<MVertex *, MVertex *> > *constrainedEdges)
 {
   ExtrudeParams *ep = to->meshAttributes.extrude;
+  extrudedColumns columns;
 
   // create vertices (if the edges are constrained, they already exist)
   if(!constrainedEdges) {
@@ -94,7 +116,7 @@ extrudeMesh(GEdge *from, GFace *to, MVertexRTree &pos,
       std::vector<MVertex *> extruded_vertices;
       MVertex *v = from->mesh_vertices[i];
       MEdgeVertex *mv = (MEdgeVertex *)v;
-      mv->bl_data = new MVertexBoundaryLayerData();
+      std::vector<MVertex *> &column = columns[v];
       for(int j = 0; j < ep->mesh.NbLayer; j++) {
         for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
           double x = v->x(), y = v->y(), z = v->z();
@@ -111,12 +133,20 @@ extrudeMesh(GEdge *from, GFace *to, MVertexRTree &pos,
               newv = new MVertex(x, y, z, to);
             }
             to->mesh_vertices.push_back(newv);
-            pos.insert(newv);
+            MVertex *old = pos.insert(newv);
+            column.push_back(old ? old : newv);
             extruded_vertices.push_back(newv);
           }
         }
       }
-      mv->bl_data->addChildrenFamily(extruded_vertices);
+      // the source curve can be extruded into several surfaces
+#if defined(_OPENMP)
+#pragma omp critical(extrudedBoundaryLayerData)
+#endif
+      {
+        if(!mv->bl_data) mv->bl_data = new MVertexBoundaryLayerData();
+        mv->bl_data->addChildrenFamily(extruded_vertices);
+      }
     }
   }
 
@@ -138,28 +168,24 @@ extrudeMesh(GEdge *from, GFace *to, MVertexRTree &pos,
       to->tag());
 #endif
 
-  // create elements (note that it would be faster to access the *interior*
-  // nodes by direct indexing, but it's just simpler to query everything by
-  // position)
+  // create elements (the interior nodes are accessed by direct indexing, the
+  // other ones are queried by position)
   for(std::size_t i = 0; i < from->lines.size(); i++) {
     MVertex *v0 = from->lines[i]->getVertex(0);
     MVertex *v1 = from->lines[i]->getVertex(1);
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> verts;
-        double x[4] = {v0->x(), v1->x(), v0->x(), v1->x()};
-        double y[4] = {v0->y(), v1->y(), v0->y(), v1->y()};
-        double z[4] = {v0->z(), v1->z(), v0->z(), v1->z()};
-        for(int p = 0; p < 2; p++) {
-          ep->Extrude(j, k, x[p], y[p], z[p]);
-          ep->Extrude(j, k + 1, x[p + 2], y[p + 2], z[p + 2]);
-        }
+        MVertex *src[4] = {v0, v1, v0, v1};
         for(int p = 0; p < 4; p++) {
-          MVertex *tmp = pos.find(x[p], y[p], z[p]);
+          MVertex *tmp =
+            findExtrudedVertex(src[p], j, k + p / 2, ep, pos, columns);
           if(!tmp) {
+            double x = src[p]->x(), y = src[p]->y(), z = src[p]->z();
+            ep->Extrude(j, k + p / 2, x, y, z);
             Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g) "
                        "in surface %d",
-                       x[p], y[p], z[p], to->tag());
+                       x, y, z, to->tag());
             return;
           }
           verts.push_back(tmp);
@@ -182,24 +208,32 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
   std::vector<MVertex *> embedded = from->getEmbeddedMeshVertices();
   mesh_vertices.insert(mesh_vertices.end(), embedded.begin(), embedded.end());
 
-  // create extruded vertices
+  // create extruded vertices (reparametrized on the target face in a single
+  // batch)
+  std::vector<SPoint3> xyz(mesh_vertices.size());
   for(std::size_t i = 0; i < mesh_vertices.size(); i++) {
     MVertex *v = mesh_vertices[i];
     double x = v->x(), y = v->y(), z = v->z();
     ep->Extrude(ep->mesh.NbLayer - 1, ep->mesh.NbElmLayer[ep->mesh.NbLayer - 1],
                 x, y, z);
+    xyz[i] = SPoint3(x, y, z);
+  }
+  bool param = (to->geomType() != GEntity::DiscreteSurface &&
+                to->geomType() != GEntity::BoundaryLayerSurface);
+  std::vector<SPoint2> uv;
+  if(param) to->parFromPoints(xyz, uv);
+  // extruded interior vertices (retrieved without querying the rtree)
+  std::map<MVertex *, MVertex *> top;
+  for(std::size_t i = 0; i < xyz.size(); i++) {
     MVertex *newv = 0;
-    if(to->geomType() != GEntity::DiscreteSurface &&
-       to->geomType() != GEntity::BoundaryLayerSurface) {
-      SPoint3 xyz(x, y, z);
-      SPoint2 uv = to->parFromPoint(xyz);
-      newv = new MFaceVertex(x, y, z, to, uv[0], uv[1]);
-    }
-    else {
-      newv = new MVertex(x, y, z, to);
-    }
+    if(param)
+      newv = new MFaceVertex(xyz[i].x(), xyz[i].y(), xyz[i].z(), to, uv[i][0],
+                             uv[i][1]);
+    else
+      newv = new MVertex(xyz[i].x(), xyz[i].y(), xyz[i].z(), to);
     to->mesh_vertices.push_back(newv);
-    pos.insert(newv);
+    MVertex *old = pos.insert(newv);
+    top[mesh_vertices[i]] = old ? old : newv;
   }
 
 #if defined(HAVE_QUADTRI)
@@ -239,6 +273,11 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
     std::vector<MVertex *> verts;
     for(int j = 0; j < 3; j++) {
       MVertex *v = from->triangles[i]->getVertex(j);
+      std::map<MVertex *, MVertex *>::iterator itv = top.find(v);
+      if(itv != top.end()) {
+        verts.push_back(itv->second);
+        continue;
+      }
       double x = v->x(), y = v->y(), z = v->z();
       ep->Extrude(ep->mesh.NbLayer - 1,
                   ep->mesh.NbElmLayer[ep->mesh.NbLayer - 1], x, y, z);
@@ -271,6 +310,11 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
     std::vector<MVertex *> verts;
     for(int j = 0; j < 4; j++) {
       MVertex *v = from->quadrangles[i]->getVertex(j);
+      std::map<MVertex *, MVertex *>::iterator itv = top.find(v);
+      if(itv != top.end()) {
+        verts.push_back(itv->second);
+        continue;
+      }
       double x = v->x(), y = v->y(), z = v->z();
       ep->Extrude(ep->mesh.NbLayer - 1,
                   ep->mesh.NbElmLayer[ep->mesh.NbLayer - 1], x, y, z);
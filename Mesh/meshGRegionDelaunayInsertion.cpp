@@ -23,6 +23,10 @@
 #include "MLine.h"
 #include "ExtrudeParams.h"
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 int MTet4::radiusNorm = 2;
 
 #ifdef DEBUG_BOUNDARY_RECOVERY
@@ -463,7 +467,6 @@ bool insertVertexB(std::vector<faceXtet> &shell, std::vector<MTet4 *> &cavity,
                    MVertex *v, double lc1, double lc2,
                    std::vector<double> &vSizes, std::vector<double> &vSizesBGM,
                    MTet4 *t, MTet4Factory &myFactory,
-                   std::set<MTet4 *, compareTet4Ptr> &allTets,
                    const std::set<MFace, Less_Face> &allEmbeddedFaces)
 {
   std::vector<MTet4 *> new_cavity;
@@ -476,8 +479,8 @@ bool insertVertexB(std::vector<faceXtet> &shell, std::vector<MTet4 *> &cavity,
 
   bool onePointIsTooClose = false;
   while(it != shell.end()) {
-    MTetrahedron *tr =
-      new MTetrahedron(it->getVertex(0), it->getVertex(1), it->getVertex(2), v);
+    MTetrahedron *tr = myFactory.NewTetrahedron(
+      it->getVertex(0), it->getVertex(1), it->getVertex(2), v);
     MTet4 *t4 = myFactory.Create(tr, vSizes, vSizesBGM, lc1, lc2);
     t4->setOnWhat(t->onWhat());
 
@@ -503,7 +506,8 @@ bool insertVertexB(std::vector<faceXtet> &shell, std::vector<MTet4 *> &cavity,
       connectTets(new_cavity.begin(), new_cavity.end(), &allEmbeddedFaces);
     }
 
-    allTets.insert(new_tets.begin(), new_tets.end());
+    for(std::size_t i = 0; i < new_tets.size(); i++)
+      myFactory.push(new_tets[i]);
 
     return true;
   }
@@ -878,6 +882,175 @@ void adaptMeshGRegion::operator()(GRegion *gr)
   }
 }
 
+// Swap an edge (mode 0) or relocate the nodes (mode 1) of a tet if its quality
+// is below qMin; return the number of successful operations
+static int optimizeTet(MTet4 *t, int mode, double qMin,
+                       const qmTetrahedron::Measures &qm,
+                       const std::set<MEdge, Less_Edge> &allEmbeddedEdges,
+                       const std::set<MFace, Less_Face> &allEmbeddedFaces,
+                       std::vector<MTet4 *> &newTets)
+{
+  if(t->isDeleted()) return 0;
+  double qq = t->getQuality();
+  if(qq >= qMin) return 0;
+  int n = 0;
+  if(mode == 0) {
+    for(int i = 0; i < 6; i++) {
+      MEdge ed = t->tet()->getEdge(i);
+      if(allEmbeddedEdges.find(ed) == allEmbeddedEdges.end()) {
+        if(edgeSwap(newTets, t, i, qm, allEmbeddedFaces)) return 1;
+      }
+    }
+  }
+  else {
+    for(int i = 0; i < 4; i++) {
+      if(smoothVertex(t, i, qm)) n++;
+    }
+  }
+  return n;
+}
+
+#if defined(_OPENMP)
+
+// Claims on the nodes of a region, used to optimize its tets concurrently. A
+// swap or a relocation around a tet only modifies tets that contain one of its
+// nodes, and only reads nodes adjacent to those: claiming a tet thus locks its
+// nodes and all their neighbors. Nodes are hashed on a fixed set of locks, and
+// a claim never waits: if a lock is already taken, the claim fails.
+class tetClaims {
+private:
+  std::vector<omp_lock_t> _locks;
+  std::size_t _bucket(MVertex *v) const
+  {
+    return ((std::size_t)v->getNum() * 2654435761u) % _locks.size();
+  }
+  bool _lock(MVertex *v, std::vector<std::size_t> &held)
+  {
+    std::size_t b = _bucket(v);
+    if(std::find(held.begin(), held.end(), b) != held.end()) return true;
+    if(!omp_test_lock(&_locks[b])) return false;
+    held.push_back(b);
+    return true;
+  }
+
+public:
+  tetClaims(std::size_t n = 65536) : _locks(n)
+  {
+    for(std::size_t i = 0; i < _locks.size(); i++) omp_init_lock(&_locks[i]);
+  }
+  ~tetClaims()
+  {
+    for(std::size_t i = 0; i < _locks.size(); i++)
+      omp_destroy_lock(&_locks[i]);
+  }
+  // lock the nodes of a tet: its quality and its deletion flag can then be
+  // read safely
+  bool claimNodes(MTet4 *t, std::vector<std::size_t> &held)
+  {
+    held.clear();
+    for(int i = 0; i < 4; i++) {
+      if(!_lock(t->tet()->getVertex(i), held)) {
+        release(held);
+        return false;
+      }
+    }
+    return true;
+  }
+  // lock the neighbors of the nodes of a live tet whose nodes are claimed (the
+  // balls of the nodes cannot change anymore)
+  bool claimNeighbors(MTet4 *t, std::vector<std::size_t> &held,
+                      std::vector<MTet4 *> &ball)
+  {
+    for(int i = 0; i < 4; i++) {
+      MVertex *v = t->tet()->getVertex(i);
+      ball.clear();
+      ball.push_back(t);
+      buildVertexCavity_recur(t, v, ball);
+      for(std::size_t j = 0; j < ball.size(); j++) {
+        for(int k = 0; k < 4; k++) {
+          if(!_lock(ball[j]->tet()->getVertex(k), held)) {
+            release(held);
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+  void release(std::vector<std::size_t> &held)
+  {
+    for(std::size_t i = 0; i < held.size(); i++) omp_unset_lock(&_locks[held[i]]);
+    held.clear();
+  }
+};
+
+#endif
+
+// Apply optimizeTet() to all the tets, concurrently if several threads are
+// available: each tet is then optimized after claiming its neighborhood, and
+// the tets that could not be claimed are optimized serially afterwards
+static int optimizeTets(std::vector<MTet4 *> &allTets, int mode, double qMin,
+                        const qmTetrahedron::Measures &qm,
+                        const std::set<MEdge, Less_Edge> &allEmbeddedEdges,
+                        const std::set<MFace, Less_Face> &allEmbeddedFaces,
+                        std::vector<MTet4 *> &newTets)
+{
+  int n = 0;
+  std::vector<MTet4 *> deferred;
+  const int nbTets = allTets.size();
+#if defined(_OPENMP)
+  if(Msg::GetMaxThreads() > 1 && nbTets > 10000) {
+    tetClaims claims;
+    // per-thread results, merged in thread order
+    std::vector<std::vector<MTet4 *> > threadNewTets(Msg::GetMaxThreads());
+    std::vector<std::vector<MTet4 *> > threadDeferred(Msg::GetMaxThreads());
+#pragma omp parallel reduction(+ : n)
+    {
+      std::vector<MTet4 *> &myNewTets = threadNewTets[Msg::GetThreadNum()];
+      std::vector<MTet4 *> &myDeferred = threadDeferred[Msg::GetThreadNum()];
+      std::vector<MTet4 *> ball;
+      std::vector<std::size_t> held;
+#pragma omp for schedule(dynamic, 256)
+      for(int i = 0; i < nbTets; i++) {
+        MTet4 *t = allTets[i];
+        if(!claims.claimNodes(t, held)) {
+          myDeferred.push_back(t);
+          continue;
+        }
+        if(t->isDeleted() || t->getQuality() >= qMin) {
+          claims.release(held);
+          continue;
+        }
+        if(!claims.claimNeighbors(t, held, ball)) {
+          myDeferred.push_back(t);
+          continue;
+        }
+        n += optimizeTet(t, mode, qMin, qm, allEmbeddedEdges, allEmbeddedFaces,
+                         myNewTets);
+        claims.release(held);
+      }
+    }
+    for(std::size_t i = 0; i < threadNewTets.size(); i++) {
+      newTets.insert(newTets.end(), threadNewTets[i].begin(),
+                     threadNewTets[i].end());
+      deferred.insert(deferred.end(), threadDeferred[i].begin(),
+                      threadDeferred[i].end());
+    }
+    Msg::Debug("%d tets optimized serially (conflicts)", (int)deferred.size());
+  }
+  else
+#endif
+  {
+    for(int i = 0; i < nbTets; i++)
+      n += optimizeTet(allTets[i], mode, qMin, qm, allEmbeddedEdges,
+                       allEmbeddedFaces, newTets);
+  }
+  for(std::size_t i = 0; i < deferred.size(); i++)
+    n += optimizeTet(deferred[i], mode, qMin, qm, allEmbeddedEdges,
+                     allEmbeddedFaces, newTets);
+  return n;
+}
+
 void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm)
 {
   double qMin = CTX::instance()->mesh.optimizeThreshold;
@@ -952,30 +1125,21 @@ void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm)
   while(1) {
     std::vector<MTet4 *> newTets;
 
+    // swap edges
+    nbESwap += optimizeTets(allTets, 0, qMin, qm, allEmbeddedEdges,
+                            allEmbeddedFaces, newTets);
+
     illegals.clear();
     for(int i = 0; i < nbRanges; i++) quality_ranges[i] = 0;
 
     for(CONTAINER::iterator it = allTets.begin(); it != allTets.end(); ++it) {
       if(!(*it)->isDeleted()) {
         double qq = (*it)->getQuality();
-        if(qq < qMin) {
-          for(int i = 0; i < 6; i++) {
-            MEdge ed = (*it)->tet()->getEdge(i);
-            if(allEmbeddedEdges.find(ed) == allEmbeddedEdges.end()) {
-              if(edgeSwap(newTets, *it, i, qm, allEmbeddedFaces)) {
-                nbESwap++;
-                break;
-              }
-            }
-          }
-        }
-        if(!(*it)->isDeleted()) {
-          if(qq < sliverLimit) illegals.push_back(*it);
-          for(int i = 0; i < nbRanges; i++) {
-            double low = (double)i / nbRanges;
-            double high = (double)(i + 1) / nbRanges;
-            if(qq >= low && qq < high) quality_ranges[i]++;
-          }
+        if(qq < sliverLimit) illegals.push_back(*it);
+        for(int i = 0; i < nbRanges; i++) {
+          double low = (double)i / nbRanges;
+          double high = (double)(i + 1) / nbRanges;
+          if(qq >= low && qq < high) quality_ranges[i]++;
         }
       }
     }
@@ -993,16 +1157,8 @@ void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm)
 
     // relocate vertices
     if(gr->hexahedra.empty() && gr->prisms.empty() && gr->pyramids.empty()) {
-      for(CONTAINER::iterator it = allTets.begin(); it != allTets.end(); ++it) {
-        if(!(*it)->isDeleted()) {
-          double qq = (*it)->getQuality();
-          if(qq < qMin){
-            for(int i = 0; i < 4; i++) {
-              if(smoothVertex(*it, i, qm)) nbReloc++;
-            }
-          }
-        }
-      }
+      nbReloc += optimizeTets(allTets, 1, qMin, qm, allEmbeddedEdges,
+                              allEmbeddedFaces, newTets);
     }
 
     double totalVolumeb = 0.0;
@@ -1126,22 +1282,6 @@ double tetcircumcenter(double a[3], double b[3], double c[3], double d[3],
   return xxx;
 }
 
-static void memoryCleanup(MTet4Factory &myFactory,
-                          std::set<MTet4 *, compareTet4Ptr> &allTets)
-{
-  // int n1 = allTets.size();
-  std::set<MTet4 *, compareTet4Ptr>::iterator itd = allTets.begin();
-  while(itd != allTets.end()) {
-    if((*itd)->isDeleted()) {
-      myFactory.Free((*itd));
-      allTets.erase(itd++);
-    }
-    else
-      itd++;
-  }
-  // Msg::Info("Cleaning up memory %d -> %d", n1, allTets.size());
-}
-
 static int isCavityCompatibleWithEmbeddedEdges(std::vector<MTet4 *> &cavity,
                                                std::vector<faceXtet> &shell,
                                                edgeContainerB &allEmbeddedEdges)
@@ -1227,8 +1367,8 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
 #endif
 
   std::vector<double> vSizes, vSizesBGM;
-  MTet4Factory myFactory(1600000);
-  std::set<MTet4 *, compareTet4Ptr> &allTets = myFactory.getAllTets();
+  MTet4Factory myFactory;
+  MTet4Factory::container &allTets = myFactory.getAllTets();
   int NUM = 0;
 
   // leave this in a block so the map gets deallocated directly
@@ -1295,8 +1435,9 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
 
   for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
     gr->tetrahedra[i]->setVolumePositive();
-    allTets.insert(myFactory.Create(gr->tetrahedra[i], vSizes, vSizesBGM));
+    allTets.push_back(myFactory.Create(gr->tetrahedra[i], vSizes, vSizesBGM));
   }
+  myFactory.makeHeap();
 
   gr->tetrahedra.clear();
 
@@ -1380,6 +1521,29 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
   connectTets(allTets.begin(), allTets.end(), &allEmbeddedFaces);
   Msg::Debug("All %d tets were connected", allTets.size());
 
+  // if requested, refine the bulk of the mesh by batches of points first: the
+  // serial insertion below then only deals with the remaining large tets
+  // (cavities are not checked against embedded edges in parallel)
+  if(CTX::instance()->mesh.parallelRefinement3D &&
+     Msg::GetMaxThreads() > 1 && allEmbeddedEdges.empty()) {
+    double t0 = Cpu();
+    std::vector<MTetrahedron *> T;
+    std::vector<GRegion *> R;
+    int n = delaunayRefinement(Msg::GetMaxThreads(), 1, allTets,
+                               allEmbeddedFaces, vSizes, vSizesBGM, T, R);
+    NUM = vSizes.size();
+    for(std::size_t i = 0; i < allTets.size(); i++) myFactory.Free(allTets[i]);
+    allTets.clear();
+    for(std::size_t i = 0; i < T.size(); i++) {
+      MTet4 *t4 = myFactory.Create(T[i], vSizes, vSizesBGM);
+      t4->setOnWhat(R[i]);
+      allTets.push_back(t4);
+    }
+    myFactory.makeHeap();
+    connectTets(allTets.begin(), allTets.end(), &allEmbeddedFaces);
+    Msg::Info("%d points inserted in parallel (%g s)", n, Cpu() - t0);
+  }
+
   // here the classification should be done
 
   int ITER = 0, REALCOUNT = 0;
@@ -1399,11 +1563,11 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
       break;
     }
 
-    MTet4 *worst = *allTets.begin();
+    MTet4 *worst = myFactory.worst();
 
     if(worst->isDeleted()) {
+      myFactory.popWorst();
       myFactory.Free(worst);
-      allTets.erase(allTets.begin());
     }
     else {
       if(ITER++ % 500 == 0)
@@ -1490,9 +1654,9 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
 
         if(correctedCavityIncompatibleWithEmbeddedEntities || !starShaped ||
            !insertVertexB(shell, cavity, v, lc1, lc2, vSizes, vSizesBGM, worst,
-                          myFactory, allTets, allEmbeddedFaces)) {
+                          myFactory, allEmbeddedFaces)) {
           COUNT_MISS_1++;
-          myFactory.changeTetRadius(allTets.begin(), 0.);
+          myFactory.changeWorstRadius(0.);
           for(std::vector<MTet4 *>::iterator itc = cavity.begin();
               itc != cavity.end(); ++itc)
             (*itc)->setDeleted(false);
@@ -1508,7 +1672,7 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
       }
 
       else {
-        myFactory.changeTetRadius(allTets.begin(), 0.0);
+        myFactory.changeWorstRadius(0.0);
         COUNT_MISS_2++;
         for(std::vector<MTet4 *>::iterator itc = cavity.begin();
             itc != cavity.end(); ++itc)
@@ -1520,11 +1684,11 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
     // allows to clean up the set of tets when lots of deleted ones are present
     // in the mesh
     if(allTets.size() > 7 * vSizes.size() && ITER > 1000) {
-      memoryCleanup(myFactory, allTets);
+      myFactory.memoryCleanup();
     }
   }
 
-  memoryCleanup(myFactory, allTets);
+  myFactory.memoryCleanup();
   double t2 = Cpu();
   double dt = (t2 - t1);
   int COUNT_MISS = COUNT_MISS_1 + COUNT_MISS_2;
@@ -1551,15 +1715,17 @@ void insertVerticesInRegion(GRegion *gr, int maxVert, bool _classify,
     }
   }
 
-  while(1) {
-    if(allTets.begin() == allTets.end()) break;
-    MTet4 *worst = *allTets.begin();
+  // smoothing has modified the radii: sort the tets again before handing
+  // them over to the regions
+  myFactory.makeHeap();
+  while(!allTets.empty()) {
+    MTet4 *worst = myFactory.worst();
+    myFactory.popWorst();
     if(!worst->isDeleted()) {
       worst->onWhat()->tetrahedra.push_back(worst->tet());
       worst->tet() = 0;
     }
     myFactory.Free(worst);
-    allTets.erase(allTets.begin());
   }
 
   _deleteUnusedVertices(gr);
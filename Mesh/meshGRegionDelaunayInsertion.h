@@ -10,13 +10,14 @@
 #include <set>
 #include <map>
 #include <stack>
+#include <vector>
+#include <algorithm>
 #include "MTetrahedron.h"
 #include "Numeric.h"
 #include "BackgroundMeshTools.h"
 #include "qualityMeasures.h"
 #include "robustPredicates.h"
 
-//#define _GMSH_PRE_ALLOCATE_STRATEGY_ 1
 class GRegion;
 class GFace;
 class GModel;
@@ -32,9 +33,8 @@ class MTet4Factory;
 //
 // * sizeof(MTet4) = 36 Bytes and sizeof(MTetrahedron) = 28 Bytes
 //   -> 64 MB
-// * rb tree containing all pointers sorted with respect to tet
-//   radius: each bucket of the tree contains 4 pointers (16 Bytes)
-//   plus the data -> 20 MB
+// * heap containing all pointers sorted with respect to tet radius
+//   -> 4 MB
 // * sizeof(MVertex) = 44 Bytes and there are about 200000 verts per
 //   million tet -> 9MB
 // * vector of char lengths per vertex -> 1.6Mb
@@ -231,89 +231,124 @@ struct compareTet4Ptr {
   }
 };
 
+// Storage for the tets created during Delaunay refinement. MTet4s are
+// allocated by blocks and recycled, as well as the MTetrahedron they point to,
+// so that the insertion loop does not hit the allocator (nor burn element
+// numbers) for the many short-lived tets. All the tets are kept in a binary
+// heap w.r.t. their radius, the worst tet being first.
 class MTet4Factory {
 public:
-  typedef std::set<MTet4 *, compareTet4Ptr> container;
+  typedef std::vector<MTet4 *> container;
   typedef container::iterator iterator;
 
 private:
+  struct compareHeap {
+    bool operator()(MTet4 const *const a, MTet4 const *const b) const
+    {
+      return compareTet4Ptr()(b, a);
+    }
+  };
   container allTets;
-#ifdef _GMSH_PRE_ALLOCATE_STRATEGY_
-  MTet4 *allSlots;
-  int s_last, s_alloc;
-  std::stack<MTet4 *> emptySlots;
-  inline MTet4 *getANewSlot()
+  std::size_t _blockSize, _lastInBlock;
+  std::vector<MTet4 *> _blocks;
+  std::vector<MTet4 *> _emptySlots;
+  std::vector<MTetrahedron *> _emptyTets;
+  MTet4 *getAnEmptySlot()
   {
-    if(s_last >= s_alloc) return 0;
-    MTet4 *t = &(allSlots[s_last]);
-    s_last++;
-    return t;
-  }
-  inline MTet4 *getAnEmptySlot()
-  {
-    if(!emptySlots.empty()) {
-      MTet4 *t = emptySlots.top();
-      emptySlots.pop();
+    if(!_emptySlots.empty()) {
+      MTet4 *t = _emptySlots.back();
+      _emptySlots.pop_back();
       return t;
     }
-    return getANewSlot();
-  };
-#endif
+    if(_blocks.empty() || _lastInBlock == _blockSize) {
+      _blocks.push_back(new MTet4[_blockSize]);
+      _lastInBlock = 0;
+    }
+    return &_blocks.back()[_lastInBlock++];
+  }
+
 public:
-  MTet4Factory(int _size = 1000000)
+  MTet4Factory(std::size_t blockSize = 65536)
+    : _blockSize(blockSize), _lastInBlock(0)
   {
-#ifdef _GMSH_PRE_ALLOCATE_STRATEGY_
-    s_last = 0;
-    s_alloc = _size;
-    allSlots = new MTet4[s_alloc];
-#endif
   }
   ~MTet4Factory()
   {
-#ifdef _GMSH_PRE_ALLOCATE_STRATEGY_
-    delete[] allSlots;
-#endif
+    for(std::size_t i = 0; i < _blocks.size(); i++) delete[] _blocks[i];
+    for(std::size_t i = 0; i < _emptyTets.size(); i++) delete _emptyTets[i];
+  }
+  MTetrahedron *NewTetrahedron(MVertex *v0, MVertex *v1, MVertex *v2,
+                               MVertex *v3)
+  {
+    if(_emptyTets.empty()) return new MTetrahedron(v0, v1, v2, v3);
+    MTetrahedron *t = _emptyTets.back();
+    _emptyTets.pop_back();
+    t->setVertex(0, v0);
+    t->setVertex(1, v1);
+    t->setVertex(2, v2);
+    t->setVertex(3, v3);
+    return t;
   }
   MTet4 *Create(MTetrahedron *t, std::vector<double> &sizes,
                 std::vector<double> &sizesBGM)
   {
-#ifdef _GMSH_PRE_ALLOCATE_STRATEGY_
     MTet4 *t4 = getAnEmptySlot();
-#else
-    MTet4 *t4 = new MTet4;
-#endif
     t4->setup(t, sizes, sizesBGM);
+    t4->setOnWhat(0);
     return t4;
   }
   MTet4 *Create(MTetrahedron *t, std::vector<double> &sizes,
                 std::vector<double> &sizesBGM, double lc1, double lc2)
   {
-#ifdef _GMSH_PRE_ALLOCATE_STRATEGY_
     MTet4 *t4 = getAnEmptySlot();
-#else
-    MTet4 *t4 = new MTet4;
-#endif
     t4->setup(t, sizes, sizesBGM, lc1, lc2);
+    t4->setOnWhat(0);
     return t4;
   }
-
+  // the tet must not be in the heap anymore
   void Free(MTet4 *t)
   {
-    if(t->tet()) delete t->tet();
+    if(t->tet()) _emptyTets.push_back(t->tet());
     t->tet() = 0;
-#ifdef _GMSH_PRE_ALLOCATE_STRATEGY_
-    emptySlots.push(t);
     t->setDeleted(true);
-#else
-    delete t;
-#endif
+    _emptySlots.push_back(t);
+  }
+  void push(MTet4 *t)
+  {
+    allTets.push_back(t);
+    std::push_heap(allTets.begin(), allTets.end(), compareHeap());
   }
-  void changeTetRadius(iterator it, double r)
+  MTet4 *worst() const { return allTets.front(); }
+  void popWorst()
   {
-    MTet4 *t = *it;
-    allTets.erase(it);
+    std::pop_heap(allTets.begin(), allTets.end(), compareHeap());
+    allTets.pop_back();
+  }
+  void changeWorstRadius(double r)
+  {
+    MTet4 *t = worst();
+    popWorst();
     t->forceRadius(r);
-    allTets.insert(t);
+    push(t);
+  }
+  // restore the heap after the tets (or their radius) have been modified
+  // through getAllTets()
+  void makeHeap()
+  {
+    std::make_heap(allTets.begin(), allTets.end(), compareHeap());
+  }
+  // free all the deleted tets
+  void memoryCleanup()
+  {
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < allTets.size(); i++) {
+      if(allTets[i]->isDeleted())
+        Free(allTets[i]);
+      else
+        allTets[n++] = allTets[i];
+    }
+    allTets.resize(n);
+    makeHeap();
   }
   container &getAllTets() { return allTets; }
 };
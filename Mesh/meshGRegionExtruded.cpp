@@ -4,6 +4,7 @@
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <set>
+#include <map>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "GModel.h"
@@ -112,26 +113,40 @@ static void createTet(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
     addTetrahedron(v1, v2, v3, v4, to);
 }
 
+// vertices created in the layers above each interior vertex of the source
+// surface, which can then be retrieved without querying the rtree
+typedef std::map<MVertex *, std::vector<MVertex *> > extrudedColumns;
+
 static int getExtrudedVertices(MElement *ele, ExtrudeParams *ep, int j, int k,
-                               MVertexRTree &pos, std::vector<MVertex *> &verts)
+                               MVertexRTree &pos, std::vector<MVertex *> &verts,
+                               const extrudedColumns *columns = 0)
 {
-  double x[8], y[8], z[8];
+  int l = k;
+  for(int jj = 0; jj < j; jj++) l += ep->mesh.NbElmLayer[jj];
   int n = ele->getNumVertices();
-  for(int p = 0; p < n; p++) {
-    MVertex *v = ele->getVertex(p);
-    x[p] = x[p + n] = v->x();
-    y[p] = y[p + n] = v->y();
-    z[p] = z[p + n] = v->z();
-  }
-  for(int p = 0; p < n; p++) {
-    ep->Extrude(j, k, x[p], y[p], z[p]);
-    ep->Extrude(j, k + 1, x[p + n], y[p + n], z[p + n]);
-  }
   for(int p = 0; p < 2 * n; p++) {
-    MVertex *tmp = pos.find(x[p], y[p], z[p]);
+    MVertex *v = ele->getVertex(p % n);
+    int kk = (p < n) ? k : k + 1;
+    if(columns) {
+      extrudedColumns::const_iterator it = columns->find(v);
+      int ll = (p < n) ? l : l + 1;
+      if(it != columns->end()) {
+        if(ll == 0) {
+          verts.push_back(v);
+          continue;
+        }
+        if(ll - 1 < (int)it->second.size()) {
+          verts.push_back(it->second[ll - 1]);
+          continue;
+        }
+      }
+    }
+    double x = v->x(), y = v->y(), z = v->z();
+    ep->Extrude(j, kk, x, y, z);
+    MVertex *tmp = pos.find(x, y, z);
     if(!tmp)
-      Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g)", x[p],
-                 y[p], z[p]);
+      Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g)", x, y,
+                 z);
     else
       verts.push_back(tmp);
   }
@@ -167,8 +182,10 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
   mesh_vertices.insert(mesh_vertices.end(), seam.begin(), seam.end());
 
   // create extruded vertices
+  extrudedColumns columns;
   for(std::size_t i = 0; i < mesh_vertices.size(); i++) {
     MVertex *v = mesh_vertices[i];
+    std::vector<MVertex *> &column = columns[v];
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         double x = v->x(), y = v->y(), z = v->z();
@@ -176,7 +193,8 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
         if(j != ep->mesh.NbLayer - 1 || k != ep->mesh.NbElmLayer[j] - 1) {
           MVertex *newv = new MVertex(x, y, z, to);
           to->mesh_vertices.push_back(newv);
-          pos.insert(newv);
+          MVertex *old = pos.insert(newv);
+          column.push_back(old ? old : newv);
         }
       }
     }
@@ -189,14 +207,14 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
   }
 #endif
 
-  // create elements (note that it would be faster to access the *interior*
-  // nodes by direct indexing, but it's just simpler to query everything by
-  // position)
+  // create elements (the interior nodes are accessed by direct indexing, the
+  // other ones are queried by position)
   for(std::size_t i = 0; i < from->triangles.size(); i++) {
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> verts;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, verts) == 6) {
+        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, verts,
+                               &columns) == 6) {
           createPriPyrTet(verts, to, from->triangles[i]);
         }
       }
@@ -211,8 +229,8 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
       for(int j = 0; j < ep->mesh.NbLayer; j++) {
         for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
           std::vector<MVertex *> verts;
-          if(getExtrudedVertices(from->quadrangles[i], ep, j, k, pos, verts) ==
-             8)
+          if(getExtrudedVertices(from->quadrangles[i], ep, j, k, pos, verts,
+                                 &columns) == 8)
             createHexPri(verts, to, from->quadrangles[i]);
         }
       }
@@ -275,9 +293,16 @@ void meshGRegionExtruded::operator()(GRegion *gr)
   // carve holes if any (only do it now if the mesh is final, i.e., if
   // the mesh is recombined)
   if(ep->mesh.Holes.size() && ep->mesh.Recombine) {
-    std::map<int, std::pair<double, std::vector<int> > >::iterator it;
-    for(it = ep->mesh.Holes.begin(); it != ep->mesh.Holes.end(); it++)
-      carveHole(gr, it->first, it->second.first, it->second.second);
+    // the surface of the hole can be shared by several volumes (named, since
+    // carveHole() creates elements and vertices)
+#if defined(_OPENMP)
+#pragma omp critical(carveHole)
+#endif
+    {
+      std::map<int, std::pair<double, std::vector<int> > >::iterator it;
+      for(it = ep->mesh.Holes.begin(); it != ep->mesh.Holes.end(); it++)
+        carveHole(gr, it->first, it->second.first, it->second.second);
+    }
   }
 }
 
@@ -34,6 +34,9 @@ bool collapseVertex(std::vector<MTet4 *> &newTets, MTet4 *t, int iVertex,
                     int iTarget, const qmTetrahedron::Measures &cr,
                     const localMeshModAction = GMSH_DOIT, double *result = 0);
 
+void buildVertexCavity_recur(MTet4 *t, MVertex *v,
+                             std::vector<MTet4 *> &cavity);
+
 bool edgeSplit(std::vector<MTet4 *> &newTets, MTet4 *tet, MVertex *newVertex,
                int iLocalEdge, const qmTetrahedron::Measures &cr);
 
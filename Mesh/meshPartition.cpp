@@ -102,9 +102,6 @@ private:
   unsigned int *_xadj, *_adjncy;
   // Elements corresponding to each graph elements in eptr
   MElement **_element;
-  // Vertices corresponding to each graph vertices in eptr
-  int *_vertex;
-  int _vertexSize;
   // The width associated to each elements of eptr
   unsigned int *_vwgt;
   // The partitions output from the partitioner
@@ -113,8 +110,7 @@ private:
 public:
   Graph(GModel *const model)
     : _model(model), _nparts(0), _ne(0), _nn(0), _dim(0), _eind(0), _eptr(0),
-      _xadj(0), _adjncy(0), _element(0), _vertex(0), _vertexSize(0), _vwgt(0),
-      _partition(0)
+      _xadj(0), _adjncy(0), _element(0), _vwgt(0), _partition(0)
   {
   }
   void fillDefaultWeights()
@@ -179,7 +175,6 @@ public:
   unsigned int adjncy(unsigned int i) const { return _adjncy[i]; };
   unsigned int *adjncy() const { return _adjncy; };
   MElement *element(unsigned int i) const { return _element[i]; };
-  int vertex(unsigned int i) const { return _vertex[i]; };
   unsigned int *vwgt() const { return _vwgt; };
   unsigned int partition(unsigned int i) const { return _partition[i]; };
   unsigned int *partition() const { return _partition; };
@@ -207,14 +202,7 @@ public:
     for(unsigned int i = 0; i < size; i++) _element[i] = 0;
   }
   void element(unsigned int i, MElement *element) { _element[i] = element; };
-  void vertexResize(unsigned int size)
-  {
-    _vertexSize = size;
-    _vertex = new int[size];
-    for(unsigned int i = 0; i < size; i++) _vertex[i] = -1;
-  }
   void adjncy(unsigned int i, unsigned int adjncy) { _adjncy[i] = adjncy; };
-  void vertex(unsigned int i, int vertex) { _vertex[i] = vertex; };
   void vwgt(unsigned int *vwgt) { _vwgt = vwgt; };
   void partition(unsigned int *partition) { _partition = partition; };
   void clear()
@@ -239,11 +227,6 @@ public:
       delete[] _element;
       _element = 0;
     }
-    if(_vertex) {
-      delete[] _vertex;
-      _vertex = 0;
-    }
-    _vertexSize = 0;
     if(_vwgt) {
       delete[] _vwgt;
       _vwgt = 0;
@@ -264,13 +247,6 @@ public:
       _adjncy = 0;
     }
   }
-  void eraseVertex()
-  {
-    if(_vertex) {
-      for(int i = 0; i < _vertexSize; i++) _vertex[i] = -1;
-    }
-  }
-
   std::vector<std::set<MElement *> > getBoundaryElements(int size = 0)
   {
     std::vector<std::set<MElement *> > elements((size ? size : _nparts),
@@ -343,284 +319,302 @@ public:
     }
   }
 
+  // Find the neighbors of element i in the dual graph, i.e. the elements
+  // sharing enough nodes with it (or at least one if connectedAll is set). The
+  // neighbors are written in adjncy (if not null) in increasing order. Returns
+  // the number of neighbors. The candidates buffer is used as scratch space.
+  unsigned int findNeighbors(unsigned int i, const unsigned int *nptr,
+                             const unsigned int *nind, bool connectedAll,
+                             std::vector<unsigned int> &candidates,
+                             unsigned int *adjncy) const
+  {
+    candidates.clear();
+    for(unsigned int j = _eptr[i]; j < _eptr[i + 1]; j++) {
+      for(unsigned int k = nptr[_eind[j]]; k < nptr[_eind[j] + 1]; k++) {
+        if(nind[k] != i) candidates.push_back(nind[k]);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    unsigned int numNeighbors = 0;
+    std::size_t j = 0;
+    while(j < candidates.size()) {
+      // the number of occurrences of a candidate is the number of shared nodes
+      std::size_t k = j + 1;
+      while(k < candidates.size() && candidates[k] == candidates[j]) k++;
+      if((int)(k - j) >=
+         (connectedAll ?
+            1 :
+            _element[i]->numCommonNodesInDualGraph(_element[candidates[j]]))) {
+        if(adjncy) adjncy[numNeighbors] = candidates[j];
+        numNeighbors++;
+      }
+      j = k;
+    }
+    return numNeighbors;
+  }
+
   void createDualGraph(bool connectedAll)
   {
-    int *nptr = new int[_nn + 1];
+    // Node-to-element map
+    unsigned int *nptr = new unsigned int[_nn + 1];
     for(unsigned int i = 0; i < _nn + 1; i++) nptr[i] = 0;
-    int *nind = new int[_eptr[_ne]];
-    for(unsigned int i = 0; i < _eptr[_ne]; i++) nind[i] = 0;
+    unsigned int *nind = new unsigned int[_eptr[_ne]];
 
     for(unsigned int i = 0; i < _ne; i++) {
       for(unsigned int j = _eptr[i]; j < _eptr[i + 1]; j++) {
-        nptr[_eind[j]]++;
+        nptr[_eind[j] + 1]++;
       }
     }
-
-    for(unsigned int i = 1; i < _nn; i++) nptr[i] += nptr[i - 1];
-    for(unsigned int i = _nn; i > 0; i--) nptr[i] = nptr[i - 1];
-    nptr[0] = 0;
-
+    for(unsigned int i = 1; i < _nn + 1; i++) nptr[i] += nptr[i - 1];
     for(unsigned int i = 0; i < _ne; i++) {
       for(unsigned int j = _eptr[i]; j < _eptr[i + 1]; j++) {
         nind[nptr[_eind[j]]++] = i;
       }
     }
-
     for(unsigned int i = _nn; i > 0; i--) nptr[i] = nptr[i - 1];
     nptr[0] = 0;
 
+    // Dual graph: count the neighbors of each element, then fill the adjacency
+    // lists; both loops run in parallel over the elements
     _xadj = new unsigned int[_ne + 1];
-    for(unsigned int i = 0; i < _ne + 1; i++) _xadj[i] = 0;
-    int *nbrs = new int[_ne];
-    int *marker = new int[_ne];
-    for(unsigned int i = 0; i < _ne; i++) {
-      nbrs[i] = 0;
-      marker[i] = 0;
-    }
-
-    for(unsigned int i = 0; i < _ne; i++) {
-      unsigned int l = 0;
-      for(unsigned int j = _eptr[i]; j < _eptr[i + 1]; j++) {
-        for(int k = nptr[_eind[j]]; k < nptr[_eind[j] + 1]; k++) {
-          if(nind[k] != (int)i) {
-            if(marker[nind[k]] == 0) nbrs[l++] = nind[k];
-            marker[nind[k]]++;
-          }
-        }
-      }
-
-      unsigned int nbrsNeighbors = 0;
-      for(unsigned int j = 0; j < l; j++) {
-        if(marker[nbrs[j]] >=
-           (connectedAll ?
-              1 :
-              _element[i]->numCommonNodesInDualGraph(_element[nbrs[j]])))
-          nbrsNeighbors++;
-        marker[nbrs[j]] = 0;
-        nbrs[j] = 0;
+    _xadj[0] = 0;
+    const int ne = _ne;
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+    {
+      std::vector<unsigned int> candidates;
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic, 1024)
+#endif
+      for(int i = 0; i < ne; i++) {
+        _xadj[i + 1] =
+          findNeighbors(i, nptr, nind, connectedAll, candidates, 0);
       }
-
-      _xadj[i] = nbrsNeighbors;
     }
 
-    for(unsigned int i = 1; i < _ne; i++) _xadj[i] = _xadj[i] + _xadj[i - 1];
-    for(unsigned int i = _ne; i > 0; i--) _xadj[i] = _xadj[i - 1];
-    _xadj[0] = 0;
-
+    for(unsigned int i = 1; i < _ne + 1; i++) _xadj[i] += _xadj[i - 1];
     _adjncy = new unsigned int[_xadj[_ne]];
-    for(unsigned int i = 0; i < _xadj[_ne]; i++) _adjncy[i] = 0;
-
-    for(unsigned int i = 0; i < _ne; i++) {
-      unsigned int l = 0;
-      for(unsigned int j = _eptr[i]; j < _eptr[i + 1]; j++) {
-        for(int k = nptr[_eind[j]]; k < nptr[_eind[j] + 1]; k++) {
-          if(nind[k] != (int)i) {
-            if(marker[nind[k]] == 0) nbrs[l++] = nind[k];
-            marker[nind[k]]++;
-          }
-        }
-      }
 
-      for(unsigned int j = 0; j < l; j++) {
-        if(marker[nbrs[j]] >=
-           (connectedAll ?
-              1 :
-              _element[i]->numCommonNodesInDualGraph(_element[nbrs[j]]))) {
-          _adjncy[_xadj[i]] = nbrs[j];
-          _xadj[i] = _xadj[i] + 1;
-        }
-        marker[nbrs[j]] = 0;
-        nbrs[j] = 0;
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+    {
+      std::vector<unsigned int> candidates;
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic, 1024)
+#endif
+      for(int i = 0; i < ne; i++) {
+        findNeighbors(i, nptr, nind, connectedAll, candidates,
+                      &_adjncy[_xadj[i]]);
       }
     }
-    delete[] nbrs;
-    delete[] marker;
-
-    for(unsigned int i = _ne; i > 0; i--) _xadj[i] = _xadj[i - 1];
-    _xadj[0] = 0;
 
     delete[] nptr;
     delete[] nind;
   }
 };
 
-template <class ITERATOR>
-static void fillElementsToNodesMap(Graph &graph, const GEntity *const entity,
-                                   int &eptrIndex, int &eindIndex,
-                                   int &numVertex, ITERATOR it_beg,
-                                   ITERATOR it_end)
+// Operations applied to the element vectors of an entity by
+// applyToElements(). The order in which the vectors are visited is the order of
+// the elements in the graph (see CreatePartitionTopology).
+template <class OPERATION>
+static void applyToElements(GEntity *const entity, OPERATION &op)
 {
-  for(ITERATOR it = it_beg; it != it_end; ++it) {
-    const int numVertices = (*it)->getNumPrimaryVertices();
-    graph.element(eptrIndex++, *it);
-    graph.eptr(eptrIndex, graph.eptr(eptrIndex - 1) + numVertices);
-    for(int i = 0; i < numVertices; i++) {
-      if(graph.vertex((*it)->getVertex(i)->getNum() - 1) == -1) {
-        graph.vertex((*it)->getVertex(i)->getNum() - 1, numVertex++);
-      }
-      graph.eind(eindIndex, graph.vertex((*it)->getVertex(i)->getNum() - 1));
-      eindIndex++;
-    }
+  switch(entity->dim()) {
+  case 3: {
+    GRegion *r = static_cast<GRegion *>(entity);
+    op(r->tetrahedra);
+    op(r->hexahedra);
+    op(r->prisms);
+    op(r->pyramids);
+    op(r->trihedra);
+  } break;
+  case 2: {
+    GFace *f = static_cast<GFace *>(entity);
+    op(f->triangles);
+    op(f->quadrangles);
+  } break;
+  case 1: op(static_cast<GEdge *>(entity)->lines); break;
+  case 0: op(static_cast<GVertex *>(entity)->points); break;
+  default: break;
   }
 }
 
-static int getSizeOfEind(const GModel *const model)
-{
-  int size = 0;
-  // Loop over regions
-  for(GModel::const_riter it = model->firstRegion(); it != model->lastRegion();
-      ++it) {
-    size += 4 * (*it)->tetrahedra.size();
-    size += 8 * (*it)->hexahedra.size();
-    size += 6 * (*it)->prisms.size();
-    size += 5 * (*it)->pyramids.size();
-    size += 4 * (*it)->trihedra.size();
+// Count the elements and the size of the element-to-node map
+class countElements {
+public:
+  unsigned int ne, eindSize;
+  countElements() : ne(0), eindSize(0) {}
+  template <class T> void operator()(const std::vector<T *> &elements)
+  {
+    ne += elements.size();
+    for(std::size_t i = 0; i < elements.size(); i++)
+      eindSize += elements[i]->getNumPrimaryVertices();
   }
+};
 
-  // Loop over faces
-  for(GModel::const_fiter it = model->firstFace(); it != model->lastFace();
-      ++it) {
-    size += 3 * (*it)->triangles.size();
-    size += 4 * (*it)->quadrangles.size();
+// Tag the nodes of the elements as not numbered
+class resetNodes {
+public:
+  template <class T> void operator()(const std::vector<T *> &elements)
+  {
+    for(std::size_t i = 0; i < elements.size(); i++)
+      for(int j = 0; j < elements[i]->getNumPrimaryVertices(); j++)
+        elements[i]->getVertex(j)->setIndex(-1);
   }
+};
 
-  // Loop over edges
-  for(GModel::const_eiter it = model->firstEdge(); it != model->lastEdge();
-      ++it) {
-    size += 2 * (*it)->lines.size();
+// Number the nodes of the elements contiguously, in the order in which they are
+// encountered
+class numberNodes {
+public:
+  int nn;
+  numberNodes() : nn(0) {}
+  template <class T> void operator()(const std::vector<T *> &elements)
+  {
+    for(std::size_t i = 0; i < elements.size(); i++) {
+      for(int j = 0; j < elements[i]->getNumPrimaryVertices(); j++) {
+        MVertex *v = elements[i]->getVertex(j);
+        if(v->getIndex() < 0) v->setIndex(nn++);
+      }
+    }
   }
+};
 
-  // Loop over vertices
-  for(GModel::const_viter it = model->firstVertex(); it != model->lastVertex();
-      ++it) {
-    size += 1 * (*it)->points.size();
-  }
+// Fill the element-to-node map, starting at the given positions in eptr and
+// eind
+class fillElementsToNodesMap {
+private:
+  Graph &_graph;
+  unsigned int _eptrIndex, _eindIndex;
 
-  return size;
-}
+public:
+  fillElementsToNodesMap(Graph &graph, unsigned int eptrIndex,
+                         unsigned int eindIndex)
+    : _graph(graph), _eptrIndex(eptrIndex), _eindIndex(eindIndex)
+  {
+  }
+  template <class T> void operator()(const std::vector<T *> &elements)
+  {
+    for(std::size_t i = 0; i < elements.size(); i++) {
+      _graph.element(_eptrIndex++, elements[i]);
+      for(int j = 0; j < elements[i]->getNumPrimaryVertices(); j++)
+        _graph.eind(_eindIndex++, elements[i]->getVertex(j)->getIndex());
+      _graph.eptr(_eptrIndex, _eindIndex);
+    }
+  }
+};
 
-// Creates a mesh data structure used by Metis routines. Returns: 0 = success, 1
-// = no elements found, 2 = error.
+// Creates a mesh data structure used by Metis routines, with the elements of
+// all the entities (if selectDim < 0) or of the entities of dimension
+// selectDim. Nodes are numbered contiguously using the MVertex index, so that
+// the memory footprint does not depend on the node tags; the element-to-node
+// map is filled in parallel, one entity per thread. Returns: 0 = success, 1 =
+// no elements found, 2 = error.
 static int MakeGraph(GModel *const model, Graph &graph, int selectDim)
 {
-  int eindSize = 0;
-  if(selectDim < 0) {
-    graph.ne(model->getNumMeshElements());
-    graph.nn(model->getNumMeshVertices());
-    graph.dim(model->getMeshDim());
-    graph.elementResize(graph.ne());
-    graph.vertexResize(model->getMaxVertexNumber());
-    graph.eptrResize(graph.ne() + 1);
-    graph.eptr(0, 0);
-    eindSize = getSizeOfEind(model);
-    graph.eindResize(eindSize);
+  // Entities in the order regions, faces, edges, vertices
+  std::vector<GEntity *> all;
+  all.insert(all.end(), model->firstRegion(), model->lastRegion());
+  all.insert(all.end(), model->firstFace(), model->lastFace());
+  all.insert(all.end(), model->firstEdge(), model->lastEdge());
+  all.insert(all.end(), model->firstVertex(), model->lastVertex());
+  std::vector<GEntity *> entities;
+  for(std::size_t i = 0; i < all.size(); i++) {
+    if(selectDim < 0 || all[i]->dim() == selectDim) entities.push_back(all[i]);
   }
-  else {
-    GModel *tmp = new GModel();
-    std::vector<GEntity *> entities;
-    model->getEntities(entities);
-
-    std::set<MVertex *> vertices;
-    for(std::size_t i = 0; i < entities.size(); i++) {
-      if(entities[i]->dim() == selectDim) {
-        switch(entities[i]->dim()) {
-        case 3: tmp->add(static_cast<GRegion *>(entities[i])); break;
-        case 2: tmp->add(static_cast<GFace *>(entities[i])); break;
-        case 1: tmp->add(static_cast<GEdge *>(entities[i])); break;
-        case 0: tmp->add(static_cast<GVertex *>(entities[i])); break;
-        default: break;
-        }
-        for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
-          for(std::size_t k = 0;
-              k < entities[i]->getMeshElement(j)->getNumVertices(); k++) {
-            vertices.insert(entities[i]->getMeshElement(j)->getVertex(k));
-          }
-        }
-      }
-    }
 
-    graph.ne(tmp->getNumMeshElements());
-    graph.nn(vertices.size());
-    graph.dim(tmp->getMeshDim());
-    graph.elementResize(graph.ne());
-    graph.vertexResize(model->getMaxVertexNumber());
-    graph.eptrResize(graph.ne() + 1);
-    graph.eptr(0, 0);
-    eindSize = getSizeOfEind(tmp);
-    graph.eindResize(eindSize);
+  // Position of the elements of each entity in eptr and eind
+  const int numEntities = entities.size();
+  std::vector<countElements> count(numEntities);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < numEntities; i++) applyToElements(entities[i], count[i]);
 
-    tmp->remove();
-    delete tmp;
+  std::vector<unsigned int> eptrOffset(numEntities + 1, 0);
+  std::vector<unsigned int> eindOffset(numEntities + 1, 0);
+  unsigned int dim = 0;
+  for(int i = 0; i < numEntities; i++) {
+    eptrOffset[i + 1] = eptrOffset[i] + count[i].ne;
+    eindOffset[i + 1] = eindOffset[i] + count[i].eindSize;
+    if(count[i].ne && entities[i]->dim() > (int)dim) dim = entities[i]->dim();
   }
 
-  int eptrIndex = 0;
-  int eindIndex = 0;
-  int numVertex = 0;
-
-  if(graph.ne() == 0) {
+  if(eptrOffset[numEntities] == 0) {
     Msg::Error("No mesh elements were found");
     return 1;
   }
-  if(graph.dim() == 0) {
+  if(dim == 0) {
     Msg::Error("Cannot partition a point");
     return 1;
   }
 
-  // Loop over regions
-  if(selectDim < 0 || selectDim == 3) {
-    for(GModel::const_riter it = model->firstRegion();
-        it != model->lastRegion(); ++it) {
-      const GRegion *r = *it;
-      fillElementsToNodesMap(graph, r, eptrIndex, eindIndex, numVertex,
-                             r->tetrahedra.begin(), r->tetrahedra.end());
-      fillElementsToNodesMap(graph, r, eptrIndex, eindIndex, numVertex,
-                             r->hexahedra.begin(), r->hexahedra.end());
-      fillElementsToNodesMap(graph, r, eptrIndex, eindIndex, numVertex,
-                             r->prisms.begin(), r->prisms.end());
-      fillElementsToNodesMap(graph, r, eptrIndex, eindIndex, numVertex,
-                             r->pyramids.begin(), r->pyramids.end());
-      fillElementsToNodesMap(graph, r, eptrIndex, eindIndex, numVertex,
-                             r->trihedra.begin(), r->trihedra.end());
-    }
-  }
-
-  // Loop over faces
-  if(selectDim < 0 || selectDim == 2) {
-    for(GModel::const_fiter it = model->firstFace(); it != model->lastFace();
-        ++it) {
-      const GFace *f = *it;
+  graph.ne(eptrOffset[numEntities]);
+  graph.dim(dim);
+  graph.elementResize(graph.ne());
+  graph.eptrResize(graph.ne() + 1);
+  graph.eindResize(eindOffset[numEntities]);
 
-      fillElementsToNodesMap(graph, f, eptrIndex, eindIndex, numVertex,
-                             f->triangles.begin(), f->triangles.end());
-      fillElementsToNodesMap(graph, f, eptrIndex, eindIndex, numVertex,
-                             f->quadrangles.begin(), f->quadrangles.end());
+  if(selectDim < 0) {
+    // All the elements are used: number the nodes entity by entity
+    std::vector<int> nodeOffset(all.size() + 1, 0);
+    for(std::size_t i = 0; i < all.size(); i++)
+      nodeOffset[i + 1] = nodeOffset[i] + all[i]->mesh_vertices.size();
+    const int numAll = all.size();
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int i = 0; i < numAll; i++) {
+      for(std::size_t j = 0; j < all[i]->mesh_vertices.size(); j++)
+        all[i]->mesh_vertices[j]->setIndex(nodeOffset[i] + j);
     }
+    graph.nn(nodeOffset[all.size()]);
   }
-
-  // Loop over edges
-  if(selectDim < 0 || selectDim == 1) {
-    for(GModel::const_eiter it = model->firstEdge(); it != model->lastEdge();
-        ++it) {
-      const GEdge *e = *it;
-      fillElementsToNodesMap(graph, e, eptrIndex, eindIndex, numVertex,
-                             e->lines.begin(), e->lines.end());
-    }
+  else {
+    // Only number the nodes of the selected elements
+    resetNodes reset;
+    for(int i = 0; i < numEntities; i++) applyToElements(entities[i], reset);
+    numberNodes number;
+    for(int i = 0; i < numEntities; i++) applyToElements(entities[i], number);
+    graph.nn(number.nn);
   }
 
-  // Loop over vertices
-  if(selectDim < 0 || selectDim == 0) {
-    for(GModel::const_viter it = model->firstVertex();
-        it != model->lastVertex(); ++it) {
-      GVertex *v = *it;
-
-      fillElementsToNodesMap(graph, v, eptrIndex, eindIndex, numVertex,
-                             v->points.begin(), v->points.end());
-    }
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < numEntities; i++) {
+    fillElementsToNodesMap fill(graph, eptrOffset[i], eindOffset[i]);
+    applyToElements(entities[i], fill);
   }
 
   return 0;
 }
 
+// Creates the graph of the elements of a single entity
+static void MakeGraph(GEntity *const entity, Graph &graph)
+{
+  countElements count;
+  applyToElements(entity, count);
+
+  graph.ne(count.ne);
+  graph.dim(entity->dim());
+  graph.elementResize(graph.ne());
+  graph.eptrResize(graph.ne() + 1);
+  graph.eindResize(count.eindSize);
+
+  resetNodes reset;
+  applyToElements(entity, reset);
+  numberNodes number;
+  applyToElements(entity, number);
+  graph.nn(number.nn);
+
+  fillElementsToNodesMap fill(graph, 0, 0);
+  applyToElements(entity, fill);
+}
+
 // Partition a graph created by MakeGraph using Metis library. Returns: 0 =
 // success, 1 = error, 2 = exception thrown.
 static int PartitionGraph(Graph &graph)
@@ -945,37 +939,14 @@ dividedNonConnectedEntities(GModel *const model, int dim,
 
   // Loop over edges
   if(dim < 0 || dim == 1) {
-    // We build a graph
-    Graph graph(model);
-    graph.ne(model->getNumMeshElements(1));
-    graph.nn(model->getNumMeshVertices(1));
-    graph.dim(model->getMeshDim());
-    graph.elementResize(graph.ne());
-    graph.vertexResize(model->getMaxVertexNumber());
-    graph.eptrResize(graph.ne() + 1);
-    graph.eptr(0, 0);
-    const int eindSize = getSizeOfEind(model);
-    graph.eindResize(eindSize);
-
     int elementaryNumber = model->getMaxElementaryNumber(1);
 
     for(GModel::const_eiter it = edges.begin(); it != edges.end(); ++it) {
       if((*it)->geomType() == GEntity::PartitionCurve) {
         partitionEdge *edge = static_cast<partitionEdge *>(*it);
 
-        graph.ne(edge->getNumMeshElements());
-        graph.dim(1);
-        graph.eptr(0, 0);
-        graph.clearDualGraph();
-        graph.eraseVertex();
-
-        int eptrIndex = 0;
-        int eindIndex = 0;
-        int numVertex = 0;
-
-        fillElementsToNodesMap(graph, edge, eptrIndex, eindIndex, numVertex,
-                               edge->lines.begin(), edge->lines.end());
-        graph.nn(numVertex);
+        Graph graph(model);
+        MakeGraph(edge, graph);
         graph.createDualGraph(false);
 
         // if a graph contains more than ((n-1)*(n-2))/2 edges
@@ -1041,40 +1012,14 @@ dividedNonConnectedEntities(GModel *const model, int dim,
 
   // Loop over faces
   if(dim < 0 || dim == 2) {
-    // We build a graph
-    Graph graph(model);
-    graph.ne(model->getNumMeshElements(2));
-    graph.nn(model->getNumMeshVertices(2));
-    graph.dim(model->getMeshDim());
-    graph.elementResize(graph.ne());
-    graph.vertexResize(model->getMaxVertexNumber());
-    graph.eptrResize(graph.ne() + 1);
-    graph.eptr(0, 0);
-    const int eindSize = getSizeOfEind(model);
-    graph.eindResize(eindSize);
-
     int elementaryNumber = model->getMaxElementaryNumber(2);
 
     for(GModel::const_fiter it = faces.begin(); it != faces.end(); ++it) {
       if((*it)->geomType() == GEntity::PartitionSurface) {
         partitionFace *face = static_cast<partitionFace *>(*it);
 
-        graph.ne(face->getNumMeshElements());
-        graph.dim(2);
-        graph.eptr(0, 0);
-        graph.clearDualGraph();
-        graph.eraseVertex();
-
-        int eptrIndex = 0;
-        int eindIndex = 0;
-        int numVertex = 0;
-
-        fillElementsToNodesMap(graph, face, eptrIndex, eindIndex, numVertex,
-                               face->triangles.begin(), face->triangles.end());
-        fillElementsToNodesMap(graph, face, eptrIndex, eindIndex, numVertex,
-                               face->quadrangles.begin(),
-                               face->quadrangles.end());
-        graph.nn(numVertex);
+        Graph graph(model);
+        MakeGraph(face, graph);
         graph.createDualGraph(false);
 
         // if a graph contains more than ((n-1)*(n-2))/2 edges
@@ -1138,49 +1083,14 @@ dividedNonConnectedEntities(GModel *const model, int dim,
 
   // Loop over regions
   if(dim < 0 || dim == 3) {
-    // We build a graph
-    Graph graph(model);
-    graph.ne(model->getNumMeshElements(3));
-    graph.nn(model->getNumMeshVertices(3));
-    graph.dim(model->getMeshDim());
-    graph.elementResize(graph.ne());
-    graph.vertexResize(model->getMaxVertexNumber());
-    graph.eptrResize(graph.ne() + 1);
-    graph.eptr(0, 0);
-    const int eindSize = getSizeOfEind(model);
-    graph.eindResize(eindSize);
-
     int elementaryNumber = model->getMaxElementaryNumber(3);
 
     for(GModel::const_riter it = regions.begin(); it != regions.end(); ++it) {
       if((*it)->geomType() == GEntity::PartitionVolume) {
         partitionRegion *region = static_cast<partitionRegion *>(*it);
 
-        graph.ne(region->getNumMeshElements());
-        graph.dim(3);
-        graph.eptr(0, 0);
-        graph.clearDualGraph();
-        graph.eraseVertex();
-
-        int eptrIndex = 0;
-        int eindIndex = 0;
-        int numVertex = 0;
-
-        fillElementsToNodesMap(graph, region, eptrIndex, eindIndex, numVertex,
-                               region->tetrahedra.begin(),
-                               region->tetrahedra.end());
-        fillElementsToNodesMap(graph, region, eptrIndex, eindIndex, numVertex,
-                               region->hexahedra.begin(),
-                               region->hexahedra.end());
-        fillElementsToNodesMap(graph, region, eptrIndex, eindIndex, numVertex,
-                               region->prisms.begin(), region->prisms.end());
-        fillElementsToNodesMap(graph, region, eptrIndex, eindIndex, numVertex,
-                               region->pyramids.begin(),
-                               region->pyramids.end());
-        fillElementsToNodesMap(graph, region, eptrIndex, eindIndex, numVertex,
-                               region->trihedra.begin(),
-                               region->trihedra.end());
-        graph.nn(numVertex);
+        Graph graph(model);
+        MakeGraph(region, graph);
         graph.createDualGraph(false);
 
         // if a graph contains more than ((n-1)*(n-2))/2 edges
@@ -2555,8 +2465,7 @@ int PartitionUsingThisSplit(GModel *const model, unsigned int npart,
   AssignMeshVertices(model);
 
   if(CTX::instance()->mesh.partitionCreateGhostCells) {
-    graph.clearDualGraph();
-    graph.createDualGraph(false);
+    // the dual graph created above is still valid
     graph.assignGhostCells();
   }
 
@@ -4,6 +4,7 @@
 // bugs and problems to the public mailing list <gmsh@geuz.org>.
 
 #include <limits>
+#include <map>
 #include "qualityMeasuresJacobian.h"
 #include "MElement.h"
 #include "BasisFactory.h"
@@ -166,6 +167,27 @@ static inline void computeIGE_(const fullVector<double> &det,
 
 namespace jacobianBasedQuality {
 
+  // bounds of the Jacobian determinant from its Bezier coefficients,
+  // subdividing the domain until they are sharp enough
+  static void _minMaxFromBezier(fullVector<double> &coeffBez,
+                                const bezierBasis *bfs, double &min,
+                                double &max)
+  {
+    std::vector<_CoeffData *> domains;
+    domains.push_back(new _CoeffDataJac(coeffBez, bfs, 0));
+
+    _subdivideDomains(domains);
+
+    min = domains[0]->minB();
+    max = domains[0]->maxB();
+    delete domains[0];
+    for(std::size_t i = 1; i < domains.size(); ++i) {
+      min = std::min(min, domains[i]->minB());
+      max = std::max(max, domains[i]->maxB());
+      delete domains[i];
+    }
+  }
+
   void minMaxJacobianDeterminant(MElement *el, double &min, double &max,
                                  const fullMatrix<double> *normals)
   {
@@ -187,18 +209,78 @@ namespace jacobianBasedQuality {
     jfs->getSignedJacobian(nodesXYZ, coeffLag, normals);
     jfs->lag2Bez(coeffLag, coeffBez);
 
-    std::vector<_CoeffData *> domains;
-    domains.push_back(new _CoeffDataJac(coeffBez, jfs->getBezier(), 0));
+    _minMaxFromBezier(coeffBez, jfs->getBezier(), min, max);
+  }
 
-    _subdivideDomains(domains);
+  void minMaxJacobianDeterminant(const std::vector<MElement *> &el,
+                                 std::vector<double> &min,
+                                 std::vector<double> &max,
+                                 const fullMatrix<double> *normals)
+  {
+    min.assign(el.size(), 99);
+    max.assign(el.size(), -99);
+
+    // group the elements sharing the same Jacobian basis (the bases are
+    // created here, so that they are only read in the parallel loop)
+    std::map<std::pair<const JacobianBasis *, int>, std::vector<int> > groups;
+    for(std::size_t i = 0; i < el.size(); i++) {
+      const JacobianBasis *jfs = el[i]->getJacobianFuncSpace();
+      if(!jfs) {
+        Msg::Error(
+          "Jacobian function space not implemented for type of element %d",
+          el[i]->getTypeForMSH());
+        continue;
+      }
+      jfs->getBezier();
+      groups[std::make_pair(jfs, (int)el[i]->getNumVertices())].push_back(i);
+    }
 
-    min = domains[0]->minB();
-    max = domains[0]->maxB();
-    delete domains[0];
-    for(std::size_t i = 1; i < domains.size(); ++i) {
-      min = std::min(min, domains[i]->minB());
-      max = std::max(max, domains[i]->maxB());
-      delete domains[i];
+    // split the groups into blocks of elements: the Jacobian determinants and
+    // their Bezier coefficients are computed for a whole block by matrix
+    // products, and only the elements for which the Bezier coefficients do
+    // not give sharp enough bounds are subdivided
+    const int blockSize = 256;
+    std::vector<std::pair<const std::vector<int> *, int> > blocks;
+    std::map<std::pair<const JacobianBasis *, int>,
+             std::vector<int> >::iterator it;
+    for(it = groups.begin(); it != groups.end(); ++it)
+      for(std::size_t i = 0; i < it->second.size(); i += blockSize)
+        blocks.push_back(std::make_pair(&it->second, (int)i));
+
+    const int nBlocks = blocks.size();
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic) if(Msg::GetMaxThreads() > 1 && nBlocks > 1)
+#endif
+    for(int b = 0; b < nBlocks; b++) {
+      const std::vector<int> &group = *blocks[b].first;
+      const int start = blocks[b].second;
+      const int n = std::min(blockSize, (int)group.size() - start);
+      const JacobianBasis *jfs = el[group[start]]->getJacobianFuncSpace();
+      const bezierBasis *bfs = jfs->getBezier();
+      const int numVertices = el[group[start]]->getNumVertices();
+
+      fullMatrix<double> nodesX(numVertices, n), nodesY(numVertices, n),
+        nodesZ(numVertices, n), nodesXYZ(numVertices, 3);
+      for(int j = 0; j < n; j++) {
+        el[group[start + j]]->getNodesCoord(nodesXYZ);
+        for(int i = 0; i < numVertices; i++) {
+          nodesX(i, j) = nodesXYZ(i, 0);
+          nodesY(i, j) = nodesXYZ(i, 1);
+          nodesZ(i, j) = nodesXYZ(i, 2);
+        }
+      }
+
+      fullMatrix<double> coeffLag(jfs->getNumJacNodes(), n);
+      fullMatrix<double> coeffBez(jfs->getNumJacNodes(), n);
+      jfs->getSignedJacobian(nodesX, nodesY, nodesZ, coeffLag, normals);
+      jfs->lag2Bez(coeffLag, coeffBez);
+
+      for(int j = 0; j < n; j++) {
+        fullVector<double> coeff(jfs->getNumJacNodes());
+        for(int i = 0; i < coeff.size(); i++) coeff(i) = coeffBez(i, j);
+        const int k = group[start + j];
+        _minMaxFromBezier(coeff, bfs, min[k], max[k]);
+      }
     }
   }
 
@@ -17,6 +17,12 @@ namespace jacobianBasedQuality {
 
   void minMaxJacobianDeterminant(MElement *el, double &min, double &max,
                                  const fullMatrix<double> *normals = NULL);
+  // same for a set of elements, processed by blocks of elements of the same
+  // type (in parallel if possible)
+  void minMaxJacobianDeterminant(const std::vector<MElement *> &el,
+                                 std::vector<double> &min,
+                                 std::vector<double> &max,
+                                 const fullMatrix<double> *normals = NULL);
   double minIGEMeasure(MElement *el, bool knownValid = false,
                        bool reversedOk = false,
                        const fullMatrix<double> *normals = NULL);
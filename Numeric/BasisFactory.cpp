@@ -20,13 +20,44 @@ std::map<FuncSpaceData, JacobianBasis *> BasisFactory::js;
 std::map<FuncSpaceData, bezierBasis *> BasisFactory::bs;
 std::map<FuncSpaceData, GradientBasis *> BasisFactory::gs;
 
+// The bases are created outside of the critical sections, as their
+// construction can itself query the factory
+
+template <class K, class B> static B *findBasis(std::map<K, B *> &m, const K &k)
+{
+  B *b = 0;
+#if defined(_OPENMP)
+#pragma omp critical(BasisFactory)
+#endif
+  {
+    typename std::map<K, B *>::const_iterator it = m.find(k);
+    if(it != m.end()) b = it->second;
+  }
+  return b;
+}
+
+template <class K, class B>
+static B *insertBasis(std::map<K, B *> &m, const K &k, B *b)
+{
+  B *old = 0;
+#if defined(_OPENMP)
+#pragma omp critical(BasisFactory)
+#endif
+  {
+    std::pair<typename std::map<K, B *>::iterator, bool> inserted =
+      m.insert(std::make_pair(k, b));
+    if(!inserted.second) old = inserted.first->second;
+  }
+  if(!old) return b;
+  delete b; // created concurrently by another thread
+  return old;
+}
+
 const nodalBasis *BasisFactory::getNodalBasis(int tag)
 {
   // If the Basis has already been built, return it.
-  std::map<int, nodalBasis *>::const_iterator it = fs.find(tag);
-  if(it != fs.end()) {
-    return it->second;
-  }
+  nodalBasis *b = findBasis(fs, tag);
+  if(b) return b;
   // Get the parent type to see which kind of basis
   // we want to create
   nodalBasis *F = NULL;
@@ -51,30 +82,17 @@ const nodalBasis *BasisFactory::getNodalBasis(int tag)
     }
   }
 
-  std::pair<std::map<int, nodalBasis *>::const_iterator, bool> inserted;
-
-#if defined(_OPENMP)
-#pragma omp critical
-#endif
-  {
-    inserted = fs.insert(std::make_pair(tag, F));
-
-    if(!inserted.second) delete F;
-  }
-
-  return inserted.first->second;
+  return insertBasis(fs, tag, F);
 }
 
 const JacobianBasis *BasisFactory::getJacobianBasis(FuncSpaceData fsd)
 {
   FuncSpaceData data = fsd.getForNonSerendipitySpace();
 
-  std::map<FuncSpaceData, JacobianBasis *>::const_iterator it = js.find(data);
-  if(it != js.end()) return it->second;
+  JacobianBasis *J = findBasis(js, data);
+  if(J) return J;
 
-  JacobianBasis *J = new JacobianBasis(data);
-  js.insert(std::make_pair(data, J));
-  return J;
+  return insertBasis(js, data, new JacobianBasis(data));
 }
 
 const JacobianBasis *BasisFactory::getJacobianBasis(int tag, int order)
@@ -99,22 +117,18 @@ const JacobianBasis *BasisFactory::getJacobianBasis(int tag)
 
 const CondNumBasis *BasisFactory::getCondNumBasis(int tag, int cnOrder)
 {
-  std::map<int, CondNumBasis *>::const_iterator it = cs.find(tag);
-  if(it != cs.end()) return it->second;
+  CondNumBasis *M = findBasis(cs, tag);
+  if(M) return M;
 
-  CondNumBasis *M = new CondNumBasis(tag, cnOrder);
-  cs.insert(std::make_pair(tag, M));
-  return M;
+  return insertBasis(cs, tag, new CondNumBasis(tag, cnOrder));
 }
 
 const GradientBasis *BasisFactory::getGradientBasis(FuncSpaceData data)
 {
-  std::map<FuncSpaceData, GradientBasis *>::const_iterator it = gs.find(data);
-  if(it != gs.end()) return it->second;
+  GradientBasis *G = findBasis(gs, data);
+  if(G) return G;
 
-  GradientBasis *G = new GradientBasis(data);
-  gs.insert(std::make_pair(data, G));
-  return G;
+  return insertBasis(gs, data, new GradientBasis(data));
 }
 
 const GradientBasis *BasisFactory::getGradientBasis(int tag, int order)
@@ -131,12 +145,10 @@ const bezierBasis *BasisFactory::getBezierBasis(FuncSpaceData fsd)
 {
   FuncSpaceData data = fsd.getForPrimaryElement();
 
-  std::map<FuncSpaceData, bezierBasis *>::const_iterator it = bs.find(data);
-  if(it != bs.end()) return it->second;
+  bezierBasis *B = findBasis(bs, data);
+  if(B) return B;
 
-  bezierBasis *B = new bezierBasis(data);
-  bs.insert(std::make_pair(data, B));
-  return B;
+  return insertBasis(bs, data, new bezierBasis(data));
 }
 
 const bezierBasis *BasisFactory::getBezierBasis(int parentTag, int order)
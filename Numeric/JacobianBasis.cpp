@@ -758,6 +758,66 @@ void JacobianBasis::getSignedIdealJacAndGradientsGeneral(
                                   normals, JDJ);
 }
 
+void JacobianBasis::getSignedJacAndGradientsBlock(
+  const fullMatrix<double> &nodesXYZ, const fullMatrix<double> &normals,
+  fullMatrix<double> &JDJ, bool ideal) const
+{
+  const fullMatrix<double> &gSMatX =
+    ideal ? _gradBasis->gradShapeIdealMatX : _gradBasis->gradShapeMatX;
+  const fullMatrix<double> &gSMatY =
+    ideal ? _gradBasis->gradShapeIdealMatY : _gradBasis->gradShapeMatY;
+  const fullMatrix<double> &gSMatZ =
+    ideal ? _gradBasis->gradShapeIdealMatZ : _gradBasis->gradShapeMatZ;
+  const int numEl = nodesXYZ.size2() / 3;
+  const int numCol = 3 * numMapNodes + 1;
+
+  // derivatives of the mapping for all the elements at once
+  fullMatrix<double> dxyzdX, dxyzdY, dxyzdZ;
+  if(_dim > 0) {
+    dxyzdX.resize(numJacNodes, 3 * numEl);
+    gSMatX.mult(nodesXYZ, dxyzdX);
+  }
+  if(_dim > 1) {
+    dxyzdY.resize(numJacNodes, 3 * numEl);
+    gSMatY.mult(nodesXYZ, dxyzdY);
+  }
+  if(_dim > 2) {
+    dxyzdZ.resize(numJacNodes, 3 * numEl);
+    gSMatZ.mult(nodesXYZ, dxyzdZ);
+  }
+
+  for(int e = 0; e < numEl; e++) {
+    fullMatrix<double> JDJe(JDJ, e * numCol, numCol);
+    const int c = 3 * e;
+    for(int i = 0; i < numJacNodes; i++) {
+      switch(_dim) {
+      case 0:
+        for(int j = 0; j < 3 * numMapNodes; j++) JDJe(i, j) = 0.;
+        JDJe(i, 3 * numMapNodes) = 1.;
+        break;
+      case 1:
+        calcJDJ1D(dxyzdX(i, c), normals(0, c), normals(1, c), dxyzdX(i, c + 1),
+                  normals(0, c + 1), normals(1, c + 1), dxyzdX(i, c + 2),
+                  normals(0, c + 2), normals(1, c + 2), i, numMapNodes, gSMatX,
+                  JDJe);
+        break;
+      case 2:
+        calcJDJ2D(dxyzdX(i, c), dxyzdY(i, c), normals(0, c), dxyzdX(i, c + 1),
+                  dxyzdY(i, c + 1), normals(0, c + 1), dxyzdX(i, c + 2),
+                  dxyzdY(i, c + 2), normals(0, c + 2), i, numMapNodes, gSMatX,
+                  gSMatY, JDJe);
+        break;
+      case 3:
+        calcJDJ3D(dxyzdX(i, c), dxyzdY(i, c), dxyzdZ(i, c), dxyzdX(i, c + 1),
+                  dxyzdY(i, c + 1), dxyzdZ(i, c + 1), dxyzdX(i, c + 2),
+                  dxyzdY(i, c + 2), dxyzdZ(i, c + 2), i, numMapNodes, gSMatX,
+                  gSMatY, gSMatZ, JDJe);
+        break;
+      }
+    }
+  }
+}
+
 void JacobianBasis::getMetricMinAndGradients(
   const fullMatrix<double> &nodesXYZ,
   const fullMatrix<double> &nodesXYZStraight, fullVector<double> &lambdaJ,
@@ -119,6 +119,13 @@ public:
                                     _gradBasis->gradShapeIdealMatZ, nodesXYZ,
                                     normals, JDJ);
   }
+  // same for a block of elements of this type (the nodes and normals of
+  // element e in columns 3e to 3e+2, its Jacobian and gradients in columns
+  // e(3N+1) to e(3N+1)+3N of JDJ, with N = getNumMapNodes())
+  void getSignedJacAndGradientsBlock(const fullMatrix<double> &nodesXYZ,
+                                     const fullMatrix<double> &normals,
+                                     fullMatrix<double> &JDJ,
+                                     bool ideal = false) const;
   void getMetricMinAndGradients(const fullMatrix<double> &nodesXYZ,
                                 const fullMatrix<double> &nodesXYZStraight,
                                 fullVector<double> &lambdaJ,
@@ -3,30 +3,456 @@
 // See the LICENSE.txt file for license information. Please report all
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <map>
+#include <algorithm>
 #include "mathEvaluator.h"
 
-#if defined(HAVE_MATHEX)
+#if !defined(M_PI)
+#define M_PI 3.14159265358979323846
+#endif
+
+#if !defined(M_E)
+#define M_E 2.7182818284590452354
+#endif
+
+// number of points evaluated together by the vectorized evaluator
+static const int blockSize = 64;
+
+// evaluation errors
+enum { ERR_DIVISION = 1, ERR_RANGE = 2 };
+
+// operations (of both the expression graph and the bytecode)
+enum {
+  OP_VAR,
+  OP_CONST,
+  OP_NEG,
+  OP_ADD,
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,
+  OP_MOD,
+  OP_POW,
+  OP_MIN,
+  OP_MAX,
+  OP_RAND,
+  OP_FUNC
+};
+
+static bool isBinary(int op) { return op >= OP_ADD && op <= OP_MAX; }
+
+// one-argument functions, with the same semantics as in MathEx
+
+static double mathAbs(double x) { return std::fabs(x); }
+static double mathDeg(double x) { return x * 180.0 / M_PI; }
+static double mathRad(double x) { return x * M_PI / 180.0; }
+static double mathTrunc(double x) { return (double)(long)x; }
+static double mathRound(double x) { return (double)(long)(x + 0.5); }
+static double mathStep(double x) { return (x < 0) ? 0. : 1.; }
+static double mathSign(double x) { return (x < 0) ? -1. : 1.; }
+static double mathFac(double x)
+{
+  if(x < 0 || x > 170) return 0.; // range error, reported by the caller
+  unsigned int n = (unsigned int)(x + 0.5);
+  double p = 1.;
+  for(; n > 1; n--) p *= n;
+  return p;
+}
+
+struct mathFunction {
+  const char *name;
+  double (*f)(double);
+};
+
+static const mathFunction mathFunctions[] = {
+  {"abs", mathAbs},     {"fabs", mathAbs},   {"acos", acos},
+  {"asin", asin},       {"atan", atan},      {"cos", cos},
+  {"cosh", cosh},       {"deg", mathDeg},    {"exp", exp},
+  {"fac", mathFac},     {"log", log},        {"log10", log10},
+  {"rad", mathRad},     {"round", mathRound}, {"sign", mathSign},
+  {"sin", sin},         {"sinh", sinh},      {"sqrt", sqrt},
+  {"step", mathStep},   {"tan", tan},        {"tanh", tanh},
+#if !defined(WIN32)
+  {"atanh", atanh},
+#endif
+  {"trunc", mathTrunc}, {"floor", floor},    {"ceil", ceil},
+  {0, 0}};
+
+// functions with a variable number of arguments
+enum { USER_RAND, USER_SUM, USER_MAX, USER_MIN, USER_MED };
+static const char *userFunctions[] = {"rand", "sum", "max", "min", "med", 0};
+
+// names are accepted as is or with a capitalized first letter
+static bool matchName(const std::string &name, const char *ref)
+{
+  if(name.empty() || name.size() != strlen(ref)) return false;
+  if(name[0] != ref[0] && name[0] != toupper(ref[0])) return false;
+  return !name.compare(1, std::string::npos, ref + 1);
+}
+
+static double applyOp(int op, int f, double a, double b, int &err)
+{
+  switch(op) {
+  case OP_NEG: return -a;
+  case OP_ADD: return a + b;
+  case OP_SUB: return a - b;
+  case OP_MUL: return a * b;
+  case OP_DIV:
+    if(b == 0.) err |= ERR_DIVISION;
+    return a / b;
+  case OP_MOD: return fmod(a, b);
+  case OP_POW: return pow(a, b);
+  case OP_MIN: return (b < a) ? b : a;
+  case OP_MAX: return (b > a) ? b : a;
+  case OP_FUNC:
+    if(mathFunctions[f].f == mathFac && (a < 0 || a > 170)) err |= ERR_RANGE;
+    return mathFunctions[f].f(a);
+  }
+  return 0.;
+}
+
+// node of the expression graph: operands a and b are node indices (a is the
+// variable index for OP_VAR, b the function index for OP_FUNC)
+struct mathNode {
+  int op, a, b;
+  double value;
+};
+
+struct mathNodeLessThan {
+  bool operator()(const mathNode &n1, const mathNode &n2) const
+  {
+    if(n1.op != n2.op) return n1.op < n2.op;
+    if(n1.a != n2.a) return n1.a < n2.a;
+    if(n1.b != n2.b) return n1.b < n2.b;
+    return memcmp(&n1.value, &n2.value, sizeof(double)) < 0;
+  }
+};
+
+// recursive descent parser building the (shared) expression graph
+class mathParser {
+private:
+  enum tokenType {
+    END,
+    VALUE,
+    VARIABLE,
+    FUNCTION,
+    USERFUNC,
+    PLUS,
+    MINUS,
+    TIMES,
+    DIVIDE,
+    MODULE,
+    POWER,
+    COMMA,
+    OPAREN,
+    CPAREN,
+    INVALID
+  };
+  const std::string &_expr;
+  const std::vector<std::string> &_variables;
+  std::vector<mathNode> &_nodes;
+  std::map<mathNode, int, mathNodeLessThan> &_cse;
+  std::size_t _pos;
+  tokenType _tok;
+  double _value;
+  int _index;
+  std::string _error;
+  bool _getNumber();
+  void _nextToken();
+  bool _fail(const std::string &where, const std::string &what);
+  int _node(int op, int a = -1, int b = -1, double value = 0.);
+  bool _parseSum(int &n);
+  bool _parseProduct(int &n);
+  bool _parsePower(int &n);
+  bool _parseUnary(int &n);
+  bool _parseAtom(int &n);
+
+public:
+  mathParser(const std::string &expr, const std::vector<std::string> &vars,
+             std::vector<mathNode> &nodes,
+             std::map<mathNode, int, mathNodeLessThan> &cse)
+    : _expr(expr), _variables(vars), _nodes(nodes), _cse(cse), _pos(0),
+      _tok(END), _value(0.), _index(-1)
+  {
+  }
+  bool parse(int &root)
+  {
+    _nextToken();
+    if(!_parseSum(root)) return false;
+    if(_tok != END) return _fail("parse()", "End of expression expected");
+    return true;
+  }
+  std::size_t getPosition() const { return _pos; }
+  const std::string &getError() const { return _error; }
+};
+
+bool mathParser::_getNumber()
+{
+  std::size_t i = _pos;
+  if(i >= _expr.size() || !strchr("0123456789.", _expr[i])) return false;
+  bool decimal = false;
+  for(; i < _expr.size(); i++) {
+    if(!isdigit(_expr[i]) && (_expr[i] != '.' || decimal)) break;
+    if(_expr[i] == '.') decimal = true;
+  }
+  if(i == _pos + 1 && _expr[_pos] == '.') return false;
+  if(i < _expr.size() && toupper(_expr[i]) == 'E') {
+    i++;
+    if(i < _expr.size() && (_expr[i] == '+' || _expr[i] == '-')) i++;
+    while(i < _expr.size() && isdigit(_expr[i])) i++;
+  }
+  _value = strtod(_expr.substr(_pos, i - _pos).c_str(), 0);
+  _pos = i;
+  return true;
+}
+
+void mathParser::_nextToken()
+{
+  while(_pos < _expr.size() && isspace(_expr[_pos])) _pos++;
+  if(_pos == _expr.size()) {
+    _tok = END;
+    return;
+  }
+  if(_getNumber()) {
+    _tok = VALUE;
+    return;
+  }
+  if(isalpha(_expr[_pos]) || _expr[_pos] == '_') {
+    std::size_t i = _pos;
+    while(i < _expr.size() && (isalnum(_expr[i]) || _expr[i] == '_')) i++;
+    std::string name = _expr.substr(_pos, i - _pos);
+    _pos = i;
+    for(int j = 0; mathFunctions[j].name; j++) {
+      if(matchName(name, mathFunctions[j].name)) {
+        _tok = FUNCTION;
+        _index = j;
+        return;
+      }
+    }
+    for(int j = 0; userFunctions[j]; j++) {
+      if(matchName(name, userFunctions[j])) {
+        _tok = USERFUNC;
+        _index = j;
+        return;
+      }
+    }
+    for(std::size_t j = 0; j < _variables.size(); j++) {
+      if(name == _variables[j]) {
+        _tok = VARIABLE;
+        _index = j;
+        return;
+      }
+    }
+    _tok = VALUE;
+    if(name == "Pi" || name == "pi")
+      _value = M_PI;
+    else if(name == "e")
+      _value = M_E;
+    else
+      _tok = INVALID;
+    return;
+  }
+  switch(_expr[_pos]) {
+  case '+': _tok = PLUS; break;
+  case '-': _tok = MINUS; break;
+  case '*': _tok = TIMES; break;
+  case '/': _tok = DIVIDE; break;
+  case '%': _tok = MODULE; break;
+  case '^': _tok = POWER; break;
+  case ',': _tok = COMMA; break;
+  case '(': _tok = OPAREN; break;
+  case ')': _tok = CPAREN; break;
+  default: _tok = INVALID; break;
+  }
+  if(_tok != INVALID) _pos++;
+}
+
+bool mathParser::_fail(const std::string &where, const std::string &what)
+{
+  _error = "Error [mathEvaluator::" + where + "]: " + what;
+  return false;
+}
+
+int mathParser::_node(int op, int a, int b, double value)
+{
+  if(op != OP_VAR && op != OP_CONST && op != OP_RAND) {
+    bool constA = (_nodes[a].op == OP_CONST);
+    bool constB = !isBinary(op) || _nodes[b].op == OP_CONST;
+    // constant folding (unless it triggers an error, which is then reported
+    // at evaluation time)
+    if(constA && constB) {
+      int err = 0;
+      double v = applyOp(op, b, _nodes[a].value,
+                         isBinary(op) ? _nodes[b].value : 0., err);
+      if(!err) return _node(OP_CONST, -1, -1, v);
+    }
+    // x^2 -> x*x
+    if(op == OP_POW && constB && _nodes[b].value == 2.)
+      return _node(OP_MUL, a, a);
+    // canonical order of the operands of commutative operations
+    if((op == OP_ADD || op == OP_MUL) && b < a) std::swap(a, b);
+  }
+  mathNode n;
+  n.op = op;
+  n.a = a;
+  n.b = b;
+  n.value = value;
+  if(op != OP_RAND) {
+    // common subexpression elimination
+    std::map<mathNode, int, mathNodeLessThan>::iterator it = _cse.find(n);
+    if(it != _cse.end()) return it->second;
+    _cse[n] = _nodes.size();
+  }
+  _nodes.push_back(n);
+  return _nodes.size() - 1;
+}
+
+bool mathParser::_parseSum(int &n)
+{
+  if(!_parseProduct(n)) return false;
+  while(_tok == PLUS || _tok == MINUS) {
+    int op = (_tok == PLUS) ? OP_ADD : OP_SUB;
+    _nextToken();
+    if(_tok == PLUS || _tok == MINUS)
+      return _fail("parse()", "Invalid expression");
+    int m;
+    if(!_parseProduct(m)) return false;
+    n = _node(op, n, m);
+  }
+  return true;
+}
+
+bool mathParser::_parseProduct(int &n)
+{
+  if(!_parsePower(n)) return false;
+  while(_tok == TIMES || _tok == DIVIDE || _tok == MODULE) {
+    int op = (_tok == TIMES) ? OP_MUL : (_tok == DIVIDE) ? OP_DIV : OP_MOD;
+    _nextToken();
+    if(_tok == PLUS || _tok == MINUS)
+      return _fail("parse()", "Invalid expression");
+    int m;
+    if(!_parsePower(m)) return false;
+    n = _node(op, n, m);
+  }
+  return true;
+}
+
+bool mathParser::_parsePower(int &n)
+{
+  if(!_parseUnary(n)) return false;
+  if(_tok == POWER) {
+    _nextToken();
+    if(_tok == PLUS || _tok == MINUS)
+      return _fail("parse()", "Invalid expression");
+    int m;
+    if(!_parseUnary(m)) return false;
+    n = _node(OP_POW, n, m);
+  }
+  return true;
+}
+
+bool mathParser::_parseUnary(int &n)
+{
+  tokenType sign = _tok;
+  if(sign == PLUS || sign == MINUS) _nextToken();
+  if(_tok == PLUS || _tok == MINUS)
+    return _fail("parse()", "Invalid expression");
+  if(!_parseAtom(n)) return false;
+  if(sign == MINUS) n = _node(OP_NEG, n);
+  return true;
+}
+
+bool mathParser::_parseAtom(int &n)
+{
+  if(_tok == OPAREN) {
+    _nextToken();
+    if(_tok == CPAREN)
+      return _fail("parseatom()", "No expression inside parentesis");
+    if(!_parseSum(n)) return false;
+    if(_tok != CPAREN) return _fail("parseatom()", "\")\" expected");
+    _nextToken();
+  }
+  else if(_tok == VALUE) {
+    n = _node(OP_CONST, -1, -1, _value);
+    _nextToken();
+  }
+  else if(_tok == VARIABLE) {
+    n = _node(OP_VAR, _index);
+    _nextToken();
+  }
+  else if(_tok == FUNCTION) {
+    int f = _index;
+    _nextToken();
+    if(_tok != OPAREN) return _fail("parseatom()", "\"(\" expected");
+    _nextToken();
+    if(_tok == CPAREN)
+      return _fail("parseatom()", "invalid number of arguments");
+    if(!_parseSum(n)) return false;
+    if(_tok != CPAREN) return _fail("parseatom()", "\")\" expected");
+    n = _node(OP_FUNC, n, f);
+    _nextToken();
+  }
+  else if(_tok == USERFUNC) {
+    int f = _index;
+    _nextToken();
+    if(_tok != OPAREN) return _fail("parseatom()", "\"(\" expected");
+    _nextToken();
+    std::vector<int> args;
+    if(_tok != CPAREN) {
+      int m;
+      if(!_parseSum(m)) return false;
+      args.push_back(m);
+      while(_tok != END && _tok != CPAREN) {
+        if(_tok != COMMA) return _fail("parseatom()", "unknow error");
+        _nextToken();
+        if(!_parseSum(m)) return false;
+        args.push_back(m);
+      }
+      if(_tok != CPAREN) return _fail("parseatom()", "\")\" expected");
+    }
+    if((f == USER_RAND) != args.empty())
+      return _fail("parseatom()", "invalid number of arguments");
+    if(f == USER_RAND) { n = _node(OP_RAND); }
+    else {
+      int op = (f == USER_MAX) ? OP_MAX : (f == USER_MIN) ? OP_MIN : OP_ADD;
+      n = args[0];
+      for(std::size_t i = 1; i < args.size(); i++) n = _node(op, n, args[i]);
+      if(f == USER_MED)
+        n = _node(OP_DIV, n, _node(OP_CONST, -1, -1, (double)args.size()));
+    }
+    _nextToken();
+  }
+  else if(_tok == END)
+    return _fail("parseatom()", "unexpected end of expression");
+  else if(_tok == INVALID)
+    return _fail("parseatom()", "invalid token on expression");
+  else
+    return _fail("parseatom()", "unknow error");
+  return true;
+}
 
 mathEvaluator::mathEvaluator(std::vector<std::string> &expressions,
                              const std::vector<std::string> &variables)
+  : _numVariables(variables.size()), _numRegisters(0)
 {
   static std::string lastError;
 
-  _expressions.resize(expressions.size());
-  _variables.resize(variables.size(), 0.);
+  // all the expressions share the same graph, so that their common
+  // subexpressions are only evaluated once
+  std::vector<mathNode> nodes;
+  std::map<mathNode, int, mathNodeLessThan> cse;
+  std::vector<int> roots(expressions.size());
   bool error = false;
   for(std::size_t i = 0; i < expressions.size(); i++) {
-    _expressions[i] = new smlib::mathex();
-    for(std::size_t j = 0; j < variables.size(); j++)
-      _expressions[i]->addvar(variables[j], &_variables[j]);
-    try {
-      _expressions[i]->expression(expressions[i]);
-      _expressions[i]->parse();
-    } catch(smlib::mathex::error &e) {
-      if(e.what() + expressions[i] != lastError) {
-        lastError = e.what() + expressions[i];
-        Msg::Error(e.what());
-        std::string pos(_expressions[i]->stopposition(), ' ');
+    mathParser p(expressions[i], variables, nodes, cse);
+    if(!p.parse(roots[i])) {
+      if(p.getError() + expressions[i] != lastError) {
+        lastError = p.getError() + expressions[i];
+        Msg::Error(p.getError().c_str());
+        std::string pos(p.getPosition(), ' ');
         pos.push_back('^');
         Msg::Error(expressions[i].c_str());
         Msg::Error(pos.c_str());
@@ -35,52 +461,226 @@ mathEvaluator::mathEvaluator(std::vector<std::string> &expressions,
     }
   }
   if(error) {
-    for(std::size_t i = 0; i < _expressions.size(); i++)
-      delete(_expressions[i]);
-    _expressions.clear();
     expressions.clear();
+    return;
+  }
+  _generate(nodes, roots);
+}
+
+void mathEvaluator::_generate(const std::vector<mathNode> &nodes,
+                              const std::vector<int> &roots)
+{
+  int numNodes = nodes.size();
+
+  // nodes are created after their operands: a backward sweep marks the nodes
+  // contributing to the results, a forward sweep finds their last use
+  std::vector<char> used(numNodes, 0);
+  for(std::size_t i = 0; i < roots.size(); i++) used[roots[i]] = 1;
+  for(int i = numNodes - 1; i >= 0; i--) {
+    if(!used[i]) continue;
+    const mathNode &n = nodes[i];
+    if(n.op == OP_NEG || n.op == OP_FUNC) used[n.a] = 1;
+    if(isBinary(n.op)) used[n.a] = used[n.b] = 1;
+  }
+  std::vector<int> lastUse(numNodes, -1);
+  for(int i = 0; i < numNodes; i++) {
+    if(!used[i]) continue;
+    const mathNode &n = nodes[i];
+    if(n.op == OP_NEG || n.op == OP_FUNC) lastUse[n.a] = i;
+    if(isBinary(n.op)) lastUse[n.a] = lastUse[n.b] = i;
+  }
+  for(std::size_t i = 0; i < roots.size(); i++) lastUse[roots[i]] = numNodes;
+
+  // variables and constants have fixed registers
+  std::vector<int> reg(numNodes, -1);
+  for(int i = 0; i < numNodes; i++) {
+    if(!used[i]) continue;
+    if(nodes[i].op == OP_VAR)
+      reg[i] = nodes[i].a;
+    else if(nodes[i].op == OP_CONST) {
+      reg[i] = _numVariables + _constants.size();
+      _constants.push_back(nodes[i].value);
+    }
+  }
+  _numRegisters = _numVariables + _constants.size();
+
+  // temporaries are recycled as soon as their value is dead
+  std::vector<int> freeRegisters;
+  for(int i = 0; i < numNodes; i++) {
+    const mathNode &n = nodes[i];
+    if(!used[i] || n.op == OP_VAR || n.op == OP_CONST) continue;
+    instruction ins;
+    ins.op = n.op;
+    ins.a = (n.op == OP_RAND) ? -1 : reg[n.a];
+    ins.b = isBinary(n.op) ? reg[n.b] : (n.op == OP_FUNC) ? n.b : -1;
+    int operands[2] = {(n.op == OP_RAND) ? -1 : n.a,
+                       (isBinary(n.op) && n.b != n.a) ? n.b : -1};
+    for(int j = 0; j < 2; j++) {
+      int o = operands[j];
+      if(o >= 0 && lastUse[o] == i && reg[o] >= (int)_constants.size() +
+                                                   _numVariables)
+        freeRegisters.push_back(reg[o]);
+    }
+    if(freeRegisters.empty())
+      ins.dst = _numRegisters++;
+    else {
+      ins.dst = freeRegisters.back();
+      freeRegisters.pop_back();
+    }
+    reg[i] = ins.dst;
+    _program.push_back(ins);
+  }
+
+  _results.resize(roots.size());
+  for(std::size_t i = 0; i < roots.size(); i++) _results[i] = reg[roots[i]];
+}
+
+void mathEvaluator::_loadConstants(int stride, double *reg) const
+{
+  for(std::size_t i = 0; i < _constants.size(); i++) {
+    double *r = reg + (_numVariables + i) * stride;
+    for(int k = 0; k < stride; k++) r[k] = _constants[i];
   }
 }
 
-mathEvaluator::~mathEvaluator()
+// run the bytecode on n points; register r of point k is reg[r * stride + k]
+int mathEvaluator::_run(int n, int stride, double *reg) const
 {
-  for(std::size_t i = 0; i < _expressions.size(); i++) delete(_expressions[i]);
+  int err = 0;
+  for(std::size_t i = 0; i < _program.size(); i++) {
+    const instruction &ins = _program[i];
+    double *d = reg + ins.dst * stride;
+    const double *a = (ins.op == OP_RAND) ? 0 : reg + ins.a * stride;
+    const double *b = isBinary(ins.op) ? reg + ins.b * stride : 0;
+    switch(ins.op) {
+    case OP_NEG:
+      for(int k = 0; k < n; k++) d[k] = -a[k];
+      break;
+    case OP_ADD:
+      for(int k = 0; k < n; k++) d[k] = a[k] + b[k];
+      break;
+    case OP_SUB:
+      for(int k = 0; k < n; k++) d[k] = a[k] - b[k];
+      break;
+    case OP_MUL:
+      for(int k = 0; k < n; k++) d[k] = a[k] * b[k];
+      break;
+    case OP_DIV:
+      for(int k = 0; k < n; k++)
+        if(b[k] == 0.) err |= ERR_DIVISION;
+      for(int k = 0; k < n; k++) d[k] = a[k] / b[k];
+      break;
+    case OP_MOD:
+      for(int k = 0; k < n; k++) d[k] = fmod(a[k], b[k]);
+      break;
+    case OP_POW:
+      for(int k = 0; k < n; k++) d[k] = pow(a[k], b[k]);
+      break;
+    case OP_MIN:
+      for(int k = 0; k < n; k++) d[k] = (b[k] < a[k]) ? b[k] : a[k];
+      break;
+    case OP_MAX:
+      for(int k = 0; k < n; k++) d[k] = (b[k] > a[k]) ? b[k] : a[k];
+      break;
+    case OP_RAND:
+      for(int k = 0; k < n; k++) d[k] = rand() / (RAND_MAX + 1.0);
+      break;
+    case OP_FUNC: {
+      double (*f)(double) = mathFunctions[ins.b].f;
+      if(f == mathFac) {
+        for(int k = 0; k < n; k++)
+          if(a[k] < 0 || a[k] > 170) err |= ERR_RANGE;
+      }
+      for(int k = 0; k < n; k++) d[k] = f(a[k]);
+    } break;
+    }
+  }
+  return err;
+}
+
+static void reportError(int err)
+{
+  if(err & ERR_DIVISION) Msg::Error("Division by zero in math expression");
+  if(err & ERR_RANGE) Msg::Error("Range error in math expression (fac)");
 }
 
 bool mathEvaluator::eval(const std::vector<double> &values,
-                         std::vector<double> &res)
+                         std::vector<double> &res) const
 {
-  if(values.size() != _variables.size()) {
-    Msg::Error("Given %d value(s) for %d variable(s)", values.size(),
-               _variables.size());
+  if((int)values.size() != _numVariables) {
+    Msg::Error("Given %d value(s) for %d variable(s)", (int)values.size(),
+               _numVariables);
     return false;
   }
 
-  if(res.size() != _expressions.size()) {
-    Msg::Error("Given %d result(s) for %d expression(s)", res.size(),
-               _expressions.size());
+  if(res.size() != _results.size()) {
+    Msg::Error("Given %d result(s) for %d expression(s)", (int)res.size(),
+               (int)_results.size());
     return false;
   }
 
-  for(std::size_t i = 0; i < values.size(); i++) _variables[i] = values[i];
-
-  for(std::size_t i = 0; i < _expressions.size(); i++) {
-    try {
-      res[i] = _expressions[i]->eval();
-    } catch(smlib::mathex::error &e) {
-      Msg::Error(e.what());
-      double eps = 1.e-20;
-      for(std::size_t j = 0; j < values.size(); j++)
-        _variables[j] = values[j] + eps;
-      try {
-        res[i] = _expressions[i]->eval();
-      } catch(smlib::mathex::error &e2) {
-        Msg::Error(e2.what());
-        return false;
-      }
+  if(_results.empty()) return true;
+
+  double tmp[64];
+  std::vector<double> tmpLarge;
+  double *reg = tmp;
+  if(_numRegisters > 64) {
+    tmpLarge.resize(_numRegisters);
+    reg = &tmpLarge[0];
+  }
+  _loadConstants(1, reg);
+  for(int i = 0; i < _numVariables; i++) reg[i] = values[i];
+  int err = _run(1, 1, reg);
+  if(err) {
+    reportError(err);
+    double eps = 1.e-20;
+    for(int i = 0; i < _numVariables; i++) reg[i] = values[i] + eps;
+    err = _run(1, 1, reg);
+    if(err) {
+      reportError(err);
+      return false;
     }
   }
+  for(std::size_t i = 0; i < _results.size(); i++) res[i] = reg[_results[i]];
   return true;
 }
 
-#endif
+bool mathEvaluator::eval(int n, const double *values, double *res) const
+{
+  if(_results.empty() || n <= 0) return true;
+
+  int numExpressions = _results.size();
+  std::vector<double> reg(_numRegisters * blockSize);
+  _loadConstants(blockSize, &reg[0]);
+  bool ok = true;
+  std::vector<double> pointValues, pointRes;
+  for(int start = 0; start < n; start += blockSize) {
+    int m = std::min(blockSize, n - start);
+    const double *v = values + start * _numVariables;
+    for(int i = 0; i < _numVariables; i++) {
+      double *r = &reg[i * blockSize];
+      for(int k = 0; k < m; k++) r[k] = v[k * _numVariables + i];
+    }
+    double *out = res + start * numExpressions;
+    if(_run(m, blockSize, &reg[0])) {
+      // evaluate the block again point by point, with the same retry on
+      // errors as the single point evaluation
+      pointValues.resize(_numVariables);
+      pointRes.resize(numExpressions);
+      for(int k = 0; k < m; k++) {
+        for(int i = 0; i < _numVariables; i++)
+          pointValues[i] = v[k * _numVariables + i];
+        pointRes.assign(numExpressions, 0.);
+        if(!eval(pointValues, pointRes)) ok = false;
+        for(int i = 0; i < numExpressions; i++)
+          out[k * numExpressions + i] = pointRes[i];
+      }
+      continue;
+    }
+    for(int i = 0; i < numExpressions; i++) {
+      const double *r = &reg[_results[i] * blockSize];
+      for(int k = 0; k < m; k++) out[k * numExpressions + i] = r[k];
+    }
+  }
+  return ok;
+}
@@ -11,14 +11,28 @@
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 
-#if defined(HAVE_MATHEX)
-
-#include "mathex.h"
+struct mathNode;
 
+// Evaluator for mathematical expressions (using the MathEx syntax). The
+// expressions are compiled once into a register bytecode, with constant
+// folding and with common subexpressions shared between all the expressions.
+// Evaluation does not modify the evaluator and can thus be done concurrently
+// by several threads.
 class mathEvaluator {
 private:
-  std::vector<smlib::mathex *> _expressions;
-  std::vector<double> _variables;
+  struct instruction {
+    int op, dst, a, b;
+  };
+  int _numVariables, _numRegisters;
+  // registers are ordered as variables, constants and temporaries
+  std::vector<double> _constants;
+  std::vector<instruction> _program;
+  // register holding the result of each expression
+  std::vector<int> _results;
+  void _generate(const std::vector<mathNode> &nodes,
+                 const std::vector<int> &roots);
+  void _loadConstants(int stride, double *reg) const;
+  int _run(int n, int stride, double *reg) const;
 
 public:
   // initialize one or more expressions depending on zero or more
@@ -26,30 +40,16 @@ public:
   // cleared.
   mathEvaluator(std::vector<std::string> &expressions,
                 const std::vector<std::string> &variables);
-  ~mathEvaluator();
+  ~mathEvaluator() {}
+  std::size_t getNumVariables() const { return _numVariables; }
+  std::size_t getNumExpressions() const { return _results.size(); }
   // evaluate the expression(s) using the given values and fill the
   // result vector. Returns true if the evaluation succeeded.
-  bool eval(const std::vector<double> &values, std::vector<double> &res);
+  bool eval(const std::vector<double> &values, std::vector<double> &res) const;
+  // evaluate the expression(s) at n points: values[i * numVariables + j] is
+  // the value of variable j at point i, and res[i * numExpressions + k]
+  // receives the value of expression k at point i
+  bool eval(int n, const double *values, double *res) const;
 };
 
-#else
-
-class mathEvaluator {
-public:
-  mathEvaluator(std::vector<std::string> &expressions,
-                const std::vector<std::string> &variables)
-  {
-    Msg::Error("Gmsh must be compiled with MathEx support to evaluate math "
-               "expressions");
-    expressions.clear();
-  }
-  ~mathEvaluator() {}
-  bool eval(const std::vector<double> &values, std::vector<double> &res)
-  {
-    return false;
-  }
-};
-
-#endif
-
 #endif
@@ -0,0 +1,58 @@
+// Gmsh - Copyright (C) 1997-2019 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file for license information. Please report all
+// issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef _SIMPLE_FUNCTION_MATH_EVAL_H_
+#define _SIMPLE_FUNCTION_MATH_EVAL_H_
+
+#include "mathEvaluator.h"
+#include "simpleFunction.h"
+
+// function of x, y, z given by a math expression; evaluation is thread-safe
+class simpleFunctionMathEval : public simpleFunction<double> {
+  mathEvaluator *_expr;
+  // the evaluator is owned: no copy
+  simpleFunctionMathEval(const simpleFunctionMathEval &);
+  simpleFunctionMathEval &operator=(const simpleFunctionMathEval &);
+
+public:
+  simpleFunctionMathEval(const std::string &f, double val = 0.)
+    : simpleFunction<double>(val)
+  {
+    std::vector<std::string> expressions(1, f), variables(3);
+    variables[0] = "x";
+    variables[1] = "y";
+    variables[2] = "z";
+    _expr = new mathEvaluator(expressions, variables);
+    if(expressions.empty()) {
+      delete _expr;
+      _expr = 0;
+    }
+  }
+  ~simpleFunctionMathEval()
+  {
+    if(_expr) delete _expr;
+  }
+  bool isValid() const { return _expr != 0; }
+  // returns the default value if the expression is invalid
+  double operator()(double x, double y, double z) const
+  {
+    if(!_expr) return _val;
+    std::vector<double> values(3), res(1);
+    values[0] = x;
+    values[1] = y;
+    values[2] = z;
+    if(_expr->eval(values, res)) return res[0];
+    return _val;
+  }
+  // evaluate the function at n points (xyz[3 * i + j] is coordinate j of
+  // point i)
+  bool eval(int n, const double *xyz, double *res) const
+  {
+    if(!_expr) return false;
+    return _expr->eval(n, xyz, res);
+  }
+};
+
+#endif
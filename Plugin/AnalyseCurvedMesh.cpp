@@ -161,27 +161,27 @@ PView *GMSH_AnalyseCurvedMeshPlugin::execute(PView *v)
   for(int dim = 1; dim <= 3 && dim <= _m->getDim(); ++dim) {
     if((askedDim == 4 && dim > 1) || dim == askedDim) {
       if(!_computedJac[dim - 1]) {
-        double time = Cpu();
+        double time = TimeOfDay();
         Msg::StatusBar(true, "Computing Jacobian for %dD elements...", dim);
         _computeMinMaxJandValidity(dim);
         Msg::StatusBar(true, "Done computing Jacobian for %dD elements (%g s)",
-                       dim, Cpu() - time);
+                       dim, TimeOfDay() - time);
         printStatJ = true;
       }
       if(computeIGE && !_computedIGE[dim - 1]) {
-        double time = Cpu();
+        double time = TimeOfDay();
         Msg::StatusBar(true, "Computing IGE for %dD elements...", dim);
         _computeMinIGE(dim);
         Msg::StatusBar(true, "Done computing IGE for %dD elements (%g s)", dim,
-                       Cpu() - time);
+                       TimeOfDay() - time);
         printStatS = true;
       }
       if(computeICN && !_computedICN[dim - 1]) {
-        double time = Cpu();
+        double time = TimeOfDay();
         Msg::StatusBar(true, "Computing ICN for %dD elements...", dim);
         _computeMinICN(dim);
         Msg::StatusBar(true, "Done computing ICN for %dD elements (%g s)", dim,
-                       Cpu() - time);
+                       TimeOfDay() - time);
         printStatI = true;
       }
     }
@@ -360,16 +360,17 @@ void GMSH_AnalyseCurvedMeshPlugin::_computeMinMaxJandValidity(int dim)
     default: break;
     }
 
-    MsgProgressStatus progress(num);
+    std::vector<MElement *> elements(num);
+    for(unsigned i = 0; i < num; ++i) elements[i] = entity->getMeshElement(i);
+    std::vector<double> min, max;
+    jacobianBasedQuality::minMaxJacobianDeterminant(elements, min, max,
+                                                    normals);
 
     _data.reserve(_data.size() + num);
     for(unsigned i = 0; i < num; ++i) {
-      MElement *el = entity->getMeshElement(i);
-      double min, max;
-      jacobianBasedQuality::minMaxJacobianDeterminant(el, min, max, normals);
-      _data.push_back(data_elementMinMax(el, min, max));
-      if(min < 0 && max < 0) ++cntInverted;
-      progress.next();
+      MElement *el = elements[i];
+      _data.push_back(data_elementMinMax(el, min[i], max[i]));
+      if(min[i] < 0 && max[i] < 0) ++cntInverted;
 
 #if defined(HAVE_VISUDEV)
       _computePointwiseQuantities(el, normals);
@@ -5,6 +5,7 @@
 
 #include "Curl.h"
 #include "shapeFunctions.h"
+#include "PViewDataGModel.h"
 #include "GmshDefines.h"
 
 StringXNumber CurlOptions_Number[] = {{GMSH_FULLRC, "View", NULL, -1.}};
@@ -31,6 +32,101 @@ StringXNumber *GMSH_CurlPlugin::getOption(int iopt)
   return &CurlOptions_Number[iopt];
 }
 
+class curlOperation : public PluginElementOperation {
+private:
+  PViewData *_data;
+  int _step;
+  elementNodeGradients _gsf;
+  // the time steps with data
+  std::vector<int> _steps;
+  // compute the curl at the nodes of element (ent, ele), val[i]
+  // receiving the curl at step _steps[i]
+  void _compute(int ent, int ele, int numNodes, double *x, double *y,
+                double *z, std::vector<double *> &val)
+  {
+    int dim = _data->getDimension(_step, ent, ele);
+    elementFactory factory;
+    element *element = factory.create(numNodes, dim, x, y, z);
+    if(!element) return;
+    // the shape function gradients and the inverse Jacobians at the nodes do
+    // not depend on the time step: compute them once
+    const double *gsf[8];
+    double inv[8][3][3];
+    bool tabulated = (_gsf.get(dim, numNodes, 0) != 0);
+    if(tabulated) {
+      for(int nod = 0; nod < numNodes; nod++) {
+        double jac[3][3];
+        gsf[nod] = _gsf.get(dim, numNodes, nod);
+        element->getJacobian(gsf[nod], jac);
+        inv3x3(jac, inv[nod]);
+      }
+    }
+    double vals[8 * 3];
+    for(std::size_t i = 0; i < _steps.size(); i++) {
+      for(int nod = 0; nod < numNodes; nod++)
+        for(int comp = 0; comp < 3; comp++)
+          _data->getValue(_steps[i], ent, ele, nod, comp,
+                          vals[3 * nod + comp]);
+      for(int nod = 0; nod < numNodes; nod++) {
+        double *f = val[i] + 3 * nod;
+        if(tabulated)
+          element->interpolateCurl(vals, gsf[nod], inv[nod], f, 3);
+        else {
+          double u, v, w;
+          element->getNode(nod, u, v, w);
+          element->interpolateCurl(vals, u, v, w, f, 3);
+        }
+      }
+    }
+    delete element;
+  }
+
+public:
+  curlOperation(PViewData *data, int step) : _data(data), _step(step)
+  {
+    for(int s = 0; s < data->getNumTimeSteps(); s++)
+      if(data->hasTimeStep(s)) _steps.push_back(s);
+  }
+  const std::vector<int> &getSteps() const { return _steps; }
+  void operator()(int ent, int ele, int chunk,
+                  std::vector<PViewDataList *> &lists)
+  {
+    if(_data->skipElement(_step, ent, ele)) return;
+    int numComp = _data->getNumComponents(_step, ent, ele);
+    if(numComp != 3) return;
+    int type = _data->getType(_step, ent, ele);
+    int numNodes = _data->getNumNodes(_step, ent, ele);
+    std::vector<double> *out = lists[0]->incrementList(3, type, numNodes);
+    if(!out) return;
+    double x[8], y[8], z[8];
+    for(int nod = 0; nod < numNodes; nod++)
+      _data->getNode(_step, ent, ele, nod, x[nod], y[nod], z[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
+    std::size_t n = 3 * numNodes;
+    std::vector<double> buf(_steps.size() * n, 0.);
+    std::vector<double *> val(_steps.size());
+    for(std::size_t i = 0; i < _steps.size(); i++) val[i] = &buf[i * n];
+    _compute(ent, ele, numNodes, x, y, z, val);
+    out->insert(out->end(), buf.begin(), buf.end());
+  }
+  int getNumOutputNodes(int ent, int ele)
+  {
+    if(_data->skipElement(_step, ent, ele)) return 0;
+    if(_data->getNumComponents(_step, ent, ele) != 3) return 0;
+    return _data->getNumNodes(_step, ent, ele);
+  }
+  void computeOutput(int ent, int ele, int chunk, std::vector<double *> &val)
+  {
+    int numNodes = _data->getNumNodes(_step, ent, ele);
+    double x[8], y[8], z[8];
+    for(int nod = 0; nod < numNodes; nod++)
+      _data->getNode(_step, ent, ele, nod, x[nod], y[nod], z[nod]);
+    _compute(ent, ele, numNodes, x, y, z, val);
+  }
+};
+
 PView *GMSH_CurlPlugin::execute(PView *v)
 {
   int iView = (int)CurlOptions_Number[0].def;
@@ -44,55 +140,30 @@ PView *GMSH_CurlPlugin::execute(PView *v)
     return v;
   }
 
-  PView *v2 = new PView();
-  PViewDataList *data2 = getDataList(v2);
   int firstNonEmptyStep = data1->getFirstNonEmptyTimeStep();
+  curlOperation op(data1, firstNonEmptyStep);
+  std::vector<double> times;
+  for(std::size_t i = 0; i < op.getSteps().size(); i++)
+    times.push_back(data1->getTime(op.getSteps()[i]));
 
-  for(int ent = 0; ent < data1->getNumEntities(firstNonEmptyStep); ent++) {
-    for(int ele = 0; ele < data1->getNumElements(firstNonEmptyStep, ent);
-        ele++) {
-      if(data1->skipElement(firstNonEmptyStep, ent, ele)) continue;
-      int numComp = data1->getNumComponents(firstNonEmptyStep, ent, ele);
-      if(numComp != 3) continue;
-      int type = data1->getType(firstNonEmptyStep, ent, ele);
-      int numNodes = data1->getNumNodes(firstNonEmptyStep, ent, ele);
-      std::vector<double> *out = data2->incrementList(3, type, numNodes);
-      if(!out) continue;
-      double x[8], y[8], z[8], val[8 * 3];
-      for(int nod = 0; nod < numNodes; nod++)
-        data1->getNode(firstNonEmptyStep, ent, ele, nod, x[nod], y[nod],
-                       z[nod]);
-      int dim = data1->getDimension(firstNonEmptyStep, ent, ele);
-      elementFactory factory;
-      element *element = factory.create(numNodes, dim, x, y, z);
-      if(!element) continue;
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
-      for(int step = 0; step < data1->getNumTimeSteps(); step++) {
-        if(!data1->hasTimeStep(step)) continue;
-        for(int nod = 0; nod < numNodes; nod++)
-          for(int comp = 0; comp < numComp; comp++)
-            data1->getValue(step, ent, ele, nod, comp,
-                            val[numComp * nod + comp]);
-        for(int nod = 0; nod < numNodes; nod++) {
-          double u, v, w, f[3];
-          element->getNode(nod, u, v, w);
-          element->interpolateCurl(val, u, v, w, f, 3);
-          out->push_back(f[0]);
-          out->push_back(f[1]);
-          out->push_back(f[2]);
-        }
-      }
-      delete element;
-    }
+  // model-based data is differentiated directly in a new model-based view
+  PViewDataGModel *model1 = getModelData(data1);
+  if(model1 &&
+     model1->getStepData(firstNonEmptyStep)->getNumComponents() == 3) {
+    PViewDataGModel *data2 =
+      new PViewDataGModel(PViewDataGModel::ElementNodeData);
+    forEachElement(model1, firstNonEmptyStep, op, data2, times, 3);
+    data2->setName(data1->getName() + "_Curl");
+    data2->setFileName(data1->getName() + "_Curl.msh");
+    data2->finalize();
+    return new PView(data2);
   }
 
-  for(int i = 0; i < data1->getNumTimeSteps(); i++) {
-    if(!data1->hasTimeStep(i)) continue;
-    double time = data1->getTime(i);
-    data2->Time.push_back(time);
-  }
+  PView *v2 = new PView();
+  PViewDataList *data2 = getDataList(v2);
+  std::vector<PViewDataList *> out(1, data2);
+  forEachElement(data1, firstNonEmptyStep, op, out);
+  data2->Time = times;
   data2->setName(data1->getName() + "_Curl");
   data2->setFileName(data1->getName() + "_Curl.pos");
   data2->finalize();
@@ -34,6 +34,51 @@ StringXNumber *GMSH_EigenvaluesPlugin::getOption(int iopt)
   return &EigenvaluesOptions_Number[iopt];
 }
 
+class eigenvaluesOperation : public PluginElementOperation {
+private:
+  PViewData *_data;
+
+public:
+  eigenvaluesOperation(PViewData *data) : _data(data) {}
+  void operator()(int ent, int ele, int chunk,
+                  std::vector<PViewDataList *> &lists)
+  {
+    if(_data->skipElement(0, ent, ele)) return;
+    int numComp = _data->getNumComponents(0, ent, ele);
+    if(numComp != 9) return;
+    int type = _data->getType(0, ent, ele);
+    int numNodes = _data->getNumNodes(0, ent, ele);
+    std::vector<double> *outmin = lists[0]->incrementList(1, type, numNodes);
+    std::vector<double> *outmid = lists[1]->incrementList(1, type, numNodes);
+    std::vector<double> *outmax = lists[2]->incrementList(1, type, numNodes);
+    if(!outmin || !outmid || !outmax) return;
+    double xyz[3][8];
+    for(int nod = 0; nod < numNodes; nod++)
+      _data->getNode(0, ent, ele, nod, xyz[0][nod], xyz[1][nod], xyz[2][nod]);
+    for(int i = 0; i < 3; i++) {
+      for(int nod = 0; nod < numNodes; nod++) {
+        outmin->push_back(xyz[i][nod]);
+        outmid->push_back(xyz[i][nod]);
+        outmax->push_back(xyz[i][nod]);
+      }
+    }
+    for(int step = 0; step < _data->getNumTimeSteps(); step++) {
+      for(int nod = 0; nod < numNodes; nod++) {
+        double val[9], w[3];
+        for(int comp = 0; comp < numComp; comp++)
+          _data->getValue(step, ent, ele, nod, comp, val[comp]);
+        double A[3][3] = {{val[0], val[1], val[2]},
+                          {val[3], val[4], val[5]},
+                          {val[6], val[7], val[8]}};
+        eigenvalue(A, w);
+        outmin->push_back(w[2]);
+        outmid->push_back(w[1]);
+        outmax->push_back(w[0]);
+      }
+    }
+  }
+};
+
 PView *GMSH_EigenvaluesPlugin::execute(PView *v)
 {
   int iView = (int)EigenvaluesOptions_Number[0].def;
@@ -55,43 +100,12 @@ PView *GMSH_EigenvaluesPlugin::execute(PView *v)
   PViewDataList *dmid = getDataList(mid);
   PViewDataList *dmax = getDataList(max);
 
-  for(int ent = 0; ent < data1->getNumEntities(0); ent++) {
-    for(int ele = 0; ele < data1->getNumElements(0, ent); ele++) {
-      if(data1->skipElement(0, ent, ele)) continue;
-      int numComp = data1->getNumComponents(0, ent, ele);
-      if(numComp != 9) continue;
-      int type = data1->getType(0, ent, ele);
-      int numNodes = data1->getNumNodes(0, ent, ele);
-      std::vector<double> *outmin = dmin->incrementList(1, type, numNodes);
-      std::vector<double> *outmid = dmid->incrementList(1, type, numNodes);
-      std::vector<double> *outmax = dmax->incrementList(1, type, numNodes);
-      if(!outmin || !outmid || !outmax) continue;
-      double xyz[3][8];
-      for(int nod = 0; nod < numNodes; nod++)
-        data1->getNode(0, ent, ele, nod, xyz[0][nod], xyz[1][nod], xyz[2][nod]);
-      for(int i = 0; i < 3; i++) {
-        for(int nod = 0; nod < numNodes; nod++) {
-          outmin->push_back(xyz[i][nod]);
-          outmid->push_back(xyz[i][nod]);
-          outmax->push_back(xyz[i][nod]);
-        }
-      }
-      for(int step = 0; step < data1->getNumTimeSteps(); step++) {
-        for(int nod = 0; nod < numNodes; nod++) {
-          double val[9], w[3];
-          for(int comp = 0; comp < numComp; comp++)
-            data1->getValue(step, ent, ele, nod, comp, val[comp]);
-          double A[3][3] = {{val[0], val[1], val[2]},
-                            {val[3], val[4], val[5]},
-                            {val[6], val[7], val[8]}};
-          eigenvalue(A, w);
-          outmin->push_back(w[2]);
-          outmid->push_back(w[1]);
-          outmax->push_back(w[0]);
-        }
-      }
-    }
-  }
+  std::vector<PViewDataList *> out(3);
+  out[0] = dmin;
+  out[1] = dmid;
+  out[2] = dmax;
+  eigenvaluesOperation op(data1);
+  forEachElement(data1, 0, op, out);
 
   for(int i = 0; i < data1->getNumTimeSteps(); i++) {
     double time = data1->getTime(i);
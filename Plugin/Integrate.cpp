@@ -46,6 +46,113 @@ StringXNumber *GMSH_IntegratePlugin::getOption(int iopt)
   return &IntegrateOptions_Number[iopt];
 }
 
+class spatialIntegralOperation : public PluginElementOperation {
+private:
+  PViewData *_data;
+  int _step, _dimension;
+  bool _visible;
+
+public:
+  // partial results of each chunk
+  std::vector<double> res, resv;
+  std::vector<char> simpleSum;
+  spatialIntegralOperation(PViewData *data, int step, int dimension,
+                           bool visible)
+    : _data(data), _step(step), _dimension(dimension), _visible(visible),
+      res(Msg::GetMaxThreads(), 0.), resv(9 * Msg::GetMaxThreads(), 0.),
+      simpleSum(Msg::GetMaxThreads(), 0)
+  {
+  }
+  void operator()(int ent, int ele, int chunk,
+                  std::vector<PViewDataList *> &lists)
+  {
+    if(_visible && _data->skipEntity(_step, ent)) return;
+    if(_data->skipElement(_step, ent, ele, _visible)) return;
+    int numComp = _data->getNumComponents(_step, ent, ele);
+    int numEdges = _data->getNumEdges(_step, ent, ele);
+    bool scalar = (numComp == 1);
+    bool circulation = (numComp == 3 && numEdges == 1);
+    bool flux = (numComp == 3 && (numEdges == 3 || numEdges == 4));
+    int numNodes = _data->getNumNodes(_step, ent, ele);
+    int dim = _data->getDimension(_step, ent, ele);
+    if((_dimension > 0) && (dim != _dimension)) return;
+    double x[8], y[8], z[8], val[8 * 3] = {0.};
+    for(int nod = 0; nod < numNodes; nod++) {
+      _data->getNode(_step, ent, ele, nod, x[nod], y[nod], z[nod]);
+      for(int comp = 0; comp < numComp; comp++)
+        _data->getValue(_step, ent, ele, nod, comp, val[numComp * nod + comp]);
+    }
+    if(numNodes == 1) {
+      simpleSum[chunk] = 1;
+      res[chunk] += val[0];
+      for(int comp = 0; comp < numComp; comp++)
+        resv[9 * chunk + comp] += val[comp];
+    }
+    else {
+      elementFactory factory;
+      element *element = factory.create(numNodes, dim, x, y, z);
+      if(!element) return;
+      if(scalar)
+        res[chunk] += element->integrate(val);
+      else if(circulation)
+        res[chunk] += element->integrateCirculation(val);
+      else if(flux)
+        res[chunk] += element->integrateFlux(val);
+      delete element;
+    }
+  }
+};
+
+class timeIntegralOperation : public PluginElementOperation {
+private:
+  PViewData *_data;
+  int _timeBeg, _overTime, _dimension;
+
+public:
+  timeIntegralOperation(PViewData *data, int timeBeg, int overTime,
+                        int dimension)
+    : _data(data), _timeBeg(timeBeg), _overTime(overTime),
+      _dimension(dimension)
+  {
+  }
+  void operator()(int ent, int ele, int chunk,
+                  std::vector<PViewDataList *> &lists)
+  {
+    if(_data->skipElement(_timeBeg, ent, ele)) return;
+    int dim = _data->getDimension(_timeBeg, ent, ele);
+    if((_dimension > 0) && (dim != _dimension)) return;
+
+    int numNodes = _data->getNumNodes(_timeBeg, ent, ele);
+    int type = _data->getType(_timeBeg, ent, ele);
+    int numComp = _data->getNumComponents(_timeBeg, ent, ele);
+    if(numComp != 1) Msg::Error("Can only integrate scalar views over time");
+    std::vector<double> *out = lists[0]->incrementList(numComp, type, numNodes);
+    std::vector<double> x(numNodes), y(numNodes), z(numNodes);
+    for(int nod = 0; nod < numNodes; nod++)
+      _data->getNode(_timeBeg, ent, ele, nod, x[nod], y[nod], z[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
+
+    std::vector<double> timeIntegral(numNodes, 0.);
+    double time =
+      (_overTime > 0) ? _data->getTime(_timeBeg + _overTime - 1) : 0.0;
+    for(int step = _timeBeg + _overTime; step < _data->getNumTimeSteps();
+        step++) {
+      if(!_data->hasTimeStep(step)) continue;
+      double newTime = _data->getTime(step);
+      double dt = newTime - time;
+      time = newTime;
+      for(int nod = 0; nod < numNodes; nod++) {
+        double val;
+        _data->getValue(step, ent, ele, nod, 0, val);
+        timeIntegral[nod] += val * dt;
+      }
+    }
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(timeIntegral[nod]);
+  }
+};
+
 PView *GMSH_IntegratePlugin::execute(PView *v)
 {
   int iView = (int)IntegrateOptions_Number[0].def;
@@ -68,45 +175,16 @@ PView *GMSH_IntegratePlugin::execute(PView *v)
     data2->SP.push_back(y);
     data2->SP.push_back(z);
     for(int step = 0; step < data1->getNumTimeSteps(); step++) {
+      spatialIntegralOperation op(data1, step, dimension, visible);
+      std::vector<PViewDataList *> out;
+      forEachElement(data1, step, op, out);
       double res = 0, resv[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
       bool simpleSum = false;
-      for(int ent = 0; ent < data1->getNumEntities(step); ent++) {
-        if(visible && data1->skipEntity(step, ent)) continue;
-        for(int ele = 0; ele < data1->getNumElements(step, ent); ele++) {
-          if(data1->skipElement(step, ent, ele, visible)) continue;
-          int numComp = data1->getNumComponents(step, ent, ele);
-          int numEdges = data1->getNumEdges(step, ent, ele);
-          bool scalar = (numComp == 1);
-          bool circulation = (numComp == 3 && numEdges == 1);
-          bool flux = (numComp == 3 && (numEdges == 3 || numEdges == 4));
-          int numNodes = data1->getNumNodes(step, ent, ele);
-          int dim = data1->getDimension(step, ent, ele);
-          if((dimension > 0) && (dim != dimension)) continue;
-          double x[8], y[8], z[8], val[8 * 3] = {0.};
-          for(int nod = 0; nod < numNodes; nod++) {
-            data1->getNode(step, ent, ele, nod, x[nod], y[nod], z[nod]);
-            for(int comp = 0; comp < numComp; comp++)
-              data1->getValue(step, ent, ele, nod, comp,
-                              val[numComp * nod + comp]);
-          }
-          if(numNodes == 1) {
-            simpleSum = true;
-            res += val[0];
-            for(int comp = 0; comp < numComp; comp++) resv[comp] += val[comp];
-          }
-          else {
-            elementFactory factory;
-            element *element = factory.create(numNodes, dim, x, y, z);
-            if(!element) continue;
-            if(scalar)
-              res += element->integrate(val);
-            else if(circulation)
-              res += element->integrateCirculation(val);
-            else if(flux)
-              res += element->integrateFlux(val);
-            delete element;
-          }
-        }
+      // sum the partial results in chunk order
+      for(int c = 0; c < Msg::GetMaxThreads(); c++) {
+        res += op.res[c];
+        for(int comp = 0; comp < 9; comp++) resv[comp] += op.resv[9 * c + comp];
+        if(op.simpleSum[c]) simpleSum = true;
       }
       if(simpleSum)
         Msg::Info("Step %d: sum = %g %g %g %g %g %g %g %g %g", step, resv[0],
@@ -126,45 +204,9 @@ PView *GMSH_IntegratePlugin::execute(PView *v)
   }
   else {
     int timeBeg = data1->getFirstNonEmptyTimeStep();
-    int timeEnd = data1->getNumTimeSteps();
-    for(int ent = 0; ent < data1->getNumEntities(timeBeg); ent++) {
-      for(int ele = 0; ele < data1->getNumElements(timeBeg, ent); ele++) {
-        if(data1->skipElement(timeBeg, ent, ele)) continue;
-        int dim = data1->getDimension(timeBeg, ent, ele);
-        if((dimension > 0) && (dim != dimension)) continue;
-
-        int numNodes = data1->getNumNodes(timeBeg, ent, ele);
-        int type = data1->getType(timeBeg, ent, ele);
-        int numComp = data1->getNumComponents(timeBeg, ent, ele);
-        if(numComp != 1)
-          Msg::Error("Can only integrate scalar views over time");
-        std::vector<double> *out =
-          data2->incrementList(numComp, type, numNodes);
-        std::vector<double> x(numNodes), y(numNodes), z(numNodes);
-        for(int nod = 0; nod < numNodes; nod++)
-          data1->getNode(timeBeg, ent, ele, nod, x[nod], y[nod], z[nod]);
-        for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
-        for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
-        for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
-
-        std::vector<double> timeIntegral(numNodes, 0.);
-        double time =
-          (overTime > 0) ? data1->getTime(timeBeg + overTime - 1) : 0.0;
-        for(int step = timeBeg + overTime; step < timeEnd; step++) {
-          if(!data1->hasTimeStep(step)) continue;
-          double newTime = data1->getTime(step);
-          double dt = newTime - time;
-          time = newTime;
-          for(int nod = 0; nod < numNodes; nod++) {
-            double val;
-            data1->getValue(step, ent, ele, nod, 0, val);
-            timeIntegral[nod] += val * dt;
-          }
-        }
-        for(int nod = 0; nod < numNodes; nod++)
-          out->push_back(timeIntegral[nod]);
-      }
-    }
+    std::vector<PViewDataList *> out(1, data2);
+    timeIntegralOperation op(data1, timeBeg, overTime, dimension);
+    forEachElement(data1, timeBeg, op, out);
   }
 
   data2->setName(data1->getName() + "_Integrate");
@@ -8,6 +8,7 @@
 #include "MathEval.h"
 #include "mathEvaluator.h"
 #include "OctreePost.h"
+#include "PViewDataGModel.h"
 #include "GEntity.h"
 #include <algorithm>
 
@@ -85,6 +86,137 @@ StringXString *GMSH_MathEvalPlugin::getOptionStr(int iopt)
   return &MathEvalOptions_String[iopt];
 }
 
+class mathEvalOperation : public PluginElementOperation {
+private:
+  PViewData *_data, *_otherData;
+  OctreePost *_octree;
+  const mathEvaluator &_f;
+  // the evaluated time steps
+  std::vector<int> _steps;
+  int _timeBeg, _otherTimeStep, _forceInterpolation, _numComp2;
+  std::vector<char> _entityOk;
+  // per-chunk evaluation buffers; a chunk stops at the first evaluation error
+  std::vector<std::vector<double> > _values, _res, _out;
+  std::vector<std::vector<double *> > _val;
+  std::vector<char> _failed;
+  bool _skip(int ent, int ele)
+  {
+    return !_entityOk[ent] || _data->skipElement(_timeBeg, ent, ele);
+  }
+  // evaluate the expressions at the nodes of element (ent, ele), val[i]
+  // receiving the values at the evaluated step i
+  void _evaluate(int ent, int ele, int chunk, std::vector<double> &x,
+                 std::vector<double> &y, std::vector<double> &z,
+                 std::vector<double *> &val)
+  {
+    int numNodes = x.size();
+    int numComp = _data->getNumComponents(_timeBeg, ent, ele);
+    int otherNumComp = (!_otherData || _octree) ?
+                         9 :
+                         _otherData->getNumComponents(_timeBeg, ent, ele);
+    std::vector<double> v(std::max(9, numComp), 0.);
+    std::vector<double> w(std::max(9, otherNumComp), 0.);
+    std::size_t numVariables = _f.getNumVariables();
+    std::vector<double> &values = _values[chunk], &res = _res[chunk];
+    values.resize(numNodes * numVariables);
+    res.resize(numNodes * _numComp2);
+    for(std::size_t i = 0; i < _steps.size(); i++) {
+      int step = _steps[i];
+      int step2 = (_otherTimeStep < 0) ? step : _otherTimeStep;
+      for(int nod = 0; nod < numNodes; nod++) {
+        for(int comp = 0; comp < numComp; comp++)
+          _data->getValue(step, ent, ele, nod, comp, v[comp]);
+        if(_otherData) {
+          if(_octree) {
+            int qn = _forceInterpolation ? numNodes : 0;
+            if(!_octree->searchScalar(x[nod], y[nod], z[nod], &w[0], step2, 0,
+                                      qn, &x[0], &y[0], &z[0]))
+              if(!_octree->searchVector(x[nod], y[nod], z[nod], &w[0], step2,
+                                        0, qn, &x[0], &y[0], &z[0]))
+                _octree->searchTensor(x[nod], y[nod], z[nod], &w[0], step2, 0,
+                                      qn, &x[0], &y[0], &z[0]);
+          }
+          else
+            for(int comp = 0; comp < otherNumComp; comp++)
+              _otherData->getValue(step2, ent, ele, nod, comp, w[comp]);
+        }
+        double *vals = &values[nod * numVariables];
+        vals[0] = x[nod];
+        vals[1] = y[nod];
+        vals[2] = z[nod];
+        for(int j = 0; j < 9; j++) vals[3 + j] = v[j];
+        for(int j = 0; j < 9; j++) vals[12 + j] = w[j];
+      }
+      // evaluate the expressions at all the nodes at once
+      if(!_f.eval(numNodes, &values[0], &res[0])) {
+        _failed[chunk] = 1;
+        return;
+      }
+      for(int j = 0; j < numNodes * _numComp2; j++) val[i][j] = res[j];
+    }
+  }
+
+public:
+  mathEvalOperation(PViewData *data, PViewData *otherData, OctreePost *octree,
+                    const mathEvaluator &f, const std::vector<int> &steps,
+                    int otherTimeStep, int forceInterpolation,
+                    int physicalRegion, int numComp2)
+    : _data(data), _otherData(otherData), _octree(octree), _f(f),
+      _steps(steps), _timeBeg(steps.empty() ? 0 : steps[0]),
+      _otherTimeStep(otherTimeStep), _forceInterpolation(forceInterpolation),
+      _numComp2(numComp2), _entityOk(data->getNumEntities(_timeBeg), 1),
+      _values(Msg::GetMaxThreads()), _res(Msg::GetMaxThreads()),
+      _out(Msg::GetMaxThreads()), _val(Msg::GetMaxThreads()),
+      _failed(Msg::GetMaxThreads(), 0)
+  {
+    if(physicalRegion <= 0) return;
+    for(std::size_t ent = 0; ent < _entityOk.size(); ent++) {
+      GEntity *ge = data->getEntity(_timeBeg, ent);
+      if(ge)
+        _entityOk[ent] = (std::find(ge->physicals.begin(),
+                                    ge->physicals.end(),
+                                    physicalRegion) != ge->physicals.end());
+    }
+  }
+  void operator()(int ent, int ele, int chunk,
+                  std::vector<PViewDataList *> &lists)
+  {
+    if(_failed[chunk] || _skip(ent, ele)) return;
+    int numNodes = _data->getNumNodes(_timeBeg, ent, ele);
+    int type = _data->getType(_timeBeg, ent, ele);
+    std::vector<double> *out =
+      lists[0]->incrementList(_numComp2, type, numNodes);
+    std::vector<double> x(numNodes), y(numNodes), z(numNodes);
+    for(int nod = 0; nod < numNodes; nod++)
+      _data->getNode(_timeBeg, ent, ele, nod, x[nod], y[nod], z[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
+    for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
+    std::size_t n = numNodes * _numComp2;
+    std::vector<double> &buf = _out[chunk];
+    std::vector<double *> &val = _val[chunk];
+    buf.assign(_steps.size() * n, 0.);
+    val.resize(_steps.size());
+    for(std::size_t i = 0; i < _steps.size(); i++) val[i] = &buf[i * n];
+    _evaluate(ent, ele, chunk, x, y, z, val);
+    out->insert(out->end(), buf.begin(), buf.end());
+  }
+  int getNumOutputNodes(int ent, int ele)
+  {
+    if(_skip(ent, ele)) return 0;
+    return _data->getNumNodes(_timeBeg, ent, ele);
+  }
+  void computeOutput(int ent, int ele, int chunk, std::vector<double *> &val)
+  {
+    if(_failed[chunk]) return;
+    int numNodes = _data->getNumNodes(_timeBeg, ent, ele);
+    std::vector<double> x(numNodes), y(numNodes), z(numNodes);
+    for(int nod = 0; nod < numNodes; nod++)
+      _data->getNode(_timeBeg, ent, ele, nod, x[nod], y[nod], z[nod]);
+    _evaluate(ent, ele, chunk, x, y, z, val);
+  }
+};
+
 PView *GMSH_MathEvalPlugin::execute(PView *view)
 {
   int timeStep = (int)MathEvalOptions_Number[0].def;
@@ -156,7 +288,6 @@ PView *GMSH_MathEvalPlugin::execute(PView *view)
   for(std::size_t i = 0; i < numVariables; i++) variables[i] = names[i];
   mathEvaluator f(expr, variables);
   if(expr.empty()) return view;
-  std::vector<double> values(numVariables), res(numComp2);
 
   OctreePost *octree = 0;
   if(forceInterpolation ||
@@ -166,9 +297,6 @@ PView *GMSH_MathEvalPlugin::execute(PView *view)
     octree = new OctreePost(otherView);
   }
 
-  PView *v2 = new PView();
-  PViewDataList *data2 = getDataList(v2);
-
   if(timeStep < 0) {
     timeStep = -data1->getNumTimeSteps();
   }
@@ -181,85 +309,54 @@ PView *GMSH_MathEvalPlugin::execute(PView *view)
   int firstNonEmptyStep = data1->getFirstNonEmptyTimeStep();
   int timeBeg = (timeStep < 0) ? firstNonEmptyStep : timeStep;
   int timeEnd = (timeStep < 0) ? -timeStep : timeStep + 1;
-  for(int ent = 0; ent < data1->getNumEntities(timeBeg); ent++) {
-    bool ok = (physicalRegion <= 0);
-    if(physicalRegion > 0) {
-      GEntity *ge = data1->getEntity(timeBeg, ent);
-      if(ge) {
-        std::vector<int>::iterator it =
-          std::find(ge->physicals.begin(), ge->physicals.end(), physicalRegion);
-        ok = (it != ge->physicals.end());
-      }
-    }
-    if(!ok) continue;
-    for(int ele = 0; ele < data1->getNumElements(timeBeg, ent); ele++) {
-      if(data1->skipElement(timeBeg, ent, ele)) continue;
-      int numNodes = data1->getNumNodes(timeBeg, ent, ele);
-      int type = data1->getType(timeBeg, ent, ele);
-      int numComp = data1->getNumComponents(timeBeg, ent, ele);
-      int otherNumComp = (!otherData || octree) ?
-                           9 :
-                           otherData->getNumComponents(timeBeg, ent, ele);
-      std::vector<double> *out = data2->incrementList(numComp2, type, numNodes);
-      std::vector<double> v(std::max(9, numComp), 0.);
-      std::vector<double> w(std::max(9, otherNumComp), 0.);
-      std::vector<double> x(numNodes), y(numNodes), z(numNodes);
-      for(int nod = 0; nod < numNodes; nod++)
-        data1->getNode(timeBeg, ent, ele, nod, x[nod], y[nod], z[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
-      for(int step = timeBeg; step < timeEnd; step++) {
-        if(!data1->hasTimeStep(step)) continue;
-        int step2 = (otherTimeStep < 0) ? step : otherTimeStep;
-        for(int nod = 0; nod < numNodes; nod++) {
-          for(int comp = 0; comp < numComp; comp++)
-            data1->getValue(step, ent, ele, nod, comp, v[comp]);
-          if(otherData) {
-            if(octree) {
-              int qn = forceInterpolation ? numNodes : 0;
-              if(!octree->searchScalar(x[nod], y[nod], z[nod], &w[0], step2, 0,
-                                       qn, &x[0], &y[0], &z[0]))
-                if(!octree->searchVector(x[nod], y[nod], z[nod], &w[0], step2,
-                                         0, qn, &x[0], &y[0], &z[0]))
-                  octree->searchTensor(x[nod], y[nod], z[nod], &w[0], step2, 0,
-                                       qn, &x[0], &y[0], &z[0]);
-            }
-            else
-              for(int comp = 0; comp < otherNumComp; comp++)
-                otherData->getValue(step2, ent, ele, nod, comp, w[comp]);
-          }
-          values[0] = x[nod];
-          values[1] = y[nod];
-          values[2] = z[nod];
-          for(int i = 0; i < 9; i++) values[3 + i] = v[i];
-          for(int i = 0; i < 9; i++) values[12 + i] = w[i];
-          if(f.eval(values, res)) {
-            for(int i = 0; i < numComp2; i++) out->push_back(res[i]);
-          }
-          else {
-            goto end;
-          }
-        }
-      }
-    }
-  }
+  std::vector<int> steps;
+  for(int step = timeBeg; step < timeEnd; step++)
+    if(data1->hasTimeStep(step)) steps.push_back(step);
+  mathEvalOperation op(data1, otherData, octree, f, steps, otherTimeStep,
+                       forceInterpolation, physicalRegion, numComp2);
+  // the octree cannot be searched concurrently
+  bool parallel = !octree;
+  if(parallel && otherData != data1)
+    otherData->prepareConcurrentAccess(Msg::GetMaxThreads());
 
-end:
-  if(octree) delete octree;
+  // model-based data (on a single mesh, without interpolation) is evaluated
+  // directly in a new model-based view
+  PViewDataGModel *model1 = getModelData(data1);
+  if(octree || steps.empty()) model1 = 0;
 
-  if(timeStep < 0) {
-    for(int i = firstNonEmptyStep; i < data1->getNumTimeSteps(); i++) {
-      if(!data1->hasTimeStep(i)) continue;
-      data2->Time.push_back(data1->getTime(i));
+  PView *v2;
+  if(model1) {
+    PViewDataGModel *data2 =
+      new PViewDataGModel(PViewDataGModel::ElementNodeData);
+    std::vector<double> times;
+    for(std::size_t i = 0; i < steps.size(); i++)
+      times.push_back(data1->getTime(steps[i]));
+    forEachElement(model1, timeBeg, op, data2, times, numComp2, parallel);
+    data2->setName(data1->getName() + "_MathEval");
+    data2->setFileName(data1->getName() + "_MathEval.msh");
+    data2->finalize();
+    v2 = new PView(data2);
+  }
+  else {
+    v2 = new PView();
+    PViewDataList *data2 = getDataList(v2);
+    std::vector<PViewDataList *> out(1, data2);
+    forEachElement(data1, timeBeg, op, out, parallel);
+    if(timeStep < 0) {
+      for(int i = firstNonEmptyStep; i < data1->getNumTimeSteps(); i++) {
+        if(!data1->hasTimeStep(i)) continue;
+        data2->Time.push_back(data1->getTime(i));
+      }
     }
+    else
+      data2->Time.push_back(data1->getTime(timeStep));
+    data2->setName(data1->getName() + "_MathEval");
+    data2->setFileName(data1->getName() + "_MathEval.pos");
+    data2->finalize();
   }
-  else
-    data2->Time.push_back(data1->getTime(timeStep));
 
-  data2->setName(data1->getName() + "_MathEval");
-  data2->setFileName(data1->getName() + "_MathEval.pos");
-  data2->finalize();
+  if(parallel && otherData != data1) otherData->prepareConcurrentAccess(1);
+  if(octree) delete octree;
 
   return v2;
 }
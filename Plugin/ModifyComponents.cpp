@@ -88,6 +88,79 @@ StringXString *GMSH_ModifyComponentsPlugin::getOptionStr(int iopt)
   return &ModifyComponentsOptions_String[iopt];
 }
 
+class modifyComponentsOperation : public PluginElementOperation {
+private:
+  PViewData *_data, *_otherData;
+  OctreePost *_octree;
+  const mathEvaluator &_f;
+  const std::vector<std::string> &_expressions;
+  int _step, _step2;
+  double _time;
+  int _forceInterpolation;
+
+public:
+  modifyComponentsOperation(PViewData *data, PViewData *otherData,
+                            OctreePost *octree, const mathEvaluator &f,
+                            const std::vector<std::string> &expressions,
+                            int step, int step2, double time,
+                            int forceInterpolation)
+    : _data(data), _otherData(otherData), _octree(octree), _f(f),
+      _expressions(expressions), _step(step), _step2(step2), _time(time),
+      _forceInterpolation(forceInterpolation)
+  {
+  }
+  void operator()(int ent, int ele, int chunk,
+                  std::vector<PViewDataList *> &lists)
+  {
+    if(_data->skipElement(_step, ent, ele)) return;
+    int numComp = _data->getNumComponents(_step, ent, ele);
+    int numComp2 =
+      _octree ? 9 : _otherData->getNumComponents(_step2, ent, ele);
+    int numNodes = _data->getNumNodes(_step, ent, ele);
+    std::vector<double> x(numNodes), y(numNodes), z(numNodes);
+    std::vector<int> tag(numNodes);
+    for(int nod = 0; nod < numNodes; nod++)
+      tag[nod] = _data->getNode(_step, ent, ele, nod, x[nod], y[nod], z[nod]);
+    std::vector<double> values(_f.getNumVariables()), res(9);
+    for(int nod = 0; nod < numNodes; nod++) {
+      if(_data->isNodeData() && tag[nod])
+        continue; // node has already been modified
+      std::vector<double> v(std::max(9, numComp), 0.);
+      for(int comp = 0; comp < numComp; comp++)
+        _data->getValue(_step, ent, ele, nod, comp, v[comp]);
+      std::vector<double> w(std::max(9, numComp2), 0.);
+      if(_octree) {
+        int qn = _forceInterpolation ? numNodes : 0;
+        if(!_octree->searchScalar(x[nod], y[nod], z[nod], &w[0], _step2, 0, qn,
+                                  &x[0], &y[0], &z[0]))
+          if(!_octree->searchVector(x[nod], y[nod], z[nod], &w[0], _step2, 0,
+                                    qn, &x[0], &y[0], &z[0]))
+            _octree->searchTensor(x[nod], y[nod], z[nod], &w[0], _step2, 0, qn,
+                                  &x[0], &y[0], &z[0]);
+      }
+      else {
+        for(int comp = 0; comp < numComp2; comp++)
+          _otherData->getValue(_step2, ent, ele, nod, comp, w[comp]);
+      }
+      values[0] = x[nod];
+      values[1] = y[nod];
+      values[2] = z[nod];
+      values[3] = _time;
+      values[4] = _step;
+      for(int i = 0; i < 9; i++) values[5 + i] = v[i];
+      for(int i = 0; i < 9; i++) values[14 + i] = w[i];
+      if(_f.eval(values, res)) {
+        for(int comp = 0; comp < numComp; comp++) {
+          if(_expressions[comp].size()) {
+            _data->setValue(_step, ent, ele, nod, comp, res[comp]);
+          }
+        }
+      }
+      if(_data->isNodeData()) _data->tagNode(_step, ent, ele, nod, 1);
+    }
+  }
+};
+
 PView *GMSH_ModifyComponentsPlugin::execute(PView *view)
 {
   int timeStep = (int)ModifyComponentsOptions_Number[0].def;
@@ -146,8 +219,6 @@ PView *GMSH_ModifyComponentsPlugin::execute(PView *view)
   for(std::size_t i = 0; i < numVariables; i++) variables[i] = names[i];
   mathEvaluator f(expressions0, variables);
 
-  std::vector<double> values(numVariables), res(9);
-
   OctreePost *octree = 0;
   if(forceInterpolation ||
      (data1->getNumEntities() != data2->getNumEntities()) ||
@@ -173,55 +244,16 @@ PView *GMSH_ModifyComponentsPlugin::execute(PView *view)
       }
     }
 
-    for(int ent = 0; ent < data1->getNumEntities(step); ent++) {
-      for(int ele = 0; ele < data1->getNumElements(step, ent); ele++) {
-        if(data1->skipElement(step, ent, ele)) continue;
-        int numComp = data1->getNumComponents(step, ent, ele);
-        int numComp2 = octree ? 9 : data2->getNumComponents(step2, ent, ele);
-        int numNodes = data1->getNumNodes(step, ent, ele);
-        std::vector<double> x(numNodes), y(numNodes), z(numNodes);
-        std::vector<int> tag(numNodes);
-        for(int nod = 0; nod < numNodes; nod++)
-          tag[nod] =
-            data1->getNode(step, ent, ele, nod, x[nod], y[nod], z[nod]);
-        for(int nod = 0; nod < numNodes; nod++) {
-          if(data1->isNodeData() && tag[nod])
-            continue; // node has already been modified
-          std::vector<double> v(std::max(9, numComp), 0.);
-          for(int comp = 0; comp < numComp; comp++)
-            data1->getValue(step, ent, ele, nod, comp, v[comp]);
-          std::vector<double> w(std::max(9, numComp2), 0.);
-          if(octree) {
-            int qn = forceInterpolation ? numNodes : 0;
-            if(!octree->searchScalar(x[nod], y[nod], z[nod], &w[0], step2, 0,
-                                     qn, &x[0], &y[0], &z[0]))
-              if(!octree->searchVector(x[nod], y[nod], z[nod], &w[0], step2, 0,
-                                       qn, &x[0], &y[0], &z[0]))
-                octree->searchTensor(x[nod], y[nod], z[nod], &w[0], step2, 0,
-                                     qn, &x[0], &y[0], &z[0]);
-          }
-          else {
-            for(int comp = 0; comp < numComp2; comp++)
-              data2->getValue(step2, ent, ele, nod, comp, w[comp]);
-          }
-          values[0] = x[nod];
-          values[1] = y[nod];
-          values[2] = z[nod];
-          values[3] = time;
-          values[4] = step;
-          for(int i = 0; i < 9; i++) values[5 + i] = v[i];
-          for(int i = 0; i < 9; i++) values[14 + i] = w[i];
-          if(f.eval(values, res)) {
-            for(int comp = 0; comp < numComp; comp++) {
-              if(expressions[comp].size()) {
-                data1->setValue(step, ent, ele, nod, comp, res[comp]);
-              }
-            }
-          }
-          if(data1->isNodeData()) data1->tagNode(step, ent, ele, nod, 1);
-        }
-      }
-    }
+    modifyComponentsOperation op(data1, data2, octree, f, expressions, step,
+                                 step2, time, forceInterpolation);
+    // node values are shared between elements and the octree cannot be
+    // searched concurrently: only process element-based data in parallel
+    bool parallel = !data1->isNodeData() && !octree;
+    if(parallel && data2 != data1)
+      data2->prepareConcurrentAccess(Msg::GetMaxThreads());
+    std::vector<PViewDataList *> out;
+    forEachElement(data1, step, op, out, parallel);
+    if(parallel && data2 != data1) data2->prepareConcurrentAccess(1);
   }
 
   if(octree) delete octree;
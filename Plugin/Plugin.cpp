@@ -4,11 +4,13 @@
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <sstream>
+#include <algorithm>
 #include <stdio.h>
 #include <string.h>
 #include "GmshConfig.h"
 #include "Plugin.h"
 #include "PViewData.h"
+#include "PViewDataGModel.h"
 #include "PViewOptions.h"
 #include "Context.h"
 
@@ -16,6 +18,9 @@
 #include "drawContext.h"
 #endif
 
+// minimum number of elements per chunk in GMSH_PostPlugin::forEachElement
+static const int minElementsPerChunk = 1000;
+
 void (*GMSH_Plugin::draw)(void *) = 0;
 
 void GMSH_Plugin::setDrawFunction(void (*fct)(void *))
@@ -104,6 +109,16 @@ PViewData *GMSH_PostPlugin::getPossiblyAdaptiveData(PView *view)
   return view->getData(true);
 }
 
+PViewDataGModel *GMSH_PostPlugin::getModelData(PViewData *data)
+{
+  PViewDataGModel *d = dynamic_cast<PViewDataGModel *>(data);
+  if(!d || d->hasMultipleMeshes() || !d->getNumTimeSteps()) return 0;
+  if(d->getType() == PViewDataGModel::GaussPointData ||
+     d->getType() == PViewDataGModel::BeamData)
+    return 0;
+  return d;
+}
+
 PViewDataList *GMSH_PostPlugin::getDataList(PView *view, bool showError)
 {
   if(!view) return 0;
@@ -116,3 +131,98 @@ PViewDataList *GMSH_PostPlugin::getDataList(PView *view, bool showError)
       "This plugin can only be run on list-based views (`.pos' files)");
   return 0;
 }
+
+void GMSH_PostPlugin::forEachElement(PViewData *data, int step,
+                                     PluginElementOperation &op,
+                                     std::vector<PViewDataList *> &out,
+                                     bool parallel)
+{
+  std::vector<std::pair<int, int> > elements;
+  for(int ent = 0; ent < data->getNumEntities(step); ent++)
+    for(int ele = 0; ele < data->getNumElements(step, ent); ele++)
+      elements.push_back(std::make_pair(ent, ele));
+  int numElements = elements.size();
+
+  int numChunks = 1;
+  if(parallel)
+    numChunks = std::max(1, std::min(Msg::GetMaxThreads(),
+                                     numElements / minElementsPerChunk));
+  if(numChunks == 1) {
+    for(int i = 0; i < numElements; i++)
+      op(elements[i].first, elements[i].second, 0, out);
+    return;
+  }
+
+  // the first chunk is appended directly to the output lists
+  std::vector<std::vector<PViewDataList *> > lists(numChunks, out);
+  for(int c = 1; c < numChunks; c++)
+    for(std::size_t i = 0; i < out.size(); i++)
+      lists[c][i] = new PViewDataList();
+
+  data->prepareConcurrentAccess(Msg::GetMaxThreads());
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static, 1)
+#endif
+  for(int c = 0; c < numChunks; c++) {
+    int beg = (int)((double)numElements * c / numChunks);
+    int end = (int)((double)numElements * (c + 1) / numChunks);
+    for(int i = beg; i < end; i++)
+      op(elements[i].first, elements[i].second, c, lists[c]);
+  }
+  data->prepareConcurrentAccess(1);
+
+  for(int c = 1; c < numChunks; c++) {
+    for(std::size_t i = 0; i < out.size(); i++) {
+      out[i]->importLists(lists[c][i]);
+      delete lists[c][i];
+    }
+  }
+}
+
+void GMSH_PostPlugin::forEachElement(PViewDataGModel *data, int step,
+                                     PluginElementOperation &op,
+                                     PViewDataGModel *out,
+                                     const std::vector<double> &times,
+                                     int numComp, bool parallel)
+{
+  GModel *model = data->getModel(step);
+  int numSteps = times.size();
+  for(int s = 0; s < numSteps; s++) out->addStep(model, s, times[s], numComp);
+
+  // the step data cannot grow concurrently: allocate the values of all the
+  // elements first
+  std::vector<std::pair<int, int> > elements;
+  std::vector<int> nums;
+  for(int ent = 0; ent < data->getNumEntities(step); ent++) {
+    for(int ele = 0; ele < data->getNumElements(step, ent); ele++) {
+      int numNodes = op.getNumOutputNodes(ent, ele);
+      if(!numNodes) continue;
+      int num = data->getElement(step, ent, ele)->getNum();
+      for(int s = 0; s < numSteps; s++)
+        out->getStepData(s)->getData(num, true, numNodes);
+      elements.push_back(std::make_pair(ent, ele));
+      nums.push_back(num);
+    }
+  }
+  int numElements = elements.size();
+
+  int numChunks = 1;
+  if(parallel)
+    numChunks = std::max(1, std::min(Msg::GetMaxThreads(),
+                                     numElements / minElementsPerChunk));
+  if(numChunks > 1) data->prepareConcurrentAccess(Msg::GetMaxThreads());
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static, 1)
+#endif
+  for(int c = 0; c < numChunks; c++) {
+    int beg = (int)((double)numElements * c / numChunks);
+    int end = (int)((double)numElements * (c + 1) / numChunks);
+    std::vector<double *> val(numSteps);
+    for(int i = beg; i < end; i++) {
+      for(int s = 0; s < numSteps; s++)
+        val[s] = out->getStepData(s)->getData(nums[i]);
+      op.computeOutput(elements[i].first, elements[i].second, c, val);
+    }
+  }
+  if(numChunks > 1) data->prepareConcurrentAccess(1);
+}
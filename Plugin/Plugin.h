@@ -14,6 +14,7 @@
 //  in the executable. I think that it's a good way to start.
 
 #include <string>
+#include <vector>
 #include "Options.h"
 #include "GmshMessage.h"
 #include "PView.h"
@@ -21,6 +22,7 @@
 #include "fullMatrix.h"
 
 class PluginDialogBox;
+class PViewDataGModel;
 class Vertex;
 
 class GMSH_Plugin {
@@ -78,6 +80,28 @@ public:
 #endif
 };
 
+// An element-wise operation of a post-processing plugin, applied to all the
+// elements of a view by GMSH_PostPlugin::forEachElement(). The operation is
+// called concurrently on different elements: it should only read the data (or
+// modify the element it is given) and append its results to the given output
+// lists. 'chunk' (< Msg::GetMaxThreads()) identifies the contiguous chunk of
+// elements being processed, e.g. to accumulate partial results.
+class PluginElementOperation {
+public:
+  virtual ~PluginElementOperation() {}
+  virtual void operator()(int ent, int ele, int chunk,
+                          std::vector<PViewDataList *> &out) = 0;
+  // For operations that can write their results directly in a model-based
+  // view: the number of nodes of element (ent, ele) in the output (0 if the
+  // element has no output), and the computation of its values in place, where
+  // val[i] points to the values (node by node) at output step i
+  virtual int getNumOutputNodes(int ent, int ele) { return 0; }
+  virtual void computeOutput(int ent, int ele, int chunk,
+                             std::vector<double *> &val)
+  {
+  }
+};
+
 // The base class for post-processing plugins. The user can either
 // modify or duplicate a post-processing view
 class GMSH_PostPlugin : public GMSH_Plugin {
@@ -103,6 +127,27 @@ public:
   // get the the adapted data (i.e. linear, on refined mesh) if
   // available, otherwise get the original data
   virtual PViewData *getPossiblyAdaptiveData(PView *view);
+  // get the data in model-based format if the results of an element-wise
+  // operation on it can be written directly in a new ElementNodeData view on
+  // the same mesh (see forEachElement()), otherwise 0
+  static PViewDataGModel *getModelData(PViewData *data);
+  // apply op to all the elements of data (as numbered at time step 'step'),
+  // appending its results to the lists out in element order. The elements are
+  // split in contiguous chunks processed in parallel, each chunk filling its
+  // own lists, which are then merged in order. If out is empty, op modifies
+  // the data in place and no copy is made.
+  static void forEachElement(PViewData *data, int step,
+                             PluginElementOperation &op,
+                             std::vector<PViewDataList *> &out,
+                             bool parallel = true);
+  // same as above, but op writes its results directly in out, an
+  // ElementNodeData view on the mesh of data, with one step (with numComp
+  // components) for each time in 'times': the values of all the elements are
+  // allocated first, then filled in parallel without any copy
+  static void forEachElement(PViewDataGModel *data, int step,
+                             PluginElementOperation &op, PViewDataGModel *out,
+                             const std::vector<double> &times, int numComp,
+                             bool parallel = true);
   virtual void assignSpecificVisibility() const {}
   virtual bool geometricalFilter(fullMatrix<double> *) const { return true; }
 };
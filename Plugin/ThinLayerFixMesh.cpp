@@ -871,9 +871,7 @@ void GMSH_ThinLayerFixMeshPlugin::fillTetToTet4()
   GModel *m = GModel::current();
   std::vector<double> vSizes;
   std::vector<double> vSizesBGM;
-  MTet4Factory myFactory(1600000);
-  std::set<MTet4 *, compareTet4Ptr> &allTets = myFactory.getAllTets();
-  std::set<MTet4 *, compareTet4Ptr> activeTets;
+  std::vector<MTet4 *> vecAllTet4;
   int NUM = 0;
 
   for(GModel::riter itr = m->firstRegion(); itr != m->lastRegion(); itr++) {
@@ -898,20 +896,15 @@ void GMSH_ThinLayerFixMeshPlugin::fillTetToTet4()
       }
     }
     for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
-      MTet4 *currentTet4 =
-        myFactory.Create(gr->tetrahedra[i], vSizes, vSizesBGM);
+      // the tets are referenced by TetToTet4 after this function returns, so
+      // they cannot be allocated by a (local) MTet4Factory
+      MTet4 *currentTet4 = new MTet4;
+      currentTet4->setup(gr->tetrahedra[i], vSizes, vSizesBGM);
       TetToTet4[gr->tetrahedra[i]] = currentTet4;
-      allTets.insert(currentTet4);
+      vecAllTet4.push_back(currentTet4);
     }
   }
 
-  std::vector<MTet4 *> vecAllTet4;
-  vecAllTet4.clear();
-  for(std::set<MTet4 *, compareTet4Ptr>::iterator itTp = allTets.begin();
-      itTp != allTets.end(); itTp++) {
-    vecAllTet4.push_back((*itTp));
-    //		//std::cout<<"inserted "<<(*itTp)->tet()->getNum()<<std::endl;
-  }
   connectTets(vecAllTet4);
 }
 
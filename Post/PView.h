@@ -150,9 +150,10 @@ public:
   // fill the vertex arrays, given the current option and data
   bool fillVertexArrays();
 
-  // fill a vertex array using a raw stream of bytes
+  // fill a vertex array using a raw (or compressed) stream of bytes
   static void fillVertexArray(onelab::localNetworkClient *remote, int length,
-                              const char *data, int swap);
+                              const char *data, int swap,
+                              bool compressed = false);
 
   // smoothed normals
   smooth_normals *normals;
@@ -61,6 +61,10 @@ public:
   virtual bool finalize(bool computeMinMax = true,
                         const std::string &interpolationScheme = "");
 
+  // prepare the data for concurrent access by numThreads threads (reading
+  // any element, or modifying distinct elements)
+  virtual void prepareConcurrentAccess(int numThreads) {}
+
   // get/set name
   virtual std::string getName() { return _name; }
   virtual void setName(const std::string &val) { _name = val; }
@@ -253,11 +253,8 @@ bool PViewDataGModel::finalize(bool computeMinMax,
 
 MElement *PViewDataGModel::_getElement(int step, int ent, int ele)
 {
-  static int lastStep = -1, lastEnt = -1, lastEle = -1;
-  static MElement *curr = 0;
-  if(step != lastStep || ent != lastEnt || ele != lastEle)
-    curr = _steps[step]->getEntity(ent)->getMeshElement(ele);
-  return curr;
+  // no cache, so that elements can be accessed concurrently
+  return _steps[step]->getEntity(ent)->getMeshElement(ele);
 }
 
 std::string PViewDataGModel::getFileName(int step)
@@ -261,13 +261,18 @@ public:
                const std::vector<std::vector<double> > &data, int step,
                double time, int partition, int numComp);
 
+  // Add an empty step "on the fly", whose values can then be allocated and
+  // filled directly through getStepData()
+  bool addStep(GModel *model, int step, double time, int numComp);
+
   // Allow to destroy the data
   void destroyData();
   // I/O routines
   bool readMSH(const std::string &viewName, const std::string &fileName,
                int fileIndex, FILE *fp, bool binary, bool swap, int step,
                double time, int partition, int numComp, int numNodes,
-               const std::string &interpolationScheme);
+               const std::string &interpolationScheme,
+               long long dataSize = -1);
   virtual bool writeMSH(const std::string &fileName, double version = 2.2,
                         bool binary = false, bool savemesh = true,
                         bool multipleView = false, int partitionNum = 0,
@@ -3,6 +3,9 @@
 // See the LICENSE.txt file for license information. Please report all
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "PViewDataGModel.h"
@@ -80,17 +83,96 @@ bool PViewDataGModel::addData(GModel *model, const std::vector<int> &tags,
   return true;
 }
 
+bool PViewDataGModel::addStep(GModel *model, int step, double time,
+                              int numComp)
+{
+  if(step < 0 || numComp < 1) return false;
+
+  while(step >= (int)_steps.size())
+    _steps.push_back(new stepData<double>(model, numComp));
+  _steps[step]->fillEntities();
+  _steps[step]->computeBoundingBox();
+  _steps[step]->setTime(time);
+
+  int numEnt = (_type == NodeData) ? model->getNumMeshVertices() :
+                                     model->getNumMeshElements();
+  _steps[step]->resizeData(numEnt);
+  return true;
+}
+
 void PViewDataGModel::destroyData()
 {
   for(std::size_t i = 0; i < _steps.size(); i++) _steps[i]->destroyData();
 }
 
+static void updateMinMax(stepData<double> *s, int numComp, int mult,
+                         double *d, double &min, double &max)
+{
+  for(int j = 0; j < mult; j++) {
+    double val = ComputeScalarRep(numComp, &d[numComp * j]);
+    s->setMin(std::min(s->getMin(), val));
+    s->setMax(std::max(s->getMax(), val));
+    min = std::min(min, val);
+    max = std::max(max, val);
+  }
+}
+
+// parse n ASCII records, one per (null-terminated) line, in parallel. Returns
+// false if a line does not hold exactly one record.
+static bool parseMSHRecords(int n, char **lines, int numComp, bool hasMult,
+                            std::vector<int> &nums, std::vector<int> &mults,
+                            std::vector<std::size_t> &offsets,
+                            std::vector<double> &values)
+{
+  nums.resize(n);
+  mults.assign(n, 1);
+  offsets.resize(n + 1);
+  std::vector<char *> rest(n);
+  int ok = 1;
+#if defined(_OPENMP)
+#pragma omp parallel for reduction(&& : ok)
+#endif
+  for(int i = 0; i < n; i++) {
+    char *p = lines[i], *e;
+    nums[i] = (int)strtol(p, &e, 10);
+    if(e == p) ok = 0;
+    if(hasMult) {
+      p = e;
+      mults[i] = (int)strtol(p, &e, 10);
+      if(e == p || mults[i] < 1) ok = 0;
+    }
+    rest[i] = e;
+  }
+  if(!ok) return false;
+  offsets[0] = 0;
+  for(int i = 0; i < n; i++) offsets[i + 1] = offsets[i] + numComp * mults[i];
+  values.resize(offsets[n]);
+#if defined(_OPENMP)
+#pragma omp parallel for reduction(&& : ok)
+#endif
+  for(int i = 0; i < n; i++) {
+    char *p = rest[i], *e;
+    for(std::size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+      values[j] = strtod(p, &e);
+      if(e == p) {
+        ok = 0;
+        break;
+      }
+      p = e;
+    }
+    while(*p && isspace(*p)) p++;
+    if(*p) ok = 0;
+  }
+  return ok ? true : false;
+}
+
 bool PViewDataGModel::readMSH(const std::string &viewName,
                               const std::string &fileName, int fileIndex,
                               FILE *fp, bool binary, bool swap, int step,
                               double time, int partition, int numComp,
                               int numEnt,
-                              const std::string &interpolationScheme)
+                              const std::string &interpolationScheme,
+                              long long dataSize)
 {
   Msg::Debug("Reading view `%s' step %d (time %g) partition %d: %d records",
              viewName.c_str(), step, time, partition, numEnt);
@@ -113,8 +195,63 @@ bool PViewDataGModel::readMSH(const std::string &viewName,
 
   _steps[step]->resizeData(numEnt);
 
+  bool hasMult = (_type == ElementNodeData || _type == GaussPointData);
+
   Msg::ResetProgressMeter();
-  for(int i = 0; i < numEnt; i++) {
+  int numRead = 0;
+  if(!binary && dataSize > 0) {
+    // read the ASCII records by chunks of complete lines and parse them in
+    // parallel; fall back to the sequential reader below if the records are
+    // not laid out one per line
+    const long long chunkSize = 1 << 24;
+    long long pos = Ftell(fp), end = pos + dataSize;
+    std::vector<char> buf;
+    std::vector<char *> lines;
+    std::vector<int> nums, mults;
+    std::vector<std::size_t> offsets;
+    std::vector<double> values;
+    while(numRead < numEnt && pos < end) {
+      long long n = std::min(chunkSize, end - pos);
+      buf.resize(n + 1);
+      if((long long)fread(&buf[0], 1, n, fp) != n) return false;
+      buf[n] = '\0';
+      lines.clear();
+      char *p = &buf[0], *last = &buf[0] + n;
+      while(p < last && (int)lines.size() < numEnt - numRead) {
+        char *nl = (char *)memchr(p, '\n', last - p);
+        if(!nl) {
+          if(pos + n == end) {
+            lines.push_back(p);
+            p = last;
+          }
+          break;
+        }
+        *nl = '\0';
+        lines.push_back(p);
+        p = nl + 1;
+      }
+      if(lines.empty() ||
+         !parseMSHRecords((int)lines.size(), &lines[0], numComp, hasMult,
+                          nums, mults, offsets, values)) {
+        if(Fseek(fp, pos, SEEK_SET)) return false;
+        break;
+      }
+      for(std::size_t i = 0; i < lines.size(); i++) {
+        if(nums[i] < 0) return false;
+        double *d = _steps[step]->getData(nums[i], true, mults[i]);
+        std::copy(values.begin() + offsets[i], values.begin() + offsets[i + 1],
+                  d);
+        updateMinMax(_steps[step], numComp, mults[i], d, _min, _max);
+        numRead++;
+        if(numEnt > 100000)
+          Msg::ProgressMeter(numRead, numEnt, true, "Reading data");
+      }
+      pos += p - &buf[0];
+      if(Fseek(fp, pos, SEEK_SET)) return false;
+    }
+  }
+
+  for(int i = numRead; i < numEnt; i++) {
     int num;
     if(binary) {
       if(fread(&num, sizeof(int), 1, fp) != 1) return false;
@@ -125,7 +262,7 @@ bool PViewDataGModel::readMSH(const std::string &viewName,
     }
     if(num < 0) return false;
     int mult = 1;
-    if(_type == ElementNodeData || _type == GaussPointData) {
+    if(hasMult) {
       if(binary) {
         if(fread(&mult, sizeof(int), 1, fp) != 1) return false;
         if(swap) SwapBytes((char *)&mult, sizeof(int), 1);
@@ -149,13 +286,7 @@ bool PViewDataGModel::readMSH(const std::string &viewName,
     // datasets (since we would recompute the min/max for all the
     // previously loaded steps/partitions, and thus loop over all the
     // elements many times)
-    for(int j = 0; j < mult; j++) {
-      double val = ComputeScalarRep(numComp, &d[numComp * j]);
-      _steps[step]->setMin(std::min(_steps[step]->getMin(), val));
-      _steps[step]->setMax(std::max(_steps[step]->getMax(), val));
-      _min = std::min(_min, val);
-      _max = std::max(_max, val);
-    }
+    updateMinMax(_steps[step], numComp, mult, d, _min, _max);
     if(numEnt > 100000) Msg::ProgressMeter(i + 1, numEnt, true, "Reading data");
   }
 
@@ -19,9 +19,7 @@ PViewDataList::PViewDataList(bool isAdapted)
     NbVQ(0), NbTQ(0), NbSG(0), NbVG(0), NbTG(0), NbSS(0), NbVS(0), NbTS(0),
     NbSH(0), NbVH(0), NbTH(0), NbSI(0), NbVI(0), NbTI(0), NbSY(0), NbVY(0),
     NbTY(0), NbSR(0), NbVR(0), NbTR(0), NbSD(0), NbVD(0), NbTD(0), NbT2(0),
-    NbT3(0), _lastElement(-1), _lastDimension(-1), _lastNumNodes(-1),
-    _lastNumComponents(-1), _lastNumValues(-1), _lastNumEdges(-1),
-    _lastType(-1), _lastXYZ(0), _lastVal(0), _isAdapted(isAdapted)
+    NbT3(0), _last(1), _isAdapted(isAdapted)
 {
   for(int i = 0; i < 33; i++) _index[i] = 0;
   polyTotNumNodes[0] = 0.;
@@ -66,6 +64,7 @@ bool PViewDataList::finalize(bool computeMinMax,
   BBox.reset();
   Min = VAL_INF;
   Max = -VAL_INF;
+  _last.assign(_last.size(), lastElement());
 
   // finalize text strings first, to get the max value of NbTimeStep
   // for strings-only views (strings are designed to degrade
@@ -294,19 +293,20 @@ void PViewDataList::_stat(std::vector<double> &list, int nbcomp, int nbelm,
   }
 }
 
-void PViewDataList::_setLast(int ele, int dim, int nbnod, int nbcomp, int nbedg,
-                             int type, std::vector<double> &list, int nblist)
+void PViewDataList::_setLast(lastElement &l, int ele, int dim, int nbnod,
+                             int nbcomp, int nbedg, int type,
+                             std::vector<double> &list, int nblist)
 {
   if(haveInterpolationMatrices()) {
     std::vector<fullMatrix<double> *> im;
     if(getInterpolationMatrices(type, im) == 4) nbnod = im[2]->size1();
   }
 
-  _lastDimension = dim;
-  _lastNumNodes = nbnod;
-  _lastNumComponents = nbcomp;
-  _lastNumEdges = nbedg;
-  _lastType = type;
+  l.dimension = dim;
+  l.numNodes = nbnod;
+  l.numComponents = nbcomp;
+  l.numEdges = nbedg;
+  l.type = type;
   int nb = list.size() / nblist; // number of coords and values for the element
   int nbAg =
     ele * nb; // number of coords and values before the ones of the element
@@ -315,125 +315,125 @@ void PViewDataList::_setLast(int ele, int dim, int nbnod, int nbcomp, int nbedg,
     nb = list.size() / polyTotNumNodes[t] * nbnod;
     nbAg = polyAgNumNodes[t][ele] * nb / nbnod;
   }
-  _lastNumValues = (nb - 3 * nbnod) / NbTimeStep;
-  _lastXYZ = &list[nbAg];
-  _lastVal = &list[nbAg + 3 * _lastNumNodes];
+  l.numValues = (nb - 3 * nbnod) / NbTimeStep;
+  l.xyz = &list[nbAg];
+  l.val = &list[nbAg + 3 * l.numNodes];
 }
 
-void PViewDataList::_setLast(int ele)
+void PViewDataList::_setLast(lastElement &l, int ele)
 {
-  _lastElement = ele;
+  l.element = ele;
   if(ele < _index[2]) { // points
     if(ele < _index[0])
-      _setLast(ele, 0, 1, 1, 0, TYPE_PNT, SP, NbSP);
+      _setLast(l, ele, 0, 1, 1, 0, TYPE_PNT, SP, NbSP);
     else if(ele < _index[1])
-      _setLast(ele - _index[0], 0, 1, 3, 0, TYPE_PNT, VP, NbVP);
+      _setLast(l, ele - _index[0], 0, 1, 3, 0, TYPE_PNT, VP, NbVP);
     else
-      _setLast(ele - _index[1], 0, 1, 9, 0, TYPE_PNT, TP, NbTP);
+      _setLast(l, ele - _index[1], 0, 1, 9, 0, TYPE_PNT, TP, NbTP);
   }
   else if(ele < _index[5]) { // lines
     if(ele < _index[3])
-      _setLast(ele - _index[2], 1, 2, 1, 1, TYPE_LIN, SL, NbSL);
+      _setLast(l, ele - _index[2], 1, 2, 1, 1, TYPE_LIN, SL, NbSL);
     else if(ele < _index[4])
-      _setLast(ele - _index[3], 1, 2, 3, 1, TYPE_LIN, VL, NbVL);
+      _setLast(l, ele - _index[3], 1, 2, 3, 1, TYPE_LIN, VL, NbVL);
     else
-      _setLast(ele - _index[4], 1, 2, 9, 1, TYPE_LIN, TL, NbTL);
+      _setLast(l, ele - _index[4], 1, 2, 9, 1, TYPE_LIN, TL, NbTL);
   }
   else if(ele < _index[8]) { // triangles
     if(ele < _index[6])
-      _setLast(ele - _index[5], 2, 3, 1, 3, TYPE_TRI, ST, NbST);
+      _setLast(l, ele - _index[5], 2, 3, 1, 3, TYPE_TRI, ST, NbST);
     else if(ele < _index[7])
-      _setLast(ele - _index[6], 2, 3, 3, 3, TYPE_TRI, VT, NbVT);
+      _setLast(l, ele - _index[6], 2, 3, 3, 3, TYPE_TRI, VT, NbVT);
     else
-      _setLast(ele - _index[7], 2, 3, 9, 3, TYPE_TRI, TT, NbTT);
+      _setLast(l, ele - _index[7], 2, 3, 9, 3, TYPE_TRI, TT, NbTT);
   }
   else if(ele < _index[11]) { // quadrangles
     if(ele < _index[9])
-      _setLast(ele - _index[8], 2, 4, 1, 4, TYPE_QUA, SQ, NbSQ);
+      _setLast(l, ele - _index[8], 2, 4, 1, 4, TYPE_QUA, SQ, NbSQ);
     else if(ele < _index[10])
-      _setLast(ele - _index[9], 2, 4, 3, 4, TYPE_QUA, VQ, NbVQ);
+      _setLast(l, ele - _index[9], 2, 4, 3, 4, TYPE_QUA, VQ, NbVQ);
     else
-      _setLast(ele - _index[10], 2, 4, 9, 4, TYPE_QUA, TQ, NbTQ);
+      _setLast(l, ele - _index[10], 2, 4, 9, 4, TYPE_QUA, TQ, NbTQ);
   }
   else if(ele < _index[14]) { // tetrahedra
     if(ele < _index[12])
-      _setLast(ele - _index[11], 3, 4, 1, 6, TYPE_TET, SS, NbSS);
+      _setLast(l, ele - _index[11], 3, 4, 1, 6, TYPE_TET, SS, NbSS);
     else if(ele < _index[13])
-      _setLast(ele - _index[12], 3, 4, 3, 6, TYPE_TET, VS, NbVS);
+      _setLast(l, ele - _index[12], 3, 4, 3, 6, TYPE_TET, VS, NbVS);
     else
-      _setLast(ele - _index[13], 3, 4, 9, 6, TYPE_TET, TS, NbTS);
+      _setLast(l, ele - _index[13], 3, 4, 9, 6, TYPE_TET, TS, NbTS);
   }
   else if(ele < _index[17]) { // hexahedra
     if(ele < _index[15])
-      _setLast(ele - _index[14], 3, 8, 1, 12, TYPE_HEX, SH, NbSH);
+      _setLast(l, ele - _index[14], 3, 8, 1, 12, TYPE_HEX, SH, NbSH);
     else if(ele < _index[16])
-      _setLast(ele - _index[15], 3, 8, 3, 12, TYPE_HEX, VH, NbVH);
+      _setLast(l, ele - _index[15], 3, 8, 3, 12, TYPE_HEX, VH, NbVH);
     else
-      _setLast(ele - _index[16], 3, 8, 9, 12, TYPE_HEX, TH, NbTH);
+      _setLast(l, ele - _index[16], 3, 8, 9, 12, TYPE_HEX, TH, NbTH);
   }
   else if(ele < _index[20]) { // prisms
     if(ele < _index[18])
-      _setLast(ele - _index[17], 3, 6, 1, 9, TYPE_PRI, SI, NbSI);
+      _setLast(l, ele - _index[17], 3, 6, 1, 9, TYPE_PRI, SI, NbSI);
     else if(ele < _index[19])
-      _setLast(ele - _index[18], 3, 6, 3, 9, TYPE_PRI, VI, NbVI);
+      _setLast(l, ele - _index[18], 3, 6, 3, 9, TYPE_PRI, VI, NbVI);
     else
-      _setLast(ele - _index[19], 3, 6, 9, 9, TYPE_PRI, TI, NbTI);
+      _setLast(l, ele - _index[19], 3, 6, 9, 9, TYPE_PRI, TI, NbTI);
   }
   else if(ele < _index[23]) { // pyramids
     if(ele < _index[21])
-      _setLast(ele - _index[20], 3, 5, 1, 8, TYPE_PYR, SY, NbSY);
+      _setLast(l, ele - _index[20], 3, 5, 1, 8, TYPE_PYR, SY, NbSY);
     else if(ele < _index[22])
-      _setLast(ele - _index[21], 3, 5, 3, 8, TYPE_PYR, VY, NbVY);
+      _setLast(l, ele - _index[21], 3, 5, 3, 8, TYPE_PYR, VY, NbVY);
     else
-      _setLast(ele - _index[22], 3, 5, 9, 8, TYPE_PYR, TY, NbTY);
+      _setLast(l, ele - _index[22], 3, 5, 9, 8, TYPE_PYR, TY, NbTY);
   }
   else if(ele < _index[26]) { // trihedra
     if(ele < _index[24])
-      _setLast(ele - _index[23], 3, 4, 1, 5, TYPE_TRIH, SR, NbSR);
+      _setLast(l, ele - _index[23], 3, 4, 1, 5, TYPE_TRIH, SR, NbSR);
     else if(ele < _index[25])
-      _setLast(ele - _index[24], 3, 4, 3, 5, TYPE_TRIH, VR, NbVR);
+      _setLast(l, ele - _index[24], 3, 4, 3, 5, TYPE_TRIH, VR, NbVR);
     else
-      _setLast(ele - _index[25], 3, 4, 9, 5, TYPE_TRIH, TR, NbTR);
+      _setLast(l, ele - _index[25], 3, 4, 9, 5, TYPE_TRIH, TR, NbTR);
   }
   else if(ele < _index[29]) { // polygons
     int nN = polyNumNodes[0][ele - _index[26]];
     if(ele < _index[27])
-      _setLast(ele - _index[26], 2, nN, 1, nN, TYPE_POLYG, SG, NbSG);
+      _setLast(l, ele - _index[26], 2, nN, 1, nN, TYPE_POLYG, SG, NbSG);
     else if(ele < _index[28])
-      _setLast(ele - _index[27], 2, nN, 3, nN, TYPE_POLYG, VG, NbVG);
+      _setLast(l, ele - _index[27], 2, nN, 3, nN, TYPE_POLYG, VG, NbVG);
     else
-      _setLast(ele - _index[28], 2, nN, 9, nN, TYPE_POLYG, TG, NbTG);
+      _setLast(l, ele - _index[28], 2, nN, 9, nN, TYPE_POLYG, TG, NbTG);
   }
   else if(ele < _index[32]) { // polyhedra
     int nN = polyNumNodes[1][ele - _index[29]];
     if(ele < _index[30])
-      _setLast(ele - _index[29], 3, nN, 1, nN * 1.5, TYPE_POLYH, SD, NbSD);
+      _setLast(l, ele - _index[29], 3, nN, 1, nN * 1.5, TYPE_POLYH, SD, NbSD);
     else if(ele < _index[32])
-      _setLast(ele - _index[30], 3, nN, 3, nN * 1.5, TYPE_POLYH, VD, NbVD);
+      _setLast(l, ele - _index[30], 3, nN, 3, nN * 1.5, TYPE_POLYH, VD, NbVD);
     else
-      _setLast(ele - _index[31], 3, nN, 9, nN * 1.5, TYPE_POLYH, TD, NbTD);
+      _setLast(l, ele - _index[31], 3, nN, 9, nN * 1.5, TYPE_POLYH, TD, NbTD);
   }
 }
 
 int PViewDataList::getDimension(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastDimension;
+  lastElement &l = _getLast(ele);
+  return l.dimension;
 }
 
 int PViewDataList::getNumNodes(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumNodes;
+  lastElement &l = _getLast(ele);
+  return l.numNodes;
 }
 
 int PViewDataList::getNode(int step, int ent, int ele, int nod, double &x,
                            double &y, double &z)
 {
-  if(ele != _lastElement) _setLast(ele);
-  x = _lastXYZ[nod];
-  y = _lastXYZ[_lastNumNodes + nod];
-  z = _lastXYZ[2 * _lastNumNodes + nod];
+  lastElement &l = _getLast(ele);
+  x = l.xyz[nod];
+  y = l.xyz[l.numNodes + nod];
+  z = l.xyz[2 * l.numNodes + nod];
   return 0;
 }
 
@@ -441,59 +441,59 @@ void PViewDataList::setNode(int step, int ent, int ele, int nod, double x,
                             double y, double z)
 {
   if(step) return;
-  if(ele != _lastElement) _setLast(ele);
-  _lastXYZ[nod] = x;
-  _lastXYZ[_lastNumNodes + nod] = y;
-  _lastXYZ[2 * _lastNumNodes + nod] = z;
+  lastElement &l = _getLast(ele);
+  l.xyz[nod] = x;
+  l.xyz[l.numNodes + nod] = y;
+  l.xyz[2 * l.numNodes + nod] = z;
 }
 
 int PViewDataList::getNumComponents(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumComponents;
+  lastElement &l = _getLast(ele);
+  return l.numComponents;
 }
 
 int PViewDataList::getNumValues(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumValues;
+  lastElement &l = _getLast(ele);
+  return l.numValues;
 }
 
 void PViewDataList::getValue(int step, int ent, int ele, int idx, double &val)
 {
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
   if(step >= NbTimeStep) step = 0;
-  val = _lastVal[step * _lastNumValues + idx];
+  val = l.val[step * l.numValues + idx];
 }
 
 void PViewDataList::getValue(int step, int ent, int ele, int nod, int comp,
                              double &val)
 {
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
   if(step >= NbTimeStep) step = 0;
-  val = _lastVal[step * _lastNumNodes * _lastNumComponents +
-                 nod * _lastNumComponents + comp];
+  val = l.val[step * l.numNodes * l.numComponents +
+                 nod * l.numComponents + comp];
 }
 
 void PViewDataList::setValue(int step, int ent, int ele, int nod, int comp,
                              double val)
 {
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
   if(step >= NbTimeStep) step = 0;
-  _lastVal[step * _lastNumNodes * _lastNumComponents +
-           nod * _lastNumComponents + comp] = val;
+  l.val[step * l.numNodes * l.numComponents +
+           nod * l.numComponents + comp] = val;
 }
 
 int PViewDataList::getNumEdges(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumEdges;
+  lastElement &l = _getLast(ele);
+  return l.numEdges;
 }
 
 int PViewDataList::getType(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastType;
+  lastElement &l = _getLast(ele);
+  return l.type;
 }
 
 void PViewDataList::_getString(int dim, int i, int step, std::string &str,
@@ -564,29 +564,29 @@ void PViewDataList::getString3D(int i, int step, std::string &str, double &x,
 void PViewDataList::reverseElement(int step, int ent, int ele)
 {
   if(step) return;
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
 
   // copy data
-  std::vector<double> XYZ(3 * _lastNumNodes);
-  for(std::size_t i = 0; i < XYZ.size(); i++) XYZ[i] = _lastXYZ[i];
+  std::vector<double> XYZ(3 * l.numNodes);
+  for(std::size_t i = 0; i < XYZ.size(); i++) XYZ[i] = l.xyz[i];
 
-  std::vector<double> V(_lastNumNodes * _lastNumComponents * getNumTimeSteps());
-  for(std::size_t i = 0; i < V.size(); i++) V[i] = _lastVal[i];
+  std::vector<double> V(l.numNodes * l.numComponents * getNumTimeSteps());
+  for(std::size_t i = 0; i < V.size(); i++) V[i] = l.val[i];
 
   // reverse node order
-  for(int i = 0; i < _lastNumNodes; i++) {
-    _lastXYZ[i] = XYZ[_lastNumNodes - i - 1];
-    _lastXYZ[_lastNumNodes + i] = XYZ[2 * _lastNumNodes - i - 1];
-    _lastXYZ[2 * _lastNumNodes + i] = XYZ[3 * _lastNumNodes - i - 1];
+  for(int i = 0; i < l.numNodes; i++) {
+    l.xyz[i] = XYZ[l.numNodes - i - 1];
+    l.xyz[l.numNodes + i] = XYZ[2 * l.numNodes - i - 1];
+    l.xyz[2 * l.numNodes + i] = XYZ[3 * l.numNodes - i - 1];
   }
 
   for(int step = 0; step < getNumTimeSteps(); step++)
-    for(int i = 0; i < _lastNumNodes; i++)
-      for(int k = 0; k < _lastNumComponents; k++)
-        _lastVal[_lastNumComponents * _lastNumNodes * step +
-                 _lastNumComponents * i + k] =
-          V[_lastNumComponents * _lastNumNodes * step +
-            _lastNumComponents * (_lastNumNodes - i - 1) + k];
+    for(int i = 0; i < l.numNodes; i++)
+      for(int k = 0; k < l.numComponents; k++)
+        l.val[l.numComponents * l.numNodes * step +
+                 l.numComponents * i + k] =
+          V[l.numComponents * l.numNodes * step +
+            l.numComponents * (l.numNodes - i - 1) + k];
 }
 
 static void generateConnectivities(std::vector<double> &list, int nbList,
@@ -951,6 +951,38 @@ bool PViewDataList::combineTime(nameData &nd)
   return finalize();
 }
 
+void PViewDataList::importLists(PViewDataList *l)
+{
+  for(int i = 0; i < 27; i++) {
+    std::vector<double> *list, *list2;
+    int *nbe, *nbe2, nbc, nbn;
+    _getRawData(i, &list, &nbe, &nbc, &nbn);
+    l->_getRawData(i, &list2, &nbe2, &nbc, &nbn);
+    list->insert(list->end(), list2->begin(), list2->end());
+    *nbe += *nbe2;
+  }
+  // polygons and polyhedra also store their number of nodes
+  std::vector<double> *poly[2][3] = {{&SG, &VG, &TG}, {&SD, &VD, &TD}};
+  std::vector<double> *poly2[2][3] = {{&l->SG, &l->VG, &l->TG},
+                                      {&l->SD, &l->VD, &l->TD}};
+  int *nbPoly[2][3] = {{&NbSG, &NbVG, &NbTG}, {&NbSD, &NbVD, &NbTD}};
+  int nbPoly2[2][3] = {{l->NbSG, l->NbVG, l->NbTG},
+                       {l->NbSD, l->NbVD, l->NbTD}};
+  for(int t = 0; t < 2; t++) {
+    for(int i = 0; i < 3; i++) {
+      poly[t][i]->insert(poly[t][i]->end(), poly2[t][i]->begin(),
+                         poly2[t][i]->end());
+      *nbPoly[t][i] += nbPoly2[t][i];
+    }
+    for(std::size_t j = 0; j < l->polyNumNodes[t].size(); j++) {
+      int nN = l->polyNumNodes[t][j];
+      polyNumNodes[t].push_back(nN);
+      polyAgNumNodes[t].push_back(polyAgNumNodes[t].back() + nN);
+    }
+    polyTotNumNodes[t] += l->polyTotNumNodes[t];
+  }
+}
+
 int PViewDataList::_getRawData(int idxtype, std::vector<double> **l, int **ne,
                                int *nc, int *nn)
 {
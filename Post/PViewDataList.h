@@ -9,6 +9,8 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
+#include "GmshMessage.h"
 #include "PViewData.h"
 #include "SBoundingBox3d.h"
 
@@ -54,17 +56,32 @@ public:
 
 private:
   int _index[33];
-  int _lastElement, _lastDimension;
-  int _lastNumNodes, _lastNumComponents, _lastNumValues, _lastNumEdges,
-    _lastType;
-  double *_lastXYZ, *_lastVal;
+  // cache of the last accessed element, one per thread
+  struct lastElement {
+    int element, dimension, numNodes, numComponents, numValues, numEdges,
+      type;
+    double *xyz, *val;
+    lastElement()
+      : element(-1), dimension(-1), numNodes(-1), numComponents(-1),
+        numValues(-1), numEdges(-1), type(-1), xyz(0), val(0)
+    {
+    }
+  };
+  std::vector<lastElement> _last;
   bool _isAdapted;
   void _stat(std::vector<double> &D, std::vector<char> &C, int nb);
   void _stat(std::vector<double> &list, int nbcomp, int nbelm, int nbnod,
              int type);
-  void _setLast(int ele);
-  void _setLast(int ele, int dim, int nbnod, int nbcomp, int nbedg, int type,
-                std::vector<double> &list, int nblist);
+  lastElement &_getLast(int ele)
+  {
+    int t = (_last.size() > 1) ? Msg::GetThreadNum() : 0;
+    lastElement &l = _last[(t < (int)_last.size()) ? t : 0];
+    if(ele != l.element) _setLast(l, ele);
+    return l;
+  }
+  void _setLast(lastElement &l, int ele);
+  void _setLast(lastElement &l, int ele, int dim, int nbnod, int nbcomp,
+                int nbedg, int type, std::vector<double> &list, int nblist);
   void _getString(int dim, int i, int timestep, std::string &str, double &x,
                   double &y, double &z, double &style);
   int _getRawData(int idxtype, std::vector<double> **l, int **ne, int *nc,
@@ -76,6 +93,10 @@ public:
   bool isAdapted() { return _isAdapted; }
   bool finalize(bool computeMinMax = true,
                 const std::string &interpolationScheme = "");
+  void prepareConcurrentAccess(int numThreads)
+  {
+    _last.assign(std::max(1, numThreads), lastElement());
+  }
   int getNumTimeSteps() { return NbTimeStep; }
   double getTime(int step);
   double getMin(int step = -1, bool onlyVisible = false, int tensorRep = 0,
@@ -125,6 +146,8 @@ public:
   void smooth();
   bool combineTime(nameData &nd);
   bool combineSpace(nameData &nd);
+  // append the elements of l at the end of the element lists
+  void importLists(PViewDataList *l);
   void setXY(std::vector<double> &x, std::vector<double> &y);
   void setXYZV(std::vector<double> &x, std::vector<double> &y,
                std::vector<double> &z, std::vector<double> &v);
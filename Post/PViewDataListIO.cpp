@@ -4,7 +4,9 @@
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <string.h>
+#include <stdlib.h>
 #include <set>
+#include <algorithm>
 #include "PViewDataList.h"
 #include "MElement.h"
 #include "Numeric.h"
@@ -16,22 +18,118 @@
 #include "adaptiveData.h"
 #include "OS.h"
 
+static bool isBlank(char c)
+{
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' ||
+         c == '\f';
+}
+
+// parse the first n whitespace-separated numbers of the (null-terminated)
+// text buf into v, by splitting the text into one segment per thread. Returns
+// the number of values read and sets end to the first character after the
+// last value read; returns -1 on a parse error.
+static int parseDoubles(char *buf, std::size_t len, double *v, int n,
+                        char *&end)
+{
+  int numSegments = 1;
+#if defined(_OPENMP)
+  if(len > (1 << 16)) numSegments = Msg::GetMaxThreads();
+#endif
+  // segment boundaries, moved to the start of a token
+  std::vector<std::size_t> beg(numSegments + 1, len);
+  beg[0] = 0;
+  for(int t = 1; t < numSegments; t++) {
+    std::size_t p = std::max(beg[t - 1], len * t / numSegments);
+    while(p < len && p > 0 && !isBlank(buf[p - 1])) p++;
+    beg[t] = p;
+  }
+  // count the tokens of each segment
+  std::vector<int> count(numSegments + 1, 0);
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+  for(int t = 0; t < numSegments; t++) {
+    int c = 0;
+    for(std::size_t p = beg[t]; p < beg[t + 1]; p++)
+      if(!isBlank(buf[p]) && (p == 0 || isBlank(buf[p - 1]))) c++;
+    count[t + 1] = c;
+  }
+  for(int t = 0; t < numSegments; t++) count[t + 1] += count[t];
+  // parse the tokens in place
+  int numRead = std::min(n, count[numSegments]), ok = 1;
+  std::vector<char *> segmentEnd(numSegments, (char *)0);
+#if defined(_OPENMP)
+#pragma omp parallel for reduction(&& : ok)
+#endif
+  for(int t = 0; t < numSegments; t++) {
+    char *p = buf + beg[t], *e;
+    for(int i = count[t]; i < std::min(count[t + 1], numRead); i++) {
+      v[i] = strtod(p, &e);
+      if(e == p) {
+        ok = 0;
+        break;
+      }
+      p = e;
+      segmentEnd[t] = e;
+    }
+    // all the tokens of the segment should have been consumed
+    if(ok && count[t + 1] <= numRead) {
+      while(p < buf + beg[t + 1] && isBlank(*p)) p++;
+      if(p != buf + beg[t + 1]) ok = 0;
+    }
+  }
+  if(!ok) return -1;
+  end = buf;
+  for(int t = 0; t < numSegments; t++)
+    if(segmentEnd[t]) end = segmentEnd[t];
+  return numRead;
+}
+
+// read n ASCII numbers in bulk: the text is read by chunks, parsed in
+// parallel, and the file position is set right after the last number
+static bool dVecReadASCII(double *v, int n, FILE *fp)
+{
+  const std::size_t chunkSize = 1 << 24;
+  std::vector<char> buf;
+  int done = 0;
+  while(done < n) {
+    long long start = Ftell(fp);
+    std::size_t size = std::min(chunkSize, (std::size_t)(n - done) * 32 + 64);
+    buf.resize(size + 1);
+    std::size_t len = fread(&buf[0], 1, size, fp);
+    if(!len) return false;
+    if(len == size) {
+      // do not split the last token of the chunk
+      while(len > 0 && !isBlank(buf[len - 1])) len--;
+      if(!len) return false;
+    }
+    buf[len] = '\0';
+    char *end = &buf[0];
+    int numRead = parseDoubles(&buf[0], len, v + done, n - done, end);
+    if(numRead < 0) return false;
+    if(!numRead && len < size) return false;
+    done += numRead;
+    if(Fseek(fp, start + (long long)(end - &buf[0]), SEEK_SET)) return false;
+    if(!numRead) {
+      // whitespace only: skip it
+      if(Fseek(fp, start + (long long)len, SEEK_SET)) return false;
+    }
+  }
+  return true;
+}
+
 static void dVecRead(std::vector<double> &v, int n, FILE *fp, bool binary,
                      int swap)
 {
   if(!n) return;
   v.resize(n);
   if(binary) {
-    if(!fread(&v[0], sizeof(double), n, fp)) Msg::Error("Read error");
+    if((int)fread(&v[0], sizeof(double), n, fp) != n)
+      Msg::Error("Read error");
     if(swap) SwapBytes((char *)&v[0], sizeof(double), n);
   }
   else {
-    for(int i = 0; i < n; i++) {
-      if(!fscanf(fp, "%lf", &v[i])) {
-        Msg::Error("Read error");
-        break;
-      }
-    }
+    if(!dVecReadASCII(&v[0], n, fp)) Msg::Error("Read error");
   }
 }
 
@@ -72,10 +170,33 @@ static void cVecRead(std::vector<char> &v, int n, FILE *fp, bool binary,
 static void dVecWrite(std::vector<double> &v, FILE *fp, bool binary)
 {
   if(v.empty()) return;
-  if(binary)
+  if(binary) {
     fwrite(&v[0], sizeof(double), v.size(), fp);
-  else
-    for(unsigned i = 0; i < v.size(); i++) fprintf(fp, " %.16g", v[i]);
+    return;
+  }
+  // format blocks of values in parallel and write them in order
+  const std::size_t blockSize = 1 << 16;
+  std::size_t numBlocks = (v.size() + blockSize - 1) / blockSize;
+  int numThreads = Msg::GetMaxThreads();
+  std::vector<std::string> text(numThreads);
+  for(std::size_t b0 = 0; b0 < numBlocks; b0 += numThreads) {
+    int nb = (int)std::min((std::size_t)numThreads, numBlocks - b0);
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+    for(int b = 0; b < nb; b++) {
+      std::size_t beg = (b0 + b) * blockSize;
+      std::size_t end = std::min(beg + blockSize, v.size());
+      std::string &s = text[b];
+      s.clear();
+      char str[64];
+      for(std::size_t i = beg; i < end; i++) {
+        sprintf(str, " %.16g", v[i]);
+        s += str;
+      }
+    }
+    for(int b = 0; b < nb; b++) fwrite(text[b].c_str(), 1, text[b].size(), fp);
+  }
 }
 
 static void cVecWrite(std::vector<char> &v, FILE *fp, bool binary)
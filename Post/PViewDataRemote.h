@@ -9,8 +9,10 @@
 #include <vector>
 #include <string>
 #include "GmshMessage.h"
+#include "Context.h"
 #include "PViewData.h"
 #include "SBoundingBox3d.h"
+#include "VertexArray.h"
 #include "onelab.h"
 
 // The container for a remote dataset (does not contain any actual data)
@@ -21,12 +23,17 @@ private:
   int _numTimeSteps;
   double _time;
   SBoundingBox3d _bbox;
+  // reference arrays for the delta-encoding of compressed vertex arrays
+  // received from the remote server, and whether it should send plain arrays
+  // (and reset its own references) at the next request
+  VertexArrayHistory _vertexArrayHistory;
+  bool _resetVertexArrays;
 
 public:
   PViewDataRemote(onelab::localNetworkClient *remote, double min, double max,
                   int numsteps, double time, SBoundingBox3d &bbox)
     : _remote(remote), _min(min), _max(max), _numTimeSteps(numsteps),
-      _time(time), _bbox(bbox)
+      _time(time), _bbox(bbox), _resetVertexArrays(false)
   {
   }
   ~PViewDataRemote() {}
@@ -55,6 +62,13 @@ public:
   void setBoundingBox(SBoundingBox3d &bbox) { _bbox = bbox; }
   void setTime(double time) { _time = time; }
   bool isRemote() { return true; }
+  onelab::localNetworkClient *getRemote() { return _remote; }
+  VertexArrayHistory &getVertexArrayHistory() { return _vertexArrayHistory; }
+  void resetVertexArrays()
+  {
+    _vertexArrayHistory.clear();
+    _resetVertexArrays = true;
+  }
   int fillRemoteVertexArrays(std::string &options)
   {
     GmshServer *server = _remote->getGmshServer();
@@ -63,7 +77,12 @@ public:
       return 1;
     }
     setDirty(true);
-    server->SendString(GmshSocket::GMSH_VERTEX_ARRAY, options.c_str());
+    server->SendString((CTX::instance()->solver.remoteCompression &&
+                        !_resetVertexArrays) ?
+                         GmshSocket::GMSH_VERTEX_ARRAY_COMPRESSED :
+                         GmshSocket::GMSH_VERTEX_ARRAY,
+                       options.c_str());
+    _resetVertexArrays = false;
     return 1;
   }
 };
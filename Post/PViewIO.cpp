@@ -81,23 +81,118 @@ bool PView::readPOS(const std::string &fileName, int fileIndex)
   return true;
 }
 
-bool PView::readMSH(const std::string &fileName, int fileIndex, int partitionToRead)
+// header of a $NodeData, $ElementData or $ElementNodeData section
+struct mshDataHeader {
+  PViewDataGModel::DataType type;
+  std::string viewName, interpolationScheme;
+  double time;
+  int timeStep, numComp, numEnt, partition;
+  long long blocksize;
+};
+
+// a section of an MSH file relevant to post-processing, as found by
+// indexMSH()
+struct mshSection {
+  bool data; // data section or $InterpolationScheme
+  long long offset; // position just after the section header line
+  long long dataSize; // size of the data in bytes (-1 if unknown)
+  bool binary, swap;
+  mshDataHeader header;
+};
+
+static bool readMSHDataHeader(FILE *fp, const char *section, mshDataHeader &h)
 {
-  FILE *fp = Fopen(fileName.c_str(), "rb");
-  if(!fp) {
-    Msg::Error("Unable to open file '%s'", fileName.c_str());
-    return false;
+  if(!strncmp(section, "NodeData", 8))
+    h.type = PViewDataGModel::NodeData;
+  else if(!strncmp(section, "ElementData", 11))
+    h.type = PViewDataGModel::ElementData;
+  else
+    h.type = PViewDataGModel::ElementNodeData;
+
+  char str[256];
+  int numTags;
+  // string tags
+  if(!fgets(str, sizeof(str), fp)) return false;
+  if(sscanf(str, "%d", &numTags) != 1) return false;
+  for(int i = 0; i < numTags; i++) {
+    if(!fgets(str, sizeof(str), fp)) return false;
+    if(i == 0)
+      h.viewName = ExtractDoubleQuotedString(str, sizeof(str));
+    else if(i == 1)
+      h.interpolationScheme = ExtractDoubleQuotedString(str, sizeof(str));
   }
+  // double tags
+  h.time = 0.;
+  if(!fgets(str, sizeof(str), fp)) return false;
+  if(sscanf(str, "%d", &numTags) != 1) return false;
+  for(int i = 0; i < numTags; i++) {
+    if(!fgets(str, sizeof(str), fp)) return false;
+    if(i == 0) {
+      if(sscanf(str, "%lf", &h.time) != 1) return false;
+    }
+  }
+  // integer tags
+  h.timeStep = h.numComp = h.numEnt = h.partition = 0;
+  h.blocksize = 0;
+  if(!fgets(str, sizeof(str), fp)) return false;
+  if(sscanf(str, "%d", &numTags) != 1) return false;
+  for(int i = 0; i < numTags; i++) {
+    if(!fgets(str, sizeof(str), fp)) return false;
+    if(i == 0) {
+      if(sscanf(str, "%d", &h.timeStep) != 1) return false;
+    }
+    else if(i == 1) {
+      if(sscanf(str, "%d", &h.numComp) != 1) return false;
+    }
+    else if(i == 2) {
+      if(sscanf(str, "%d", &h.numEnt) != 1) return false;
+    }
+    else if(i == 3) {
+      if(sscanf(str, "%d", &h.partition) != 1) return false;
+    }
+    else if(i == 4) {
+      if(sscanf(str, "%lld", &h.blocksize) != 1) return false;
+    }
+  }
+  return true;
+}
 
-  GModel *model = GModel::current();
-  if(model->empty()) {
-    Msg::Error("Model is empty: please load a mesh before loading the dataset");
-    fclose(fp);
-    return false;
+static bool readMSHInterpolationScheme(FILE *fp)
+{
+  char str[256];
+  if(!fgets(str, sizeof(str), fp)) return false;
+  std::string name = ExtractDoubleQuotedString(str, sizeof(str));
+  Msg::Debug("Reading interpolation scheme '%s'", name.c_str());
+  PViewData::removeInterpolationScheme(name);
+  int numTypes;
+  if(fscanf(fp, "%d", &numTypes) != 1) return false;
+  for(int i = 0; i < numTypes; i++) {
+    int type, numMatrices;
+    if(fscanf(fp, "%d %d", &type, &numMatrices) != 2) return false;
+    for(int j = 0; j < numMatrices; j++) {
+      int m, n;
+      if(fscanf(fp, "%d %d", &m, &n) != 2) return false;
+      fullMatrix<double> mat(m, n);
+      for(int k = 0; k < m; k++) {
+        for(int l = 0; l < n; l++) {
+          double d;
+          if(fscanf(fp, "%lf", &d) != 1) return false;
+          mat.set(k, l, d);
+        }
+      }
+      PViewData::addMatrixToInterpolationScheme(name, type, mat);
+    }
   }
+  return true;
+}
 
+// Index the post-processing sections of an MSH file in one pass. Only the
+// section headers are parsed: binary data blocks whose size is known are
+// skipped with Fseek, while ASCII blocks are scanned for the end of the
+// section (their size is recorded to allow reading them in bulk later).
+static bool indexMSH(FILE *fp, std::vector<mshSection> &sections)
+{
   char str[256] = "XXX";
-  int index = -1;
   bool binary = false, swap = false;
 
   while(1) {
@@ -109,23 +204,14 @@ bool PView::readMSH(const std::string &fileName, int fileIndex, int partitionToR
 
     if(!strncmp(&str[1], "MeshFormat", 10)) {
       double version;
-      if(!fgets(str, sizeof(str), fp)) {
-        fclose(fp);
-        return false;
-      }
+      if(!fgets(str, sizeof(str), fp)) return false;
       int format, size;
-      if(sscanf(str, "%lf %d %d", &version, &format, &size) != 3) {
-        fclose(fp);
-        return false;
-      }
+      if(sscanf(str, "%lf %d %d", &version, &format, &size) != 3) return false;
       if(format) {
         binary = true;
         Msg::Debug("View data is in binary format");
         int one;
-        if(fread(&one, sizeof(int), 1, fp) != 1) {
-          fclose(fp);
-          return 0;
-        }
+        if(fread(&one, sizeof(int), 1, fp) != 1) return false;
         if(one != 1) {
           swap = true;
           Msg::Debug("Swapping bytes from binary file");
@@ -133,180 +219,46 @@ bool PView::readMSH(const std::string &fileName, int fileIndex, int partitionToR
       }
     }
     else if(!strncmp(&str[1], "InterpolationScheme", 19)) {
-      std::string name;
-      if(!fgets(str, sizeof(str), fp)) {
-        fclose(fp);
-        return false;
-      }
-      name = ExtractDoubleQuotedString(str, sizeof(str));
-      Msg::Debug("Reading interpolation scheme '%s'", name.c_str());
-      PViewData::removeInterpolationScheme(name);
-      int numTypes;
-      if(fscanf(fp, "%d", &numTypes) != 1) {
-        fclose(fp);
-        return false;
-      }
-      for(int i = 0; i < numTypes; i++) {
-        int type, numMatrices;
-        if(fscanf(fp, "%d %d", &type, &numMatrices) != 2) {
-          fclose(fp);
-          return false;
-        }
-        for(int j = 0; j < numMatrices; j++) {
-          int m, n;
-          if(fscanf(fp, "%d %d", &m, &n) != 2) {
-            fclose(fp);
-            return false;
-          }
-          fullMatrix<double> mat(m, n);
-          for(int k = 0; k < m; k++) {
-            for(int l = 0; l < n; l++) {
-              double d;
-              if(fscanf(fp, "%lf", &d) != 1) {
-                fclose(fp);
-                return false;
-              }
-              mat.set(k, l, d);
-            }
-          }
-          PViewData::addMatrixToInterpolationScheme(name, type, mat);
-        }
-      }
+      mshSection s;
+      s.data = false;
+      s.offset = Ftell(fp);
+      s.dataSize = -1;
+      s.binary = binary;
+      s.swap = swap;
+      sections.push_back(s);
     }
     else if(!strncmp(&str[1], "NodeData", 8) ||
             !strncmp(&str[1], "ElementData", 11) ||
             !strncmp(&str[1], "ElementNodeData", 15)) {
-      index++;
-      if(fileIndex < 0 || fileIndex == index) {
-        PViewDataGModel::DataType type;
-        if(!strncmp(&str[1], "NodeData", 8))
-          type = PViewDataGModel::NodeData;
-        else if(!strncmp(&str[1], "ElementData", 11))
-          type = PViewDataGModel::ElementData;
-        else
-          type = PViewDataGModel::ElementNodeData;
-        int numTags;
-        // string tags
-        std::string viewName, interpolationScheme;
-        if(!fgets(str, sizeof(str), fp)) {
-          fclose(fp);
-          return false;
-        }
-        if(sscanf(str, "%d", &numTags) != 1) {
-          fclose(fp);
-          return false;
-        }
-        for(int i = 0; i < numTags; i++) {
-          if(!fgets(str, sizeof(str), fp)) {
-            fclose(fp);
-            return false;
-          }
-          if(i == 0)
-            viewName = ExtractDoubleQuotedString(str, sizeof(str));
-          else if(i == 1)
-            interpolationScheme = ExtractDoubleQuotedString(str, sizeof(str));
-        }
-        // double tags
-        double time = 0.;
-        if(!fgets(str, sizeof(str), fp)) {
-          fclose(fp);
-          return false;
-        }
-        if(sscanf(str, "%d", &numTags) != 1) {
-          fclose(fp);
-          return false;
-        }
-        for(int i = 0; i < numTags; i++) {
-          if(!fgets(str, sizeof(str), fp)) {
-            fclose(fp);
-            return false;
-          }
-          if(i == 0) {
-            if(sscanf(str, "%lf", &time) != 1) {
-              fclose(fp);
-              return false;
-            }
-          }
-        }
-        // integer tags
-        int timeStep = 0, numComp = 0, numEnt = 0, partition = 0;
-        long int blocksize = 0;
-        if(!fgets(str, sizeof(str), fp)) {
-          fclose(fp);
-          return false;
-        }
-        if(sscanf(str, "%d", &numTags) != 1) {
-          fclose(fp);
-          return false;
-        }
-        for(int i = 0; i < numTags; i++) {
-          if(!fgets(str, sizeof(str), fp)) {
-            fclose(fp);
-            return false;
-          }
-          if(i == 0) {
-            if(sscanf(str, "%d", &timeStep) != 1) {
-              fclose(fp);
-              return false;
-            }
-          }
-          else if(i == 1) {
-            if(sscanf(str, "%d", &numComp) != 1) {
-              fclose(fp);
-              return false;
-            }
-          }
-          else if(i == 2) {
-            if(sscanf(str, "%d", &numEnt) != 1) {
-              fclose(fp);
-              return false;
-            }
-          }
-          else if(i == 3) {
-            if(sscanf(str, "%d", &partition) != 1) {
-              fclose(fp);
-              return false;
-            }
-          }
-          else if(i == 4) {
-            if(sscanf(str, "%ld", &blocksize) != 1) {
-              fclose(fp);
-              return false;
-            }
-          }
-        }
-        if(partitionToRead == -1 || partitionToRead == partition) {
-          // if default (no particular partition requested from MergeFile -> -1)  or
-          // if current partition corresponds to the requested partition, read the data
-          if(numEnt > 0) {
-            // either get existing viewData, or create new one
-            PView *p = getViewByName(viewName, timeStep, partition);
-            PViewDataGModel *d = 0;
-            if(p) d = dynamic_cast<PViewDataGModel *>(p->getData());
-            bool create = d ? false : true;
-            if(create) d = new PViewDataGModel(type);
-            if(!d->readMSH(viewName, fileName, fileIndex, fp, binary, swap,
-                           timeStep, time, partition, numComp, numEnt,
-                           interpolationScheme)) {
-              Msg::Error("Could not read data in msh file");
-              if(create) delete d;
-              fclose(fp);
-              return false;
-            }
-            else {
-              d->setName(viewName);
-              d->setFileName(fileName);
-              d->setFileIndex(index);
-              if(create) new PView(d);
-            }
-          }
-        }
-        else if(blocksize > 0 && partitionToRead != partition) {
-          // if current partition does not correspond to the requested partition and
-          // if its blocksise has been read (5th integer in the header), jump over it
-          fseek(fp, blocksize, SEEK_CUR);
+      mshSection s;
+      s.data = true;
+      s.binary = binary;
+      s.swap = swap;
+      if(!readMSHDataHeader(fp, &str[1], s.header)) return false;
+      s.offset = Ftell(fp);
+      s.dataSize = -1;
+      const mshDataHeader &h = s.header;
+      if(binary && h.blocksize > 0)
+        s.dataSize = h.blocksize;
+      else if(binary && h.type != PViewDataGModel::ElementNodeData)
+        s.dataSize = (long long)h.numEnt *
+                     (long long)(sizeof(int) + h.numComp * sizeof(double));
+      if(s.dataSize >= 0) {
+        if(Fseek(fp, s.dataSize, SEEK_CUR)) return false;
+      }
+      else if(!binary) {
+        // scan the data lines up to the end of the section
+        long long size = 0;
+        while(1) {
+          if(!fgets(str, sizeof(str), fp) || feof(fp)) break;
+          if(str[0] == '$') break;
+          size += strlen(str);
         }
+        s.dataSize = size;
+        sections.push_back(s);
+        continue;
       }
+      sections.push_back(s);
     }
 
     do {
@@ -314,6 +266,76 @@ bool PView::readMSH(const std::string &fileName, int fileIndex, int partitionToR
     } while(str[0] != '$');
   }
 
+  return true;
+}
+
+bool PView::readMSH(const std::string &fileName, int fileIndex,
+                    int partitionToRead)
+{
+  FILE *fp = Fopen(fileName.c_str(), "rb");
+  if(!fp) {
+    Msg::Error("Unable to open file '%s'", fileName.c_str());
+    return false;
+  }
+
+  GModel *model = GModel::current();
+  if(model->empty()) {
+    Msg::Error("Model is empty: please load a mesh before loading the dataset");
+    fclose(fp);
+    return false;
+  }
+
+  std::vector<mshSection> sections;
+  if(!indexMSH(fp, sections)) {
+    fclose(fp);
+    return false;
+  }
+
+  // only read the interpolation schemes and the requested data sections
+  int index = -1;
+  for(std::size_t i = 0; i < sections.size(); i++) {
+    const mshSection &s = sections[i];
+    if(!s.data) {
+      if(Fseek(fp, s.offset, SEEK_SET) || !readMSHInterpolationScheme(fp)) {
+        fclose(fp);
+        return false;
+      }
+      continue;
+    }
+    index++;
+    if(fileIndex >= 0 && fileIndex != index) continue;
+    const mshDataHeader &h = s.header;
+    // if default (no particular partition requested from MergeFile -> -1) or
+    // if current partition corresponds to the requested partition, read the
+    // data
+    if(partitionToRead != -1 && partitionToRead != h.partition) continue;
+    if(h.numEnt <= 0) continue;
+    if(Fseek(fp, s.offset, SEEK_SET)) {
+      fclose(fp);
+      return false;
+    }
+    // either get existing viewData, or create new one
+    PView *p = getViewByName(h.viewName, h.timeStep, h.partition);
+    PViewDataGModel *d = 0;
+    if(p) d = dynamic_cast<PViewDataGModel *>(p->getData());
+    bool create = d ? false : true;
+    if(create) d = new PViewDataGModel(h.type);
+    if(!d->readMSH(h.viewName, fileName, fileIndex, fp, s.binary, s.swap,
+                   h.timeStep, h.time, h.partition, h.numComp, h.numEnt,
+                   h.interpolationScheme, s.dataSize)) {
+      Msg::Error("Could not read data in msh file");
+      if(create) delete d;
+      fclose(fp);
+      return false;
+    }
+    else {
+      d->setName(h.viewName);
+      d->setFileName(fileName);
+      d->setFileIndex(index);
+      if(create) new PView(d);
+    }
+  }
+
   fclose(fp);
   return true;
 }
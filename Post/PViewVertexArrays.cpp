@@ -1571,7 +1571,7 @@ bool PView::fillVertexArrays()
 }
 
 void PView::fillVertexArray(onelab::localNetworkClient *remote, int length,
-                            const char *bytes, int swap)
+                            const char *bytes, int swap, bool compressed)
 {
   std::string name;
   int tag, type, numSteps;
@@ -1606,35 +1606,63 @@ void PView::fillVertexArray(onelab::localNetworkClient *remote, int length,
   // not perfect (does not take transformations into account)
   p->getOptions()->tmpBBox = bbox;
 
+  // compressed arrays are delta-encoded with respect to the last arrays
+  // received from the same client for the same view
+  PViewDataRemote *remoteData = dynamic_cast<PViewDataRemote *>(p->getData());
+  if(remoteData && remoteData->getRemote() != remote) remoteData = 0;
+  VertexArrayHistory noHistory;
+  VertexArrayHistory &history =
+    remoteData ? remoteData->getVertexArrayHistory() : noHistory;
+  bool ok = true;
+
   switch(type) {
   case 1:
     if(p->va_points) delete p->va_points;
     p->va_points = new VertexArray(1, 100);
-    p->va_points->fromChar(length, bytes, swap);
+    if(compressed)
+      ok = p->va_points->fromCompressedChar(length, bytes, swap, history);
+    else
+      p->va_points->fromChar(length, bytes, swap);
     break;
   case 2:
     if(p->va_lines) delete p->va_lines;
     p->va_lines = new VertexArray(2, 100);
-    p->va_lines->fromChar(length, bytes, swap);
+    if(compressed)
+      ok = p->va_lines->fromCompressedChar(length, bytes, swap, history);
+    else
+      p->va_lines->fromChar(length, bytes, swap);
     break;
   case 3:
     if(p->va_triangles) delete p->va_triangles;
     p->va_triangles = new VertexArray(3, 100);
-    p->va_triangles->fromChar(length, bytes, swap);
+    if(compressed)
+      ok = p->va_triangles->fromCompressedChar(length, bytes, swap, history);
+    else
+      p->va_triangles->fromChar(length, bytes, swap);
     break;
   case 4:
     if(p->va_vectors) delete p->va_vectors;
     p->va_vectors = new VertexArray(2, 100);
-    p->va_vectors->fromChar(length, bytes, swap);
+    if(compressed)
+      ok = p->va_vectors->fromCompressedChar(length, bytes, swap, history);
+    else
+      p->va_vectors->fromChar(length, bytes, swap);
     break;
   case 5:
     if(p->va_ellipses) delete p->va_ellipses;
     p->va_ellipses = new VertexArray(4, 100);
-    p->va_ellipses->fromChar(length, bytes, swap);
+    if(compressed)
+      ok = p->va_ellipses->fromCompressedChar(length, bytes, swap, history);
+    else
+      p->va_ellipses->fromChar(length, bytes, swap);
     break;
   default: Msg::Error("Cannot fill vertex array of type %d", type); return;
   }
 
-  p->setChanged(false);
+  // on error, ask the server for plain arrays (and new references) at the next
+  // redraw
+  if(!ok && remoteData) remoteData->resetVertexArrays();
+
+  p->setChanged(!ok);
   p->getData()->setDirty(false);
 }
@@ -6,6 +6,7 @@
 #ifndef _SHAPE_FUNCTIONS_H_
 #define _SHAPE_FUNCTIONS_H_
 
+#include <vector>
 #include "Numeric.h"
 #include "GmshMessage.h"
 
@@ -16,6 +17,8 @@ protected:
   static double TOL;
 
 public:
+  // maximum number of nodes of the elements defined below
+  static const int maxNumNodes = 8;
   element(double *x, double *y, double *z, int numNodes = 0)
   {
     if(!numNodes) {
@@ -65,16 +68,29 @@ public:
                                 double &s) = 0;
   virtual void getGradShapeFunction(int num, double u, double v, double w,
                                     double s[3]) = 0;
+  // gradients of all the shape functions at (u, v, w): gsf[3 * i + j] is
+  // component j of the gradient of shape function i
+  void getGradShapeFunctions(double u, double v, double w, double *gsf)
+  {
+    for(int i = 0; i < getNumNodes(); i++)
+      getGradShapeFunction(i, u, v, w, &gsf[3 * i]);
+  }
   double getJacobian(double u, double v, double w, double jac[3][3])
+  {
+    double gsf[3 * maxNumNodes];
+    getGradShapeFunctions(u, v, w, gsf);
+    return getJacobian(gsf, jac);
+  }
+  // same as above, using the gradients of the shape functions at (u, v, w)
+  double getJacobian(const double *gsf, double jac[3][3])
   {
     jac[0][0] = jac[0][1] = jac[0][2] = 0.;
     jac[1][0] = jac[1][1] = jac[1][2] = 0.;
     jac[2][0] = jac[2][1] = jac[2][2] = 0.;
-    double s[3];
     switch(getDimension()) {
     case 3:
       for(int i = 0; i < getNumNodes(); i++) {
-        getGradShapeFunction(i, u, v, w, s);
+        const double *s = &gsf[3 * i];
         jac[0][0] += _x[i] * s[0];
         jac[0][1] += _y[i] * s[0];
         jac[0][2] += _z[i] * s[0];
@@ -91,7 +107,7 @@ public:
         jac[0][0] * jac[1][2] * jac[2][1] - jac[0][1] * jac[1][0] * jac[2][2]);
     case 2:
       for(int i = 0; i < getNumNodes(); i++) {
-        getGradShapeFunction(i, u, v, w, s);
+        const double *s = &gsf[3 * i];
         jac[0][0] += _x[i] * s[0];
         jac[0][1] += _y[i] * s[0];
         jac[0][2] += _z[i] * s[0];
@@ -118,7 +134,7 @@ public:
         std::pow(jac[0][1] * jac[1][2] - jac[0][2] * jac[1][1], 2));
     case 1:
       for(int i = 0; i < getNumNodes(); i++) {
-        getGradShapeFunction(i, u, v, w, s);
+        const double *s = &gsf[3 * i];
         jac[0][0] += _x[i] * s[0];
         jac[0][1] += _y[i] * s[0];
         jac[0][2] += _z[i] * s[0];
@@ -168,36 +184,51 @@ public:
   }
   void interpolateGrad(double val[], double u, double v, double w, double f[3],
                        int stride = 1, double invjac[3][3] = NULL)
+  {
+    double gsf[3 * maxNumNodes];
+    getGradShapeFunctions(u, v, w, gsf);
+    if(invjac) {
+      interpolateGrad(val, gsf, invjac, f, stride);
+    }
+    else {
+      double jac[3][3], inv[3][3];
+      getJacobian(gsf, jac);
+      inv3x3(jac, inv);
+      interpolateGrad(val, gsf, inv, f, stride);
+    }
+  }
+  // same as above, using the gradients of the shape functions and the inverse
+  // of the Jacobian at the interpolation point
+  void interpolateGrad(double val[], const double *gsf, double invjac[3][3],
+                       double f[3], int stride = 1)
   {
     double dfdu[3] = {0., 0., 0.};
     int j = 0;
     for(int i = 0; i < getNumNodes(); i++) {
-      double s[3];
-      getGradShapeFunction(i, u, v, w, s);
+      const double *s = &gsf[3 * i];
       dfdu[0] += val[j] * s[0];
       dfdu[1] += val[j] * s[1];
       dfdu[2] += val[j] * s[2];
       j += stride;
     }
-    if(invjac) {
-      matvec(invjac, dfdu, f);
-    }
-    else {
-      double jac[3][3], inv[3][3];
-      getJacobian(u, v, w, jac);
-      inv3x3(jac, inv);
-      matvec(inv, dfdu, f);
-    }
+    matvec(invjac, dfdu, f);
   }
   void interpolateCurl(double val[], double u, double v, double w, double f[3],
                        int stride = 3)
   {
-    double fx[3], fy[3], fz[3], jac[3][3], inv[3][3];
-    getJacobian(u, v, w, jac);
+    double gsf[3 * maxNumNodes], jac[3][3], inv[3][3];
+    getGradShapeFunctions(u, v, w, gsf);
+    getJacobian(gsf, jac);
     inv3x3(jac, inv);
-    interpolateGrad(&val[0], u, v, w, fx, stride, inv);
-    interpolateGrad(&val[1], u, v, w, fy, stride, inv);
-    interpolateGrad(&val[2], u, v, w, fz, stride, inv);
+    interpolateCurl(val, gsf, inv, f, stride);
+  }
+  void interpolateCurl(double val[], const double *gsf, double invjac[3][3],
+                       double f[3], int stride = 3)
+  {
+    double fx[3], fy[3], fz[3];
+    interpolateGrad(&val[0], gsf, invjac, fx, stride);
+    interpolateGrad(&val[1], gsf, invjac, fy, stride);
+    interpolateGrad(&val[2], gsf, invjac, fz, stride);
     f[0] = fz[1] - fy[2];
     f[1] = -(fz[0] - fx[2]);
     f[2] = fy[0] - fx[1];
@@ -205,12 +236,19 @@ public:
   double interpolateDiv(double val[], double u, double v, double w,
                         int stride = 3)
   {
-    double fx[3], fy[3], fz[3], jac[3][3], inv[3][3];
-    getJacobian(u, v, w, jac);
+    double gsf[3 * maxNumNodes], jac[3][3], inv[3][3];
+    getGradShapeFunctions(u, v, w, gsf);
+    getJacobian(gsf, jac);
     inv3x3(jac, inv);
-    interpolateGrad(&val[0], u, v, w, fx, stride, inv);
-    interpolateGrad(&val[1], u, v, w, fy, stride, inv);
-    interpolateGrad(&val[2], u, v, w, fz, stride, inv);
+    return interpolateDiv(val, gsf, inv, stride);
+  }
+  double interpolateDiv(double val[], const double *gsf, double invjac[3][3],
+                        int stride = 3)
+  {
+    double fx[3], fy[3], fz[3];
+    interpolateGrad(&val[0], gsf, invjac, fx, stride);
+    interpolateGrad(&val[1], gsf, invjac, fy, stride);
+    interpolateGrad(&val[2], gsf, invjac, fz, stride);
     return fx[0] + fy[1] + fz[2];
   }
   double integrate(double val[], int stride = 1)
@@ -1410,6 +1448,46 @@ public:
   }
 };
 
+// Gradients of the shape functions at the nodes of the reference elements
+// created by elementFactory, tabulated once per type of element
+class elementNodeGradients {
+private:
+  // _gsf[dim][numNodes][3 * (numNodes * nod + i) + j] is component j of the
+  // gradient of shape function i at node nod
+  std::vector<double> _gsf[4][element::maxNumNodes + 1];
+
+public:
+  elementNodeGradients()
+  {
+    double x[element::maxNumNodes] = {0.}, y[element::maxNumNodes] = {0.},
+           z[element::maxNumNodes] = {0.};
+    elementFactory factory;
+    for(int dim = 0; dim < 4; dim++) {
+      for(int n = 1; n <= element::maxNumNodes; n++) {
+        element *e = factory.create(n, dim, x, y, z);
+        if(e->getNumNodes() == n) {
+          _gsf[dim][n].resize(3 * n * n);
+          for(int nod = 0; nod < n; nod++) {
+            double u, v, w;
+            e->getNode(nod, u, v, w);
+            e->getGradShapeFunctions(u, v, w, &_gsf[dim][n][3 * n * nod]);
+          }
+        }
+        delete e;
+      }
+    }
+  }
+  // gradients of the shape functions at node nod of an element with numNodes
+  // nodes of dimension dim, or 0 if elementFactory has no such element
+  const double *get(int dim, int numNodes, int nod) const
+  {
+    if(dim < 0 || dim > 3 || numNodes < 1 ||
+       numNodes > element::maxNumNodes || _gsf[dim][numNodes].empty())
+      return 0;
+    return &_gsf[dim][numNodes][3 * numNodes * nod];
+  }
+};
+
 #undef SQU
 
 #endif
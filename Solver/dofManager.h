@@ -559,6 +559,15 @@ public:
     return _isParallel ? _localSize : unknown.size();
   }
   virtual int sizeOfF() const { return fixed.size(); }
+  // allocate the current system and return true if contributions of
+  // elements sharing no Dof can be assembled concurrently
+  virtual bool prepareConcurrentAssembly()
+  {
+    if(_isParallel || !constraints.empty() || !_current->isRowThreadSafe())
+      return false;
+    if(!_current->isAllocated()) _current->allocate(sizeOfR());
+    return true;
+  }
   virtual void systemSolve() { _current->systemSolve(); }
   virtual void systemClear()
   {
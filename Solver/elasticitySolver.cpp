@@ -4,6 +4,7 @@
 // issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <string.h>
+#include <stdlib.h>
 #include "GmshConfig.h"
 #include "elasticitySolver.h"
 #include "linearSystemCSR.h"
@@ -20,6 +21,7 @@
 #include "solverField.h"
 #include "MPoint.h"
 #include "gmshLevelset.h"
+#include "simpleFunctionMathEval.h"
 #if defined(HAVE_POST)
 #include "PView.h"
 #include "PViewData.h"
@@ -119,11 +121,12 @@ void elasticitySolver::solve()
 
 #if defined(HAVE_PETSC)
   linearSystemPETSc<double> *lsys = new linearSystemPETSc<double>;
-#elif defined(HAVE_GMM)
-  linearSystemGmm<double> *lsys = new linearSystemGmm<double>;
-  lsys->setNoisy(2);
 #else
-  linearSystemFull<double> *lsys = new linearSystemFull<double>;
+  linearSystemCSRKrylov<double> *lsys = new linearSystemCSRKrylov<double>;
+  // Lagrange multipliers make the system indefinite
+  if(LagrangeMultiplierFields.size())
+    lsys->setSolver(linearSystemCSRKrylov<double>::GMRES);
+  lsys->setNoisy(1);
 #endif
 
   assemble(lsys);
@@ -160,6 +163,17 @@ void elasticitySolver::postSolve()
   printf("elastic energy=%f\n", energ);
 }
 
+// constant value, or expression of x, y and z (without spaces)
+static simpleFunction<double> *newScalarFunction(const char *str)
+{
+  char *end;
+  double val = strtod(str, &end);
+  if(end != str && *end == '\0') return new simpleFunction<double>(val);
+  simpleFunctionMathEval *fct = new simpleFunctionMathEval(str);
+  if(!fct->isValid()) Msg::Error("Invalid expression '%s'", str);
+  return fct;
+}
+
 void elasticitySolver::readInputFile(const std::string &fn)
 {
   FILE *f = Fopen(fn.c_str(), "r");
@@ -219,45 +233,45 @@ void elasticitySolver::readInputFile(const std::string &fn)
       elasticFields.push_back(field);
     }
     else if(!strcmp(what, "NodeDisplacement")) {
-      double val;
+      char val[256];
       int node, comp;
-      if(fscanf(f, "%d %d %lf", &node, &comp, &val) != 3) {
+      if(fscanf(f, "%d %d %255s", &node, &comp, val) != 3) {
         fclose(f);
         return;
       }
       dirichletBC diri;
       diri.g = new groupOfElements(0, node);
-      diri._f = new simpleFunction<double>(val);
+      diri._f = newScalarFunction(val);
       diri._comp = comp;
       diri._tag = node;
       diri.onWhat = BoundaryCondition::ON_VERTEX;
       allDirichlet.push_back(diri);
     }
     else if(!strcmp(what, "EdgeDisplacement")) {
-      double val;
+      char val[256];
       int edge, comp;
-      if(fscanf(f, "%d %d %lf", &edge, &comp, &val) != 3) {
+      if(fscanf(f, "%d %d %255s", &edge, &comp, val) != 3) {
         fclose(f);
         return;
       }
       dirichletBC diri;
       diri.g = new groupOfElements(1, edge);
-      diri._f = new simpleFunction<double>(val);
+      diri._f = newScalarFunction(val);
       diri._comp = comp;
       diri._tag = edge;
       diri.onWhat = BoundaryCondition::ON_EDGE;
       allDirichlet.push_back(diri);
     }
     else if(!strcmp(what, "FaceDisplacement")) {
-      double val;
+      char val[256];
       int face, comp;
-      if(fscanf(f, "%d %d %lf", &face, &comp, &val) != 3) {
+      if(fscanf(f, "%d %d %255s", &face, &comp, val) != 3) {
         fclose(f);
         return;
       }
       dirichletBC diri;
       diri.g = new groupOfElements(2, face);
-      diri._f = new simpleFunction<double>(val);
+      diri._f = newScalarFunction(val);
       diri._comp = comp;
       diri._tag = face;
       diri.onWhat = BoundaryCondition::ON_FACE;
@@ -534,13 +548,31 @@ void elasticitySolver::assemble(linearSystem<double> *lsys)
       FixVoidNodalDofs(*LagSpace, elasticFields[i].g->begin(),
                        elasticFields[i].g->end(), *pAssembler);
   }
+  // Sparsity pattern of the terms assembled below, so that the matrix entries
+  // are preallocated (and can then be assembled concurrently)
+  for(std::size_t i = 0; i < LagrangeMultiplierFields.size(); i++) {
+    std::size_t j = 0;
+    for(; j < LagrangeMultiplierSpaces.size(); j++)
+      if(LagrangeMultiplierSpaces[j]->getId() ==
+         LagrangeMultiplierFields[i]._tag)
+        break;
+    SparsityDofs(*LagSpace, *(LagrangeMultiplierSpaces[j]),
+                 LagrangeMultiplierFields[i].g->begin(),
+                 LagrangeMultiplierFields[i].g->end(), *pAssembler);
+    SparsityDofs(*(LagrangeMultiplierSpaces[j]),
+                 LagrangeMultiplierFields[i].g->begin(),
+                 LagrangeMultiplierFields[i].g->end(), *pAssembler);
+  }
+  for(std::size_t i = 0; i < elasticFields.size(); i++)
+    SparsityDofs(*LagSpace, elasticFields[i].g->begin(),
+                 elasticFields[i].g->end(), *pAssembler);
+  if(lsys->isAllocated()) lsys->preAllocateEntries();
   // Neumann conditions
   GaussQuadrature Integ_Boundary(GaussQuadrature::Val);
 
   for(std::size_t i = 0; i < allNeumann.size(); i++) {
     LoadTerm<SVector3> Lterm(*LagSpace, allNeumann[i]._f);
-    Assemble(Lterm, *LagSpace, allNeumann[i].g->begin(), allNeumann[i].g->end(),
-             Integ_Boundary, *pAssembler);
+    Assemble(Lterm, *LagSpace, *allNeumann[i].g, Integ_Boundary, *pAssembler);
   }
   // Assemble cross term, laplace term and rhs term for LM
   GaussQuadrature Integ_LagrangeMult(GaussQuadrature::ValVal);
@@ -556,23 +588,20 @@ void elasticitySolver::assemble(linearSystem<double> *lsys)
                                              *(LagrangeMultiplierSpaces[j]),
                                              LagrangeMultiplierFields[i]._d);
     Assemble(LagTerm, *LagSpace, *(LagrangeMultiplierSpaces[j]),
-             LagrangeMultiplierFields[i].g->begin(),
-             LagrangeMultiplierFields[i].g->end(), Integ_LagrangeMult,
+             *LagrangeMultiplierFields[i].g, Integ_LagrangeMult,
              *pAssembler);
 
     printf("Lagrange Mult Lap\n");
     LaplaceTerm<double, double> LapTerm(*(LagrangeMultiplierSpaces[j]),
                                         -LagrangeMultiplierFields[i]._tau);
     Assemble(LapTerm, *(LagrangeMultiplierSpaces[j]),
-             LagrangeMultiplierFields[i].g->begin(),
-             LagrangeMultiplierFields[i].g->end(), Integ_Laplace, *pAssembler);
+             *LagrangeMultiplierFields[i].g, Integ_Laplace, *pAssembler);
 
     printf("Lagrange Mult Load\n");
     LoadTermOnBorder<double> Lterm(*(LagrangeMultiplierSpaces[j]),
                                    LagrangeMultiplierFields[i]._f);
     Assemble(Lterm, *(LagrangeMultiplierSpaces[j]),
-             LagrangeMultiplierFields[i].g->begin(),
-             LagrangeMultiplierFields[i].g->end(), Integ_Boundary, *pAssembler);
+             *LagrangeMultiplierFields[i].g, Integ_Boundary, *pAssembler);
   }
   // Assemble elastic term for
   GaussQuadrature Integ_Bulk(GaussQuadrature::GradGrad);
@@ -580,8 +609,7 @@ void elasticitySolver::assemble(linearSystem<double> *lsys)
     printf("Elastic\n");
     IsotropicElasticTerm Eterm(*LagSpace, elasticFields[i]._E,
                                elasticFields[i]._nu);
-    Assemble(Eterm, *LagSpace, elasticFields[i].g->begin(),
-             elasticFields[i].g->end(), Integ_Bulk, *pAssembler);
+    Assemble(Eterm, *LagSpace, *elasticFields[i].g, Integ_Bulk, *pAssembler);
   }
 
   printf("nDofs=%d\n", pAssembler->sizeOfR());
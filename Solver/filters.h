@@ -80,7 +80,8 @@ public:
     groupOfElements *LevelSetElements =
       new groupOfElements(_LevelSetEntity.first, _LevelSetEntity.second);
     // tag enriched vertex determination
-    std::set<MElement *>::const_iterator it = LevelSetElements->begin();
+    groupOfElements::elementContainer::const_iterator it =
+      LevelSetElements->begin();
     for(; it != LevelSetElements->end(); it++) {
       MElement *e = *it;
       if(e->getParent()) { // if element got parents
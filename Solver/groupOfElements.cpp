@@ -7,19 +7,20 @@
 #include "GModel.h"
 #include "GEntity.h"
 
-groupOfElements::groupOfElements(GFace *gf)
+groupOfElements::groupOfElements(GFace *gf) : _finalized(true)
 {
   elementFilterTrivial filter;
   addElementary(gf, filter);
 }
 
-groupOfElements::groupOfElements(GRegion *gr)
+groupOfElements::groupOfElements(GRegion *gr) : _finalized(true)
 {
   elementFilterTrivial filter;
   addElementary(gr, filter);
 }
 
 groupOfElements::groupOfElements(std::vector<MElement *> &elems)
+  : _finalized(true)
 {
   elementFilterTrivial filter;
   for(std::vector<MElement *>::iterator it = elems.begin(); it != elems.end();
@@ -29,6 +30,7 @@ groupOfElements::groupOfElements(std::vector<MElement *> &elems)
       insert(e);
     }
   }
+  _finalize();
 }
 
 void groupOfElements::addElementary(GEntity *ge, const elementFilter &filter)
@@ -39,6 +41,7 @@ void groupOfElements::addElementary(GEntity *ge, const elementFilter &filter)
       insert(e);
     }
   }
+  _finalize();
 }
 
 void groupOfElements::addPhysical(int dim, int physical,
@@ -51,3 +54,76 @@ void groupOfElements::addPhysical(int dim, int physical,
     addElementary(ent[i], filter);
   }
 }
+
+template <class T> static void sortAndUnique(std::vector<T> &v)
+{
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+}
+
+void groupOfElements::_sortAndUnique() const
+{
+  // sorting by pointer gives the same ordering as the former std::set
+  // containers
+  sortAndUnique(_vertices);
+  sortAndUnique(_elements);
+  sortAndUnique(_parents);
+  _finalized = true;
+}
+
+const std::vector<groupOfElements::elementContainer> &
+groupOfElements::getColours() const
+{
+  _finalize();
+  if(_colours.size() || _elements.empty()) return _colours;
+
+  std::vector<MVertex *> nodes;
+  for(std::size_t i = 0; i < _elements.size(); i++) {
+    MElement *e = _elements[i];
+    for(std::size_t j = 0; j < e->getNumVertices(); j++)
+      nodes.push_back(e->getVertex(j));
+    if(e->getParent())
+      for(std::size_t j = 0; j < e->getParent()->getNumVertices(); j++)
+        nodes.push_back(e->getParent()->getVertex(j));
+  }
+  sortAndUnique(nodes);
+
+  // colours are assigned by blocks of 64, each node storing the mask of the
+  // colours of the block already used by its elements
+  const int nbits = 8 * sizeof(unsigned long long);
+  std::vector<unsigned long long> used(nodes.size());
+  elementContainer todo(_elements), left;
+  std::vector<std::size_t> en;
+  std::size_t base = 0;
+  while(todo.size()) {
+    std::fill(used.begin(), used.end(), 0);
+    left.clear();
+    for(std::size_t i = 0; i < todo.size(); i++) {
+      MElement *e = todo[i];
+      en.clear();
+      for(std::size_t j = 0; j < e->getNumVertices(); j++)
+        en.push_back(std::lower_bound(nodes.begin(), nodes.end(),
+                                      e->getVertex(j)) -
+                     nodes.begin());
+      if(e->getParent())
+        for(std::size_t j = 0; j < e->getParent()->getNumVertices(); j++)
+          en.push_back(std::lower_bound(nodes.begin(), nodes.end(),
+                                        e->getParent()->getVertex(j)) -
+                       nodes.begin());
+      unsigned long long mask = 0;
+      for(std::size_t j = 0; j < en.size(); j++) mask |= used[en[j]];
+      if(mask == ~0ULL) {
+        left.push_back(e);
+        continue;
+      }
+      int c = 0;
+      while(mask & (1ULL << c)) c++;
+      for(std::size_t j = 0; j < en.size(); j++) used[en[j]] |= (1ULL << c);
+      if(base + c >= _colours.size()) _colours.resize(base + c + 1);
+      _colours[base + c].push_back(e);
+    }
+    base += nbits;
+    todo.swap(left);
+  }
+  return _colours;
+}
@@ -6,7 +6,8 @@
 #ifndef _GROUPOFELEMENTS_H_
 #define _GROUPOFELEMENTS_H_
 
-#include <set>
+#include <vector>
+#include <algorithm>
 #include "GFace.h"
 #include "MElement.h"
 
@@ -23,17 +24,28 @@ public:
 
 class groupOfElements {
 public:
-  typedef std::set<MElement *> elementContainer;
-  typedef std::set<MVertex *> vertexContainer;
+  typedef std::vector<MElement *> elementContainer;
+  typedef std::vector<MVertex *> vertexContainer;
 
 protected:
-  vertexContainer _vertices;
-  elementContainer _elements;
-  elementContainer _parents;
+  // contiguous containers, sorted and without duplicates once finalized
+  mutable vertexContainer _vertices;
+  mutable elementContainer _elements;
+  mutable elementContainer _parents;
+  mutable bool _finalized;
+  mutable std::vector<elementContainer> _colours;
+  void _finalize() const
+  {
+    if(!_finalized) _sortAndUnique();
+  }
+  void _sortAndUnique() const;
 
 public:
-  groupOfElements() {}
-  groupOfElements(int dim, int physical) { addPhysical(dim, physical); }
+  groupOfElements() : _finalized(true) {}
+  groupOfElements(int dim, int physical) : _finalized(true)
+  {
+    addPhysical(dim, physical);
+  }
   groupOfElements(GFace *);
   groupOfElements(GRegion *);
   groupOfElements(std::vector<MElement *> &elems);
@@ -50,40 +62,72 @@ public:
 
   virtual void addPhysical(int dim, int physical, const elementFilter &);
 
-  vertexContainer::const_iterator vbegin() const { return _vertices.begin(); }
-  vertexContainer::const_iterator vend() const { return _vertices.end(); }
-  elementContainer::const_iterator begin() const { return _elements.begin(); }
-  elementContainer::const_iterator end() const { return _elements.end(); }
+  vertexContainer::const_iterator vbegin() const
+  {
+    _finalize();
+    return _vertices.begin();
+  }
+  vertexContainer::const_iterator vend() const
+  {
+    _finalize();
+    return _vertices.end();
+  }
+  elementContainer::const_iterator begin() const
+  {
+    _finalize();
+    return _elements.begin();
+  }
+  elementContainer::const_iterator end() const
+  {
+    _finalize();
+    return _elements.end();
+  }
 
-  size_t size() const { return _elements.size(); }
-  size_t vsize() const { return _vertices.size(); }
+  size_t size() const
+  {
+    _finalize();
+    return _elements.size();
+  }
+  size_t vsize() const
+  {
+    _finalize();
+    return _vertices.size();
+  }
 
   // FIXME : NOT VERY ELEGANT !!!
   bool find(
     MElement *e) const // if same parent but different physicals return true ?!
   {
-    if(e->getParent() && _parents.find(e->getParent()) != _parents.end())
+    _finalize();
+    if(e->getParent() &&
+       std::binary_search(_parents.begin(), _parents.end(), e->getParent()))
       return true;
-    return (_elements.find(e) != _elements.end());
+    return std::binary_search(_elements.begin(), _elements.end(), e);
   }
 
-  bool find(MVertex *v) const { return (_vertices.find(v) != _vertices.end()); }
+  bool find(MVertex *v) const
+  {
+    _finalize();
+    return std::binary_search(_vertices.begin(), _vertices.end(), v);
+  }
 
   inline void insert(MElement *e)
   {
-    _elements.insert(e);
+    _elements.push_back(e);
 
     if(e->getParent()) {
-      _parents.insert(e->getParent());
+      _parents.push_back(e->getParent());
       for(std::size_t i = 0; i < e->getParent()->getNumVertices(); i++) {
-        _vertices.insert(e->getParent()->getVertex(i));
+        _vertices.push_back(e->getParent()->getVertex(i));
       }
     }
     else {
       for(std::size_t i = 0; i < e->getNumVertices(); i++) {
-        _vertices.insert(e->getVertex(i));
+        _vertices.push_back(e->getVertex(i));
       }
     }
+    _finalized = false;
+    _colours.clear();
   }
 
   inline void clearAll()
@@ -91,7 +135,13 @@ public:
     _vertices.clear();
     _elements.clear();
     _parents.clear();
+    _finalized = true;
+    _colours.clear();
   }
+
+  // greedy colouring of the elements: two elements of the same colour share
+  // no node (neither their own nor their parent's), and hence no Dof
+  const std::vector<elementContainer> &getColours() const;
 };
 
 // child elements in pElem restricted to elements who have parent in sElem
@@ -31,6 +31,8 @@ public:
   void setParameter(std::string key, std::string value);
   std::string getParameter(std::string key) const;
   virtual void insertInSparsityPattern(int _row, int _col){};
+  // can entries of distinct rows be added concurrently?
+  virtual bool isRowThreadSafe() const { return false; }
   virtual double normInfRightHandSide() const = 0;
   virtual double normInfSolution() const { return 0; };
 };
@@ -7,6 +7,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <complex>
+#include <cmath>
+#include <algorithm>
+#include <string>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "linearSystemCSR.h"
@@ -463,3 +466,718 @@ template <> int linearSystemCSRGmm<double>::systemSolve()
 }
 
 #endif
+
+// Native preconditioned Krylov solvers on the final (sorted) CSR arrays
+
+static const int ompMinSize = 1000;
+static const std::size_t amgMaxLevels = 20;
+
+struct csrMatrixRef {
+  int n;
+  const INDEX_TYPE *jptr, *ai;
+  const double *a;
+};
+
+// y = A x
+static void csrMult(const csrMatrixRef &A, const double *x, double *y)
+{
+  const int n = A.n;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) {
+    double s = 0.;
+    for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++)
+      s += A.a[p] * x[A.ai[p]];
+    y[i] = s;
+  }
+}
+
+// r = b - A x
+static void csrResidual(const csrMatrixRef &A, const double *x,
+                        const double *b, double *r)
+{
+  const int n = A.n;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) {
+    double s = b[i];
+    for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++)
+      s -= A.a[p] * x[A.ai[p]];
+    r[i] = s;
+  }
+}
+
+static double vecDot(int n, const double *x, const double *y)
+{
+  double s = 0.;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) reduction(+ : s) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) s += x[i] * y[i];
+  return s;
+}
+
+static double vecNorm(int n, const double *x)
+{
+  return std::sqrt(vecDot(n, x, x));
+}
+
+// y += alpha x
+static void vecAxpy(int n, double alpha, const double *x, double *y)
+{
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) y[i] += alpha * x[i];
+}
+
+static void vecScale(int n, double alpha, double *x)
+{
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) x[i] *= alpha;
+}
+
+// y = x + beta y
+static void vecXpby(int n, const double *x, double beta, double *y)
+{
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) y[i] = x[i] + beta * y[i];
+}
+
+static void invertDiagonal(const csrMatrixRef &A, std::vector<double> &invDiag)
+{
+  const int n = A.n;
+  invDiag.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+  for(int i = 0; i < n; i++) {
+    double d = 0.;
+    for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++) {
+      if(A.ai[p] == i) {
+        d = A.a[p];
+        break;
+      }
+    }
+    invDiag[i] = (d != 0.) ? 1. / d : 1.;
+  }
+}
+
+class csrPreconditioner {
+public:
+  virtual ~csrPreconditioner() {}
+  // z = M^-1 r
+  virtual void apply(const double *r, double *z) = 0;
+};
+
+class csrIdentity : public csrPreconditioner {
+private:
+  int _n;
+
+public:
+  csrIdentity(int n) : _n(n) {}
+  void apply(const double *r, double *z) { std::copy(r, r + _n, z); }
+};
+
+class csrJacobi : public csrPreconditioner {
+private:
+  std::vector<double> _invDiag;
+
+public:
+  csrJacobi(const csrMatrixRef &A) { invertDiagonal(A, _invDiag); }
+  void apply(const double *r, double *z)
+  {
+    const int n = _invDiag.size();
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) z[i] = _invDiag[i] * r[i];
+  }
+};
+
+// group the rows by level, rows of the same level being independent
+static void levelSchedule(const std::vector<int> &level, std::vector<int> &ptr,
+                          std::vector<int> &rows)
+{
+  int nl = 0;
+  for(std::size_t i = 0; i < level.size(); i++)
+    nl = std::max(nl, level[i] + 1);
+  ptr.assign(nl + 1, 0);
+  for(std::size_t i = 0; i < level.size(); i++) ptr[level[i] + 1]++;
+  for(int l = 0; l < nl; l++) ptr[l + 1] += ptr[l];
+  std::vector<int> pos(ptr.begin(), ptr.end() - 1);
+  rows.resize(level.size());
+  for(std::size_t i = 0; i < level.size(); i++) rows[pos[level[i]]++] = i;
+}
+
+// ILU(0) factorization; the triangular solves are parallelized by level
+// scheduling
+class csrILU0 : public csrPreconditioner {
+private:
+  int _n;
+  const INDEX_TYPE *_jptr, *_ai;
+  std::vector<double> _lu, _invDiag;
+  std::vector<INDEX_TYPE> _upper; // first entry of the strict upper part
+  std::vector<int> _lowerPtr, _lowerRows, _upperPtr, _upperRows;
+
+public:
+  csrILU0(const csrMatrixRef &A) : _n(A.n), _jptr(A.jptr), _ai(A.ai)
+  {
+    _lu.assign(A.a, A.a + A.jptr[_n]);
+    _invDiag.resize(_n);
+    _upper.resize(_n);
+    std::vector<INDEX_TYPE> iw(_n, -1);
+    for(int i = 0; i < _n; i++) {
+      const INDEX_TYPE p0 = _jptr[i], p1 = _jptr[i + 1];
+      double rowMax = 0.;
+      for(INDEX_TYPE p = p0; p < p1; p++) {
+        iw[_ai[p]] = p;
+        rowMax = std::max(rowMax, std::abs(_lu[p]));
+      }
+      INDEX_TYPE p = p0;
+      for(; p < p1 && _ai[p] < i; p++) {
+        const int k = _ai[p];
+        _lu[p] *= _invDiag[k];
+        for(INDEX_TYPE q = _upper[k]; q < _jptr[k + 1]; q++) {
+          const INDEX_TYPE w = iw[_ai[q]];
+          if(w >= 0) _lu[w] -= _lu[p] * _lu[q];
+        }
+      }
+      double d = 0.;
+      if(p < p1 && _ai[p] == i) d = _lu[p++];
+      _upper[i] = p;
+      // shift zero pivots (e.g. for saddle point problems)
+      if(std::abs(d) <= 1.e-12 * rowMax) d = (rowMax > 0.) ? rowMax : 1.;
+      _invDiag[i] = 1. / d;
+      for(p = p0; p < p1; p++) iw[_ai[p]] = -1;
+    }
+    std::vector<int> level(_n, 0);
+    for(int i = 0; i < _n; i++)
+      for(INDEX_TYPE p = _jptr[i]; p < _jptr[i + 1] && _ai[p] < i; p++)
+        level[i] = std::max(level[i], level[_ai[p]] + 1);
+    levelSchedule(level, _lowerPtr, _lowerRows);
+    for(int i = _n - 1; i >= 0; i--) {
+      level[i] = 0;
+      for(INDEX_TYPE p = _upper[i]; p < _jptr[i + 1]; p++)
+        level[i] = std::max(level[i], level[_ai[p]] + 1);
+    }
+    levelSchedule(level, _upperPtr, _upperRows);
+  }
+  void apply(const double *r, double *z)
+  {
+    for(std::size_t l = 0; l + 1 < _lowerPtr.size(); l++) {
+      const int k0 = _lowerPtr[l], k1 = _lowerPtr[l + 1];
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(k1 - k0 > ompMinSize)
+#endif
+      for(int k = k0; k < k1; k++) {
+        const int i = _lowerRows[k];
+        double s = r[i];
+        for(INDEX_TYPE p = _jptr[i]; p < _jptr[i + 1] && _ai[p] < i; p++)
+          s -= _lu[p] * z[_ai[p]];
+        z[i] = s;
+      }
+    }
+    for(std::size_t l = 0; l + 1 < _upperPtr.size(); l++) {
+      const int k0 = _upperPtr[l], k1 = _upperPtr[l + 1];
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(k1 - k0 > ompMinSize)
+#endif
+      for(int k = k0; k < k1; k++) {
+        const int i = _upperRows[k];
+        double s = z[i];
+        for(INDEX_TYPE p = _upper[i]; p < _jptr[i + 1]; p++)
+          s -= _lu[p] * z[_ai[p]];
+        z[i] = s * _invDiag[i];
+      }
+    }
+  }
+};
+
+// Smoothed V-cycle on a hierarchy built by plain (unsmoothed) aggregation of
+// strongly coupled unknowns, with damped Jacobi smoothing
+class csrAMG : public csrPreconditioner {
+private:
+  struct level {
+    csrMatrixRef A;
+    std::vector<INDEX_TYPE> jptr, ai; // storage of A on coarse levels
+    std::vector<double> a, invDiag;
+    std::vector<int> agg; // aggregate (row on next level) of each row
+    std::vector<int> aggPtr, aggRows; // rows of each aggregate
+    std::vector<double> x, b, r;
+  };
+  std::vector<level> _levels;
+  std::vector<double> _coarseLU;
+  std::vector<int> _coarsePiv;
+  int _nu;
+  double _omega;
+
+  int _aggregate(level &L, double theta)
+  {
+    const csrMatrixRef &A = L.A;
+    const int n = A.n;
+    std::vector<double> d(n);
+    for(int i = 0; i < n; i++) d[i] = std::abs(1. / L.invDiag[i]);
+    std::vector<char> strong(A.jptr[n], 0);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) {
+      for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++) {
+        const int j = A.ai[p];
+        strong[p] =
+          (j != i && std::abs(A.a[p]) >= theta * std::sqrt(d[i] * d[j]));
+      }
+    }
+    std::vector<int> &agg = L.agg;
+    agg.assign(n, -1);
+    int nc = 0;
+    // seeds: unknowns whose strong neighbours are all free
+    for(int i = 0; i < n; i++) {
+      if(agg[i] != -1) continue;
+      bool seed = false;
+      for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++) {
+        if(!strong[p]) continue;
+        seed = true;
+        if(agg[A.ai[p]] != -1) {
+          seed = false;
+          break;
+        }
+      }
+      if(!seed) continue;
+      agg[i] = nc;
+      for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++)
+        if(strong[p]) agg[A.ai[p]] = nc;
+      nc++;
+    }
+    // attach the remaining unknowns to their strongest aggregated neighbour
+    std::vector<int> agg1(agg);
+    for(int i = 0; i < n; i++) {
+      if(agg[i] != -1) continue;
+      double best = 0.;
+      for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++) {
+        const int j = A.ai[p];
+        if(strong[p] && agg1[j] != -1 && std::abs(A.a[p]) > best) {
+          best = std::abs(A.a[p]);
+          agg[i] = agg1[j];
+        }
+      }
+    }
+    // isolated leftovers form their own aggregates
+    for(int i = 0; i < n; i++) {
+      if(agg[i] != -1) continue;
+      agg[i] = nc;
+      for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++)
+        if(strong[p] && agg[A.ai[p]] == -1) agg[A.ai[p]] = nc;
+      nc++;
+    }
+    return nc;
+  }
+  // coarse matrix P^T A P, P being the piecewise constant prolongation
+  void _galerkin(level &L, level &C, int nc)
+  {
+    const csrMatrixRef &A = L.A;
+    levelSchedule(L.agg, L.aggPtr, L.aggRows);
+    std::vector<std::vector<int> > cols(nc);
+    std::vector<std::vector<double> > vals(nc);
+#if defined(_OPENMP)
+#pragma omp parallel if(nc > ompMinSize)
+#endif
+    {
+      std::vector<int> mark(nc, -1);
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic, 64)
+#endif
+      for(int I = 0; I < nc; I++) {
+        for(int k = L.aggPtr[I]; k < L.aggPtr[I + 1]; k++) {
+          const int i = L.aggRows[k];
+          for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++) {
+            const int J = L.agg[A.ai[p]];
+            if(mark[J] < 0) {
+              mark[J] = cols[I].size();
+              cols[I].push_back(J);
+              vals[I].push_back(A.a[p]);
+            }
+            else
+              vals[I][mark[J]] += A.a[p];
+          }
+        }
+        for(std::size_t k = 0; k < cols[I].size(); k++) mark[cols[I][k]] = -1;
+      }
+    }
+    C.jptr.resize(nc + 1);
+    C.jptr[0] = 0;
+    for(int I = 0; I < nc; I++) C.jptr[I + 1] = C.jptr[I] + cols[I].size();
+    C.ai.resize(C.jptr[nc]);
+    C.a.resize(C.jptr[nc]);
+    for(int I = 0; I < nc; I++) {
+      std::copy(cols[I].begin(), cols[I].end(), C.ai.begin() + C.jptr[I]);
+      std::copy(vals[I].begin(), vals[I].end(), C.a.begin() + C.jptr[I]);
+    }
+    C.A.n = nc;
+    C.A.jptr = &C.jptr[0];
+    C.A.ai = C.ai.empty() ? 0 : &C.ai[0];
+    C.A.a = C.a.empty() ? 0 : &C.a[0];
+  }
+  void _factorCoarse()
+  {
+    const csrMatrixRef &A = _levels.back().A;
+    const int n = A.n;
+    _coarseLU.assign(n * n, 0.);
+    _coarsePiv.resize(n);
+    double *M = &_coarseLU[0];
+    double amax = 0.;
+    for(int i = 0; i < n; i++) {
+      for(INDEX_TYPE p = A.jptr[i]; p < A.jptr[i + 1]; p++) {
+        M[i * n + A.ai[p]] += A.a[p];
+        amax = std::max(amax, std::abs(A.a[p]));
+      }
+    }
+    for(int k = 0; k < n; k++) {
+      int piv = k;
+      for(int i = k + 1; i < n; i++)
+        if(std::abs(M[i * n + k]) > std::abs(M[piv * n + k])) piv = i;
+      _coarsePiv[k] = piv;
+      if(piv != k)
+        for(int j = 0; j < n; j++) std::swap(M[k * n + j], M[piv * n + j]);
+      // singular coarse matrix (e.g. pure Neumann problem)
+      if(std::abs(M[k * n + k]) <= 1.e-14 * amax)
+        M[k * n + k] = (amax > 0.) ? amax : 1.;
+      for(int i = k + 1; i < n; i++) {
+        const double f = (M[i * n + k] /= M[k * n + k]);
+        if(f == 0.) continue;
+        for(int j = k + 1; j < n; j++) M[i * n + j] -= f * M[k * n + j];
+      }
+    }
+  }
+  void _smooth(level &L)
+  {
+    const int n = L.A.n;
+    csrResidual(L.A, &L.x[0], &L.b[0], &L.r[0]);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) L.x[i] += _omega * L.invDiag[i] * L.r[i];
+  }
+  void _cycle(std::size_t l)
+  {
+    level &L = _levels[l];
+    const int n = L.A.n;
+    if(l + 1 == _levels.size() && !_coarseLU.empty()) {
+      for(int i = 0; i < n; i++) L.x[i] = L.b[i];
+      const double *M = &_coarseLU[0];
+      for(int k = 0; k < n; k++) std::swap(L.x[k], L.x[_coarsePiv[k]]);
+      for(int i = 0; i < n; i++)
+        for(int j = 0; j < i; j++) L.x[i] -= M[i * n + j] * L.x[j];
+      for(int i = n - 1; i >= 0; i--) {
+        for(int j = i + 1; j < n; j++) L.x[i] -= M[i * n + j] * L.x[j];
+        L.x[i] /= M[i * n + i];
+      }
+      return;
+    }
+    const int nu = (l + 1 == _levels.size()) ? 10 * _nu : _nu;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) L.x[i] = _omega * L.invDiag[i] * L.b[i];
+    for(int s = 1; s < nu; s++) _smooth(L);
+    if(l + 1 == _levels.size()) return;
+    level &C = _levels[l + 1];
+    csrResidual(L.A, &L.x[0], &L.b[0], &L.r[0]);
+    const int nc = C.A.n;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(nc > ompMinSize)
+#endif
+    for(int I = 0; I < nc; I++) {
+      double s = 0.;
+      for(int k = L.aggPtr[I]; k < L.aggPtr[I + 1]; k++) s += L.r[L.aggRows[k]];
+      C.b[I] = s;
+    }
+    _cycle(l + 1);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) L.x[i] += C.x[L.agg[i]];
+    for(int s = 0; s < nu; s++) _smooth(L);
+  }
+
+public:
+  csrAMG(const csrMatrixRef &A) : _nu(2), _omega(2. / 3.)
+  {
+    // no reallocation: coarse levels point to their own storage
+    _levels.reserve(amgMaxLevels);
+    _levels.resize(1);
+    _levels[0].A = A;
+    while(true) {
+      level &L = _levels.back();
+      invertDiagonal(L.A, L.invDiag);
+      L.x.resize(L.A.n);
+      L.b.resize(L.A.n);
+      L.r.resize(L.A.n);
+      if(L.A.n <= 500 || _levels.size() >= amgMaxLevels) break;
+      const int nc = _aggregate(L, 0.08);
+      if(nc > 0.9 * L.A.n) break;
+      _levels.resize(_levels.size() + 1);
+      _galerkin(_levels[_levels.size() - 2], _levels.back(), nc);
+    }
+    // direct solve on the coarsest level if small enough, smoothing otherwise
+    if(_levels.back().A.n <= 1000) _factorCoarse();
+    Msg::Debug("AMG hierarchy with %d levels (coarsest %d unknowns)",
+               (int)_levels.size(), _levels.back().A.n);
+  }
+  void apply(const double *r, double *z)
+  {
+    level &L = _levels[0];
+    std::copy(r, r + L.A.n, L.b.begin());
+    _cycle(0);
+    std::copy(L.x.begin(), L.x.end(), z);
+  }
+};
+
+static int csrCG(const csrMatrixRef &A, csrPreconditioner &M, const double *b,
+                 double *x, double tol, int maxIter, int noisy, double &res)
+{
+  const int n = A.n;
+  const double normb = vecNorm(n, b);
+  if(normb == 0.) {
+    std::fill(x, x + n, 0.);
+    res = 0.;
+    return 0;
+  }
+  std::vector<double> r(n), z(n), p(n), q(n);
+  csrResidual(A, x, b, &r[0]);
+  res = vecNorm(n, &r[0]) / normb;
+  M.apply(&r[0], &z[0]);
+  p = z;
+  double rz = vecDot(n, &r[0], &z[0]);
+  int iter = 0;
+  while(res > tol && iter < maxIter) {
+    csrMult(A, &p[0], &q[0]);
+    const double pq = vecDot(n, &p[0], &q[0]);
+    if(pq == 0.) break;
+    const double alpha = rz / pq;
+    vecAxpy(n, alpha, &p[0], x);
+    vecAxpy(n, -alpha, &q[0], &r[0]);
+    res = vecNorm(n, &r[0]) / normb;
+    iter++;
+    if(noisy > 1) Msg::Info("CG iteration %d: residual %g", iter, res);
+    if(res <= tol) break;
+    M.apply(&r[0], &z[0]);
+    const double rz1 = vecDot(n, &r[0], &z[0]);
+    vecXpby(n, &z[0], rz1 / rz, &p[0]);
+    rz = rz1;
+  }
+  return iter;
+}
+
+static int csrGMRES(const csrMatrixRef &A, csrPreconditioner &M,
+                    const double *b, double *x, double tol, int maxIter,
+                    int restart, int noisy, double &res)
+{
+  const int n = A.n, m = std::max(restart, 1);
+  const double normb = vecNorm(n, b);
+  if(normb == 0.) {
+    std::fill(x, x + n, 0.);
+    res = 0.;
+    return 0;
+  }
+  std::vector<std::vector<double> > V(m + 1, std::vector<double>(n));
+  std::vector<std::vector<double> > H(m + 1, std::vector<double>(m, 0.));
+  std::vector<double> cs(m), sn(m), g(m + 1), y(m), w(n), z(n);
+  csrResidual(A, x, b, &V[0][0]);
+  double beta = vecNorm(n, &V[0][0]);
+  res = beta / normb;
+  int iter = 0;
+  while(res > tol && iter < maxIter) {
+    vecScale(n, 1. / beta, &V[0][0]);
+    std::fill(g.begin(), g.end(), 0.);
+    g[0] = beta;
+    int j = 0;
+    while(j < m && iter < maxIter) {
+      M.apply(&V[j][0], &z[0]);
+      csrMult(A, &z[0], &w[0]);
+      for(int i = 0; i <= j; i++) {
+        H[i][j] = vecDot(n, &w[0], &V[i][0]);
+        vecAxpy(n, -H[i][j], &V[i][0], &w[0]);
+      }
+      H[j + 1][j] = vecNorm(n, &w[0]);
+      if(H[j + 1][j] != 0.)
+        for(int k = 0; k < n; k++) V[j + 1][k] = w[k] / H[j + 1][j];
+      for(int i = 0; i < j; i++) {
+        const double t = cs[i] * H[i][j] + sn[i] * H[i + 1][j];
+        H[i + 1][j] = -sn[i] * H[i][j] + cs[i] * H[i + 1][j];
+        H[i][j] = t;
+      }
+      const double d = std::sqrt(H[j][j] * H[j][j] + H[j + 1][j] * H[j + 1][j]);
+      cs[j] = (d != 0.) ? H[j][j] / d : 1.;
+      sn[j] = (d != 0.) ? H[j + 1][j] / d : 0.;
+      H[j][j] = d;
+      H[j + 1][j] = 0.;
+      g[j + 1] = -sn[j] * g[j];
+      g[j] = cs[j] * g[j];
+      res = std::abs(g[j + 1]) / normb;
+      iter++;
+      j++;
+      if(noisy > 1) Msg::Info("GMRES iteration %d: residual %g", iter, res);
+      if(res <= tol || d == 0.) break;
+    }
+    for(int i = j - 1; i >= 0; i--) {
+      y[i] = g[i];
+      for(int k = i + 1; k < j; k++) y[i] -= H[i][k] * y[k];
+      y[i] = (H[i][i] != 0.) ? y[i] / H[i][i] : 0.;
+    }
+    std::fill(w.begin(), w.end(), 0.);
+    for(int i = 0; i < j; i++) vecAxpy(n, y[i], &V[i][0], &w[0]);
+    M.apply(&w[0], &z[0]);
+    vecAxpy(n, 1., &z[0], x);
+    csrResidual(A, x, b, &V[0][0]);
+    const double beta1 = vecNorm(n, &V[0][0]);
+    res = beta1 / normb;
+    if(beta1 >= beta && j < m && res > tol) break; // stagnation
+    beta = beta1;
+  }
+  return iter;
+}
+
+static int csrBiCGStab(const csrMatrixRef &A, csrPreconditioner &M,
+                       const double *b, double *x, double tol, int maxIter,
+                       int noisy, double &res)
+{
+  const int n = A.n;
+  const double normb = vecNorm(n, b);
+  if(normb == 0.) {
+    std::fill(x, x + n, 0.);
+    res = 0.;
+    return 0;
+  }
+  std::vector<double> r(n), rhat(n), p(n, 0.), v(n, 0.), phat(n), shat(n),
+    t(n);
+  csrResidual(A, x, b, &r[0]);
+  rhat = r;
+  res = vecNorm(n, &r[0]) / normb;
+  double rho = 1., alpha = 1., omega = 1.;
+  int iter = 0;
+  while(res > tol && iter < maxIter) {
+    const double rho1 = vecDot(n, &rhat[0], &r[0]);
+    if(rho1 == 0.) break;
+    const double beta = (rho1 / rho) * (alpha / omega);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    M.apply(&p[0], &phat[0]);
+    csrMult(A, &phat[0], &v[0]);
+    const double rv = vecDot(n, &rhat[0], &v[0]);
+    if(rv == 0.) break;
+    alpha = rho1 / rv;
+    vecAxpy(n, -alpha, &v[0], &r[0]); // r now holds s
+    iter++;
+    const double ress = vecNorm(n, &r[0]) / normb;
+    if(ress <= tol) {
+      vecAxpy(n, alpha, &phat[0], x);
+      res = ress;
+      break;
+    }
+    M.apply(&r[0], &shat[0]);
+    csrMult(A, &shat[0], &t[0]);
+    const double tt = vecDot(n, &t[0], &t[0]);
+    omega = (tt != 0.) ? vecDot(n, &t[0], &r[0]) / tt : 0.;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) if(n > ompMinSize)
+#endif
+    for(int i = 0; i < n; i++) {
+      x[i] += alpha * phat[i] + omega * shat[i];
+      r[i] -= omega * t[i];
+    }
+    res = vecNorm(n, &r[0]) / normb;
+    rho = rho1;
+    if(noisy > 1) Msg::Info("BiCGStab iteration %d: residual %g", iter, res);
+    if(omega == 0.) break;
+  }
+  return iter;
+}
+
+template <> int linearSystemCSRKrylov<double>::systemSolve()
+{
+  if(!_b || _b->empty()) return 1;
+
+  INDEX_TYPE *jptr, *ai;
+  double *a;
+  getMatrix(jptr, ai, a);
+  csrMatrixRef A;
+  A.n = _b->size();
+  A.jptr = jptr;
+  A.ai = ai;
+  A.a = a;
+
+  solverType solver = _solver;
+  std::string s = getParameter("krylovSolver");
+  if(s == "cg")
+    solver = CG;
+  else if(s == "gmres")
+    solver = GMRES;
+  else if(s == "bicgstab")
+    solver = BICGSTAB;
+  else if(s.size())
+    Msg::Warning("Unknown Krylov solver '%s'", s.c_str());
+
+  preconditionerType precond = _precond;
+  s = getParameter("preconditioner");
+  if(s == "none")
+    precond = NONE;
+  else if(s == "jacobi")
+    precond = JACOBI;
+  else if(s == "ilu0")
+    precond = ILU0;
+  else if(s == "amg")
+    precond = AMG;
+  else if(s.size())
+    Msg::Warning("Unknown preconditioner '%s'", s.c_str());
+
+  double t1 = Cpu(), w1 = TimeOfDay();
+  csrPreconditioner *M;
+  switch(precond) {
+  case JACOBI: M = new csrJacobi(A); break;
+  case ILU0: M = new csrILU0(A); break;
+  case AMG: M = new csrAMG(A); break;
+  default: M = new csrIdentity(A.n); break;
+  }
+
+  double res = 0.;
+  int iter = 0;
+  const char *name = "";
+  switch(solver) {
+  case GMRES:
+    name = "GMRES";
+    iter = csrGMRES(A, *M, &(*_b)[0], &(*_x)[0], _prec, _maxIter, _restart,
+                    _noisy, res);
+    break;
+  case BICGSTAB:
+    name = "BiCGStab";
+    iter = csrBiCGStab(A, *M, &(*_b)[0], &(*_x)[0], _prec, _maxIter, _noisy,
+                       res);
+    break;
+  default:
+    name = "CG";
+    iter = csrCG(A, *M, &(*_b)[0], &(*_x)[0], _prec, _maxIter, _noisy, res);
+    break;
+  }
+  delete M;
+
+  double t2 = Cpu(), w2 = TimeOfDay();
+  if(!(res <= _prec)) {
+    Msg::Warning("%s did not converge in %d iterations (residual %g)", name,
+                 iter, res);
+    return 0;
+  }
+  if(_noisy)
+    Msg::Info("%s converged in %d iterations (residual %g, Wall %gs, CPU %gs)",
+              name, iter, res, w2 - w1, t2 - t1);
+  return 1;
+}
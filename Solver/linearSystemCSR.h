@@ -50,6 +50,12 @@ public:
     _sparsity.insertEntry(i, j);
   }
   virtual void preAllocateEntries();
+  // once preallocated (from the sparsity pattern) and sorted, entries are only
+  // looked up, never inserted
+  virtual bool isRowThreadSafe() const
+  {
+    return _entriesPreAllocated && sorted;
+  }
   virtual void addToMatrix(int il, int ic, const scalar &val)
   {
     if(!_entriesPreAllocated) preAllocateEntries();
@@ -193,4 +199,37 @@ public:
   ;
 };
 
+// Native (OpenMP-parallel) preconditioned Krylov solvers working directly on
+// the CSR arrays. The solver and the preconditioner can be selected with the
+// setters or with the "krylovSolver" (cg, gmres, bicgstab) and
+// "preconditioner" (none, jacobi, ilu0, amg) parameters.
+template <class scalar>
+class linearSystemCSRKrylov : public linearSystemCSR<scalar> {
+public:
+  enum solverType { CG, GMRES, BICGSTAB };
+  enum preconditionerType { NONE, JACOBI, ILU0, AMG };
+
+private:
+  solverType _solver;
+  preconditionerType _precond;
+  double _prec;
+  int _maxIter, _restart, _noisy;
+
+public:
+  linearSystemCSRKrylov(solverType solver = CG,
+                        preconditionerType precond = ILU0)
+    : _solver(solver), _precond(precond), _prec(1.e-8), _maxIter(10000),
+      _restart(50), _noisy(0)
+  {
+  }
+  virtual ~linearSystemCSRKrylov() {}
+  void setSolver(solverType s) { _solver = s; }
+  void setPreconditioner(preconditionerType p) { _precond = p; }
+  void setPrec(double p) { _prec = p; }
+  void setMaxIter(int n) { _maxIter = n; }
+  void setRestart(int n) { _restart = n; }
+  void setNoisy(int n) { _noisy = n; }
+  virtual int systemSolve();
+};
+
 #endif
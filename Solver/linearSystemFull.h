@@ -22,6 +22,7 @@ private:
 public:
   linearSystemFull() : _a(0), _b(0), _x(0) {}
   virtual bool isAllocated() const { return _a != 0; }
+  virtual bool isRowThreadSafe() const { return true; }
   virtual void allocate(int nbRows)
   {
     clear();
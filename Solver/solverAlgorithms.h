@@ -14,6 +14,7 @@
 #include "terms.h"
 #include "quadratureRules.h"
 #include "MVertex.h"
+#include "groupOfElements.h"
 
 template <class Iterator, class Assembler>
 void Assemble(BilinearTermBase &term, FunctionSpaceBase &space,
@@ -166,6 +167,133 @@ void Assemble(LinearTermBase<double> &term, FunctionSpaceBase &space,
   assembler.assemble(R, localVector);
 }
 
+// The quadrature rules are built on first use, which is not thread-safe:
+// build the ones needed by the elements of a group serially, before
+// assembling it in parallel
+inline void prepareIntPoints(const groupOfElements &group,
+                             QuadratureBase &integrator)
+{
+#if defined(_OPENMP)
+  for(groupOfElements::elementContainer::const_iterator it = group.begin();
+      it != group.end(); ++it) {
+    IntPt *GP;
+    integrator.getIntPoints(*it, &GP);
+  }
+#endif
+}
+
+// Assembly over a group of elements, colour by colour: the elementary
+// matrices of a colour are computed in parallel and, if the assembler allows
+// it, added concurrently to the system (elements of a colour share no Dof)
+template <class Assembler>
+void Assemble(BilinearTermBase &term, FunctionSpaceBase &space,
+              const groupOfElements &group, QuadratureBase &integrator,
+              Assembler &assembler) // symmetric
+{
+  const std::vector<groupOfElements::elementContainer> &colours =
+    group.getColours();
+  const bool concurrent = assembler.prepareConcurrentAssembly();
+  prepareIntPoints(group, integrator);
+  std::vector<fullMatrix<typename Assembler::dataMat> > localMatrices;
+  std::vector<std::vector<Dof> > R;
+  for(std::size_t c = 0; c < colours.size(); c++) {
+    const groupOfElements::elementContainer &elements = colours[c];
+    const int n = elements.size();
+    localMatrices.resize(n);
+    R.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for(int i = 0; i < n; i++) {
+      MElement *e = elements[i];
+      R[i].clear();
+      IntPt *GP;
+      int npts = integrator.getIntPoints(e, &GP);
+      term.get(e, npts, GP, localMatrices[i]);
+      space.getKeys(e, R[i]);
+      if(concurrent) assembler.assemble(R[i], localMatrices[i]);
+    }
+    if(!concurrent)
+      for(int i = 0; i < n; i++) assembler.assemble(R[i], localMatrices[i]);
+  }
+}
+
+template <class Assembler>
+void Assemble(BilinearTermBase &term, FunctionSpaceBase &shapeFcts,
+              FunctionSpaceBase &testFcts, const groupOfElements &group,
+              QuadratureBase &integrator, Assembler &assembler) // non symmetric
+{
+  const std::vector<groupOfElements::elementContainer> &colours =
+    group.getColours();
+  const bool concurrent = assembler.prepareConcurrentAssembly();
+  prepareIntPoints(group, integrator);
+  std::vector<fullMatrix<typename Assembler::dataMat> > localMatrices;
+  std::vector<std::vector<Dof> > R, C;
+  for(std::size_t c = 0; c < colours.size(); c++) {
+    const groupOfElements::elementContainer &elements = colours[c];
+    const int n = elements.size();
+    localMatrices.resize(n);
+    R.resize(n);
+    C.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for(int i = 0; i < n; i++) {
+      MElement *e = elements[i];
+      R[i].clear();
+      C[i].clear();
+      IntPt *GP;
+      int npts = integrator.getIntPoints(e, &GP);
+      term.get(e, npts, GP, localMatrices[i]);
+      shapeFcts.getKeys(e, R[i]);
+      testFcts.getKeys(e, C[i]);
+      if(concurrent) {
+        assembler.assemble(R[i], C[i], localMatrices[i]);
+        assembler.assemble(C[i], R[i], localMatrices[i].transpose());
+      }
+    }
+    if(!concurrent) {
+      for(int i = 0; i < n; i++) {
+        assembler.assemble(R[i], C[i], localMatrices[i]);
+        assembler.assemble(C[i], R[i], localMatrices[i].transpose());
+      }
+    }
+  }
+}
+
+template <class Assembler>
+void Assemble(LinearTermBase<double> &term, FunctionSpaceBase &space,
+              const groupOfElements &group, QuadratureBase &integrator,
+              Assembler &assembler)
+{
+  const std::vector<groupOfElements::elementContainer> &colours =
+    group.getColours();
+  const bool concurrent = assembler.prepareConcurrentAssembly();
+  prepareIntPoints(group, integrator);
+  std::vector<fullVector<typename Assembler::dataMat> > localVectors;
+  std::vector<std::vector<Dof> > R;
+  for(std::size_t c = 0; c < colours.size(); c++) {
+    const groupOfElements::elementContainer &elements = colours[c];
+    const int n = elements.size();
+    localVectors.resize(n);
+    R.resize(n);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for(int i = 0; i < n; i++) {
+      MElement *e = elements[i];
+      R[i].clear();
+      IntPt *GP;
+      int npts = integrator.getIntPoints(e, &GP);
+      term.get(e, npts, GP, localVectors[i]);
+      space.getKeys(e, R[i]);
+      if(concurrent) assembler.assemble(R[i], localVectors[i]);
+    }
+    if(!concurrent)
+      for(int i = 0; i < n; i++) assembler.assemble(R[i], localVectors[i]);
+  }
+}
+
 template <class Iterator, class dataMat>
 void Assemble(ScalarTermBase<double> &term, Iterator itbegin, Iterator itend,
               QuadratureBase &integrator, dataMat &val)
@@ -323,6 +451,40 @@ void NumberDofs(FunctionSpaceBase &space, Iterator itbegin, Iterator itend,
   }
 }
 
+// Insert the couplings between the (numbered) Dofs of each element in the
+// sparsity pattern, so that the entries of the matrix can be preallocated
+template <class Iterator, class Assembler>
+void SparsityDofs(FunctionSpaceBase &space, Iterator itbegin, Iterator itend,
+                  Assembler &assembler)
+{
+  std::vector<Dof> R;
+  for(Iterator it = itbegin; it != itend; ++it) {
+    R.clear();
+    space.getKeys(*it, R);
+    assembler.sparsityDof(R);
+  }
+}
+
+// Same for the couplings between the Dofs of two spaces (in both directions)
+template <class Iterator, class Assembler>
+void SparsityDofs(FunctionSpaceBase &shapeFcts, FunctionSpaceBase &testFcts,
+                  Iterator itbegin, Iterator itend, Assembler &assembler)
+{
+  std::vector<Dof> R, C;
+  for(Iterator it = itbegin; it != itend; ++it) {
+    R.clear();
+    C.clear();
+    shapeFcts.getKeys(*it, R);
+    testFcts.getKeys(*it, C);
+    for(std::size_t i = 0; i < R.size(); i++) {
+      for(std::size_t j = 0; j < C.size(); j++) {
+        assembler.insertInSparsityPattern(R[i], C[j]);
+        assembler.insertInSparsityPattern(C[j], R[i]);
+      }
+    }
+  }
+}
+
   //// Mean HangingNodes
   // template <class Assembler> void FillHangingNodes(FunctionSpaceBase &space,
   // std::map<int,std::vector <int> > &HangingNodes, Assembler &assembler, int
@@ -41,11 +41,14 @@ void thermicSolver::solve()
 {
 #if defined(HAVE_PETSC)
   linearSystemPETSc<double> *lsys = new linearSystemPETSc<double>;
-#elif defined(HAVE_GMM)
-  linearSystemGmm<double> *lsys = new linearSystemGmm<double>;
-  lsys->setNoisy(2);
 #else
-  linearSystemFull<double> *lsys = new linearSystemFull<double>;
+  linearSystemCSRKrylov<double> *lsys = new linearSystemCSRKrylov<double>;
+  // Lagrange multipliers make the system indefinite
+  if(LagrangeMultiplierFields.size())
+    lsys->setSolver(linearSystemCSRKrylov<double>::GMRES);
+  else
+    lsys->setPreconditioner(linearSystemCSRKrylov<double>::AMG);
+  lsys->setNoisy(1);
 #endif
   assemble(lsys);
   lsys->systemSolve();
@@ -133,13 +136,26 @@ void thermicSolver::assemble(linearSystem<double> *lsys)
     NumberDofs(*LagSpace, thermicFields[i].g->begin(),
                thermicFields[i].g->end(), *pAssembler);
   }
+  // Sparsity pattern of the terms assembled below, so that the matrix entries
+  // are preallocated (and can then be assembled concurrently)
+  for(std::size_t i = 0; i < LagrangeMultiplierFields.size(); i++) {
+    SparsityDofs(*LagSpace, *LagrangeMultiplierSpace,
+                 LagrangeMultiplierFields[i].g->begin(),
+                 LagrangeMultiplierFields[i].g->end(), *pAssembler);
+    SparsityDofs(*LagrangeMultiplierSpace,
+                 LagrangeMultiplierFields[i].g->begin(),
+                 LagrangeMultiplierFields[i].g->end(), *pAssembler);
+  }
+  for(std::size_t i = 0; i < thermicFields.size(); i++)
+    SparsityDofs(*LagSpace, thermicFields[i].g->begin(),
+                 thermicFields[i].g->end(), *pAssembler);
+  if(lsys->isAllocated()) lsys->preAllocateEntries();
   // Neumann conditions
   GaussQuadrature Integ_Boundary(GaussQuadrature::Val);
   for(std::size_t i = 0; i < allNeumann.size(); i++) {
     std::cout << "Neumann BC" << std::endl;
     LoadTerm<double> Lterm(*LagSpace, allNeumann[i]._f);
-    Assemble(Lterm, *LagSpace, allNeumann[i].g->begin(), allNeumann[i].g->end(),
-             Integ_Boundary, *pAssembler);
+    Assemble(Lterm, *LagSpace, *allNeumann[i].g, Integ_Boundary, *pAssembler);
   }
   // Assemble cross term, laplace term and rhs term for LM
   GaussQuadrature Integ_LagrangeMult(GaussQuadrature::ValVal);
@@ -149,29 +165,25 @@ void thermicSolver::assemble(linearSystem<double> *lsys)
     LagrangeMultiplierTerm<double> LagTerm(*LagSpace, *LagrangeMultiplierSpace,
                                            1.);
     Assemble(LagTerm, *LagSpace, *LagrangeMultiplierSpace,
-             LagrangeMultiplierFields[i].g->begin(),
-             LagrangeMultiplierFields[i].g->end(), Integ_LagrangeMult,
+             *LagrangeMultiplierFields[i].g, Integ_LagrangeMult,
              *pAssembler);
     printf("Lagrange Mult Lap\n");
     LaplaceTerm<double, double> LapTerm(*LagrangeMultiplierSpace,
                                         -LagrangeMultiplierFields[i]._tau);
     Assemble(LapTerm, *LagrangeMultiplierSpace,
-             LagrangeMultiplierFields[i].g->begin(),
-             LagrangeMultiplierFields[i].g->end(), Integ_Laplace, *pAssembler);
+             *LagrangeMultiplierFields[i].g, Integ_Laplace, *pAssembler);
     printf("Lagrange Mult Load\n");
     LoadTermOnBorder<double> Lterm(*LagrangeMultiplierSpace,
                                    LagrangeMultiplierFields[i]._f);
     Assemble(Lterm, *LagrangeMultiplierSpace,
-             LagrangeMultiplierFields[i].g->begin(),
-             LagrangeMultiplierFields[i].g->end(), Integ_Boundary, *pAssembler);
+             *LagrangeMultiplierFields[i].g, Integ_Boundary, *pAssembler);
   }
   // Assemble thermic term
   GaussQuadrature Integ_Bulk(GaussQuadrature::ValVal);
   for(std::size_t i = 0; i < thermicFields.size(); i++) {
     printf("Thermic Term\n");
     LaplaceTerm<double, double> Tterm(*LagSpace, thermicFields[i]._k);
-    Assemble(Tterm, *LagSpace, thermicFields[i].g->begin(),
-             thermicFields[i].g->end(), Integ_Bulk, *pAssembler);
+    Assemble(Tterm, *LagSpace, *thermicFields[i].g, Integ_Bulk, *pAssembler);
   }
 
   /*for (int i = 0;i<pAssembler->sizeOfR();i++){
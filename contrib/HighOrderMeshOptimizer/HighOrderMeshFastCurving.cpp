@@ -1329,7 +1329,7 @@ void HighOrderMeshFastCurving(GModel *gm, FastCurvingParameters &p,
       for(int iBndEnt = 0; iBndEnt < bndEnts.size(); iBndEnt++) {
         GEntity *&bndEnt = bndEnts[iBndEnt];
         for(std::size_t k = 0; k < blFields.size(); ++k) {
-          if(blFields[k]->isEdgeBL(bndEnt->tag())) {
+          if(blFields[k]->isEdgeBLSaved(bndEnt->tag())) {
             blBndEnts.insert(bndEnt);
             break;
           }
@@ -78,20 +78,18 @@ bool ObjContribScaledJac<FuncType>::addContrib(double &Obj,
   _min = BIGVAL;
   _max = -BIGVAL;
 
+  std::vector<std::vector<double> > sJ, gSJ; // Scaled Jacobians and gradients
+  _mesh->scaledJacAndGradients(sJ, gSJ);
   for(int iEl = 0; iEl < _mesh->nEl(); iEl++) {
-    std::vector<double> sJ(_mesh->nBezEl(iEl)); // Scaled Jacobians
-    std::vector<double> gSJ(_mesh->nBezEl(iEl) *
-                            _mesh->nPCEl(iEl)); // Gradients of scaled Jacobians
-    _mesh->scaledJacAndGradients(iEl, sJ, gSJ);
     for(int l = 0; l < _mesh->nBezEl(iEl);
         l++) { // Add contribution for each Bezier coeff.
-      Obj += _weight * FuncType::compute(sJ[l]);
-      const double dfact = _weight * FuncType::computeDiff(sJ[l]);
+      Obj += _weight * FuncType::compute(sJ[iEl][l]);
+      const double dfact = _weight * FuncType::computeDiff(sJ[iEl][l]);
       for(int iPC = 0; iPC < _mesh->nPCEl(iEl); iPC++)
         gradObj[_mesh->indPCEl(iEl, iPC)] +=
-          dfact * gSJ[_mesh->indGSJ(iEl, l, iPC)];
-      _min = std::min(_min, sJ[l]);
-      _max = std::max(_max, sJ[l]);
+          dfact * gSJ[iEl][_mesh->indGSJ(iEl, l, iPC)];
+      _min = std::min(_min, sJ[iEl][l]);
+      _max = std::max(_max, sJ[iEl][l]);
     }
   }
 
@@ -103,14 +101,12 @@ template <class FuncType> void ObjContribScaledJac<FuncType>::updateMinMax()
   _min = BIGVAL;
   _max = -BIGVAL;
 
+  std::vector<std::vector<double> > sJ, dumGSJ; // Scaled Jacobians
+  _mesh->scaledJacAndGradients(sJ, dumGSJ);
   for(int iEl = 0; iEl < _mesh->nEl(); iEl++) {
-    std::vector<double> sJ(_mesh->nBezEl(iEl)); // Scaled Jacobians
-    std::vector<double> dumGSJ(
-      _mesh->nBezEl(iEl) * _mesh->nPCEl(iEl)); // Gradients of scaled Jacobians
-    _mesh->scaledJacAndGradients(iEl, sJ, dumGSJ);
     for(int l = 0; l < _mesh->nBezEl(iEl); l++) { // Check each Bezier coeff.
-      _min = std::min(_min, sJ[l]);
-      _max = std::max(_max, sJ[l]);
+      _min = std::min(_min, sJ[iEl][l]);
+      _max = std::max(_max, sJ[iEl][l]);
     }
   }
 }
@@ -356,6 +356,47 @@ namespace {
     return result;
   }
 
+  // Distribute the patches into sets that can be optimized concurrently: two
+  // patches conflict if a node of the elements of one of them is free in the
+  // other one (which can only happen with weak merging)
+  void colourPatches(const std::vector<elSetVertSetPair> &patches,
+                     std::vector<std::vector<int> > &colours)
+  {
+    std::map<MVertex *, std::vector<int> > vertex2patches;
+    for(int iPatch = 0; iPatch < patches.size(); ++iPatch) {
+      const elSet &els = patches[iPatch].first;
+      for(elSet::const_iterator itEl = els.begin(); itEl != els.end(); ++itEl)
+        for(int iV = 0; iV < (*itEl)->getNumVertices(); ++iV) {
+          std::vector<int> &p = vertex2patches[(*itEl)->getVertex(iV)];
+          if(p.empty() || p.back() != iPatch) p.push_back(iPatch);
+        }
+    }
+
+    std::vector<int> colour(patches.size(), -1);
+    for(int iPatch = 0; iPatch < patches.size(); ++iPatch) {
+      const elSet &els = patches[iPatch].first;
+      const vertSet &fixed = patches[iPatch].second;
+      std::set<int> forbidden;
+      for(elSet::const_iterator itEl = els.begin(); itEl != els.end(); ++itEl)
+        for(int iV = 0; iV < (*itEl)->getNumVertices(); ++iV) {
+          MVertex *v = (*itEl)->getVertex(iV);
+          const bool isFree = (fixed.find(v) == fixed.end());
+          const std::vector<int> &p = vertex2patches[v];
+          for(std::size_t k = 0; k < p.size(); ++k) {
+            if(p[k] == iPatch || colour[p[k]] < 0) continue;
+            if(isFree || patches[p[k]].second.find(v) ==
+                           patches[p[k]].second.end())
+              forbidden.insert(colour[p[k]]);
+          }
+        }
+      int c = 0;
+      while(forbidden.find(c) != forbidden.end()) c++;
+      colour[iPatch] = c;
+      if(c >= colours.size()) colours.resize(c + 1);
+      colours[c].push_back(iPatch);
+    }
+  }
+
   // Get (bad) boundary elements adjacent to patch
   void getAdjacentBndElts(const elElMap &el2BndEl, const elEntMap &bndEl2Ent,
                           const elSet &elts, elSet &bndElts,
@@ -469,66 +510,90 @@ namespace {
         getAdjacentBndElts(el2BndEl, bndEl2Ent, toOptimize[iPatch].first,
                            bndElts[iPatch], par);
     }
+    // Patches of the same set are optimized concurrently, each with its own
+    // copy of the objective function (the ncurses display is serial)
+    std::vector<std::vector<int> > colours;
+    colourPatches(toOptimize, colours);
+    const bool parallel = !par.nCurses && par.logFileName.empty();
+    if(par.verbose > 1)
+      Msg::Info("Optimizing %i patches in %i independent sets",
+                toOptimize.size(), colours.size());
+
     if(par.nCurses) displayResultTable(nbPatchSuccess, toOptimize.size());
-    for(int iPatch = 0; iPatch < toOptimize.size(); ++iPatch) {
-      // Initialize optimization and output if asked
-      if(par.nCurses) {
-        mvbold(true);
-        mvprintCenter(10, " PATCH %5i ", iPatch);
-        mvbold(false);
-      }
-      if(par.verbose > 1)
-        Msg::Info("Optimizing patch %i/%i composed of %i elements, "
-                  "%i boundary elements",
-                  iPatch, toOptimize.size() - 1,
-                  toOptimize[iPatch].first.size(), bndElts[iPatch].size());
-      MeshOpt opt(e2eOpt, bndEl2Ent, toOptimize[iPatch].first,
-                  toOptimize[iPatch].second, bndElts[iPatch], par);
-      if(par.verbose > 3) {
-        std::ostringstream ossI1;
-        ossI1 << "initial_patch-" << iPatch << ".msh";
-        opt.patch.writeMSH(ossI1.str().c_str());
-      }
+    for(std::size_t iCol = 0; iCol < colours.size(); ++iCol) {
+      const std::vector<int> &colour = colours[iCol];
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic) if(parallel)
+#endif
+      for(int k = 0; k < (int)colour.size(); ++k) {
+        const int iPatch = colour[k];
+        // Initialize optimization and output if asked
+        if(par.nCurses) {
+          mvbold(true);
+          mvprintCenter(10, " PATCH %5i ", iPatch);
+          mvbold(false);
+        }
+        if(par.verbose > 1)
+          Msg::Info("Optimizing patch %i/%i composed of %i elements, "
+                    "%i boundary elements",
+                    iPatch, toOptimize.size() - 1,
+                    toOptimize[iPatch].first.size(), bndElts[iPatch].size());
+        MeshOpt opt(e2eOpt, bndEl2Ent, toOptimize[iPatch].first,
+                    toOptimize[iPatch].second, bndElts[iPatch], par);
+        if(par.verbose > 3) {
+          std::ostringstream ossI1;
+          ossI1 << "initial_patch-" << iPatch << ".msh";
+          opt.patch.writeMSH(ossI1.str().c_str());
+        }
 
-      // Optimize patch
-      int success = -1;
-      if(opt.patch.nPC() > 0)
-        success = opt.optimize(par);
-      else if(par.verbose > 1)
-        Msg::Info("Patch %i has no degree of freedom, skipping", iPatch);
-
-      if(par.verbose > 3) {
-        std::ostringstream ossI2;
-        ossI2 << "final_patch-" << iPatch << ".msh";
-        opt.patch.writeMSH(ossI2.str().c_str());
-      }
+        // Optimize patch
+        int success = -1;
+        if(opt.patch.nPC() > 0)
+          success = opt.optimize(par);
+        else if(par.verbose > 1)
+          Msg::Info("Patch %i has no degree of freedom, skipping", iPatch);
 
-      // Evaluate mesh and update it if (partial) success
-      opt.updateResults();
-      if(newObjFunctionRange.size() == 0) {
-        newObjFunctionRange = opt.objFunction()->minMax();
-        objFunctionNames = opt.objFunction()->names();
-      }
-      else {
-        for(int i = 0; i < newObjFunctionRange.size(); i++) {
-          newObjFunctionRange[i].first = std::min(
-            newObjFunctionRange[i].first, opt.objFunction()->minMax()[i].first);
-          newObjFunctionRange[i].second =
-            std::max(newObjFunctionRange[i].second,
-                     opt.objFunction()->minMax()[i].second);
+        if(par.verbose > 3) {
+          std::ostringstream ossI2;
+          ossI2 << "final_patch-" << iPatch << ".msh";
+          opt.patch.writeMSH(ossI2.str().c_str());
         }
-      }
-      if(success >= 0) opt.patch.updateGEntityPositions();
 
-      //#pragma omp critical
-      par.success = std::min(par.success, success);
+        // Evaluate mesh and update it if (partial) success
+        opt.updateResults();
+        std::vector<std::pair<double, double> > range =
+          opt.objFunction()->minMax();
+        if(success >= 0) opt.patch.updateGEntityPositions();
 
-      nbPatchSuccess[success + 1]++;
-      if(par.nCurses) {
-        displayMinMaxVal(nbPatchSuccess, objFunctionNames, newObjFunctionRange);
-        displayResultTable(nbPatchSuccess, toOptimize.size());
-        updateDisplayPatchHistory(_patchHistory, opt.objFunction()->minMaxStr(),
-                                  iPatch, -1);
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+        {
+          if(newObjFunctionRange.size() == 0) {
+            newObjFunctionRange = range;
+            objFunctionNames = opt.objFunction()->names();
+          }
+          else {
+            for(int i = 0; i < newObjFunctionRange.size(); i++) {
+              newObjFunctionRange[i].first =
+                std::min(newObjFunctionRange[i].first, range[i].first);
+              newObjFunctionRange[i].second =
+                std::max(newObjFunctionRange[i].second, range[i].second);
+            }
+          }
+
+          par.success = std::min(par.success, success);
+
+          nbPatchSuccess[success + 1]++;
+          if(par.nCurses) {
+            displayMinMaxVal(nbPatchSuccess, objFunctionNames,
+                             newObjFunctionRange);
+            displayResultTable(nbPatchSuccess, toOptimize.size());
+            updateDisplayPatchHistory(_patchHistory,
+                                      opt.objFunction()->minMaxStr(), iPatch,
+                                      -1);
+          }
+        }
       }
     }
     while(_patchHistory.size() > 0) {
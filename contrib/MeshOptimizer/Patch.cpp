@@ -328,6 +328,99 @@ void Patch::gradScaledNodeDispSq(int iFV, std::vector<double> &gDSq)
   if(_nPCFV[iFV] == 3) gDSq[2] = gUvw[2];
 }
 
+void Patch::initJacBlocks()
+{
+  if(!_jacBlocks.empty()) return;
+  std::map<const JacobianBasis *, int> basis2Block;
+  for(int iEl = 0; iEl < nEl(); iEl++) {
+    const JacobianBasis *jacBasis = _el[iEl]->getJacobianFuncSpace();
+    std::map<const JacobianBasis *, int>::iterator it =
+      basis2Block.find(jacBasis);
+    if(it == basis2Block.end()) {
+      basis2Block[jacBasis] = _jacBlocks.size();
+      _jacBlocks.push_back(std::vector<int>(1, iEl));
+    }
+    else
+      _jacBlocks[it->second].push_back(iEl);
+  }
+}
+
+void Patch::jacAndGradientsBlocks(bool ideal,
+                                  const std::vector<fullMatrix<double> > &normEl,
+                                  const std::vector<double> &invJacEl,
+                                  std::vector<std::vector<double> > &J,
+                                  std::vector<std::vector<double> > &gJ)
+{
+  J.resize(nEl());
+  gJ.resize(nEl());
+
+  for(std::size_t iB = 0; iB < _jacBlocks.size(); iB++) {
+    const std::vector<int> &block = _jacBlocks[iB];
+    const int nElB = block.size();
+    const JacobianBasis *jacBasis = _el[block[0]]->getJacobianFuncSpace();
+    const int numJacNodes = jacBasis->getNumJacNodes();
+    const int numMapNodes = _nNodEl[block[0]];
+    const int numCol = 3 * numMapNodes + 1;
+
+    // Pack coordinates of nodes and normals of all elements in block
+    fullMatrix<double> nodesXYZ(numMapNodes, 3 * nElB, false),
+      normals(2, 3 * nElB);
+    for(int e = 0; e < nElB; e++) {
+      const int iEl = block[e];
+      for(int i = 0; i < numMapNodes; i++) {
+        const SPoint3 &p = _xyz[_el2V[iEl][i]];
+        nodesXYZ(i, 3 * e) = p.x();
+        nodesXYZ(i, 3 * e + 1) = p.y();
+        nodesXYZ(i, 3 * e + 2) = p.z();
+      }
+      if(_dim < 3 && iEl < (int)normEl.size())
+        for(int r = 0; r < normEl[iEl].size1(); r++)
+          for(int k = 0; k < 3; k++) normals(r, 3 * e + k) = normEl[iEl](r, k);
+    }
+
+    // Calculate Jacobians and gradients, and transform them from Lagrangian
+    // to Bezier basis with a single matrix product for all elements
+    fullMatrix<double> JDJ(numJacNodes, numCol * nElB, false),
+      BDB(numJacNodes, numCol * nElB, false);
+    jacBasis->getSignedJacAndGradientsBlock(nodesXYZ, normals, JDJ, ideal);
+    jacBasis->lag2Bez(JDJ, BDB);
+
+    // Unpack, scale if 3D (already scaled by regularization normals in 2D)
+    std::vector<SPoint3> gXyzV(numJacNodes);
+    std::vector<SPoint3> gUvwV(numJacNodes);
+    for(int e = 0; e < nElB; e++) {
+      const int iEl = block[e];
+      const int c0 = e * numCol;
+      const double scale =
+        (_dim == 3 && !invJacEl.empty()) ? invJacEl[iEl] : 1.;
+      std::vector<double> &JEl = J[iEl], &gJEl = gJ[iEl];
+      JEl.resize(numJacNodes);
+      gJEl.resize(numJacNodes * nPCEl(iEl));
+      for(int l = 0; l < numJacNodes; l++)
+        JEl[l] = scale * BDB(l, c0 + 3 * numMapNodes);
+      int iPC = 0;
+      for(int i = 0; i < numMapNodes; i++) {
+        int &iFVi = _el2FV[iEl][i];
+        if(iFVi >= 0) {
+          for(int l = 0; l < numJacNodes; l++)
+            gXyzV[l] = SPoint3(scale * BDB(l, c0 + i),
+                               scale * BDB(l, c0 + i + numMapNodes),
+                               scale * BDB(l, c0 + i + 2 * numMapNodes));
+          _coordFV[iFVi]->gXyz2gUvw(_uvw[iFVi], gXyzV, gUvwV);
+          for(int l = 0; l < numJacNodes; l++) {
+            gJEl[iPC * numJacNodes + l] = gUvwV[l][0];
+            if(_nPCFV[iFVi] >= 2)
+              gJEl[(iPC + 1) * numJacNodes + l] = gUvwV[l][1];
+            if(_nPCFV[iFVi] == 3)
+              gJEl[(iPC + 2) * numJacNodes + l] = gUvwV[l][2];
+          }
+          iPC += _nPCFV[iFVi];
+        }
+      }
+    }
+  }
+}
+
 void Patch::initScaledJac()
 {
   // Initialize _nBezEl
@@ -336,6 +429,7 @@ void Patch::initScaledJac()
     for(int iEl = 0; iEl < nEl(); iEl++)
       _nBezEl[iEl] = _el[iEl]->getJacobianFuncSpace()->getNumJacNodes();
   }
+  initJacBlocks();
 
   // Set normals to 2D elements (with magnitude of inverse Jacobian) or initial
   // Jacobians of 3D elements
@@ -412,55 +506,10 @@ void Patch::calcNormalEl2D(int iEl, NormalScaling scaling,
                         // scaling operation on the Jacobian
 }
 
-void Patch::scaledJacAndGradients(int iEl, std::vector<double> &sJ,
-                                  std::vector<double> &gSJ)
+void Patch::scaledJacAndGradients(std::vector<std::vector<double> > &sJ,
+                                  std::vector<std::vector<double> > &gSJ)
 {
-  const JacobianBasis *jacBasis = _el[iEl]->getJacobianFuncSpace();
-  const int &numJacNodes = _nBezEl[iEl];
-  const int &numMapNodes = _nNodEl[iEl];
-  fullMatrix<double> JDJ(numJacNodes, 3 * numMapNodes + 1),
-    BDB(numJacNodes, 3 * numMapNodes + 1);
-
-  // Coordinates of nodes
-  fullMatrix<double> nodesXYZ(numMapNodes, 3), normals(_dim, 3);
-  for(int i = 0; i < numMapNodes; i++) {
-    int &iVi = _el2V[iEl][i];
-    nodesXYZ(i, 0) = _xyz[iVi].x();
-    nodesXYZ(i, 1) = _xyz[iVi].y();
-    nodesXYZ(i, 2) = _xyz[iVi].z();
-  }
-
-  // Calculate Jacobian and gradients, scale if 3D (already scaled by
-  // regularization normals in 2D)
-  jacBasis->getSignedJacAndGradients(nodesXYZ, _JacNormEl[iEl], JDJ);
-  if(_dim == 3) JDJ.scale(_invStraightJac[iEl]);
-
-  // Transform Jacobian and gradients from Lagrangian to Bezier basis
-  jacBasis->lag2Bez(JDJ, BDB);
-
-  // Scaled jacobian
-  for(int l = 0; l < numJacNodes; l++) sJ[l] = BDB(l, 3 * numMapNodes);
-
-  // Gradients of the scaled jacobian
-  int iPC = 0;
-  std::vector<SPoint3> gXyzV(numJacNodes);
-  std::vector<SPoint3> gUvwV(numJacNodes);
-  for(int i = 0; i < numMapNodes; i++) {
-    int &iFVi = _el2FV[iEl][i];
-    if(iFVi >= 0) {
-      for(int l = 0; l < numJacNodes; l++)
-        gXyzV[l] =
-          SPoint3(BDB(l, i + 0 * numMapNodes), BDB(l, i + 1 * numMapNodes),
-                  BDB(l, i + 2 * numMapNodes));
-      _coordFV[iFVi]->gXyz2gUvw(_uvw[iFVi], gXyzV, gUvwV);
-      for(int l = 0; l < numJacNodes; l++) {
-        gSJ[indGSJ(iEl, l, iPC)] = gUvwV[l][0];
-        if(_nPCFV[iFVi] >= 2) gSJ[indGSJ(iEl, l, iPC + 1)] = gUvwV[l][1];
-        if(_nPCFV[iFVi] == 3) gSJ[indGSJ(iEl, l, iPC + 2)] = gUvwV[l][2];
-      }
-      iPC += _nPCFV[iFVi];
-    }
-  }
+  jacAndGradientsBlocks(false, _JacNormEl, _invStraightJac, sJ, gSJ);
 }
 
 void Patch::metricMinAndGradients(int iEl, std::vector<double> &lambda,
@@ -770,6 +819,7 @@ void Patch::initIdealJac()
     for(int iEl = 0; iEl < nEl(); iEl++)
       _nIJacEl[iEl] = _el[iEl]->getJacobianFuncSpace()->getNumJacNodes();
   }
+  initJacBlocks();
 
   // Set normals to 2D elements (with magnitude of inverse Jacobian) or initial
   // Jacobians of 3D elements
@@ -791,54 +841,10 @@ void Patch::initIdealJac()
   }
 }
 
-void Patch::idealJacAndGradients(int iEl, std::vector<double> &iJ,
-                                 std::vector<double> &gIJ)
+void Patch::idealJacAndGradients(std::vector<std::vector<double> > &iJ,
+                                 std::vector<std::vector<double> > &gIJ)
 {
-  const JacobianBasis *jacBasis = _el[iEl]->getJacobianFuncSpace();
-  const int &numJacNodes = _nIJacEl[iEl];
-  const int &numMapNodes = _nNodEl[iEl];
-  fullMatrix<double> JDJ(numJacNodes, 3 * numMapNodes + 1),
-    BDB(numJacNodes, 3 * numMapNodes + 1);
-
-  // Coordinates of nodes
-  fullMatrix<double> nodesXYZ(numMapNodes, 3), normals(_dim, 3);
-  for(int i = 0; i < numMapNodes; i++) {
-    int &iVi = _el2V[iEl][i];
-    nodesXYZ(i, 0) = _xyz[iVi].x();
-    nodesXYZ(i, 1) = _xyz[iVi].y();
-    nodesXYZ(i, 2) = _xyz[iVi].z();
-  }
-
-  // Calculate Jacobian and gradients, scale if 3D (already scaled by
-  // regularization normals in 2D)
-  jacBasis->getSignedIdealJacAndGradients(nodesXYZ, _IJacNormEl[iEl], JDJ);
-  if(_dim == 3) JDJ.scale(_invIJac[iEl]);
-
-  // Transform Jacobian and gradients from Lagrangian to Bezier basis
-  jacBasis->lag2Bez(JDJ, BDB);
-
-  // Scaled jacobian
-  for(int l = 0; l < numJacNodes; l++) iJ[l] = BDB(l, 3 * numMapNodes);
-
-  // Gradients of the scaled jacobian
-  int iPC = 0;
-  std::vector<SPoint3> gXyzV(numJacNodes);
-  std::vector<SPoint3> gUvwV(numJacNodes);
-  for(int i = 0; i < numMapNodes; i++) {
-    int &iFVi = _el2FV[iEl][i];
-    if(iFVi >= 0) {
-      for(int l = 0; l < numJacNodes; l++)
-        gXyzV[l] = SPoint3(BDB(l, i), BDB(l, i + numMapNodes),
-                           BDB(l, i + 2 * numMapNodes));
-      _coordFV[iFVi]->gXyz2gUvw(_uvw[iFVi], gXyzV, gUvwV);
-      for(int l = 0; l < numJacNodes; l++) {
-        gIJ[indGIJac(iEl, l, iPC)] = gUvwV[l][0];
-        if(_nPCFV[iFVi] >= 2) gIJ[indGIJac(iEl, l, iPC + 1)] = gUvwV[l][1];
-        if(_nPCFV[iFVi] == 3) gIJ[indGIJac(iEl, l, iPC + 2)] = gUvwV[l][2];
-      }
-      iPC += _nPCFV[iFVi];
-    }
-  }
+  jacAndGradientsBlocks(true, _IJacNormEl, _invIJac, iJ, gIJ);
 }
 
 void Patch::initInvCondNum()
@@ -92,8 +92,8 @@ public:
   inline int nNodBndEl(int iBndEl) { return _bndEl2V[iBndEl].size(); }
   inline const int &bndEl2FV(int iBndEl, int i) { return _bndEl2FV[iBndEl][i]; }
   void initScaledJac();
-  void scaledJacAndGradients(int iEl, std::vector<double> &sJ,
-                             std::vector<double> &gSJ);
+  void scaledJacAndGradients(std::vector<std::vector<double> > &sJ,
+                             std::vector<std::vector<double> > &gSJ);
   void initMetricMin();
   void metricMinAndGradients(int iEl, std::vector<double> &sJ,
                              std::vector<double> &gSJ);
@@ -112,8 +112,8 @@ public:
   }
   inline int indGICN(int iEl, int l, int iPC) { return iPC * _nICNEl[iEl] + l; }
   void initIdealJac();
-  void idealJacAndGradients(int iEl, std::vector<double> &NCJ,
-                            std::vector<double> &gNCJ);
+  void idealJacAndGradients(std::vector<std::vector<double> > &NCJ,
+                            std::vector<std::vector<double> > &gNCJ);
   void initInvCondNum();
   void invCondNumAndGradients(int iEl, std::vector<double> &condNum,
                               std::vector<double> &gCondNum);
@@ -165,6 +165,16 @@ private:
   double _invLengthScaleSq; // Square inverse of a length for node displacement
                             // scaling
 
+  // Jacobian measures, evaluated by blocks of elements with the same
+  // Jacobian basis
+  std::vector<std::vector<int> > _jacBlocks; // Elements in each block
+  void initJacBlocks();
+  void jacAndGradientsBlocks(bool ideal,
+                             const std::vector<fullMatrix<double> > &normEl,
+                             const std::vector<double> &invJacEl,
+                             std::vector<std::vector<double> > &J,
+                             std::vector<std::vector<double> > &gJ);
+
   // High-order: scaled Jacobian and metric measures
   enum NormalScaling { NS_UNIT, NS_INVNORM, NS_SQRTNORM };
   std::vector<int> _nBezEl; // Number of Bezier poly. for an el.
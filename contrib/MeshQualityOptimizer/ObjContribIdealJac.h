@@ -77,20 +77,18 @@ bool ObjContribIdealJac<FuncType>::addContrib(double &Obj,
   _min = BIGVAL;
   _max = -BIGVAL;
 
+  std::vector<std::vector<double> > iJ, gIJ; // Scaled Jacobians and gradients
+  _mesh->idealJacAndGradients(iJ, gIJ);
   for(int iEl = 0; iEl < _mesh->nEl(); iEl++) {
-    std::vector<double> iJ(_mesh->nIJacEl(iEl)); // Scaled Jacobians
-    std::vector<double> gIJ(_mesh->nIJacEl(iEl) *
-                            _mesh->nPCEl(iEl)); // Gradients of scaled Jacobians
-    _mesh->idealJacAndGradients(iEl, iJ, gIJ);
     for(int l = 0; l < _mesh->nIJacEl(iEl);
         l++) { // Add contribution for each Bezier coeff.
-      Obj += _weight * FuncType::compute(iJ[l]);
-      const double dfact = _weight * FuncType::computeDiff(iJ[l]);
+      Obj += _weight * FuncType::compute(iJ[iEl][l]);
+      const double dfact = _weight * FuncType::computeDiff(iJ[iEl][l]);
       for(int iPC = 0; iPC < _mesh->nPCEl(iEl); iPC++)
         gradObj[_mesh->indPCEl(iEl, iPC)] +=
-          dfact * gIJ[_mesh->indGIJac(iEl, l, iPC)];
-      _min = std::min(_min, iJ[l]);
-      _max = std::max(_max, iJ[l]);
+          dfact * gIJ[iEl][_mesh->indGIJac(iEl, l, iPC)];
+      _min = std::min(_min, iJ[iEl][l]);
+      _max = std::max(_max, iJ[iEl][l]);
     }
   }
 
@@ -102,14 +100,12 @@ template <class FuncType> void ObjContribIdealJac<FuncType>::updateMinMax()
   _min = BIGVAL;
   _max = -BIGVAL;
 
+  std::vector<std::vector<double> > iJ, dumGIJ; // Scaled Jacobians
+  _mesh->idealJacAndGradients(iJ, dumGIJ);
   for(int iEl = 0; iEl < _mesh->nEl(); iEl++) {
-    std::vector<double> iJ(_mesh->nIJacEl(iEl)); // Scaled Jacobians
-    std::vector<double> dumGIJ(
-      _mesh->nIJacEl(iEl) * _mesh->nPCEl(iEl)); // Gradients of scaled Jacobians
-    _mesh->idealJacAndGradients(iEl, iJ, dumGIJ);
     for(int l = 0; l < _mesh->nIJacEl(iEl); l++) { // Check each Bezier coeff.
-      _min = std::min(_min, iJ[l]);
-      _max = std::max(_max, iJ[l]);
+      _min = std::min(_min, iJ[iEl][l]);
+      _max = std::max(_max, iJ[iEl][l]);
     }
   }
 }